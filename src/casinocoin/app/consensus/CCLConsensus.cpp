@@ -44,6 +44,7 @@
 #include <casinocoin/overlay/Overlay.h>
 #include <casinocoin/overlay/predicates.h>
 #include <casinocoin/protocol/Feature.h>
+#include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/protocol/digest.h>
 
 namespace casinocoin {
@@ -672,6 +673,7 @@ applyTransactions(
         }
     }
 
+    auto& pool = app.getApplyPool();
     bool certainRetry = true;
     // Attempt to apply all of the retriable transactions
     for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
@@ -682,6 +684,28 @@ applyTransactions(
 
         auto it = retriableTxs.begin();
 
+        if (pool.size() > 1)
+        {
+            std::vector<std::shared_ptr<STTx const>> txs;
+            txs.reserve(retriableTxs.size());
+            for (auto const& item : retriableTxs)
+                txs.push_back(item.second);
+
+            for (auto const result : applyParallel(
+                     app, view, txs, certainRetry, tapNO_CHECK_SIGN,
+                     pool, j))
+            {
+                if (result == ApplyResult::Retry)
+                {
+                    ++it;
+                    continue;
+                }
+                if (result == ApplyResult::Success)
+                    ++changes;
+                it = retriableTxs.erase(it);
+            }
+        }
+
         while (it != retriableTxs.end())
         {
             try
@@ -737,6 +761,11 @@ CCLConsensus::buildLCL(
     std::chrono::milliseconds roundTime,
     CanonicalTXSet& retriableTxs)
 {
+    using clock_type = std::chrono::steady_clock;
+    using namespace std::chrono;
+    auto const start = clock_type::now();
+    CloseBreakdown breakdown;
+
     auto replay = ledgerMaster_.releaseReplay();
     if (replay)
     {
@@ -795,17 +824,27 @@ CCLConsensus::buildLCL(
     // to the ledger.
 
     buildLCL->updateSkipList();
+    auto const applied = clock_type::now();
+    breakdown.apply = duration_cast<milliseconds>(applied - start);
 
     {
         // Write the final version of all modified SHAMap
         // nodes to the node store to preserve the new LCL
 
-        int asf = buildLCL->stateMap().flushDirty(
+        breakdown.stateNodes = buildLCL->stateMap().flushDirty(
             hotACCOUNT_NODE, buildLCL->info().seq);
-        int tmf = buildLCL->txMap().flushDirty(
+        auto const stateFlushed = clock_type::now();
+        breakdown.flushState =
+            duration_cast<milliseconds>(stateFlushed - applied);
+
+        breakdown.txNodes = buildLCL->txMap().flushDirty(
             hotTRANSACTION_NODE, buildLCL->info().seq);
-        JLOG(j_.debug()) << "Flushed " << asf << " accounts and " << tmf
-                         << " transaction nodes";
+        breakdown.flushTx =
+            duration_cast<milliseconds>(clock_type::now() - stateFlushed);
+
+        JLOG(j_.debug()) << "Flushed " << breakdown.stateNodes <<
+            " accounts and " << breakdown.txNodes << " transaction nodes in " <<
+            (breakdown.flushState + breakdown.flushTx).count() << "ms";
     }
     buildLCL->unshare();
 
@@ -820,6 +859,12 @@ CCLConsensus::buildLCL(
         JLOG(j_.debug()) << "Consensus built ledger we were acquiring";
     else
         JLOG(j_.debug()) << "Consensus built new ledger";
+
+    breakdown.total = duration_cast<milliseconds>(clock_type::now() - start);
+    {
+        std::lock_guard<std::mutex> lock(closeBreakdownLock_);
+        closeBreakdown_ = breakdown;
+    }
     return CCLCxLedger{std::move(buildLCL)};
 }
 
@@ -881,6 +926,26 @@ CCLConsensus::getJson(bool full) const
     return ret;
 }
 
+Json::Value
+CCLConsensus::getCloseBreakdown() const
+{
+    CloseBreakdown breakdown;
+    {
+        std::lock_guard<std::mutex> lock(closeBreakdownLock_);
+        breakdown = closeBreakdown_;
+    }
+
+    Json::Value ret(Json::objectValue);
+    ret[jss::apply_ms] = Json::UInt(breakdown.apply.count());
+    ret[jss::flush_state_ms] = Json::UInt(breakdown.flushState.count());
+    ret[jss::flush_tx_ms] = Json::UInt(breakdown.flushTx.count());
+    ret[jss::total_ms] = Json::UInt(breakdown.total.count());
+    ret[jss::state_nodes] = breakdown.stateNodes;
+    ret[jss::tx_nodes] = breakdown.txNodes;
+    ret[jss::flush_threads] = Json::UInt(app_.family().flushPool().size());
+    return ret;
+}
+
 PublicKey const&
 CCLConsensus::getValidationPublicKey() const
 {
@@ -129,6 +129,13 @@ public:
     Json::Value
     getJson(bool full) const;
 
+    /** Get where the time building the last closed ledger went.
+
+        Called by the server_info RPC.
+    */
+    Json::Value
+    getCloseBreakdown() const;
+
     //! See Consensus::startRound
     void
     startRound(
@@ -383,6 +390,19 @@ private:
     // only used for our own validations.
     NetClock::time_point lastValidationTime_;
 
+    // Time spent building the last closed ledger
+    struct CloseBreakdown
+    {
+        std::chrono::milliseconds apply{0};
+        std::chrono::milliseconds flushState{0};
+        std::chrono::milliseconds flushTx{0};
+        std::chrono::milliseconds total{0};
+        int stateNodes = 0;
+        int txNodes = 0;
+    };
+    CloseBreakdown closeBreakdown_;
+    std::mutex mutable closeBreakdownLock_;
+
     using PeerPositions = hash_map<NodeID, std::deque<CCLCxPeerPos::pointer>>;
     PeerPositions peerPositions_;
     std::mutex peerPositionsLock_;
@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_LEDGER_FETCHSCHEDULER_H_INCLUDED
+#define CASINOCOIN_APP_LEDGER_FETCHSCHEDULER_H_INCLUDED
+
+#include <casinocoin/basics/DecayingSample.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/basics/base_uint.h>
+#include <casinocoin/beast/clock/abstract_clock.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/overlay/Peer.h>
+#include <boost/optional.hpp>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace casinocoin {
+
+/** Decides how many ledger nodes to ask each peer for.
+
+    Every peer gets a window of nodes it may have outstanding. The
+    window follows the rate at which the peer answers, so that a
+    request is answered in about `targetReply`, and is halved when a
+    request goes unanswered. The time a peer takes to answer is also
+    used to tell when a node asked of it should be asked of another.
+
+    Shared by all inbound ledgers, so a peer busy with one acquisition
+    is asked for less by the others.
+*/
+class FetchScheduler
+{
+public:
+    using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+    using time_point = clock_type::time_point;
+
+    struct Setup
+    {
+        // Nodes a peer we know nothing about may have outstanding
+        std::size_t initialWindow = 32;
+        std::size_t minWindow = 8;
+        std::size_t maxWindow = 1024;
+
+        // How long a request should take to be answered
+        std::chrono::milliseconds targetReply {500};
+
+        // Bounds on how long to wait before asking another peer
+        std::chrono::milliseconds minTimeout {250};
+        std::chrono::milliseconds maxTimeout {2000};
+
+        // Forget peers we have not asked for this long
+        std::chrono::seconds idle {300};
+    };
+
+    /** A peer to ask and the round trip time of its pings, if known */
+    using Candidate = std::pair<
+        Peer::id_t, boost::optional<std::chrono::milliseconds>>;
+
+    explicit
+    FetchScheduler (time_point now);
+
+    FetchScheduler (time_point now, Setup const& setup);
+
+    /** Order peers by how soon they should answer a new request.
+
+        @return The peers with room in their window, fastest first,
+                each with the number of nodes it may be asked for.
+    */
+    std::vector<std::pair<Peer::id_t, std::size_t>>
+    select (std::vector<Candidate> const& peers, time_point now);
+
+    /** A request for nodes of a ledger was sent to a peer */
+    void
+    sent (Peer::id_t peer, uint256 const& ledger,
+        std::size_t nodes, time_point now);
+
+    /** A peer answered a request for nodes of a ledger.
+
+        @return When the answered request was sent, if it is known.
+    */
+    boost::optional<time_point>
+    received (Peer::id_t peer, uint256 const& ledger,
+        std::size_t nodes, std::size_t bytes, time_point now);
+
+    /** Nodes that had to be asked of another peer */
+    void
+    retried (std::size_t nodes);
+
+    /** How long to wait for a peer before asking another */
+    std::chrono::milliseconds
+    timeout (Peer::id_t peer);
+
+    /** Forget peers that have not been asked for a while */
+    void
+    sweep (time_point now);
+
+    /** Overall and per peer acquisition throughput */
+    Json::Value
+    getJson (time_point now);
+
+private:
+    struct Request
+    {
+        uint256 ledger;
+        std::size_t nodes;
+        time_point sent;
+    };
+
+    struct PeerState
+    {
+        explicit
+        PeerState (time_point now);
+
+        // Smoothed time to answer a request
+        std::chrono::milliseconds latency {0};
+        bool measured = false;
+
+        // Smoothed rates over the requests answered
+        double nodesPerSecond = 0;
+        double bytesPerSecond = 0;
+
+        double window;
+        std::size_t inFlight = 0;
+        std::deque<Request> requests;
+
+        std::uint64_t replies = 0;
+        std::uint64_t lost = 0;
+        time_point last;
+    };
+
+    PeerState&
+    get (Peer::id_t peer, time_point now);
+
+    std::chrono::milliseconds
+    timeout (PeerState const& ps) const;
+
+    // Give up on requests that have not been answered in time
+    void
+    expire (PeerState& ps, time_point now);
+
+    Setup const setup_;
+
+    std::mutex mutex_;
+    hash_map<Peer::id_t, PeerState> peers_;
+
+    DecayWindow<30, clock_type> nodesRate_;
+    DecayWindow<30, clock_type> bytesRate_;
+    std::uint64_t retried_ = 0;
+};
+
+} // casinocoin
+
+#endif
@@ -30,6 +30,7 @@
 #include <casinocoin/app/ledger/Ledger.h>
 #include <casinocoin/overlay/PeerSet.h>
 #include <casinocoin/basics/CountedObject.h>
+#include <map>
 #include <mutex>
 #include <set>
 #include <utility>
@@ -94,6 +95,12 @@ public:
 
     void runData ();
 
+    static
+    LedgerInfo
+    deserializeHeader (
+        Slice data,
+        bool hasPrefix);
+
 private:
     enum class TriggerReason
     {
@@ -102,9 +109,9 @@ private:
         timeout
     };
 
-    void filterNodes (
-        std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
-        TriggerReason reason);
+    bool requestNodes (
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+        protocol::TMGetLedger& tmGL);
 
     void trigger (std::shared_ptr<Peer> const&, TriggerReason);
 
@@ -152,10 +159,10 @@ private:
     neededStateHashes (
         int max, SHAMapSyncFilter* filter) const;
 
-    LedgerInfo
-    deserializeHeader (
-        Slice data,
-        bool hasPrefix);
+    // Ask a peer for the delta from a parent we have
+    bool tryDelta (std::shared_ptr<Peer> const& peer);
+    int takeDelta (std::shared_ptr<Peer> const& peer,
+        protocol::TMLedgerData& packet);
 
 private:
     std::shared_ptr<Ledger> mLedger;
@@ -167,13 +174,25 @@ private:
     std::uint32_t      mSeq;
     fcReason           mReason;
 
-    std::set <uint256> mRecentNodes;
+    // Nodes asked for and not yet answered
+    struct NodeRequest
+    {
+        Peer::id_t peer;
+        clock_type::time_point sent;
+    };
+    std::map <uint256, NodeRequest> mRequestedNodes;
 
     SHAMapAddNode      mStats;
 
+    // The parent a requested delta is applied to
+    std::shared_ptr<Ledger const> mDeltaParent;
+    bool               mDeltaTried;
+
     // Data we have received from peers
     std::mutex mReceivedDataLock;
     std::vector <PeerDataPairType> mReceivedData;
+    // When the latest request each peer answered was sent
+    std::map <Peer::id_t, clock_type::time_point> mAnswered;
     bool mReceiveDispatched;
 };
 
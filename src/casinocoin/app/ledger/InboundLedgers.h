@@ -26,6 +26,7 @@
 #ifndef CASINOCOIN_APP_LEDGER_INBOUNDLEDGERS_H_INCLUDED
 #define CASINOCOIN_APP_LEDGER_INBOUNDLEDGERS_H_INCLUDED
 
+#include <casinocoin/app/ledger/FetchScheduler.h>
 #include <casinocoin/app/ledger/InboundLedger.h>
 #include <casinocoin/protocol/CasinocoinLedgerHash.h>
 #include <casinocoin/core/Stoppable.h>
@@ -80,6 +81,9 @@ public:
     /** Called when a complete ledger is obtained. */
     virtual void onLedgerFetched (InboundLedger::fcReason why) = 0;
 
+    /** Decides which peers are asked for the nodes of a ledger. */
+    virtual FetchScheduler& scheduler () = 0;
+
     virtual void gotFetchPack () = 0;
     virtual void sweep () = 0;
 
@@ -34,6 +34,7 @@
 #include <casinocoin/app/ledger/PendingSaves.h>
 #include <casinocoin/app/ledger/TransactionMaster.h>
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
@@ -686,6 +687,7 @@ void Ledger::updateLedgerConfigFromLedger()
                 if (entry.fromBytes((*iter).getFieldVL(sfConfigData)))
                     ledgerConfig_.entries.push_back(entry);
             }
+            ledgerConfig_.compileWLT();
             ledgerConfig_.lastUpdateIndex = info().seq;
         }
     }
@@ -917,8 +919,13 @@ static bool saveValidatedLedger (
 
         soci::transaction tr(*db);
 
+        // The store keeps the account transactions instead
+        auto const store = app.getAccountTxStore ();
+        std::vector<AccountTxStore::Record> records;
+
         *db << boost::str (deleteTrans1 % seq);
-        *db << boost::str (deleteTrans2 % seq);
+        if (! store)
+            *db << boost::str (deleteTrans2 % seq);
 
         std::string const ledgerSeq (std::to_string (seq));
 
@@ -932,52 +939,63 @@ static bool saveValidatedLedger (
             std::string const txnId (to_string (transactionID));
             std::string const txnSeq (std::to_string (vt.second->getTxnSeq ()));
 
-            *db << boost::str (deleteAcctTrans % transactionID);
-
             auto const& accts = vt.second->getAffected ();
 
-            if (!accts.empty ())
+            if (store)
             {
-                std::string sql (
-                    "INSERT INTO AccountTransactions "
-                    "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
-
-                // Try to make an educated guess on how much space we'll need
-                // for our arguments. In argument order we have:
-                // 64 + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                sql.reserve (sql.length () + (accts.size () * 128));
+                records.emplace_back ();
+                auto& r = records.back ();
+                r.id = transactionID;
+                r.txnSeq = vt.second->getTxnSeq ();
+                r.accounts.assign (accts.begin (), accts.end ());
+            }
+            else
+            {
+                *db << boost::str (deleteAcctTrans % transactionID);
 
-                bool first = true;
-                for (auto const& account : accts)
+                if (!accts.empty ())
                 {
-                    if (!first)
-                        sql += ", ('";
-                    else
+                    std::string sql (
+                        "INSERT INTO AccountTransactions "
+                        "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
+
+                    // Try to make an educated guess on how much space we'll
+                    // need for our arguments. In argument order we have:
+                    // 64 + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
+                    sql.reserve (sql.length () + (accts.size () * 128));
+
+                    bool first = true;
+                    for (auto const& account : accts)
                     {
-                        sql += "('";
-                        first = false;
+                        if (!first)
+                            sql += ", ('";
+                        else
+                        {
+                            sql += "('";
+                            first = false;
+                        }
+
+                        sql += txnId;
+                        sql += "','";
+                        sql += app.accountIDCache().toBase58(account);
+                        sql += "',";
+                        sql += ledgerSeq;
+                        sql += ",";
+                        sql += txnSeq;
+                        sql += ")";
                     }
-
-                    sql += txnId;
-                    sql += "','";
-                    sql += app.accountIDCache().toBase58(account);
-                    sql += "',";
-                    sql += ledgerSeq;
-                    sql += ",";
-                    sql += txnSeq;
-                    sql += ")";
+                    sql += ";";
+                    JLOG (j.trace()) << "ActTx: " << sql;
+                    *db << sql;
+                }
+                else
+                {
+                    JLOG (j.warn())
+                        << "Transaction in ledger " << seq
+                        << " affects no accounts";
+                    JLOG (j.warn())
+                        << vt.second->getTxn()->getJson(0);
                 }
-                sql += ";";
-                JLOG (j.trace()) << "ActTx: " << sql;
-                *db << sql;
-            }
-            else
-            {
-                JLOG (j.warn())
-                    << "Transaction in ledger " << seq
-                    << " affects no accounts";
-                JLOG (j.warn())
-                    << vt.second->getTxn()->getJson(0);
             }
 
             *db <<
@@ -986,6 +1004,9 @@ static bool saveValidatedLedger (
                     seq, vt.second->getEscMeta ()) + ";");
         }
 
+        if (store)
+            store->saveLedger (seq, records);
+
         tr.commit ();
     }
 
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_LEDGER_LEDGERREPLAY_H_INCLUDED
+#define CASINOCOIN_APP_LEDGER_LEDGERREPLAY_H_INCLUDED
+
+#include <casinocoin/app/ledger/Ledger.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/core/Config.h>
+#include "casinocoin.pb.h"
+#include <memory>
+
+namespace casinocoin {
+
+/** Ledger deltas, for replaying a ledger on top of its parent.
+
+    Acquiring a ledger node by node takes many round trips, even when
+    only a few state entries changed since a ledger we already have. A
+    server holding the parent can instead ask a peer for the ledger's
+    delta: a TMLedgerData of type liDELTA whose first node is the ledger
+    header, followed by txCount transaction nodes keyed by transaction
+    ID and then the state entries the ledger created, modified or
+    deleted, keyed by index.
+
+    Applying the delta to a snapshot of the parent's state map and
+    filling a new transaction map rebuilds the ledger, which is only
+    accepted if its hash matches the one asked for.
+*/
+
+/** Add the delta of a ledger to its parent to a reply.
+
+    @param maxNodes The largest number of nodes the reply may hold.
+
+    @return `false` if the ledger doesn't follow parent, changed too
+            much, or if nodes of either ledger are missing locally.
+*/
+bool
+makeLedgerDelta (
+    Ledger const& ledger,
+    Ledger const& parent,
+    protocol::TMLedgerData& reply,
+    int maxNodes);
+
+/** Rebuild a ledger from its parent and a delta.
+
+    The new nodes of both maps are written to the node store.
+
+    @param hash The hash the ledger must have.
+
+    @return The immutable ledger, or `nullptr` if the delta is malformed
+            or doesn't produce the ledger asked for.
+*/
+std::shared_ptr<Ledger>
+applyLedgerDelta (
+    Ledger const& parent,
+    uint256 const& hash,
+    protocol::TMLedgerData const& delta,
+    Config const& config,
+    beast::Journal j);
+
+} // casinocoin
+
+#endif
@@ -24,7 +24,9 @@
 #include <casinocoin/ledger/CachedSLEs.h>
 #include <casinocoin/ledger/OpenView.h>
 #include <casinocoin/app/misc/CanonicalTXSet.h>
+#include <casinocoin/app/tx/apply.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/TaskPool.h>
 #include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/core/Config.h>
 #include <casinocoin/beast/utility/Journal.h>
@@ -198,6 +200,10 @@ private:
         std::shared_ptr< STTx const> const& tx,
             bool retry, ApplyFlags flags,
                 beast::Journal j);
+
+    static
+    TaskPool&
+    apply_pool (Application& app);
 };
 
 //------------------------------------------------------------------------------
@@ -209,6 +215,9 @@ OpenLedger::apply (Application& app, OpenView& view,
         OrderedTxs& retries, ApplyFlags flags,
             beast::Journal j)
 {
+    auto& pool = apply_pool(app);
+    auto const workers = pool.size();
+    std::vector<std::shared_ptr<STTx const>> batch;
     for (auto iter = txs.begin();
         iter != txs.end(); ++iter)
     {
@@ -219,6 +228,11 @@ OpenLedger::apply (Application& app, OpenView& view,
             auto const tx = *iter;
             if (check.txExists(tx->getTransactionID()))
                 continue;
+            if (workers > 1)
+            {
+                batch.push_back(tx);
+                continue;
+            }
             auto const result = apply_one(app, view,
                 tx, true, flags, j);
             if (result == Result::retry)
@@ -230,6 +244,16 @@ OpenLedger::apply (Application& app, OpenView& view,
                 "Caught exception";
         }
     }
+    if (! batch.empty())
+    {
+        auto const results = applyParallel(app, view,
+            batch, true, flags, pool, j);
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            if (results[i] == ApplyResult::Retry)
+                retries.insert(batch[i]);
+        }
+    }
     bool retry = true;
     for (int pass = 0;
         pass < LEDGER_TOTAL_PASSES;
@@ -237,6 +261,24 @@ OpenLedger::apply (Application& app, OpenView& view,
     {
         int changes = 0;
         auto iter = retries.begin();
+        if (workers > 1)
+        {
+            batch.clear();
+            for (auto const& item : retries)
+                batch.push_back(item.second);
+            for (auto const result : applyParallel(app, view,
+                batch, retry, flags, pool, j))
+            {
+                if (result == ApplyResult::Retry)
+                {
+                    ++iter;
+                    continue;
+                }
+                if (result == ApplyResult::Success)
+                    ++changes;
+                iter = retries.erase (iter);
+            }
+        }
         while (iter != retries.end())
         {
             switch (apply_one(app, view,
@@ -31,20 +31,23 @@
 #include <casinocoin/core/Config.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/protocol/Indexes.h>
+#include <algorithm>
 
 namespace casinocoin {
 
 OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , app_ (app)
+    , mBooks (std::make_shared<Books const> ())
     , mSeq (0)
+    , mScanSeq (0)
     , j_ (app.journal ("OrderBookDB"))
 {
 }
 
 void OrderBookDB::invalidate ()
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    std::lock_guard <std::mutex> sl (mLock);
     mSeq = 0;
 }
 
@@ -52,24 +55,26 @@ void OrderBookDB::setup(
     std::shared_ptr<ReadView const> const& ledger)
 {
     {
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+        std::lock_guard <std::mutex> sl (mLock);
         auto seq = ledger->info().seq;
 
-        // Do a full update every 256 ledgers
-        if (mSeq != 0)
+        // Once seeded the index follows the published ledgers, only
+        // rescan if it lost track of them
+        auto const current = mScanSeq != 0 ? mScanSeq : mSeq;
+        if (current != 0)
         {
-            if (seq == mSeq)
+            if (seq == current)
                 return;
-            if ((seq > mSeq) && ((seq - mSeq) < 256))
+            if ((seq > current) && ((seq - current) < 256))
                 return;
-            if ((seq < mSeq) && ((mSeq - seq) < 16))
+            if ((seq < current) && ((current - seq) < 16))
                 return;
         }
 
         JLOG (j_.debug())
-            << "Advancing from " << mSeq << " to " << seq;
+            << "Advancing from " << current << " to " << seq;
 
-        mSeq = seq;
+        mScanSeq = seq;
     }
 
     if (app_.config().PATH_SEARCH_MAX == 0)
@@ -87,10 +92,8 @@ void OrderBookDB::setup(
 void OrderBookDB::update(
     std::shared_ptr<ReadView const> const& ledger)
 {
-    hash_set< uint256 > seen;
-    OrderBookDB::IssueToOrderBook destMap;
-    OrderBookDB::IssueToOrderBook sourceMap;
-    hash_set< Issue > CSCBooks;
+    auto books = std::make_shared<Books> ();
+    hash_map< uint256, std::size_t > dirCount;
 
     JLOG (j_.debug()) << "OrderBookDB::update>";
 
@@ -100,9 +103,9 @@ void OrderBookDB::update(
         return;
     }
 
-    // walk through the entire ledger looking for orderbook entries
-    int books = 0;
+    auto const seq = ledger->info().seq;
 
+    // walk through the entire ledger looking for orderbook entries
     try
     {
         for(auto& sle : ledger->sles)
@@ -121,16 +124,8 @@ void OrderBookDB::update(
                 book.out.currency.copyFrom (sle->getFieldH160(
                     sfTakerGetsCurrency));
 
-                uint256 index = getBookBase (book);
-                if (seen.insert (index).second)
-                {
-                    auto orderBook = std::make_shared<OrderBook> (index, book);
-                    sourceMap[book.in].push_back (orderBook);
-                    destMap[book.out].push_back (orderBook);
-                    if (isCSC(book.out))
-                        CSCBooks.insert(book.in);
-                    ++books;
-                }
+                if (++dirCount[getBookBase (book)] == 1)
+                    rawAddBook (*books, book);
             }
         }
     }
@@ -138,98 +133,311 @@ void OrderBookDB::update(
     {
         JLOG (j_.info())
             << "OrderBookDB::update encountered a missing node";
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+        std::lock_guard <std::mutex> sl (mLock);
         mSeq = 0;
+        if (mScanSeq == seq)
+        {
+            mScanSeq = 0;
+            mPending.clear ();
+        }
         return;
     }
 
     JLOG (j_.debug())
-        << "OrderBookDB::update< " << books << " books found";
+        << "OrderBookDB::update< " << dirCount.size () << " books found";
     {
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+        std::lock_guard <std::mutex> sl (mLock);
+
+        if (mScanSeq != 0 && mScanSeq != seq)
+        {
+            // A scan of a different ledger superseded this one
+            return;
+        }
+
+        mDirCount.swap (dirCount);
+        mSeq = seq;
+        mScanSeq = 0;
 
-        mCSCBooks.swap(CSCBooks);
-        mSourceMap.swap(sourceMap);
-        mDestMap.swap(destMap);
+        // Catch up with the ledgers published during the scan
+        auto it = mPending.begin ();
+        while (it != mPending.end () && it->first <= mSeq)
+            ++it;
+        for (; it != mPending.end () && it->first == mSeq + 1; ++it)
+        {
+            applyDelta (*books, it->second);
+            mSeq = it->first;
+        }
+        mPending.clear ();
+
+        std::atomic_store (&mBooks,
+            std::shared_ptr<Books const> (std::move (books)));
     }
     app_.getLedgerMaster().newOrderBookDB();
 }
 
+void OrderBookDB::update (
+    std::shared_ptr<ReadView const> const& ledger,
+    AcceptedLedger const& accepted)
+{
+    if (app_.config().PATH_SEARCH_MAX == 0)
+        return;
+
+    auto const seq = ledger->info().seq;
+    auto delta = getDelta (accepted);
+    bool changed = false;
+    bool rescan = false;
+    {
+        std::lock_guard <std::mutex> sl (mLock);
+
+        if (mScanSeq != 0)
+        {
+            // Applied once the scan completes
+            if (seq > mScanSeq)
+                mPending[seq] = std::move (delta);
+            return;
+        }
+
+        // Already reflected
+        if (mSeq != 0 && seq <= mSeq)
+            return;
+
+        if (mSeq != 0 && seq == mSeq + 1)
+        {
+            mSeq = seq;
+            if (delta.empty ())
+                return;
+
+            auto books = std::make_shared<Books> (*snapshot ());
+            changed = applyDelta (*books, delta);
+            if (changed)
+            {
+                std::atomic_store (&mBooks,
+                    std::shared_ptr<Books const> (std::move (books)));
+            }
+        }
+        else
+        {
+            JLOG (j_.debug())
+                << "Ledger " << seq << " does not follow " << mSeq;
+            mSeq = 0;
+            rescan = true;
+        }
+    }
+
+    if (changed)
+        app_.getLedgerMaster().newOrderBookDB();
+    else if (rescan)
+        setup (ledger);
+}
+
+OrderBookDB::Delta OrderBookDB::getDelta (AcceptedLedger const& accepted)
+{
+    // Fields at their default value are omitted from the metadata of a
+    // created node, so a missing currency or issuer is CSC
+    auto const h160 = [](STObject const& obj, SField const& field)
+    {
+        uint160 ret;
+        if (obj.isFieldPresent (field))
+            ret = obj.getFieldH160 (field);
+        return ret;
+    };
+
+    Delta delta;
+    for (auto const& item : accepted.getMap ())
+    {
+        // Transactions that claim a fee can still remove offers
+        for (auto const& node : item.second->getMeta ()->getNodes ())
+        {
+            bool created;
+            SField const* field;
+            if (node.getFName () == sfCreatedNode)
+            {
+                created = true;
+                field = &sfNewFields;
+            }
+            else if (node.getFName () == sfDeletedNode)
+            {
+                created = false;
+                field = &sfFinalFields;
+            }
+            else
+            {
+                continue;
+            }
+
+            if (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            auto data = dynamic_cast<const STObject*> (
+                node.peekAtPField (*field));
+
+            // Book directories always have a non-CSC side, owner
+            // directories have neither currency, and only the root of
+            // a directory identifies it.
+            if (! data ||
+                ! data->isFieldPresent (sfRootIndex) ||
+                data->getFieldH256 (sfRootIndex) !=
+                    node.getFieldH256 (sfLedgerIndex) ||
+                (! data->isFieldPresent (sfTakerPaysCurrency) &&
+                    ! data->isFieldPresent (sfTakerGetsCurrency)))
+            {
+                continue;
+            }
+
+            Book book;
+            book.in.currency.copyFrom (h160 (*data, sfTakerPaysCurrency));
+            book.in.account.copyFrom (h160 (*data, sfTakerPaysIssuer));
+            book.out.account.copyFrom (h160 (*data, sfTakerGetsIssuer));
+            book.out.currency.copyFrom (h160 (*data, sfTakerGetsCurrency));
+            delta.push_back ({created, book});
+        }
+    }
+    return delta;
+}
+
+bool OrderBookDB::applyDelta (Books& books, Delta const& delta)
+{
+    bool changed = false;
+    for (auto const& change : delta)
+    {
+        auto const index = getBookBase (change.book);
+        if (change.created)
+        {
+            if (++mDirCount[index] == 1)
+                changed |= rawAddBook (books, change.book);
+        }
+        else
+        {
+            auto it = mDirCount.find (index);
+            if (it != mDirCount.end () && --it->second == 0)
+            {
+                mDirCount.erase (it);
+                rawRemoveBook (books, change.book);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool OrderBookDB::rawAddBook (Books& books, Book const& book)
+{
+    auto const index = getBookBase (book);
+    auto& source = books.sourceMap[book.in];
+    for (auto const& ob : source)
+    {
+        if (ob->getBookBase () == index)
+            return false;
+    }
+
+    auto orderBook = std::make_shared<OrderBook> (index, book);
+    source.push_back (orderBook);
+    books.destMap[book.out].push_back (orderBook);
+    if (isCSC (book.out))
+        books.cscBooks.insert (book.in);
+    return true;
+}
+
+void OrderBookDB::rawRemoveBook (Books& books, Book const& book)
+{
+    auto const index = getBookBase (book);
+    auto const remove = [&index](IssueToOrderBook& map, Issue const& issue)
+    {
+        auto it = map.find (issue);
+        if (it == map.end ())
+            return;
+        auto& list = it->second;
+        list.erase (std::remove_if (list.begin (), list.end (),
+            [&index](OrderBook::pointer const& ob)
+            {
+                return ob->getBookBase () == index;
+            }), list.end ());
+        if (list.empty ())
+            map.erase (it);
+    };
+
+    remove (books.sourceMap, book.in);
+    remove (books.destMap, book.out);
+    if (isCSC (book.out))
+        books.cscBooks.erase (book.in);
+}
+
+std::shared_ptr<OrderBookDB::Books const> OrderBookDB::snapshot () const
+{
+    return std::atomic_load (&mBooks);
+}
+
 void OrderBookDB::addOrderBook(Book const& book)
 {
     bool toCSC = isCSC (book.out);
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    auto const current = snapshot ();
 
     if (toCSC)
     {
         // We don't want to search through all the to-CSC or from-CSC order
         // books!
-        for (auto ob: mSourceMap[book.in])
-        {
-            if (isCSC (ob->getCurrencyOut ())) // also to CSC
-                return;
-        }
+        if (current->cscBooks.count (book.in))
+            return;
     }
     else
     {
-        for (auto ob: mDestMap[book.out])
+        auto it = current->destMap.find (book.out);
+        if (it != current->destMap.end ())
         {
-            if (ob->getCurrencyIn() == book.in.currency &&
-                ob->getIssuerIn() == book.in.account)
+            for (auto const& ob: it->second)
             {
-                return;
+                if (ob->getCurrencyIn() == book.in.currency &&
+                    ob->getIssuerIn() == book.in.account)
+                {
+                    return;
+                }
             }
         }
     }
-    uint256 index = getBookBase(book);
-    auto orderBook = std::make_shared<OrderBook> (index, book);
 
-    mSourceMap[book.in].push_back (orderBook);
-    mDestMap[book.out].push_back (orderBook);
-    if (toCSC)
-        mCSCBooks.insert(book.in);
+    std::lock_guard <std::mutex> sl (mLock);
+    auto books = std::make_shared<Books> (*snapshot ());
+    if (rawAddBook (*books, book))
+    {
+        std::atomic_store (&mBooks,
+            std::shared_ptr<Books const> (std::move (books)));
+    }
 }
 
 // return list of all orderbooks that want this issuerID and currencyID
 OrderBook::List OrderBookDB::getBooksByTakerPays (Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto it = mSourceMap.find (issue);
-    return it == mSourceMap.end () ? OrderBook::List() : it->second;
+    auto const books = snapshot ();
+    auto it = books->sourceMap.find (issue);
+    return it == books->sourceMap.end () ? OrderBook::List() : it->second;
 }
 
 int OrderBookDB::getBookSize(Issue const& issue) {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto it = mSourceMap.find (issue);
-    return it == mSourceMap.end () ? 0 : it->second.size();
+    auto const books = snapshot ();
+    auto it = books->sourceMap.find (issue);
+    return it == books->sourceMap.end () ? 0 : it->second.size();
 }
 
 bool OrderBookDB::isBookToCSC(Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    return mCSCBooks.count(issue) > 0;
+    return snapshot ()->cscBooks.count(issue) > 0;
 }
 
 BookListeners::pointer OrderBookDB::makeBookListeners (Book const& book)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto ret = getBookListeners (book);
+    std::lock_guard <std::mutex> sl (mListenersLock);
+    auto& ret = mListeners [book];
 
     if (!ret)
-    {
         ret = std::make_shared<BookListeners> ();
 
-        mListeners [book] = ret;
-        assert (getBookListeners (book) == ret);
-    }
-
     return ret;
 }
 
 BookListeners::pointer OrderBookDB::getBookListeners (Book const& book)
 {
     BookListeners::pointer ret;
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    std::lock_guard <std::mutex> sl (mListenersLock);
 
     auto it0 = mListeners.find (book);
     if (it0 != mListeners.end ())
@@ -244,7 +452,6 @@ void OrderBookDB::processTxn (
     std::shared_ptr<ReadView const> const& ledger,
         const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
     if (alTx.getResult () == tesSUCCESS)
     {
         // For this particular transaction, maintain the set of unique
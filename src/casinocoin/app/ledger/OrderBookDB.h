@@ -26,14 +26,25 @@
 #ifndef CASINOCOIN_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 #define CASINOCOIN_APP_LEDGER_ORDERBOOKDB_H_INCLUDED
 
+#include <casinocoin/app/ledger/AcceptedLedger.h>
 #include <casinocoin/app/ledger/AcceptedLedgerTx.h>
 #include <casinocoin/app/ledger/BookListeners.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/OrderBook.h>
+#include <map>
 #include <mutex>
 
 namespace casinocoin {
 
+/** Index of the order books present in the ledger.
+
+    The index is seeded with a full scan of a ledger and then kept
+    current from the metadata of each ledger that is published, which
+    only costs work for the book directories that were created or
+    deleted. Pathfinding reads an immutable snapshot of the index that
+    is replaced as a whole whenever the set of books changes, so readers
+    never wait for an update.
+*/
 class OrderBookDB
     : public Stoppable
 {
@@ -44,6 +55,16 @@ public:
     void update (std::shared_ptr<ReadView const> const& ledger);
     void invalidate ();
 
+    /** Bring the index up to date with a published ledger.
+
+        Applies the order book directories created and deleted by the
+        ledger's transactions. If the ledger does not directly follow
+        the one the index reflects, a full scan is scheduled instead.
+    */
+    void update (
+        std::shared_ptr<ReadView const> const& ledger,
+        AcceptedLedger const& accepted);
+
     void addOrderBook(Book const&);
 
     /** @return a list of all orderbooks that want this issuerID and currencyID.
@@ -67,27 +88,64 @@ public:
     using IssueToOrderBook = hash_map <Issue, OrderBook::List>;
 
 private:
-    void rawAddBook(Book const&);
+    struct Books
+    {
+        // by ci/ii
+        IssueToOrderBook sourceMap;
+
+        // by co/io
+        IssueToOrderBook destMap;
+
+        // does an order book to CSC exist
+        hash_set <Issue> cscBooks;
+    };
+
+    // A root book directory created or deleted by a ledger
+    struct DirChange
+    {
+        bool created;
+        Book book;
+    };
+
+    using Delta = std::vector<DirChange>;
+
+    static bool rawAddBook (Books& books, Book const&);
+    static void rawRemoveBook (Books& books, Book const&);
+
+    // Extract the book directory changes from a ledger's metadata
+    Delta getDelta (AcceptedLedger const& accepted);
+
+    // Apply a delta to books, returns true if the set of books changed
+    bool applyDelta (Books& books, Delta const& delta);
+
+    std::shared_ptr<Books const> snapshot () const;
 
     Application& app_;
 
-    // by ci/ii
-    IssueToOrderBook mSourceMap;
+    // The snapshot is immutable once published and only ever replaced as
+    // a whole, so readers access it with std::atomic_load and never take
+    // mLock.
+    std::shared_ptr<Books const> mBooks;
 
-    // by co/io
-    IssueToOrderBook mDestMap;
+    std::mutex mLock;
 
-    // does an order book to CSC exist
-    hash_set <Issue> mCSCBooks;
+    // Number of root quality directories per book base
+    hash_map <uint256, std::size_t> mDirCount;
 
-    std::recursive_mutex mLock;
+    // Ledger the index reflects, 0 if it needs a full scan
+    std::uint32_t mSeq;
+
+    // Ledger being scanned, 0 if no scan is in progress
+    std::uint32_t mScanSeq;
+
+    // Deltas of ledgers published while a scan is in progress
+    std::map <std::uint32_t, Delta> mPending;
 
     using BookToListenersMap = hash_map <Book, BookListeners::pointer>;
 
+    std::mutex mListenersLock;
     BookToListenersMap mListeners;
 
-    std::uint32_t mSeq;
-
     beast::Journal j_;
 };
 
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_LEDGER_OWNERDIRINDEX_H_INCLUDED
+#define CASINOCOIN_APP_LEDGER_OWNERDIRINDEX_H_INCLUDED
+
+#include <casinocoin/app/ledger/AcceptedLedger.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/ledger/AccountIndex.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <casinocoin/protocol/LedgerFormats.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace casinocoin {
+
+/** Owner directories of accounts, kept across ledgers.
+
+    The account_lines, account_offers and account_objects requests page
+    through an owner directory. Without the index each page costs a read
+    of every directory node and of every object in the way, including
+    the ones of other types, which for an account owning hundreds of
+    thousands of objects means many node store reads per page.
+
+    When enabled, the index holds the directory pages of the accounts
+    asked about, with the type of each object, and is patched from the
+    metadata of each published ledger by reading the directory pages the
+    ledger changed. A page of results then only reads the objects it
+    returns. The directories share their unchanged pages with later
+    versions.
+
+    Only requests on the last validated ledger use the index. The open
+    ledger, which is what requests get by default, and any other closed
+    ledger are read from the state map as before.
+
+    @see AccountIndex
+*/
+class OwnerDirIndex
+{
+public:
+    struct Entry
+    {
+        uint256 key;
+        LedgerEntryType type;
+    };
+
+    struct Page
+    {
+        uint256 key;
+        std::vector<Entry> entries;
+    };
+
+    /** The pages of a directory by page number, in directory order */
+    using Directory = std::map<std::uint64_t, std::shared_ptr<Page const>>;
+
+    /** Create an index.
+
+        @param maxAccounts The number of directories kept, 0 to disable
+                           the index.
+    */
+    OwnerDirIndex (std::size_t maxAccounts, beast::Journal journal);
+
+    bool
+    enabled () const
+    {
+        return index_.limit () != 0;
+    }
+
+    /** Returns the owner directory of an account in a ledger.
+
+        The directory is read from the ledger the first time it is
+        asked for.
+
+        @return `nullptr` if the index is disabled or `ledger` isn't
+                the last published ledger.
+    */
+    std::shared_ptr<Directory const>
+    getDirectory (ReadView const& ledger, AccountID const& account);
+
+    /** Bring the index up to date with a published ledger. */
+    void
+    update (ReadView const& ledger, AcceptedLedger const& accepted);
+
+    /** Iterate the objects in an owner directory after a marker.
+
+        Behaves as the forEachItemAfter in View.h, reading the
+        directory from the index when `view` is the last published
+        ledger, and from `view` otherwise. Objects of
+        another type than `type` are skipped without being read, and
+        without calling `f`.
+
+        @param type The type of objects wanted, or ltANY for all.
+    */
+    bool
+    forEachItemAfter (ReadView const& view, AccountID const& id,
+        LedgerEntryType type, uint256 const& after, std::uint64_t hint,
+            unsigned int limit, std::function<
+                bool (std::shared_ptr<SLE const> const&)> f);
+
+    /** Number of accounts whose directory is known */
+    std::size_t
+    size () const;
+
+    /** Sequence of the ledger the index reflects, 0 if none */
+    LedgerIndex
+    seq () const;
+
+private:
+    // Directory pages changed by a ledger, and the types of the objects
+    // it created, which are read from the metadata
+    struct Delta
+    {
+        hash_map<AccountID, hash_set<uint256>> pages;
+        hash_map<uint256, LedgerEntryType> created;
+    };
+
+    // Read an owner directory from a ledger
+    static
+    std::shared_ptr<Directory const>
+    load (ReadView const& ledger, AccountID const& account);
+
+    // Extract the owner directory changes from a ledger's metadata
+    static
+    bool
+    getDelta (AcceptedLedger const& accepted, Delta& delta);
+
+    // Returns a directory after a ledger's changes, nullptr if it
+    // can't be patched
+    static
+    std::shared_ptr<Directory const>
+    patch (ReadView const& ledger, AccountID const& account,
+        Directory const& dir, hash_set<uint256> const& pages,
+            hash_map<uint256, LedgerEntryType> const& created);
+
+    AccountIndex<Directory> index_;
+};
+
+} // casinocoin
+
+#endif
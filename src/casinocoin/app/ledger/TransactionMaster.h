@@ -26,6 +26,7 @@
 #ifndef CASINOCOIN_APP_LEDGER_TRANSACTIONMASTER_H_INCLUDED
 #define CASINOCOIN_APP_LEDGER_TRANSACTIONMASTER_H_INCLUDED
 
+#include <casinocoin/basics/ShardedTaggedCache.h>
 #include <casinocoin/shamap/SHAMapItem.h>
 #include <casinocoin/shamap/SHAMapTreeNode.h>
 
@@ -59,12 +60,12 @@ public:
 
     void sweep (void);
 
-    TaggedCache <uint256, Transaction>&
+    ShardedTaggedCache <uint256, Transaction>&
     getCache();
 
 private:
     Application& mApp;
-    TaggedCache <uint256, Transaction> mCache;
+    ShardedTaggedCache <uint256, Transaction> mCache;
 };
 
 } // casinocoin
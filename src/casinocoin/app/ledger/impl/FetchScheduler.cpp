@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/FetchScheduler.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <algorithm>
+#include <tuple>
+
+namespace casinocoin {
+
+FetchScheduler::PeerState::PeerState (time_point now)
+    : last (now)
+{
+}
+
+FetchScheduler::FetchScheduler (time_point now)
+    : FetchScheduler (now, Setup {})
+{
+}
+
+FetchScheduler::FetchScheduler (time_point now, Setup const& setup)
+    : setup_ (setup)
+    , nodesRate_ (now)
+    , bytesRate_ (now)
+{
+}
+
+FetchScheduler::PeerState&
+FetchScheduler::get (Peer::id_t peer, time_point now)
+{
+    auto result = peers_.emplace (peer, PeerState (now));
+    if (result.second)
+    {
+        result.first->second.latency = setup_.targetReply;
+        result.first->second.window = setup_.initialWindow;
+    }
+    return result.first->second;
+}
+
+std::chrono::milliseconds
+FetchScheduler::timeout (PeerState const& ps) const
+{
+    return std::max (setup_.minTimeout,
+        std::min (setup_.maxTimeout, 2 * ps.latency));
+}
+
+void
+FetchScheduler::expire (PeerState& ps, time_point now)
+{
+    auto const limit = timeout (ps);
+    bool lost = false;
+
+    // Requests are kept in the order they were sent
+    while (! ps.requests.empty () &&
+        ps.requests.front ().sent + limit <= now)
+    {
+        ps.inFlight -= ps.requests.front ().nodes;
+        ps.requests.pop_front ();
+        ++ps.lost;
+        lost = true;
+    }
+
+    if (lost)
+    {
+        // Back off, the peer is slower or busier than we thought
+        ps.window = std::max<double> (setup_.minWindow, ps.window / 2);
+        ps.latency = std::max (ps.latency, limit);
+        ps.measured = true;
+    }
+}
+
+std::vector<std::pair<Peer::id_t, std::size_t>>
+FetchScheduler::select (std::vector<Candidate> const& peers, time_point now)
+{
+    std::vector<std::tuple<double, Peer::id_t, std::size_t>> ranked;
+    ranked.reserve (peers.size ());
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        for (auto const& candidate : peers)
+        {
+            auto& ps = get (candidate.first, now);
+            if (! ps.measured && candidate.second)
+                ps.latency = *candidate.second;
+            expire (ps, now);
+
+            auto const window = static_cast<std::size_t> (ps.window);
+            if (ps.inFlight >= window)
+                continue;
+
+            // A new request waits for the ones already outstanding
+            double const wait = ps.latency.count () *
+                (1.0 + static_cast<double> (ps.inFlight) / window);
+            ranked.emplace_back (wait, candidate.first, window - ps.inFlight);
+        }
+    }
+
+    std::sort (ranked.begin (), ranked.end ());
+
+    std::vector<std::pair<Peer::id_t, std::size_t>> ret;
+    ret.reserve (ranked.size ());
+    for (auto const& r : ranked)
+        ret.emplace_back (std::get<1> (r), std::get<2> (r));
+    return ret;
+}
+
+void
+FetchScheduler::sent (Peer::id_t peer, uint256 const& ledger,
+    std::size_t nodes, time_point now)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto& ps = get (peer, now);
+    ps.requests.push_back ({ledger, nodes, now});
+    ps.inFlight += nodes;
+    ps.last = now;
+}
+
+boost::optional<FetchScheduler::time_point>
+FetchScheduler::received (Peer::id_t peer, uint256 const& ledger,
+    std::size_t nodes, std::size_t bytes, time_point now)
+{
+    using namespace std::chrono;
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    nodesRate_.add (nodes, now);
+    bytesRate_.add (bytes, now);
+
+    auto& ps = get (peer, now);
+    ps.last = now;
+
+    // Replies to different ledgers may be reordered by the peer
+    auto it = std::find_if (ps.requests.begin (), ps.requests.end (),
+        [&ledger](Request const& r)
+        {
+            return r.ledger == ledger;
+        });
+    if (it == ps.requests.end ())
+        return boost::none;
+
+    auto const request = *it;
+    ps.requests.erase (it);
+    ps.inFlight -= request.nodes;
+
+    auto const rtt = std::max (milliseconds (1),
+        duration_cast<milliseconds> (now - request.sent));
+    double const seconds = duration<double> (rtt).count ();
+
+    if (ps.replies++ == 0)
+    {
+        ps.nodesPerSecond = nodes / seconds;
+        ps.bytesPerSecond = bytes / seconds;
+    }
+    else
+    {
+        ps.nodesPerSecond = (ps.nodesPerSecond * 3 + nodes / seconds) / 4;
+        ps.bytesPerSecond = (ps.bytesPerSecond * 3 + bytes / seconds) / 4;
+    }
+
+    if (ps.measured)
+        ps.latency = (ps.latency * 3 + rtt) / 4;
+    else
+        ps.latency = rtt;
+    ps.measured = true;
+
+    // Move the window toward what the peer answers in the target
+    // time, at most doubling it at once
+    double const target = std::min (2 * ps.window, request.nodes /
+        seconds * duration<double> (setup_.targetReply).count ());
+    ps.window = std::max<double> (setup_.minWindow, std::min<double> (
+        setup_.maxWindow, (ps.window * 3 + target) / 4));
+
+    return request.sent;
+}
+
+void
+FetchScheduler::retried (std::size_t nodes)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    retried_ += nodes;
+}
+
+std::chrono::milliseconds
+FetchScheduler::timeout (Peer::id_t peer)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const it = peers_.find (peer);
+    if (it == peers_.end ())
+        return std::min (setup_.maxTimeout, 2 * setup_.targetReply);
+    return timeout (it->second);
+}
+
+void
+FetchScheduler::sweep (time_point now)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (auto it = peers_.begin (); it != peers_.end ();)
+    {
+        expire (it->second, now);
+        if (it->second.requests.empty () &&
+            it->second.last + setup_.idle <= now)
+            it = peers_.erase (it);
+        else
+            ++it;
+    }
+}
+
+Json::Value
+FetchScheduler::getJson (time_point now)
+{
+    Json::Value ret (Json::objectValue);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    ret[jss::nodes_per_second] =
+        static_cast<Json::UInt> (nodesRate_.value (now));
+    ret[jss::bytes_per_second] =
+        static_cast<Json::UInt> (bytesRate_.value (now));
+    ret[jss::retried] = static_cast<Json::UInt> (retried_);
+
+    Json::Value& peers = (ret[jss::peers] = Json::objectValue);
+    for (auto& entry : peers_)
+    {
+        auto& ps = entry.second;
+        expire (ps, now);
+
+        Json::Value& peer = peers[std::to_string (entry.first)];
+        peer[jss::latency] = static_cast<Json::UInt> (ps.latency.count ());
+        peer[jss::window] = static_cast<Json::UInt> (ps.window);
+        peer[jss::in_flight] = static_cast<Json::UInt> (ps.inFlight);
+        peer[jss::nodes_per_second] =
+            static_cast<Json::UInt> (ps.nodesPerSecond);
+        peer[jss::bytes_per_second] =
+            static_cast<Json::UInt> (ps.bytesPerSecond);
+        peer[jss::replies] = static_cast<Json::UInt> (ps.replies);
+        peer[jss::lost] = static_cast<Json::UInt> (ps.lost);
+    }
+
+    return ret;
+}
+
+} // casinocoin
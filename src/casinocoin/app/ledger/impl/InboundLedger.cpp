@@ -29,6 +29,7 @@
 #include <casinocoin/app/ledger/InboundLedger.h>
 #include <casinocoin/app/ledger/InboundLedgers.h>
 #include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/ledger/LedgerReplay.h>
 #include <casinocoin/app/ledger/TransactionStateSF.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
@@ -62,11 +63,8 @@ enum
     // Number of nodes to find initially
     ,missingNodesFind = 256
 
-    // Number of nodes to request for a reply
+    // Most nodes to request from a peer at once
     ,reqNodesReply = 128
-
-    // Number of nodes to request blindly
-    ,reqNodes = 8
 };
 
 // millisecond for each ledger timeout
@@ -83,6 +81,7 @@ InboundLedger::InboundLedger (
     , mByHash (true)
     , mSeq (seq)
     , mReason (reason)
+    , mDeltaTried (false)
     , mReceiveDispatched (false)
 {
     JLOG (m_journal.trace()) <<
@@ -287,6 +286,18 @@ bool InboundLedger::tryLocal ()
         mHaveHeader = true;
     }
 
+    {
+        // Read the roots we still need with one batch, fetchRoot
+        // below then finds them in the node store cache
+        std::vector <uint256> roots;
+        if (!mHaveTransactions && mLedger->info().txHash.isNonZero ())
+            roots.push_back (mLedger->info().txHash);
+        if (!mHaveState && mLedger->info().accountHash.isNonZero ())
+            roots.push_back (mLedger->info().accountHash);
+        if (roots.size () > 1)
+            app_.getNodeStore ().fetchBatch (roots);
+    }
+
     if (!mHaveTransactions)
     {
         if (mLedger->info().txHash.isZero ())
@@ -355,8 +366,6 @@ bool InboundLedger::tryLocal ()
 */
 void InboundLedger::onTimer (bool wasProgress, ScopedLockType&)
 {
-    mRecentNodes.clear ();
-
     if (isDone())
     {
         JLOG (m_journal.info()) <<
@@ -505,6 +514,10 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
                 " failed local for " << mHash;
             return;
         }
+
+        // One peer can give us the whole ledger if we have its parent
+        if (!mComplete && tryDelta (peer))
+            return;
     }
 
     protocol::TMGetLedger tmGL;
@@ -644,28 +657,12 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
                 }
                 else
                 {
-                    filterNodes (nodes, reason);
-
-                    if (!nodes.empty ())
-                    {
-                        tmGL.set_itype (protocol::liAS_NODE);
-                        for (auto const& id : nodes)
-                        {
-                            * (tmGL.add_nodeids ()) = id.first.getRawString ();
-                        }
-
-                        JLOG (m_journal.trace()) <<
-                            "Sending AS node request (" <<
-                            nodes.size () << ") to " <<
-                            (peer ? "selected peer" : "all peers");
-                        sendRequest (tmGL, peer);
+                    tmGL.set_itype (protocol::liAS_NODE);
+                    if (requestNodes (nodes, tmGL))
                         return;
-                    }
-                    else
-                    {
-                        JLOG (m_journal.trace()) <<
-                            "All AS nodes filtered";
-                    }
+
+                    JLOG (m_journal.trace()) <<
+                        "All AS nodes filtered";
                 }
             }
         }
@@ -712,27 +709,12 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
             }
             else
             {
-                filterNodes (nodes, reason);
-
-                if (!nodes.empty ())
-                {
-                    tmGL.set_itype (protocol::liTX_NODE);
-                    for (auto const& n : nodes)
-                    {
-                        * (tmGL.add_nodeids ()) = n.first.getRawString ();
-                    }
-                    JLOG (m_journal.trace()) <<
-                        "Sending TX node request (" <<
-                        nodes.size () << ") to " <<
-                        (peer ? "selected peer" : "all peers");
-                    sendRequest (tmGL, peer);
+                tmGL.set_itype (protocol::liTX_NODE);
+                if (requestNodes (nodes, tmGL))
                     return;
-                }
-                else
-                {
-                    JLOG (m_journal.trace()) <<
-                        "All TX nodes filtered";
-                }
+
+                JLOG (m_journal.trace()) <<
+                    "All TX nodes filtered";
             }
         }
     }
@@ -748,50 +730,174 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
     }
 }
 
-void InboundLedger::filterNodes (
-    std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
-    TriggerReason reason)
+/** Request the delta from the parent ledger, if we have it
+    Returns 'true' while waiting for the reply
+    Call with a lock
+*/
+bool InboundLedger::tryDelta (std::shared_ptr<Peer> const& peer)
 {
-    // Sort nodes so that the ones we haven't recently
-    // requested come before the ones we have.
-    auto dup = std::stable_partition (
-        nodes.begin(), nodes.end(),
-        [this](auto const& item)
-        {
-            return mRecentNodes.count (item.second) == 0;
-        });
+    // Wait for the reply until the first timeout
+    if (mDeltaParent)
+        return getTimeouts () == 0;
+
+    if (mDeltaTried || mSeq < 2 || !app_.config().LEDGER_REPLAY)
+        return false;
+
+    auto parent = app_.getLedgerMaster ().getLedgerBySeq (mSeq - 1);
+    if (!parent)
+        return false;
 
-    // If everything is a duplicate we don't want to send
-    // any query at all except on a timeout where we need
-    // to query everyone:
-    if (dup == nodes.begin ())
+    std::shared_ptr<Peer> target;
+    if (peer && peer->supportsLedgerReplay ())
     {
-        JLOG (m_journal.trace()) <<
-            "filterNodes: all duplicates";
+        target = peer;
+    }
+    else
+    {
+        for (auto id : mPeers)
+        {
+            auto p = app_.overlay ().findPeerByShortID (id);
+            if (p && p->supportsLedgerReplay ())
+            {
+                target = std::move (p);
+                break;
+            }
+        }
+    }
+    if (!target)
+        return false;
+
+    mDeltaTried = true;
+    mDeltaParent = std::move (parent);
+
+    protocol::TMGetLedger tmGL;
+    tmGL.set_itype (protocol::liDELTA);
+    tmGL.set_ledgerhash (mHash.begin (), mHash.size ());
+    tmGL.set_ledgerseq (mSeq);
+    JLOG (m_journal.trace()) <<
+        "Sending delta request for " << mHash;
+    sendRequest (tmGL, target);
+    return true;
+}
+
+/** Ask our peers for missing nodes
+    Nodes are spread over the peers the scheduler picks, fastest first,
+    skipping those already asked for. A node a peer has not answered
+    in time is asked of another peer.
+    Returns 'true' if any request was sent
+    Call with a lock
+*/
+bool InboundLedger::requestNodes (
+    std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+    protocol::TMGetLedger& tmGL)
+{
+    auto& scheduler = app_.getInboundLedgers ().scheduler ();
+    auto const now = m_clock.now ();
 
-        if (reason != TriggerReason::timeout)
+    // Forget the requests peers have answered
+    {
+        std::lock_guard<std::mutex> sl (mReceivedDataLock);
+        for (auto const& answered : mAnswered)
         {
-            nodes.clear ();
-            return;
+            for (auto it = mRequestedNodes.begin ();
+                it != mRequestedNodes.end ();)
+            {
+                if (it->second.peer == answered.first &&
+                    it->second.sent <= answered.second)
+                    it = mRequestedNodes.erase (it);
+                else
+                    ++it;
+            }
         }
+        mAnswered.clear ();
     }
-    else
+
+    // The nodes to ask for, with the peer that was asked before
+    std::vector<std::pair<std::size_t, boost::optional<Peer::id_t>>> wanted;
+    std::map<Peer::id_t, std::chrono::milliseconds> timeouts;
+    for (std::size_t i = 0; i < nodes.size (); ++i)
     {
-        JLOG (m_journal.trace()) <<
-            "filterNodes: pruning duplicates";
+        auto const it = mRequestedNodes.find (nodes[i].second);
+        if (it == mRequestedNodes.end ())
+        {
+            wanted.emplace_back (i, boost::none);
+            continue;
+        }
+
+        auto limit = timeouts.find (it->second.peer);
+        if (limit == timeouts.end ())
+            limit = timeouts.emplace (it->second.peer,
+                scheduler.timeout (it->second.peer)).first;
+        if (it->second.sent + limit->second <= now)
+            wanted.emplace_back (i, it->second.peer);
+    }
+
+    if (wanted.empty ())
+        return false;
 
-        nodes.erase (dup, nodes.end());
+    std::vector<FetchScheduler::Candidate> candidates;
+    std::map<Peer::id_t, std::shared_ptr<Peer>> peers;
+    for (auto id : mPeers)
+    {
+        if (auto peer = app_.overlay ().findPeerByShortID (id))
+        {
+            candidates.emplace_back (id, peer->getLatency ());
+            peers.emplace (id, std::move (peer));
+        }
     }
 
-    std::size_t const limit = (reason == TriggerReason::reply)
-        ? reqNodesReply
-        : reqNodes;
+    auto const selected = scheduler.select (candidates, now);
+    std::vector<bool> taken (wanted.size (), false);
+    std::size_t remaining = wanted.size ();
+    std::size_t retried = 0;
+    bool sent = false;
+
+    for (auto const& choice : selected)
+    {
+        if (remaining == 0)
+            break;
+
+        protocol::TMGetLedger request (tmGL);
+        auto const limit = std::min<std::size_t> (
+            choice.second, reqNodesReply);
+
+        for (std::size_t i = 0; i < wanted.size () &&
+            static_cast<std::size_t> (request.nodeids_size ()) < limit; ++i)
+        {
+            // A peer that was too slow is only asked again
+            // if there is no one else
+            auto const& prior = wanted[i].second;
+            if (taken[i] || (prior && *prior == choice.first &&
+                    selected.size () > 1))
+                continue;
+
+            taken[i] = true;
+            --remaining;
+            if (prior)
+                ++retried;
+
+            auto const& node = nodes[wanted[i].first];
+            *request.add_nodeids () = node.first.getRawString ();
+            mRequestedNodes[node.second] = { choice.first, now };
+        }
+
+        if (request.nodeids_size () == 0)
+            continue;
+
+        JLOG (m_journal.trace()) <<
+            "Sending node request (" << request.nodeids_size () <<
+            ") to peer " << choice.first;
+        peers[choice.first]->send (std::make_shared<Message> (
+            request, protocol::mtGET_LEDGER));
+        scheduler.sent (choice.first, mHash,
+            request.nodeids_size (), now);
+        sent = true;
+    }
 
-    if (nodes.size () > limit)
-        nodes.resize (limit);
+    if (retried != 0)
+        scheduler.retried (retried);
 
-    for (auto const& n : nodes)
-        mRecentNodes.insert (n.second);
+    return sent;
 }
 
 /** Take ledger header data
@@ -841,6 +947,75 @@ bool InboundLedger::takeHeader (std::string const& data)
     return true;
 }
 
+/** Rebuild the ledger from a delta received from a peer
+    Returns the number of useful nodes
+    Call with a lock
+*/
+int InboundLedger::takeDelta (std::shared_ptr<Peer> const& peer,
+    protocol::TMLedgerData& packet)
+{
+    // Only the reply to our one request is applied
+    auto const parent = std::move (mDeltaParent);
+
+    if (mComplete || mFailed || !parent || packet.nodes_size () < 1)
+        return 0;
+
+    SHAMapAddNode san;
+    auto const info = deserializeHeader (
+        makeSlice (packet.nodes (0).nodedata ()), false);
+
+    if (!packet.has_error () && info.parentHash == parent->info().hash)
+    {
+        auto ledger = applyLedgerDelta (
+            *parent, mHash, packet, app_.config(), m_journal);
+        if (!ledger)
+        {
+            JLOG (m_journal.warn()) <<
+                "Got invalid delta for " << mHash;
+            peer->charge (Resource::feeInvalidRequest);
+            return -1;
+        }
+
+        JLOG (m_journal.debug()) <<
+            "Replayed " << mHash << " from " << packet.txcount () <<
+            " transactions and " <<
+            packet.nodes_size () - 1 - packet.txcount () << " state entries";
+
+        mLedger = std::move (ledger);
+        Serializer s (128);
+        s.add32 (HashPrefix::ledgerMaster);
+        addRaw (mLedger->info(), s);
+        app_.getNodeStore ().store (
+            hotLEDGER, std::move (s.modData ()), mHash);
+
+        mHaveHeader = true;
+        mHaveState = true;
+        mHaveTransactions = true;
+        mComplete = true;
+        san.incUseful ();
+        progress ();
+        mStats += san;
+        done ();
+        return san.getGood ();
+    }
+
+    // We can't replay it, but the header saves a round trip
+    JLOG (m_journal.debug()) <<
+        "Can't replay " << mHash << " from delta";
+    if (!mHaveHeader)
+    {
+        if (!takeHeader (packet.nodes (0).nodedata ()))
+        {
+            peer->charge (Resource::feeInvalidRequest);
+            return -1;
+        }
+        san.incUseful ();
+        progress ();
+    }
+    mStats += san;
+    return san.getGood ();
+}
+
 /** Process TX data received from a peer
     Call with a lock
 */
@@ -1074,8 +1249,25 @@ InboundLedger::getNeededHashes ()
 bool InboundLedger::gotData (std::weak_ptr<Peer> peer,
     std::shared_ptr<protocol::TMLedgerData> data)
 {
+    // Time the reply as soon as it arrives
+    boost::optional<clock_type::time_point> answered;
+    auto const p = peer.lock ();
+    if (p && (data->type () == protocol::liAS_NODE ||
+        data->type () == protocol::liTX_NODE))
+    {
+        answered = app_.getInboundLedgers ().scheduler ().received (
+            p->id (), mHash, data->nodes_size (), data->ByteSize (),
+            m_clock.now ());
+    }
+
     std::lock_guard<std::mutex> sl (mReceivedDataLock);
 
+    if (answered)
+    {
+        auto& when = mAnswered[p->id ()];
+        when = std::max (when, *answered);
+    }
+
     if (isDone ())
         return false;
 
@@ -1148,6 +1340,9 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
         return san.getGood ();
     }
 
+    if (packet.type () == protocol::liDELTA)
+        return takeDelta (peer, packet);
+
     if ((packet.type () == protocol::liTX_NODE) || (
         packet.type () == protocol::liAS_NODE))
     {
@@ -67,6 +67,7 @@ public:
         , m_clock (clock)
         , mRecentFailures (clock)
         , mCounter(collector->make_counter("ledger_fetches"))
+        , scheduler_ (clock.now())
     {
     }
 
@@ -330,9 +331,16 @@ public:
                 ret[to_string (it.first)] = it.second->getJson(0);
         }
 
+        ret[jss::throughput] = scheduler_.getJson (m_clock.now());
+
         return ret;
     }
 
+    FetchScheduler& scheduler ()
+    {
+        return scheduler_;
+    }
+
     void gotFetchPack ()
     {
         std::vector<std::shared_ptr<InboundLedger>> acquires;
@@ -391,6 +399,8 @@ public:
 
         }
 
+        scheduler_.sweep (now);
+
         JLOG (j_.debug()) <<
             "Swept " << stuffToSweep.size () <<
             " out of " << total << " inbound ledgers.";
@@ -418,6 +428,8 @@ private:
     beast::aged_map <uint256, std::uint32_t> mRecentFailures;
 
     beast::insight::Counter mCounter;
+
+    FetchScheduler scheduler_;
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/LedgerReplay.h>
+#include <casinocoin/app/ledger/InboundLedger.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/nodestore/Database.h>
+
+namespace casinocoin {
+
+bool
+makeLedgerDelta (
+    Ledger const& ledger,
+    Ledger const& parent,
+    protocol::TMLedgerData& reply,
+    int maxNodes)
+{
+    if (ledger.info().parentHash != parent.info().hash)
+        return false;
+
+    try
+    {
+        Serializer header (128);
+        addRaw (ledger.info(), header);
+        reply.add_nodes ()->set_nodedata (
+            header.getDataPtr (), header.getLength ());
+
+        std::uint32_t txCount = 0;
+        for (auto const& item : ledger.txMap ())
+        {
+            if (reply.nodes_size () >= maxNodes)
+                return false;
+            auto node = reply.add_nodes ();
+            node->set_nodeid (item.key ().data (), item.key ().size ());
+            node->set_nodedata (item.data (), item.size ());
+            ++txCount;
+        }
+        reply.set_txcount (txCount);
+
+        SHAMap::Delta differences;
+        if (! parent.stateMap ().compare (ledger.stateMap (),
+                differences, maxNodes - reply.nodes_size ()))
+            return false;
+
+        for (auto const& d : differences)
+        {
+            auto node = reply.add_nodes ();
+            node->set_nodeid (d.first.data (), d.first.size ());
+            if (auto const& item = d.second.second)
+                node->set_nodedata (item->data (), item->size ());
+            else
+                node->set_nodedata ("");
+        }
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+
+    return reply.nodes_size () <= maxNodes;
+}
+
+std::shared_ptr<Ledger>
+applyLedgerDelta (
+    Ledger const& parent,
+    uint256 const& hash,
+    protocol::TMLedgerData const& delta,
+    Config const& config,
+    beast::Journal j)
+{
+    if (delta.nodes_size () < 1 ||
+        delta.txcount () > static_cast<std::uint32_t>(delta.nodes_size () - 1))
+    {
+        JLOG (j.warn()) << "Malformed delta for " << hash;
+        return nullptr;
+    }
+
+    auto const info = InboundLedger::deserializeHeader (
+        makeSlice (delta.nodes (0).nodedata ()), false);
+    if (info.seq != parent.info().seq + 1 ||
+        info.parentHash != parent.info().hash)
+    {
+        JLOG (j.debug()) << "Delta for " << hash <<
+            " doesn't follow " << parent.info().hash;
+        return nullptr;
+    }
+
+    auto ledger = std::make_shared<Ledger> (parent, info.closeTime);
+
+    auto makeItem = [](std::string const& key, std::string const& data)
+    {
+        return std::make_shared<SHAMapItem const> (
+            uint256::fromVoid (key.data ()),
+            Serializer (data.data (), data.size ()));
+    };
+
+    try
+    {
+        int const txEnd = 1 + delta.txcount ();
+        for (int i = 1; i < delta.nodes_size (); ++i)
+        {
+            auto const& node = delta.nodes (i);
+            if (node.nodeid ().size () != uint256::size ())
+            {
+                JLOG (j.warn()) << "Bad delta node for " << hash;
+                return nullptr;
+            }
+
+            bool ok;
+            if (i < txEnd)
+            {
+                ok = ledger->txMap ().addGiveItem (
+                    makeItem (node.nodeid (), node.nodedata ()), true, true);
+            }
+            else if (node.nodedata ().empty ())
+            {
+                ok = ledger->stateMap ().delItem (
+                    uint256::fromVoid (node.nodeid ().data ()));
+            }
+            else
+            {
+                auto item = makeItem (node.nodeid (), node.nodedata ());
+                auto& stateMap = ledger->stateMap ();
+                ok = stateMap.hasItem (item->key ())
+                    ? stateMap.updateGiveItem (std::move (item), false, false)
+                    : stateMap.addGiveItem (std::move (item), false, false);
+            }
+            if (! ok)
+            {
+                JLOG (j.warn()) << "Delta for " << hash <<
+                    " doesn't apply to its parent";
+                return nullptr;
+            }
+        }
+
+        // Check the roots before writing anything
+        if (ledger->txMap ().getHash ().as_uint256 () != info.txHash ||
+            ledger->stateMap ().getHash ().as_uint256 () != info.accountHash)
+        {
+            JLOG (j.warn()) << "Delta for " << hash << " has wrong root";
+            return nullptr;
+        }
+
+        ledger->stateMap ().flushDirty (hotACCOUNT_NODE, info.seq);
+        ledger->txMap ().flushDirty (hotTRANSACTION_NODE, info.seq);
+        ledger->unshare ();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j.warn()) << "Delta for " << hash << ": " << e.what ();
+        return nullptr;
+    }
+
+    ledger->setTotalDrops (info.drops.drops ());
+    ledger->setAccepted (info.closeTime, info.closeTimeResolution,
+        getCloseAgree (info), config);
+
+    if (ledger->info().hash != hash)
+    {
+        JLOG (j.warn()) << "Delta for " << hash << " built " <<
+            ledger->info().hash;
+        return nullptr;
+    }
+
+    return ledger;
+}
+
+} // casinocoin
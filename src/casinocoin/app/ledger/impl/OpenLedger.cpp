@@ -160,6 +160,12 @@ OpenLedger::apply_one (Application& app, OpenView& view,
     return Result::retry;
 }
 
+TaskPool&
+OpenLedger::apply_pool (Application& app)
+{
+    return app.getApplyPool();
+}
+
 //------------------------------------------------------------------------------
 
 std::string
@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
+#include <casinocoin/ledger/View.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <boost/optional.hpp>
+#include <algorithm>
+
+namespace casinocoin {
+
+OwnerDirIndex::OwnerDirIndex (
+        std::size_t maxAccounts, beast::Journal journal)
+    : index_ (maxAccounts, journal)
+{
+}
+
+std::shared_ptr<OwnerDirIndex::Directory const>
+OwnerDirIndex::getDirectory (ReadView const& ledger, AccountID const& account)
+{
+    if (! enabled ())
+        return nullptr;
+
+    return index_.get (ledger, account,
+        [&]()
+        {
+            return load (ledger, account);
+        });
+}
+
+void
+OwnerDirIndex::update (ReadView const& ledger, AcceptedLedger const& accepted)
+{
+    if (! enabled ())
+        return;
+
+    Delta delta;
+    bool const known = getDelta (accepted, delta);
+    index_.update (ledger.info (), known ? &delta.pages : nullptr,
+        [&](AccountID const& account, Directory const& dir,
+            hash_set<uint256> const& pages)
+        {
+            return patch (ledger, account, dir, pages, delta.created);
+        });
+}
+
+bool
+OwnerDirIndex::forEachItemAfter (ReadView const& view, AccountID const& id,
+    LedgerEntryType type, uint256 const& after, std::uint64_t hint,
+        unsigned int limit, std::function<
+            bool (std::shared_ptr<SLE const> const&)> f)
+{
+    auto const dir = getDirectory (view, id);
+    if (! dir)
+    {
+        return casinocoin::forEachItemAfter (
+            view, id, after, hint, limit, std::move (f));
+    }
+
+    auto page = dir->begin ();
+    std::size_t first = 0;
+
+    if (after.isNonZero ())
+    {
+        auto find = [&after](Page const& p)
+        {
+            return std::find_if (p.entries.begin (), p.entries.end (),
+                [&after](Entry const& e) { return e.key == after; });
+        };
+
+        // Try jumping to the page using the hint
+        page = dir->find (hint);
+        if (page == dir->end () ||
+            find (*page->second) == page->second->entries.end ())
+        {
+            page = std::find_if (dir->begin (), dir->end (),
+                [&find](Directory::value_type const& p)
+                {
+                    return find (*p.second) != p.second->entries.end ();
+                });
+            if (page == dir->end ())
+                return false;
+        }
+        first = (find (*page->second) - page->second->entries.begin ()) + 1;
+    }
+
+    for (; page != dir->end (); ++page, first = 0)
+    {
+        auto const& entries = page->second->entries;
+        for (auto i = first; i < entries.size (); ++i)
+        {
+            if (type != ltANY && entries[i].type != type)
+                continue;
+            if (f (view.read (keylet::child (entries[i].key))) &&
+                    limit-- <= 1)
+                return true;
+        }
+    }
+    return true;
+}
+
+std::size_t
+OwnerDirIndex::size () const
+{
+    return index_.size ();
+}
+
+LedgerIndex
+OwnerDirIndex::seq () const
+{
+    return index_.seq ();
+}
+
+std::shared_ptr<OwnerDirIndex::Directory const>
+OwnerDirIndex::load (ReadView const& ledger, AccountID const& account)
+{
+    auto dir = std::make_shared<Directory> ();
+    auto const root = keylet::ownerDir (account);
+    std::uint64_t n = 0;
+    do
+    {
+        auto const sle = ledger.read (keylet::page (root, n));
+        if (! sle)
+            break;
+
+        auto page = std::make_shared<Page> ();
+        page->key = sle->key ();
+        auto const& keys = sle->getFieldV256 (sfIndexes);
+        page->entries.reserve (keys.size ());
+        for (auto const& key : keys)
+        {
+            auto const object = ledger.read (keylet::child (key));
+            page->entries.push_back (
+                {key, object ? object->getType () : ltINVALID});
+        }
+        dir->emplace (n, std::move (page));
+        n = sle->getFieldU64 (sfIndexNext);
+    }
+    while (n != 0);
+    return dir;
+}
+
+bool
+OwnerDirIndex::getDelta (AcceptedLedger const& accepted, Delta& delta)
+{
+    for (auto const& item : accepted.getMap ())
+    {
+        for (auto const& node : item.second->getMeta ()->getNodes ())
+        {
+            auto const type = static_cast<LedgerEntryType> (
+                node.getFieldU16 (sfLedgerEntryType));
+            auto const key = node.getFieldH256 (sfLedgerIndex);
+            bool const created = node.getFName () == sfCreatedNode;
+            if (created)
+                delta.created[key] = type;
+
+            if (type != ltDIR_NODE)
+                continue;
+
+            auto const fields = dynamic_cast<STObject const*> (
+                node.peekAtPField (created ? sfNewFields : sfFinalFields));
+            if (! fields)
+                return false;
+
+            // Book directories have no owner
+            if (fields->isFieldPresent (sfOwner))
+                delta.pages[fields->getAccountID (sfOwner)].insert (key);
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<OwnerDirIndex::Directory const>
+OwnerDirIndex::patch (ReadView const& ledger, AccountID const& account,
+    Directory const& dir, hash_set<uint256> const& pages,
+        hash_map<uint256, LedgerEntryType> const& created)
+{
+    auto const root = keylet::ownerDir (account);
+    auto result = std::make_shared<Directory> (dir);
+
+    for (auto const& key : pages)
+    {
+        boost::optional<std::uint64_t> number;
+        std::shared_ptr<Page const> old;
+        for (auto const& page : dir)
+        {
+            if (page.second->key == key)
+            {
+                number = page.first;
+                old = page.second;
+                break;
+            }
+        }
+
+        auto const sle = ledger.read (keylet::page (key));
+        if (! sle)
+        {
+            if (number)
+                result->erase (*number);
+            continue;
+        }
+
+        if (! number && key == root.key)
+        {
+            number = 0;
+        }
+        else if (! number)
+        {
+            // Pages are added after the last one, at most as many
+            // as the ledger changed
+            auto const sleRoot = ledger.read (root);
+            if (! sleRoot)
+                return nullptr;
+            auto n = sleRoot->getFieldU64 (sfIndexPrevious);
+            for (std::size_t i = 0; ! number && n != 0 && i <= pages.size ();
+                ++i, --n)
+            {
+                if (keylet::page (root, n).key == key)
+                    number = n;
+            }
+            if (! number)
+                return nullptr;
+        }
+
+        hash_map<uint256, LedgerEntryType> types;
+        if (old)
+        {
+            for (auto const& entry : old->entries)
+                types.emplace (entry.key, entry.type);
+        }
+
+        auto page = std::make_shared<Page> ();
+        page->key = key;
+        auto const& keys = sle->getFieldV256 (sfIndexes);
+        page->entries.reserve (keys.size ());
+        for (auto const& k : keys)
+        {
+            auto const known = types.find (k);
+            if (known != types.end ())
+            {
+                page->entries.push_back ({k, known->second});
+                continue;
+            }
+
+            auto const added = created.find (k);
+            if (added != created.end ())
+            {
+                page->entries.push_back ({k, added->second});
+                continue;
+            }
+
+            auto const object = ledger.read (keylet::child (k));
+            page->entries.push_back (
+                {k, object ? object->getType () : ltINVALID});
+        }
+        (*result)[*number] = std::move (page);
+    }
+    return result;
+}
+
+} // casinocoin
@@ -120,7 +120,7 @@ void TransactionMaster::sweep (void)
     mCache.sweep ();
 }
 
-TaggedCache <uint256, Transaction>& TransactionMaster::getCache()
+ShardedTaggedCache <uint256, Transaction>& TransactionMaster::getCache()
 {
     return mCache;
 }
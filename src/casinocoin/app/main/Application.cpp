@@ -34,12 +34,14 @@
 #include <casinocoin/app/ledger/LedgerToJson.h>
 #include <casinocoin/app/ledger/OpenLedger.h>
 #include <casinocoin/app/ledger/OrderBookDB.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/ledger/PendingSaves.h>
 #include <casinocoin/app/ledger/InboundTransactions.h>
 #include <casinocoin/app/ledger/TransactionMaster.h>
 #include <casinocoin/app/main/LoadManager.h>
 #include <casinocoin/app/main/NodeIdentity.h>
 #include <casinocoin/app/main/NodeStoreScheduler.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
 #include <casinocoin/app/misc/AmendmentTable.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
@@ -53,6 +55,7 @@
 #include <casinocoin/app/tx/apply.h>
 #include <casinocoin/basics/ResolverAsio.h>
 #include <casinocoin/basics/Sustain.h>
+#include <casinocoin/basics/TaskPool.h>
 #include <casinocoin/json/json_reader.h>
 #include <casinocoin/core/DeadlineTimer.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
@@ -63,6 +66,7 @@
 #include <casinocoin/beast/asio/io_latency_probe.h>
 #include <casinocoin/beast/core/LexicalCast.h>
 #include <fstream>
+#include <thread>
 
 namespace casinocoin {
 
@@ -73,6 +77,22 @@ static int const MAJORITY_FRACTION (204);
 
 namespace detail {
 
+// Threads flushing the dirty nodes of closed ledgers, set by
+// flush_threads in the [shamap] section. Zero picks a default.
+static
+std::size_t
+setup_FlushThreads (Config const& config)
+{
+    std::size_t threads = 0;
+    get_if_exists (config.section ("shamap"), "flush_threads", threads);
+    if (threads == 0)
+    {
+        threads = std::min (4u,
+            std::max (1u, std::thread::hardware_concurrency ()));
+    }
+    return threads;
+}
+
 class AppFamily : public Family
 {
 private:
@@ -80,6 +100,7 @@ private:
     TreeNodeCache treecache_;
     FullBelowCache fullbelow_;
     NodeStore::Database& db_;
+    TaskPool flushPool_;
     beast::Journal j_;
 
     // missing node handler
@@ -115,6 +136,7 @@ public:
             collectorManager.collector(),
                 fullBelowTargetSize, fullBelowExpirationSeconds)
         , db_ (db)
+        , flushPool_ ("SHAMap flush", setup_FlushThreads (app.config ()))
         , j_ (app.journal("SHAMap"))
     {
     }
@@ -161,6 +183,12 @@ public:
         return db_;
     }
 
+    TaskPool&
+    flushPool() override
+    {
+        return flushPool_;
+    }
+
     void
     missing_node (std::uint32_t seq) override
     {
@@ -321,6 +349,8 @@ public:
     detail::AppFamily family_;
     // VFALCO TODO Make OrderBookDB abstract
     OrderBookDB m_orderBookDB;
+    OwnerDirIndex m_ownerDirIndex;
+    TaskPool m_applyPool;
     std::unique_ptr <PathRequests> m_pathRequests;
     std::unique_ptr <LedgerMaster> m_ledgerMaster;
     std::unique_ptr <InboundLedgers> m_inboundLedgers;
@@ -347,6 +377,7 @@ public:
     bool startTimers_;
 
     std::unique_ptr <DatabaseCon> mTxnDB;
+    std::unique_ptr <AccountTxStore> accountTxStore_;
     std::unique_ptr <DatabaseCon> mLedgerDB;
     std::unique_ptr <DatabaseCon> mWalletDB;
     std::unique_ptr <Overlay> m_overlay;
@@ -405,7 +436,9 @@ public:
         , m_collectorManager (CollectorManager::New (
             config_->section (SECTION_INSIGHT), logs_->journal("Collector")))
 
-        , cachedSLEs_ (std::chrono::minutes(1), stopwatch())
+        , cachedSLEs_ (std::chrono::minutes(1), stopwatch(),
+            std::size_t (config_->getSize (siSLECacheBytes)) * 1024 * 1024,
+            m_collectorManager->collector())
 
         , m_resourceManager (Resource::make_Manager (
             m_collectorManager->collector(), logs_->journal("Resource")))
@@ -427,6 +460,10 @@ public:
 
         , m_orderBookDB (*this, *m_jobQueue)
 
+        , m_ownerDirIndex (config_->OWNER_INDEX, logs_->journal("OwnerDirIndex"))
+
+        , m_applyPool ("apply", config_->APPLY_WORKERS)
+
         , m_pathRequests (std::make_unique<PathRequests> (
             *this, logs_->journal("PathRequest"), m_collectorManager->collector ()))
 
@@ -661,6 +698,16 @@ public:
         return m_orderBookDB;
     }
 
+    OwnerDirIndex& getOwnerDirIndex () override
+    {
+        return m_ownerDirIndex;
+    }
+
+    TaskPool& getApplyPool () override
+    {
+        return m_applyPool;
+    }
+
     PathRequests& getPathRequests () override
     {
         return *m_pathRequests;
@@ -766,6 +813,10 @@ public:
         assert (mTxnDB.get() != nullptr);
         return *mTxnDB;
     }
+    AccountTxStore* getAccountTxStore () override
+    {
+        return accountTxStore_.get ();
+    }
     DatabaseCon& getLedgerDB () override
     {
         assert (mLedgerDB.get() != nullptr);
@@ -1050,6 +1101,33 @@ bool ApplicationImp::setup()
     if (!updateTables ())
         return false;
 
+    try
+    {
+        accountTxStore_ = make_AccountTxStore (
+            config_->section (ConfigSection::accountTxDatabase ()),
+                getTxnDB (), logs_->journal ("AccountTxStore"));
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(m_journal.fatal()) <<
+            "Cannot open the account transactions store: " << e.what ();
+        return false;
+    }
+
+    if (config_->doImportAccountTx)
+    {
+        if (! accountTxStore_)
+        {
+            JLOG(m_journal.fatal()) << "No [" <<
+                ConfigSection::accountTxDatabase () << "] to import into";
+            return false;
+        }
+
+        JLOG(m_journal.warn()) << "Account transactions import to '" <<
+            accountTxStore_->getName () << "'.";
+        accountTxStore_->import ();
+    }
+
     // Configure the amendments the server supports
     {
         Section supportedAmendments ("Supported Amendments");
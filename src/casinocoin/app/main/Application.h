@@ -55,14 +55,17 @@ class JobQueue;
 class InboundLedgers;
 class InboundTransactions;
 class AcceptedLedger;
+class AccountTxStore;
 class LedgerMaster;
 class LoadManager;
 class ManifestCache;
 class NetworkOPs;
 class OpenLedger;
 class OrderBookDB;
+class OwnerDirIndex;
 class Overlay;
 class PathRequests;
+class TaskPool;
 class PendingSaves;
 class PublicKey;
 class SecretKey;
@@ -148,6 +151,7 @@ public:
     virtual LedgerMaster&           getLedgerMaster () = 0;
     virtual NetworkOPs&             getOPs () = 0;
     virtual OrderBookDB&            getOrderBookDB () = 0;
+    virtual OwnerDirIndex&          getOwnerDirIndex () = 0;
     virtual TransactionMaster&      getMasterTransaction () = 0;
 
     virtual
@@ -155,6 +159,7 @@ public:
     nodeIdentity () = 0;
 
     virtual Resource::Manager&      getResourceManager () = 0;
+    virtual TaskPool&               getApplyPool () = 0;
     virtual PathRequests&           getPathRequests () = 0;
     virtual SHAMapStore&            getSHAMapStore () = 0;
     virtual PendingSaves&           pendingSaves() = 0;
@@ -162,6 +167,8 @@ public:
     virtual OpenLedger&             openLedger() = 0;
     virtual OpenLedger const&       openLedger() const = 0;
     virtual DatabaseCon& getTxnDB () = 0;
+    /** The account transactions store, `nullptr` if not configured */
+    virtual AccountTxStore* getAccountTxStore () = 0;
     virtual DatabaseCon& getLedgerDB () = 0;
 
     virtual Blacklist&              blacklistedAccounts () = 0;
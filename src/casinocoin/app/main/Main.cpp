@@ -225,6 +225,15 @@ int run (int argc, char** argv)
         importText += "] configuration file section).";
     }
 
+    std::string importAccountTxText;
+    {
+        importAccountTxText += "Import the account transactions of the ";
+        importAccountTxText += "transaction database into the store ";
+        importAccountTxText += "specified in the [";
+        importAccountTxText += ConfigSection::accountTxDatabase ();
+        importAccountTxText += "] configuration file section.";
+    }
+
     // Set up option parsing.
     //
     po::options_description desc ("General Options");
@@ -253,6 +262,7 @@ int run (int argc, char** argv)
     ("debug", "Enable normally suppressed debug logging")
     ("fg", "Run in the foreground.")
     ("import", importText.c_str ())
+    ("import_account_tx", importAccountTxText.c_str ())
     ("version", "Display the build version.")
     ;
 
@@ -327,6 +337,9 @@ int run (int argc, char** argv)
     if (vm.count ("import"))
         config->doImport = true;
 
+    if (vm.count ("import_account_tx"))
+        config->doImportAccountTx = true;
+
     if (vm.count ("ledger"))
     {
         config->START_LEDGER = vm["ledger"].as<std::string> ();
@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_MISC_ACCOUNTTXSTORE_H_INCLUDED
+#define CASINOCOIN_APP_MISC_ACCOUNTTXSTORE_H_INCLUDED
+
+#include <casinocoin/basics/BasicConfig.h>
+#include <casinocoin/basics/base_uint.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/protocol/AccountID.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace casinocoin {
+
+class DatabaseCon;
+
+/** The transactions of each account, for account_tx.
+
+    Replaces the AccountTransactions table of the transaction database
+    when [account_tx_db] is configured. The transactions of an account
+    are kept under keys ordered by account, ledger sequence and
+    transaction sequence, so a page of results is one range scan
+    instead of a query. A validated ledger is stored with a single
+    batch write.
+
+    Only the keys are kept, in an ordered key/value backend either in
+    memory or in RocksDB. The transactions and their metadata are read
+    from the Transactions table of the transaction database, which is
+    written either way.
+*/
+class AccountTxStore
+{
+public:
+    /** Values to write, or keys to delete when there is no value */
+    using Batch =
+        std::vector<std::pair<std::string, boost::optional<std::string>>>;
+
+    /** Ordered key/value storage for the store. */
+    class Backend
+    {
+    public:
+        virtual ~Backend () = default;
+
+        /** Human-readable name of the backend, for diagnostics */
+        virtual
+        std::string
+        getName () = 0;
+
+        /** Fetch a value, returns `false` if the key isn't present. */
+        virtual
+        bool
+        fetch (std::string const& key, std::string& value) = 0;
+
+        /** Apply a batch atomically, in order. */
+        virtual
+        void
+        write (Batch const& batch) = 0;
+
+        /** Visit the keys from first to last inclusive, in order.
+
+            Stops when `f` returns `false`.
+        */
+        virtual
+        void
+        scan (std::string const& first, std::string const& last,
+            bool forward, std::function<bool (
+                std::string const& key, std::string const& value)> const& f) = 0;
+    };
+
+    /** A transaction of a ledger, with the accounts it affected */
+    struct Record
+    {
+        uint256 id;
+        std::uint32_t txnSeq;
+        std::vector<AccountID> accounts;
+    };
+
+    /** A transaction of an account */
+    struct Entry
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t txnSeq;
+        std::string status;
+        Blob rawTxn;
+        Blob rawMeta;
+    };
+
+    AccountTxStore (std::unique_ptr<Backend> backend,
+        DatabaseCon& txnDB, beast::Journal journal);
+
+    std::string
+    getName ()
+    {
+        return backend_->getName ();
+    }
+
+    /** Store the transactions of a ledger.
+
+        Replaces whatever was stored for the ledger before.
+    */
+    void
+    saveLedger (std::uint32_t seq, std::vector<Record> const& records);
+
+    /** Remove the transactions of the ledgers before a sequence */
+    void
+    deleteBefore (std::uint32_t seq);
+
+    /** Visit the transactions of an account in a range of ledgers.
+
+        @param start The ledger and transaction sequence to start at,
+                     if not the first in the range.
+        @param f Called for each transaction until it returns `false`.
+    */
+    void
+    forEach (AccountID const& account,
+        std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+        boost::optional<std::pair<std::uint32_t, std::uint32_t>> const& start,
+        std::function<bool (Entry const&)> const& f);
+
+    /** Copy the account transactions of the transaction database.
+
+        @return The number of transactions copied.
+    */
+    std::size_t
+    import ();
+
+private:
+    // Read the transactions of a page of entries from the database
+    void
+    fetchTransactions (std::vector<std::pair<uint256, Entry>>& page);
+
+    std::unique_ptr<Backend> backend_;
+    DatabaseCon& txnDB_;
+    beast::Journal j_;
+};
+
+/** Create the store configured in a section.
+
+    @param txnDB The transaction database the transactions are read from.
+    @return `nullptr` if no type is configured, the AccountTransactions
+            table is used then.
+*/
+std::unique_ptr<AccountTxStore>
+make_AccountTxStore (Section const& section,
+    DatabaseCon& txnDB, beast::Journal journal);
+
+} // casinocoin
+
+#endif
@@ -30,11 +30,14 @@
 #include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/core/TimeKeeper.h>
 #include <casinocoin/crypto/csprng.h>
+#include <casinocoin/protocol/AccountID.h>
 #include <casinocoin/protocol/PublicKey.h>
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/range/adaptors.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
 
@@ -59,11 +62,22 @@ struct BlacklistItem
 
 class Blacklist
 {
+    using Index = hash_set<AccountID>;
+
     TimeKeeper& timeKeeper_;
     beast::Journal j_;
+    boost::shared_mutex mutable mutex_;
+
+    // Blacklisted accounts keyed by their base58 account ID
+    std::map<std::string, BlacklistItem> blacklistMap_;
+
+    // Binary account ID index of the enabled entries. The snapshot is
+    // immutable once published and only ever replaced as a whole, so
+    // readers access it with std::atomic_load and never take mutex_.
+    std::shared_ptr<Index const> index_;
 
-    // Blacklisted account ID's     
-    std::vector<BlacklistItem> blacklistVector_;
+    // blacklistMap_ holds changes not yet published to index_
+    bool dirty_;
 
 public:
     Blacklist (
@@ -82,6 +96,20 @@ public:
     bool
     listed (std::string const& accountID ) const;
 
+    /** Returns `true` if AccountID is included on the list
+
+        Only consults the published index, so changes made by
+        refreshAccountOnList are visible once publish has been called.
+
+        @param blacklisted account id
+
+        @par Thread Safety
+
+        May be called concurrently, does not lock
+    */
+    bool
+    listed (AccountID const& accountID) const;
+
     BlacklistItem
     getAccount (std::string const& accountID ) const;
 
@@ -94,6 +122,19 @@ public:
         std::string const& lastUpdatedDate,
         bool const& enabled);
 
+    /** Publish pending list changes to the AccountID index
+
+        Rebuilds the index from the current list and swaps it in
+        atomically. Callers applying a batch of updates through
+        refreshAccountOnList should call this once afterwards.
+
+        @par Thread Safety
+
+        May be called concurrently
+    */
+    void
+    publish ();
+
     /** Return JSON representation of configured blacklist
      */
     Json::Value
@@ -25,6 +25,7 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
 #include <casinocoin/consensus/Consensus.h>
 #include <casinocoin/app/consensus/CCLConsensus.h>
 #include <casinocoin/app/ledger/AcceptedLedger.h>
@@ -35,14 +36,17 @@
 #include <casinocoin/app/ledger/LocalTxs.h>
 #include <casinocoin/app/ledger/OpenLedger.h>
 #include <casinocoin/app/ledger/OrderBookDB.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/ledger/TransactionMaster.h>
 #include <casinocoin/app/main/LoadManager.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/Transaction.h>
 #include <casinocoin/app/misc/TxQ.h>
+#include <casinocoin/app/misc/TxVerifier.h>
 #include <casinocoin/app/misc/ValidatorList.h>
 #include <casinocoin/app/misc/impl/AccountTxPaging.h>
+#include <casinocoin/app/paths/PathRequests.h>
 #include <casinocoin/app/tx/apply.h>
 #include <casinocoin/basics/mulDiv.h>
 #include <casinocoin/basics/UptimeTimer.h>
@@ -216,6 +220,8 @@ public:
         , m_job_queue (job_queue)
         , m_standalone (standalone)
         , m_network_quorum (start_valid ? 0 : network_quorum)
+        , m_txVerifier (app, jobCounter_, clock,
+            app_.logs().journal("TxVerifier"))
         , accounting_ ()
     {
     }
@@ -239,6 +245,11 @@ public:
     // Must complete immediately.
     void submitTransaction (std::shared_ptr<STTx const> const&) override;
 
+    TxVerifier& getTxVerifier () override
+    {
+        return m_txVerifier;
+    }
+
     void processTransaction (
         std::shared_ptr<Transaction>& transaction,
         bool bUnlimited, bool bLocal, FailHard failType) override;
@@ -396,6 +407,14 @@ public:
         bool descending, std::uint32_t offset, int limit,
         bool binary, bool count, bool bUnlimited);
 
+    // Visit the transactions transactionsSQL would select, from the store
+    void storeAccountTxs (
+        AccountTxStore& store, AccountID const& account,
+        std::int32_t minLedger, std::int32_t maxLedger,
+        bool descending, std::uint32_t offset, int limit,
+        bool binary, bool bUnlimited,
+        std::function<void (AccountTxStore::Entry const&)> const& f);
+
     // Client information retrieval functions.
     using NetworkOPs::AccountTxs;
     AccountTxs getAccountTxs (
@@ -579,6 +598,9 @@ private:
     // The number of nodes that we need to consider ourselves connected.
     std::size_t const m_network_quorum;
 
+    // Signature verification of network and client transactions.
+    TxVerifier m_txVerifier;
+
     // Transaction batching.
     std::condition_variable mCond;
     std::mutex mMutex;
@@ -807,38 +829,40 @@ void NetworkOPsImp::submitTransaction (std::shared_ptr<STTx const> const& iTrans
         return;
     }
 
-    try
-    {
-        auto const validity = checkValidity(
-            app_.getHashRouter(), *trans,
-                m_ledgerMaster.getValidatedRules(),
-                    app_.config());
-
-        if (validity.first != Validity::Valid)
+    // Verify the signature on the verification stage, which
+    // then hands the transaction on to the batch.
+    m_txVerifier.verify (trans, m_ledgerMaster.getValidatedRules(),
+        [this] (std::shared_ptr<STTx const> const& stx)
         {
-            JLOG(m_journal.warn()) <<
-                "Submitted transaction invalid: " <<
-                validity.second;
-            return;
-        }
-    }
-    catch (std::exception const&)
-    {
-        JLOG(m_journal.warn()) << "Exception checking transaction" << txid;
+            try
+            {
+                auto const validity = checkValidity(
+                    app_.getHashRouter(), *stx,
+                        m_ledgerMaster.getValidatedRules(),
+                            app_.config());
 
-        return;
-    }
+                if (validity.first != Validity::Valid)
+                {
+                    JLOG(m_journal.warn()) <<
+                        "Submitted transaction invalid: " <<
+                        validity.second;
+                    return;
+                }
+            }
+            catch (std::exception const&)
+            {
+                JLOG(m_journal.warn()) << "Exception checking transaction" <<
+                    stx->getTransactionID();
+
+                return;
+            }
 
-    std::string reason;
+            std::string reason;
 
-    auto tx = std::make_shared<Transaction> (
-        trans, reason, app_);
+            auto tx = std::make_shared<Transaction> (
+                stx, reason, app_);
 
-    m_job_queue.addCountedJob (
-        jtTRANSACTION, "submitTxn", jobCounter_,
-        [this, tx] (Job&) {
-            auto t = tx;
-            processTransaction(t, false, false, FailHard::no);
+            processTransaction(tx, false, false, FailHard::no);
         });
 }
 
@@ -1846,36 +1870,39 @@ void NetworkOPsImp::setMode (OperatingMode om)
 }
 
 
-std::string
-NetworkOPsImp::transactionsSQL (
-    std::string selection, AccountID const& account,
-    std::int32_t minLedger, std::int32_t maxLedger, bool descending,
-    std::uint32_t offset, int limit,
-    bool binary, bool count, bool bUnlimited)
+// Number of transactions returned by an account transactions query
+static
+std::uint32_t
+accountTxsLimit (int limit, bool binary, bool count, bool bUnlimited)
 {
     std::uint32_t NONBINARY_PAGE_LENGTH = 200;
     std::uint32_t BINARY_PAGE_LENGTH = 500;
 
-    std::uint32_t numberOfResults;
-
     if (count)
+        return 1000000000;
+
+    if (limit < 0)
+        return binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH;
+
+    if (!bUnlimited)
     {
-        numberOfResults = 1000000000;
-    }
-    else if (limit < 0)
-    {
-        numberOfResults = binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH;
-    }
-    else if (!bUnlimited)
-    {
-        numberOfResults = std::min (
+        return std::min (
             binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH,
             static_cast<std::uint32_t> (limit));
     }
-    else
-    {
-        numberOfResults = limit;
-    }
+
+    return limit;
+}
+
+std::string
+NetworkOPsImp::transactionsSQL (
+    std::string selection, AccountID const& account,
+    std::int32_t minLedger, std::int32_t maxLedger, bool descending,
+    std::uint32_t offset, int limit,
+    bool binary, bool count, bool bUnlimited)
+{
+    std::uint32_t const numberOfResults =
+        accountTxsLimit (limit, binary, count, bUnlimited);
 
     std::string maxClause = "";
     std::string minClause = "";
@@ -1930,6 +1957,35 @@ NetworkOPsImp::transactionsSQL (
     return sql;
 }
 
+void
+NetworkOPsImp::storeAccountTxs (
+    AccountTxStore& store, AccountID const& account,
+    std::int32_t minLedger, std::int32_t maxLedger, bool descending,
+    std::uint32_t offset, int limit, bool binary, bool bUnlimited,
+    std::function<void (AccountTxStore::Entry const&)> const& f)
+{
+    auto numberOfResults = accountTxsLimit (limit, binary, false, bUnlimited);
+    if (numberOfResults == 0)
+        return;
+
+    store.forEach (account,
+        minLedger == -1 ? 0 : minLedger,
+        maxLedger == -1 ?
+            std::numeric_limits<std::uint32_t>::max () : maxLedger,
+        ! descending, boost::none,
+        [&](AccountTxStore::Entry const& entry)
+        {
+            if (offset != 0)
+            {
+                --offset;
+                return true;
+            }
+
+            f (entry);
+            return --numberOfResults != 0;
+        });
+}
+
 NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
     AccountID const& account,
     std::int32_t minLedger, std::int32_t maxLedger, bool descending,
@@ -1938,6 +1994,24 @@ NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
     // can be called with no locks
     AccountTxs ret;
 
+    if (auto store = app_.getAccountTxStore ())
+    {
+        storeAccountTxs (*store, account, minLedger, maxLedger, descending,
+            offset, limit, false, bUnlimited,
+            [&](AccountTxStore::Entry const& entry)
+            {
+                auto txn = Transaction::transactionFromSQL (
+                    std::uint64_t (entry.ledgerSeq), entry.status,
+                        entry.rawTxn, app_);
+
+                if (txn)
+                    ret.emplace_back (txn, std::make_shared<TxMeta> (
+                        txn->getID (), txn->getLedger (), entry.rawMeta,
+                            app_.journal("TxMeta")));
+            });
+        return ret;
+    }
+
     std::string sql = transactionsSQL (
         "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, false, false,
@@ -2006,6 +2080,18 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
     // can be called with no locks
     std::vector<txnMetaLedgerType> ret;
 
+    if (auto store = app_.getAccountTxStore ())
+    {
+        storeAccountTxs (*store, account, minLedger, maxLedger, descending,
+            offset, limit, true, bUnlimited,
+            [&](AccountTxStore::Entry const& entry)
+            {
+                ret.emplace_back (strHex (entry.rawTxn),
+                    strHex (entry.rawMeta), entry.ledgerSeq);
+            });
+        return ret;
+    }
+
     std::string sql = transactionsSQL (
         "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, true/*binary*/, false,
@@ -2068,11 +2154,22 @@ NetworkOPsImp::getTxsAccount (
             ret, ledger_index, status, rawTxn, rawMeta, app);
     };
 
-    accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
-        std::bind(saveLedgerAsync, std::ref(app_),
-            std::placeholders::_1), bound, account, minLedger,
-                maxLedger, forward, token, limit, bUnlimited,
-                    page_length);
+    if (auto store = app_.getAccountTxStore ())
+    {
+        accountTxPage(*store,
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+    }
+    else
+    {
+        accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+    }
 
     return ret;
 }
@@ -2096,11 +2193,22 @@ NetworkOPsImp::getTxsAccountB (
         ret.emplace_back (strHex(rawTxn), strHex (rawMeta), ledgerIndex);
     };
 
-    accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
-        std::bind(saveLedgerAsync, std::ref(app_),
-            std::placeholders::_1), bound, account, minLedger,
-                maxLedger, forward, token, limit, bUnlimited,
-                    page_length);
+    if (auto store = app_.getAccountTxStore ())
+    {
+        accountTxPage(*store,
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+    }
+    else
+    {
+        accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+    }
     return ret;
 }
 
@@ -2184,6 +2292,7 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
         lastClose[jss::converge_time] =
                 Json::Int (mConsensus->prevRoundTime().count());
     }
+    lastClose[jss::close_breakdown] = mConsensus->getCloseBreakdown();
 
     info[jss::last_close] = lastClose;
 
@@ -2437,6 +2546,11 @@ void NetworkOPsImp::pubLedger (
         }
     }
 
+    // Keep the order book index current with the published ledgers
+    app_.getOrderBookDB ().update (lpAccepted, *alpAccepted);
+    app_.getPathRequests ().lineIndex ().update (*lpAccepted, *alpAccepted);
+    app_.getOwnerDirIndex ().update (*lpAccepted, *alpAccepted);
+
     // Don't lock since pubAcceptedTransaction is locking.
     for (auto const& vt : alpAccepted->getMap ())
     {
@@ -47,6 +47,7 @@ namespace casinocoin {
 class Peer;
 class LedgerMaster;
 class Transaction;
+class TxVerifier;
 
 // This is the primary interface into the "client" portion of the program.
 // Code that wants to do normal operations on the network such as
@@ -131,6 +132,9 @@ public:
     virtual void processTransaction (std::shared_ptr<Transaction>& transaction,
         bool bUnlimited, bool bLocal, FailHard failType) = 0;
 
+    /** The stage verifying signatures of transactions from the network */
+    virtual TxVerifier& getTxVerifier () = 0;
+
     //--------------------------------------------------------------------------
     //
     // Owner functions
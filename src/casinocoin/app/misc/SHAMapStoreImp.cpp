@@ -27,6 +27,7 @@
 
 #include <casinocoin/app/misc/SHAMapStoreImp.h>
 #include <casinocoin/app/ledger/TransactionMaster.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <casinocoin/core/ConfigSections.h>
 #include <casinocoin/beast/core/CurrentThreadName.h>
@@ -736,6 +737,9 @@ SHAMapStoreImp::clearPrior (LedgerIndex lastRotated)
         "DELETE FROM AccountTransactions WHERE LedgerSeq < %u;");
     if (health())
         return;
+
+    if (auto store = app_.getAccountTxStore ())
+        store->deleteBefore (lastRotated);
 }
 
 SHAMapStoreImp::Health
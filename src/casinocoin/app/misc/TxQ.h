@@ -27,6 +27,8 @@
 #define CASINOCOIN_TXQ_H_INCLUDED
 
 #include <casinocoin/app/tx/applySteps.h>
+#include <casinocoin/basics/PoolAllocator.h>
+#include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/ledger/OpenView.h>
 #include <casinocoin/ledger/ApplyView.h>
 #include <casinocoin/protocol/TER.h>
@@ -345,7 +347,9 @@ private:
     class TxQAccount
     {
     public:
-        using TxMap = std::map <TxSeq, MaybeTx>;
+        // Nodes come from a pool shared by all the accounts
+        using TxMap = std::map <TxSeq, MaybeTx, std::less<TxSeq>,
+            PoolAllocator<std::pair<TxSeq const, MaybeTx>>>;
 
         AccountID const account;
         // Sequence number will be used as the key.
@@ -366,8 +370,10 @@ private:
         bool dropPenalty = false;
 
     public:
-        explicit TxQAccount(std::shared_ptr<STTx const> const& txn);
-        explicit TxQAccount(const AccountID& account);
+        TxQAccount(std::shared_ptr<STTx const> const& txn,
+            TxMap::allocator_type const& alloc);
+        TxQAccount(const AccountID& account,
+            TxMap::allocator_type const& alloc);
 
         std::size_t
         getTxnCount() const
@@ -396,7 +402,7 @@ private:
         < MaybeTx, FeeHook,
         boost::intrusive::compare <GreaterFee> >;
 
-    using AccountMap = std::map <AccountID, TxQAccount>;
+    using AccountMap = hardened_hash_map <AccountID, TxQAccount>;
 
     Setup const setup_;
     beast::Journal j_;
@@ -405,6 +411,7 @@ private:
     // locked mutex_
     FeeMetrics feeMetrics_;
     FeeMultiSet byFee_;
+    TxQAccount::TxMap::allocator_type txPool_;
     AccountMap byAccount_;
     boost::optional<size_t> maxSize_;
 
@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_APP_MISC_TXVERIFIER_H_INCLUDED
+#define CASINOCOIN_APP_MISC_TXVERIFIER_H_INCLUDED
+
+#include <casinocoin/basics/DecayingSample.h>
+#include <casinocoin/beast/clock/abstract_clock.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/core/JobCounter.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <casinocoin/protocol/STTx.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace casinocoin {
+
+class Application;
+
+/** Signature verification stage for inbound transactions.
+
+    Transactions received from peers and clients are queued here and
+    verified in batches by up to a configured number of concurrent
+    jobs. Ed25519 single signatures in a batch are first verified
+    together to reject bad ones cheaply, then every transaction is
+    checked individually. Results are recorded in the HashRouter, so
+    the checkValidity calls made further down the pipeline only
+    perform the local checks.
+
+    Once a transaction has been checked its handler is called on the
+    verifying job, typically handing it to the transaction batch.
+*/
+class TxVerifier
+{
+public:
+    using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+    using Handler = std::function <void (std::shared_ptr<STTx const> const&)>;
+
+    /** Number of transactions taken from the queue by one job at a time */
+    static std::size_t const batchSize = 64;
+
+    /** Number of pending transactions above which new ones are refused */
+    static std::size_t const maxQueued = 4096;
+
+    TxVerifier (
+        Application& app,
+        JobCounter& jobCounter,
+        clock_type& clock,
+        beast::Journal journal);
+
+    /** Queue a transaction for signature verification.
+
+        @param stx The transaction to verify.
+        @param rules The rules the signature is checked against.
+        @param handler Called once the signature has been checked.
+
+        @par Thread Safety
+
+        May be called concurrently
+
+        @return `false` if the queue is full and the transaction dropped
+    */
+    bool
+    verify (
+        std::shared_ptr<STTx const> const& stx,
+        Rules const& rules,
+        Handler handler);
+
+    /** Number of transactions waiting to be verified */
+    std::size_t
+    size () const;
+
+    /** Number of concurrent verification jobs */
+    std::size_t
+    workers () const
+    {
+        return workers_;
+    }
+
+    /** Total number of transactions verified */
+    std::uint64_t
+    verified () const
+    {
+        return verified_;
+    }
+
+    /** Signatures verified per second */
+    double
+    rate ();
+
+    /** Add verification statistics to a get_counts result */
+    void
+    getCounts (Json::Value& ret);
+
+private:
+    struct Item
+    {
+        std::shared_ptr<STTx const> stx;
+        Rules rules;
+        Handler handler;
+    };
+
+    /// Verify queued transactions until the queue is empty
+    void
+    process ();
+
+    /// Check the signatures of a batch and record them in the router
+    void
+    verifyBatch (std::vector<Item> const& batch);
+
+    Application& app_;
+    JobCounter& jobCounter_;
+    clock_type& clock_;
+    beast::Journal j_;
+    std::size_t const workers_;
+
+    std::mutex mutable mutex_;
+    std::deque<Item> queue_;
+    std::size_t running_ = 0;
+    DecayWindow<30, clock_type> rate_;
+
+    std::atomic<std::uint64_t> verified_ {0};
+    std::atomic<std::uint64_t> batched_ {0};
+};
+
+} // casinocoin
+
+#endif
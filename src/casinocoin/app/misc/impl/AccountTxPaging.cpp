@@ -268,4 +268,91 @@ accountTxPage (
     return;
 }
 
+void
+accountTxPage (
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const& onTransaction,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool forward,
+    Json::Value& token,
+    int limit,
+    bool bAdmin,
+    std::uint32_t page_length)
+{
+    bool const lookingForMarker = !token.isNull() && token.isObject();
+
+    std::uint32_t numberOfResults;
+
+    if (limit <= 0 || (limit > page_length && !bAdmin))
+        numberOfResults = page_length;
+    else
+        numberOfResults = limit;
+
+    boost::optional<std::pair<std::uint32_t, std::uint32_t>> marker;
+
+    if (lookingForMarker)
+    {
+        try
+        {
+            if (!token.isMember(jss::ledger) || !token.isMember(jss::seq))
+                return;
+            marker.emplace (token[jss::ledger].asUInt(),
+                token[jss::seq].asUInt());
+        }
+        catch (std::exception const&)
+        {
+            return;
+        }
+    }
+
+    token = Json::nullValue;
+
+    // Same as the queries on AccountTransactions: the marker is the
+    // first transaction of the page, even outside the ledger range
+    std::uint32_t low = std::max (minLedger, 0);
+    std::uint32_t high = maxLedger < 0 ?
+        std::numeric_limits<std::uint32_t>::max () : maxLedger;
+    if (marker)
+    {
+        low = std::min (low, marker->first);
+        high = std::max (high, marker->first);
+    }
+
+    bool first = true;
+    store.forEach (account, low, high, forward, marker,
+        [&](AccountTxStore::Entry const& entry)
+        {
+            if (first)
+            {
+                first = false;
+                // The marker transaction is no longer there
+                if (marker && (entry.ledgerSeq != marker->first ||
+                        entry.txnSeq != marker->second))
+                    return false;
+            }
+
+            if (numberOfResults == 0)
+            {
+                token = Json::objectValue;
+                token[jss::ledger] = entry.ledgerSeq;
+                token[jss::seq] = entry.txnSeq;
+                return false;
+            }
+
+            if (entry.rawMeta.empty ())
+                onUnsavedLedger(entry.ledgerSeq);
+
+            onTransaction(entry.ledgerSeq, entry.status,
+                entry.rawTxn, entry.rawMeta);
+            --numberOfResults;
+            return true;
+        });
+}
+
 } // casinocoin
@@ -27,6 +27,7 @@
 #define CASINOCOIN_APP_MISC_IMPL_ACCOUNTTXPAGING_H_INCLUDED
 
 #include <casinocoin/core/DatabaseCon.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <cstdint>
 #include <string>
@@ -67,6 +68,23 @@ accountTxPage (
     bool bAdmin,
     std::uint32_t pageLength);
 
+void
+accountTxPage (
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const&,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool forward,
+    Json::Value& token,
+    int limit,
+    bool bAdmin,
+    std::uint32_t pageLength);
+
 } // casinocoin
 
 #endif
@@ -0,0 +1,584 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/StringUtilities.h>
+#include <casinocoin/core/DatabaseCon.h>
+#include <casinocoin/core/SociDB.h>
+#include <casinocoin/protocol/Serializer.h>
+#include <casinocoin/unity/rocksdb.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <mutex>
+
+namespace casinocoin {
+
+/*  Keys
+
+    'a' account ledgerSeq txnSeq    Transaction ID
+    'l' ledgerSeq                   Transaction sequences and accounts
+                                    of the ledger
+
+    Sequences are big endian so that keys sort by them. The transactions
+    themselves are in the Transactions table, a transaction saved again
+    with a later ledger has the sequence of that ledger there.
+*/
+
+static
+std::string
+accountTxKey (AccountID const& account,
+    std::uint32_t ledgerSeq, std::uint32_t txnSeq)
+{
+    Serializer s (29);
+    s.add8 ('a');
+    s.add160 (account);
+    s.add32 (ledgerSeq);
+    s.add32 (txnSeq);
+    return s.getString ();
+}
+
+static
+std::string
+accountTxLedgerKey (std::uint32_t seq)
+{
+    Serializer s (5);
+    s.add8 ('l');
+    s.add32 (seq);
+    return s.getString ();
+}
+
+// Queue the removal of what was stored for a ledger
+static
+void
+accountTxDeleteLedger (std::uint32_t seq, std::string const& value,
+    AccountTxStore::Batch& batch)
+{
+    SerialIter sit (value.data (), value.size ());
+    auto n = sit.get32 ();
+    while (n--)
+    {
+        auto const txnSeq = sit.get32 ();
+        auto accounts = sit.get32 ();
+        while (accounts--)
+        {
+            batch.emplace_back (accountTxKey (
+                sit.getBitString<160, detail::AccountIDTag> (), seq, txnSeq),
+                    boost::none);
+        }
+    }
+    batch.emplace_back (accountTxLedgerKey (seq), boost::none);
+}
+
+//------------------------------------------------------------------------------
+
+class MemoryAccountTxBackend
+    : public AccountTxStore::Backend
+{
+public:
+    std::string
+    getName () override
+    {
+        return "memory";
+    }
+
+    bool
+    fetch (std::string const& key, std::string& value) override
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const iter = map_.find (key);
+        if (iter == map_.end ())
+            return false;
+        value = iter->second;
+        return true;
+    }
+
+    void
+    write (AccountTxStore::Batch const& batch) override
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        for (auto const& e : batch)
+        {
+            if (e.second)
+                map_[e.first] = *e.second;
+            else
+                map_.erase (e.first);
+        }
+    }
+
+    void
+    scan (std::string const& first, std::string const& last,
+        bool forward, std::function<bool (
+            std::string const&, std::string const&)> const& f) override
+    {
+        // Copy the range so f may use the store
+        std::vector<std::pair<std::string, std::string>> items;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            items.assign (map_.lower_bound (first), map_.upper_bound (last));
+        }
+        if (! forward)
+            std::reverse (items.begin (), items.end ());
+        for (auto const& item : items)
+        {
+            if (! f (item.first, item.second))
+                return;
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::string, std::string> map_;
+};
+
+#if CASINOCOIN_ROCKSDB_AVAILABLE
+
+class RocksDBAccountTxBackend
+    : public AccountTxStore::Backend
+{
+public:
+    RocksDBAccountTxBackend (Section const& section, beast::Journal journal)
+        : j_ (journal)
+    {
+        if (! get_if_exists (section, "path", name_))
+            Throw<std::runtime_error> ("Missing path in [account_tx_db]");
+
+        rocksdb::Options options;
+        rocksdb::BlockBasedTableOptions table_options;
+        options.create_if_missing = true;
+
+        if (section.exists ("cache_mb"))
+        {
+            table_options.block_cache = rocksdb::NewLRUCache (
+                get<int>(section, "cache_mb") * 1024L * 1024L);
+        }
+        get_if_exists (section, "open_files", options.max_open_files);
+        if (section.exists ("compression") &&
+            (get<int>(section, "compression") == 0))
+        {
+            options.compression = rocksdb::kNoCompression;
+        }
+        options.table_factory.reset (
+            NewBlockBasedTableFactory (table_options));
+
+        rocksdb::DB* db = nullptr;
+        rocksdb::Status status = rocksdb::DB::Open (options, name_, &db);
+        if (! status.ok () || ! db)
+            Throw<std::runtime_error> (
+                std::string("Unable to open/create RocksDB: ") +
+                    status.ToString());
+        db_.reset (db);
+    }
+
+    std::string
+    getName () override
+    {
+        return name_;
+    }
+
+    bool
+    fetch (std::string const& key, std::string& value) override
+    {
+        auto const status = db_->Get (
+            rocksdb::ReadOptions (), rocksdb::Slice (key), &value);
+        if (! status.ok () && ! status.IsNotFound ())
+            JLOG (j_.error()) << status.ToString ();
+        return status.ok ();
+    }
+
+    void
+    write (AccountTxStore::Batch const& batch) override
+    {
+        rocksdb::WriteBatch wb;
+        for (auto const& e : batch)
+        {
+            if (e.second)
+                wb.Put (rocksdb::Slice (e.first), rocksdb::Slice (*e.second));
+            else
+                wb.Delete (rocksdb::Slice (e.first));
+        }
+
+        auto const status = db_->Write (rocksdb::WriteOptions (), &wb);
+        if (! status.ok ())
+            Throw<std::runtime_error> (
+                "AccountTxStore write error: " + status.ToString ());
+    }
+
+    void
+    scan (std::string const& first, std::string const& last,
+        bool forward, std::function<bool (
+            std::string const&, std::string const&)> const& f) override
+    {
+        std::unique_ptr<rocksdb::Iterator> it (
+            db_->NewIterator (rocksdb::ReadOptions ()));
+
+        if (forward)
+        {
+            for (it->Seek (rocksdb::Slice (first)); it->Valid (); it->Next ())
+            {
+                auto const key = it->key ().ToString ();
+                if (key > last || ! f (key, it->value ().ToString ()))
+                    return;
+            }
+        }
+        else
+        {
+            // Position on the last key not after the end of the range
+            it->Seek (rocksdb::Slice (last));
+            if (! it->Valid ())
+                it->SeekToLast ();
+            else if (it->key ().ToString () > last)
+                it->Prev ();
+
+            for (; it->Valid (); it->Prev ())
+            {
+                auto const key = it->key ().ToString ();
+                if (key < first || ! f (key, it->value ().ToString ()))
+                    return;
+            }
+        }
+    }
+
+private:
+    beast::Journal j_;
+    std::string name_;
+    std::unique_ptr<rocksdb::DB> db_;
+};
+
+#endif
+
+//------------------------------------------------------------------------------
+
+AccountTxStore::AccountTxStore (std::unique_ptr<Backend> backend,
+        DatabaseCon& txnDB, beast::Journal journal)
+    : backend_ (std::move (backend))
+    , txnDB_ (txnDB)
+    , j_ (journal)
+{
+}
+
+void
+AccountTxStore::saveLedger (
+    std::uint32_t seq, std::vector<Record> const& records)
+{
+    Batch batch;
+    std::string old;
+    if (backend_->fetch (accountTxLedgerKey (seq), old))
+        accountTxDeleteLedger (seq, old, batch);
+
+    Serializer ledger;
+    ledger.add32 (records.size ());
+    for (auto const& r : records)
+    {
+        ledger.add32 (r.txnSeq);
+        ledger.add32 (r.accounts.size ());
+
+        for (auto const& account : r.accounts)
+        {
+            ledger.add160 (account);
+            batch.emplace_back (accountTxKey (account, seq, r.txnSeq),
+                std::string (r.id.cbegin (), r.id.cend ()));
+        }
+    }
+    batch.emplace_back (accountTxLedgerKey (seq), ledger.getString ());
+
+    backend_->write (batch);
+    JLOG (j_.trace()) << "Saved " << records.size () <<
+        " transactions of ledger " << seq;
+}
+
+void
+AccountTxStore::deleteBefore (std::uint32_t seq)
+{
+    if (seq == 0)
+        return;
+
+    // Delete a bounded number of ledgers per batch
+    std::size_t const ledgersPerBatch = 256;
+    for (;;)
+    {
+        Batch batch;
+        std::size_t n = 0;
+        backend_->scan (accountTxLedgerKey (0), accountTxLedgerKey (seq - 1),
+            true, [&](std::string const& key, std::string const& value)
+            {
+                SerialIter sit (key.data () + 1, key.size () - 1);
+                accountTxDeleteLedger (sit.get32 (), value, batch);
+                return ++n < ledgersPerBatch;
+            });
+        if (n == 0)
+            return;
+        backend_->write (batch);
+    }
+}
+
+void
+AccountTxStore::forEach (AccountID const& account,
+    std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+    boost::optional<std::pair<std::uint32_t, std::uint32_t>> const& start,
+    std::function<bool (Entry const&)> const& f)
+{
+    auto first = accountTxKey (account, minLedger, 0);
+    auto last = accountTxKey (account, maxLedger,
+        std::numeric_limits<std::uint32_t>::max ());
+    if (start)
+    {
+        (forward ? first : last) =
+            accountTxKey (account, start->first, start->second);
+    }
+    if (first > last)
+        return;
+
+    // Keys are scanned a page at a time and the transactions of a page
+    // are then read with a single query, outside of the scan.
+    std::size_t const pageSize = 256;
+    boost::optional<std::string> resume;
+    for (;;)
+    {
+        std::vector<std::pair<uint256, Entry>> page;
+        page.reserve (pageSize);
+
+        backend_->scan (first, last, forward,
+            [&](std::string const& key, std::string const& value)
+            {
+                // Visited at the end of the previous page
+                if (key == resume)
+                    return true;
+
+                resume = key;
+                if (value.size () != uint256::bytes)
+                    return true;
+
+                SerialIter sit (key.data () + 21, key.size () - 21);
+                Entry entry;
+                entry.ledgerSeq = sit.get32 ();
+                entry.txnSeq = sit.get32 ();
+                page.emplace_back (uint256::fromVoid (value.data ()),
+                    std::move (entry));
+                return page.size () < pageSize;
+            });
+
+        if (page.empty ())
+            return;
+
+        fetchTransactions (page);
+        for (auto const& item : page)
+        {
+            // Missing, or saved again with another ledger
+            if (item.second.ledgerSeq != 0 && ! f (item.second))
+                return;
+        }
+
+        if (page.size () < pageSize)
+            return;
+        (forward ? first : last) = *resume;
+    }
+}
+
+void
+AccountTxStore::fetchTransactions (
+    std::vector<std::pair<uint256, Entry>>& page)
+{
+    std::string sql =
+        "SELECT TransID,LedgerSeq,Status,RawTxn,TxnMeta "
+        "FROM Transactions WHERE TransID IN (";
+    for (std::size_t i = 0; i < page.size (); ++i)
+    {
+        if (i != 0)
+            sql += ",";
+        sql += "'" + to_string (page[i].first) + "'";
+    }
+    sql += ");";
+
+    struct Row
+    {
+        std::uint32_t ledgerSeq;
+        std::string status;
+        Blob rawTxn;
+        Blob rawMeta;
+    };
+    std::map<uint256, Row> rows;
+    {
+        auto db = txnDB_.checkoutDb ();
+
+        std::string transID;
+        boost::optional<std::uint64_t> ledgerSeq;
+        boost::optional<std::string> status;
+        soci::blob txnData (*db);
+        soci::blob txnMeta (*db);
+        soci::indicator dataPresent, metaPresent;
+
+        soci::statement st = (db->prepare << sql,
+            soci::into (transID),
+            soci::into (ledgerSeq),
+            soci::into (status),
+            soci::into (txnData, dataPresent),
+            soci::into (txnMeta, metaPresent));
+
+        st.execute ();
+        while (st.fetch ())
+        {
+            uint256 id;
+            if (! id.SetHex (transID))
+                continue;
+
+            auto& row = rows[id];
+            row.ledgerSeq = rangeCheckedCast<std::uint32_t> (
+                ledgerSeq.value_or (0));
+            row.status = status.value_or ("");
+            if (dataPresent == soci::i_ok)
+                convert (txnData, row.rawTxn);
+            if (metaPresent == soci::i_ok)
+                convert (txnMeta, row.rawMeta);
+        }
+    }
+
+    // Entries without a matching transaction are left with ledger zero
+    for (auto& item : page)
+    {
+        auto& entry = item.second;
+        auto const iter = rows.find (item.first);
+        if (iter == rows.end ())
+        {
+            JLOG (j_.warn()) << "Missing transaction in ledger " <<
+                entry.ledgerSeq;
+            entry.ledgerSeq = 0;
+        }
+        else if (iter->second.ledgerSeq != entry.ledgerSeq)
+        {
+            // The transaction was saved again with another ledger
+            entry.ledgerSeq = 0;
+        }
+        else
+        {
+            entry.status = std::move (iter->second.status);
+            entry.rawTxn = std::move (iter->second.rawTxn);
+            entry.rawMeta = std::move (iter->second.rawMeta);
+        }
+    }
+}
+
+std::size_t
+AccountTxStore::import ()
+{
+    static std::string const sql (
+        R"(SELECT LedgerSeq,TxnSeq,TransID,Account
+          FROM AccountTransactions ORDER BY LedgerSeq,TxnSeq;)");
+
+    std::size_t count = 0;
+    std::uint32_t ledgerSeq = 0;
+    std::vector<Record> records;
+
+    auto flush = [&]()
+    {
+        if (! records.empty ())
+        {
+            saveLedger (ledgerSeq, records);
+            count += records.size ();
+            records.clear ();
+        }
+    };
+
+    auto db (txnDB_.checkoutDb ());
+
+    boost::optional<std::uint64_t> seq;
+    boost::optional<std::uint64_t> txnSeq;
+    std::string transID;
+    std::string accountID;
+
+    soci::statement st = (db->prepare << sql,
+        soci::into (seq),
+        soci::into (txnSeq),
+        soci::into (transID),
+        soci::into (accountID));
+
+    st.execute ();
+    while (st.fetch ())
+    {
+        auto const account = parseBase58<AccountID> (accountID);
+        uint256 id;
+        if (! account || ! id.SetHex (transID))
+        {
+            JLOG (j_.warn()) << "Skipping " << transID << " for " << accountID;
+            continue;
+        }
+
+        if (seq.value_or (0) != ledgerSeq)
+        {
+            flush ();
+            ledgerSeq = rangeCheckedCast<std::uint32_t> (seq.value_or (0));
+            if (ledgerSeq % 10000 == 0)
+                JLOG (j_.info()) << "Importing ledger " << ledgerSeq;
+        }
+
+        // A transaction affecting several accounts has several rows
+        if (records.empty () || records.back ().id != id)
+        {
+            records.emplace_back ();
+            auto& r = records.back ();
+            r.id = id;
+            r.txnSeq = rangeCheckedCast<std::uint32_t> (txnSeq.value_or (0));
+        }
+        records.back ().accounts.push_back (*account);
+    }
+    flush ();
+
+    JLOG (j_.info()) << "Imported " << count << " transactions into " <<
+        getName ();
+    return count;
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<AccountTxStore>
+make_AccountTxStore (Section const& section,
+    DatabaseCon& txnDB, beast::Journal journal)
+{
+    auto const type = get<std::string> (section, "type");
+    if (type.empty ())
+        return nullptr;
+
+    std::unique_ptr<AccountTxStore::Backend> backend;
+    if (boost::iequals (type, "memory"))
+    {
+        backend = std::make_unique<MemoryAccountTxBackend> ();
+    }
+#if CASINOCOIN_ROCKSDB_AVAILABLE
+    else if (boost::iequals (type, "rocksdb"))
+    {
+        backend = std::make_unique<RocksDBAccountTxBackend> (
+            section, journal);
+    }
+#endif
+    else
+    {
+        Throw<std::runtime_error> (
+            "Unsupported [account_tx_db] type: " + type);
+    }
+
+    return std::make_unique<AccountTxStore> (
+        std::move (backend), txnDB, journal);
+}
+
+} // casinocoin
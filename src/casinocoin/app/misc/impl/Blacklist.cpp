@@ -37,6 +37,8 @@ Blacklist::Blacklist (
     beast::Journal j)
     : timeKeeper_ (timeKeeper)
     , j_ (j)
+    , index_ (std::make_shared<Index const>())
+    , dirty_ (false)
 {
 }
 
@@ -47,31 +49,25 @@ Blacklist::~Blacklist()
 bool
 Blacklist::listed (std::string const& accountID) const
 {
-    bool found = false;
-    for(size_t i=0; i<blacklistVector_.size(); i++)
-    {
-        if(blacklistVector_[i].accountID == accountID)
-        {
-            found = true;
-            break;
-        }
-    }
-    return found;
+    boost::shared_lock<boost::shared_mutex> read_lock{mutex_};
+    return blacklistMap_.find (accountID) != blacklistMap_.end ();
+}
+
+bool
+Blacklist::listed (AccountID const& accountID) const
+{
+    auto const index = std::atomic_load (&index_);
+    return index->find (accountID) != index->end ();
 }
 
 BlacklistItem
 Blacklist::getAccount (std::string const& accountID ) const
 {
-    BlacklistItem account;
-    for(size_t i=0; i<blacklistVector_.size(); i++)
-    {
-        if(blacklistVector_[i].accountID == accountID)
-        {
-            account = blacklistVector_[i];
-            break;
-        }
-    }
-    return account;
+    boost::shared_lock<boost::shared_mutex> read_lock{mutex_};
+    auto const it = blacklistMap_.find (accountID);
+    if (it == blacklistMap_.end ())
+        return BlacklistItem{};
+    return it->second;
 }
 
 void
@@ -120,41 +116,69 @@ Blacklist::refreshAccountOnList (
     }
     
 
+    boost::unique_lock<boost::shared_mutex> lock{mutex_};
+
     // check if account is already listed
-    bool accountListed = Blacklist::listed(accountID);
+    auto const it = blacklistMap_.find (accountID);
+    bool const accountListed = it != blacklistMap_.end ();
     JLOG (j_.debug()) << "Account: " << accountID << " Listed: " << accountListed;
 
     if(!accountListed && enabled)
     {
         // add account to list
-        blacklistVector_.push_back({accountID, signature, publicKeySigner, creationDate, lastUpdatedDate, enabled});
+        blacklistMap_.emplace (accountID, BlacklistItem{accountID, signature,
+            publicKeySigner, creationDate, lastUpdatedDate, enabled});
+        dirty_ = true;
         JLOG (j_.debug()) << "Added AccountID: " << accountID;
     }
     else if(accountListed && !enabled)
     {
-        // remove account from list if it exists
-        auto it = std::find_if(blacklistVector_.begin(), blacklistVector_.end(), boost::bind(&BlacklistItem::accountID, _1) == accountID);
-        if (it != blacklistVector_.end())
-            blacklistVector_.erase(it);
+        // remove account from list
+        blacklistMap_.erase (it);
+        dirty_ = true;
         JLOG (j_.debug()) << "Removed AccountID: " << accountID;
     }
     else if(accountListed && enabled)
     {
         // update listed account
-        auto it = std::find_if(blacklistVector_.begin(), blacklistVector_.end(), boost::bind(&BlacklistItem::accountID, _1) == accountID);
-        if (it != blacklistVector_.end())
-            *it = {accountID, signature, publicKeySigner, creationDate, lastUpdatedDate, enabled};
+        it->second = {accountID, signature, publicKeySigner, creationDate,
+            lastUpdatedDate, enabled};
         JLOG (j_.debug()) << "Updated AccountID: " << accountID;
     }
 }
 
+void
+Blacklist::publish ()
+{
+    boost::unique_lock<boost::shared_mutex> lock{mutex_};
+    if (! dirty_)
+        return;
+
+    auto index = std::make_shared<Index> ();
+    index->reserve (blacklistMap_.size ());
+    for (auto const& entry : blacklistMap_)
+    {
+        if (auto const id = parseBase58<AccountID> (entry.first))
+            index->insert (*id);
+        else
+            JLOG (j_.warn()) << "Blacklisted AccountID " << entry.first <<
+                " can not be parsed and is not indexed";
+    }
+
+    JLOG (j_.debug()) << "Published blacklist index: " << index->size () << " accounts";
+    std::atomic_store (&index_, std::shared_ptr<Index const> (std::move (index)));
+    dirty_ = false;
+}
+
 Json::Value
 Blacklist::getJson() const
 {
     Json::Value jrr(Json::arrayValue);
     {
-        for (BlacklistItem const& item : blacklistVector_)
+        boost::shared_lock<boost::shared_mutex> read_lock{mutex_};
+        for (auto const& entry : blacklistMap_)
         {
+            BlacklistItem const& item = entry.second;
             Json::Value& v = jrr.append(Json::objectValue);
             v[jss::account_id] = item.accountID;
             v[jss::signature] = item.signature;
@@ -168,7 +192,8 @@ Blacklist::getJson() const
 size_t 
 Blacklist::getSize() const
 {
-    return blacklistVector_.size();
+    boost::shared_lock<boost::shared_mutex> read_lock{mutex_};
+    return blacklistMap_.size();
 }
 
 } // casinocoin
@@ -254,6 +254,8 @@ BlacklistUpdater::onSiteFetch(
                     break;
                 }
             }
+            // make the refreshed entries visible to transaction processing
+            blacklist_.publish ();
             // set last refresh status
             sites_[siteIdx].lastRefreshStatus.emplace(Site::Status{clock_type::now(), true});
         }
@@ -274,13 +274,16 @@ TxQ::MaybeTx::apply(Application& app, OpenView& view)
     return doApply(pcresult, app, view);
 }
 
-TxQ::TxQAccount::TxQAccount(std::shared_ptr<STTx const> const& txn)
-    :TxQAccount(txn->getAccountID(sfAccount))
+TxQ::TxQAccount::TxQAccount(std::shared_ptr<STTx const> const& txn,
+        TxMap::allocator_type const& alloc)
+    :TxQAccount(txn->getAccountID(sfAccount), alloc)
 {
 }
 
-TxQ::TxQAccount::TxQAccount(const AccountID& account_)
+TxQ::TxQAccount::TxQAccount(const AccountID& account_,
+        TxMap::allocator_type const& alloc)
     : account(account_)
+    , transactions(alloc)
 {
 }
 
@@ -310,6 +313,7 @@ TxQ::TxQ(Setup const& setup,
     : setup_(setup)
     , j_(j)
     , feeMetrics_(setup, j)
+    , txPool_(setup.minimumTxnInLedger * setup.ledgersInQueue)
     , maxSize_(boost::none)
 {
 }
@@ -1065,7 +1069,7 @@ TxQ::apply(Application& app, OpenView& view,
         // Create a new TxQAccount object and add the byAccount lookup.
         bool created;
         std::tie(accountIter, created) = byAccount_.emplace(
-            account, TxQAccount(tx));
+            account, TxQAccount(tx, txPool_));
         (void)created;
         assert(created);
     }
@@ -1120,7 +1124,11 @@ TxQ::processClosedLedger(Application& app,
     auto ledgerSeq = view.info().seq;
 
     if (!timeLeap)
+    {
         maxSize_ = snapshot.txnsExpected * setup_.ledgersInQueue;
+        // Keep no more spare nodes than the queue can hold
+        txPool_.setMaxFree(*maxSize_);
+    }
 
     // Remove any queued candidates whose LastLedgerSequence has gone by.
     for(auto candidateIter = byFee_.begin(); candidateIter != byFee_.end(); )
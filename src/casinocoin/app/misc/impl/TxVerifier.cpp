@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/app/misc/TxVerifier.h>
+#include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/misc/HashRouter.h>
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/core/JobQueue.h>
+#include <casinocoin/protocol/HashPrefix.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/protocol/PublicKey.h>
+#include <casinocoin/protocol/Serializer.h>
+#include <algorithm>
+#include <thread>
+
+namespace casinocoin {
+
+static
+std::size_t
+verifyWorkers (Config const& config)
+{
+    if (config.VERIFY_WORKERS != 0)
+        return config.VERIFY_WORKERS;
+    return std::max (1u, std::thread::hardware_concurrency () / 2);
+}
+
+TxVerifier::TxVerifier (
+    Application& app,
+    JobCounter& jobCounter,
+    clock_type& clock,
+    beast::Journal journal)
+    : app_ (app)
+    , jobCounter_ (jobCounter)
+    , clock_ (clock)
+    , j_ (journal)
+    , workers_ (verifyWorkers (app.config ()))
+    , rate_ (clock.now ())
+{
+}
+
+bool
+TxVerifier::verify (
+    std::shared_ptr<STTx const> const& stx,
+    Rules const& rules,
+    Handler handler)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    if (queue_.size () >= maxQueued)
+    {
+        JLOG (j_.info()) << "Verification queue is full";
+        return false;
+    }
+
+    queue_.push_back (Item{stx, rules, std::move (handler)});
+
+    // Start another job while there is more than a batch
+    // of work for each running one.
+    if (running_ < workers_ && queue_.size () > running_ * batchSize)
+    {
+        if (app_.getJobQueue ().addCountedJob (
+            jtTRANSACTION, "verifyTxns", jobCounter_,
+            [this] (Job&) { process (); }))
+        {
+            ++running_;
+        }
+        else if (running_ == 0)
+        {
+            // Shutting down
+            queue_.clear ();
+        }
+    }
+    return true;
+}
+
+std::size_t
+TxVerifier::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return queue_.size ();
+}
+
+double
+TxVerifier::rate ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return rate_.value (clock_.now ());
+}
+
+void
+TxVerifier::getCounts (Json::Value& ret)
+{
+    ret[jss::verify_rate] = rate ();
+    ret[jss::verify_queue] = static_cast<Json::UInt> (size ());
+    ret[jss::verify_total] = std::to_string (verified_.load ());
+    ret[jss::verify_batched] = std::to_string (batched_.load ());
+}
+
+void
+TxVerifier::process ()
+{
+    std::vector<Item> batch;
+    batch.reserve (batchSize);
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            if (! batch.empty ())
+                rate_.add (batch.size (), clock_.now ());
+
+            if (queue_.empty ())
+            {
+                --running_;
+                return;
+            }
+
+            batch.clear ();
+            auto const n = std::min (batchSize, queue_.size ());
+            std::move (queue_.begin (), queue_.begin () + n,
+                std::back_inserter (batch));
+            queue_.erase (queue_.begin (), queue_.begin () + n);
+        }
+
+        verifyBatch (batch);
+        verified_ += batch.size ();
+
+        for (auto const& item : batch)
+            item.handler (item.stx);
+    }
+}
+
+void
+TxVerifier::verifyBatch (std::vector<Item> const& batch)
+{
+    // Collect the single signed Ed25519 transactions
+    // whose signature has not been checked yet.
+    std::vector<uint256> ids;
+    std::vector<PublicKey> keys;
+    std::vector<Blob> data;
+    std::vector<Blob> sigs;
+
+    auto& router = app_.getHashRouter ();
+    for (auto const& item : batch)
+    {
+        auto const& tx = *item.stx;
+        auto const id = tx.getTransactionID ();
+
+        // Anything already known to the router, in particular
+        // cached signature results, goes to the individual check.
+        if (router.getFlags (id) != 0)
+            continue;
+
+        try
+        {
+            if (tx.isFieldPresent (sfSigners))
+                continue;
+
+            auto const spk = tx.getFieldVL (sfSigningPubKey);
+            if (publicKeyType (makeSlice (spk)) != KeyType::ed25519)
+                continue;
+
+            Serializer s;
+            s.add32 (HashPrefix::txSign);
+            tx.addWithoutSigningFields (s);
+
+            ids.push_back (id);
+            keys.emplace_back (makeSlice (spk));
+            data.push_back (s.getData ());
+            sigs.push_back (tx.getFieldVL (sfTxnSignature));
+        }
+        catch (std::exception const&)
+        {
+            // Left for the individual check to reject
+        }
+    }
+
+    if (! ids.empty ())
+    {
+        std::vector<Slice> messages;
+        std::vector<Slice> signatures;
+        messages.reserve (ids.size ());
+        signatures.reserve (ids.size ());
+        for (std::size_t i = 0; i < ids.size (); ++i)
+        {
+            messages.push_back (makeSlice (data[i]));
+            signatures.push_back (makeSlice (sigs[i]));
+        }
+
+        // The batch may accept a signature that verify rejects, so
+        // only its rejections are final. Accepted signatures are
+        // checked again individually before they are trusted.
+        auto const valid = verifyEd25519Batch (keys, messages, signatures);
+        for (std::size_t i = 0; i < ids.size (); ++i)
+        {
+            if (! valid[i])
+                forceSigBad (router, ids[i]);
+        }
+        batched_ += ids.size ();
+    }
+
+    // Check everything individually. Signatures rejected by
+    // the batch are cached, so those fail without a check.
+    for (auto const& item : batch)
+    {
+        try
+        {
+            auto const validity = checkValidity (
+                router, *item.stx, item.rules, app_.config ());
+            if (validity.first == Validity::SigBad)
+            {
+                JLOG (j_.debug()) << "Transaction " <<
+                    item.stx->getTransactionID () <<
+                    " has bad signature: " << validity.second;
+            }
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.warn()) << "Exception checking transaction " <<
+                item.stx->getTransactionID () << ": " << e.what ();
+        }
+    }
+}
+
+} // casinocoin
@@ -30,7 +30,10 @@
 namespace casinocoin {
 
 CasinocoinLineCache::CasinocoinLineCache(
-    std::shared_ptr <ReadView const> const& ledger)
+    std::shared_ptr <ReadView const> const& ledger,
+    CasinocoinLineIndex* index)
+    : mBase (ledger)
+    , mIndex (index)
 {
     // We want the caching that OpenView provides
     // And we need to own a shared_ptr to the input view
@@ -45,14 +48,21 @@ CasinocoinLineCache::getCasinocoinLines (AccountID const& accountID)
 
     std::lock_guard <std::mutex> sl (mLock);
 
-    auto it = lines_.emplace (key,
-        std::vector<CasinocoinState::pointer>());
+    auto it = lines_.emplace (key, nullptr);
 
     if (it.second)
-        it.first->second = getCasinocoinStateItems (
-            accountID, *mLedger);
+    {
+        if (mIndex)
+            it.first->second = mIndex->getLines (*mBase, accountID);
+        if (! it.first->second)
+        {
+            it.first->second = std::make_shared<
+                std::vector<CasinocoinState::pointer> const> (
+                    getCasinocoinStateItems (accountID, *mLedger));
+        }
+    }
 
-    return it.first->second;
+    return *it.first->second;
 }
 
 } // casinocoin
@@ -27,6 +27,7 @@
 #define CASINOCOIN_APP_PATHS_CASINOCOINLINECACHE_H_INCLUDED
 
 #include <casinocoin/app/ledger/Ledger.h>
+#include <casinocoin/app/paths/CasinocoinLineIndex.h>
 #include <casinocoin/app/paths/CasinocoinState.h>
 #include <casinocoin/basics/hardened_hash.h>
 #include <cstddef>
@@ -40,9 +41,15 @@ namespace casinocoin {
 class CasinocoinLineCache
 {
 public:
+    /** Create a cache for a ledger.
+
+        @param index If set, lines are taken from it when it
+                     reflects the ledger.
+    */
     explicit
     CasinocoinLineCache (
-        std::shared_ptr <ReadView const> const& l);
+        std::shared_ptr <ReadView const> const& l,
+        CasinocoinLineIndex* index = nullptr);
 
     std::shared_ptr <ReadView const> const&
     getLedger () const
@@ -50,6 +57,16 @@ public:
         return mLedger;
     }
 
+    /** The ledger the cache was made from.
+
+        Unlike getLedger, this lists the ledger's transactions.
+    */
+    std::shared_ptr <ReadView const> const&
+    getBaseLedger () const
+    {
+        return mBase;
+    }
+
     std::vector<CasinocoinState::pointer> const&
     getCasinocoinLines (AccountID const& accountID);
 
@@ -58,6 +75,8 @@ private:
 
     casinocoin::hardened_hash<> hasher_;
     std::shared_ptr <ReadView const> mLedger;
+    std::shared_ptr <ReadView const> mBase;
+    CasinocoinLineIndex* mIndex;
 
     struct AccountKey
     {
@@ -97,7 +116,7 @@ private:
 
     hash_map <
         AccountKey,
-        std::vector <CasinocoinState::pointer>,
+        std::shared_ptr <std::vector <CasinocoinState::pointer> const>,
         AccountKey::Hash> lines_;
 };
 
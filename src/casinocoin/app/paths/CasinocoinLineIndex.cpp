@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/paths/CasinocoinLineIndex.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <algorithm>
+
+namespace casinocoin {
+
+CasinocoinLineIndex::CasinocoinLineIndex (
+        std::size_t maxAccounts, beast::Journal journal)
+    : index_ (maxAccounts, journal)
+{
+}
+
+std::shared_ptr<CasinocoinLineIndex::Lines const>
+CasinocoinLineIndex::getLines (ReadView const& ledger,
+    AccountID const& account, bool load)
+{
+    return index_.get (ledger, account,
+        [&]() -> std::shared_ptr<Lines const>
+        {
+            if (! load)
+                return nullptr;
+            return std::make_shared<Lines const> (
+                getCasinocoinStateItems (account, ledger));
+        });
+}
+
+void
+CasinocoinLineIndex::update (
+    ReadView const& ledger, AcceptedLedger const& accepted)
+{
+    Delta delta;
+    bool const known = getDelta (ledger, accepted, delta);
+    index_.update (ledger.info (), known ? &delta : nullptr,
+        [&ledger](AccountID const& account, Lines const& lines,
+            std::vector<Change> const& changes)
+        {
+            return patch (ledger, account, lines, changes);
+        });
+}
+
+std::size_t
+CasinocoinLineIndex::size () const
+{
+    return index_.size ();
+}
+
+LedgerIndex
+CasinocoinLineIndex::seq () const
+{
+    return index_.seq ();
+}
+
+bool
+CasinocoinLineIndex::getDelta (ReadView const& ledger,
+    AcceptedLedger const& accepted, Delta& delta)
+{
+    for (auto const& item : accepted.getMap ())
+    {
+        for (auto const& node : item.second->getMeta ()->getNodes ())
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltCASINOCOIN_STATE)
+                continue;
+
+            auto const key = node.getFieldH256 (sfLedgerIndex);
+            bool const created = node.getFName () == sfCreatedNode;
+
+            // Deleted lines, and lines created and deleted by the same
+            // ledger, are only found in the metadata
+            auto const sle = ledger.read (keylet::line (key));
+            STObject const* fields = sle.get ();
+            if (! fields)
+            {
+                fields = dynamic_cast<STObject const*> (node.peekAtPField (
+                    created ? sfNewFields : sfFinalFields));
+            }
+            if (! fields ||
+                ! fields->isFieldPresent (sfLowLimit) ||
+                ! fields->isFieldPresent (sfHighLimit))
+            {
+                return false;
+            }
+
+            delta[fields->getFieldAmount (sfLowLimit).getIssuer ()]
+                .push_back ({key, created});
+            delta[fields->getFieldAmount (sfHighLimit).getIssuer ()]
+                .push_back ({key, created});
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<CasinocoinLineIndex::Lines const>
+CasinocoinLineIndex::patch (ReadView const& ledger, AccountID const& account,
+    Lines const& lines, std::vector<Change> const& changes)
+{
+    hash_set<uint256> changed;
+    std::vector<uint256> created;
+    for (auto const& change : changes)
+    {
+        changed.insert (change.key);
+        if (change.created)
+            created.push_back (change.key);
+    }
+
+    // The metadata doesn't say in which order several lines were added
+    // to the owner directory, the lines are read again when needed.
+    if (created.size () > 1)
+        return nullptr;
+
+    auto result = std::make_shared<Lines> ();
+    result->reserve (lines.size () + created.size ());
+
+    auto add = [&](uint256 const& key)
+    {
+        if (auto sle = ledger.read (keylet::line (key)))
+        {
+            if (auto line = CasinocoinState::makeItem (account, std::move (sle)))
+                result->push_back (std::move (line));
+        }
+    };
+
+    for (auto const& line : lines)
+    {
+        if (changed.count (line->key ()) == 0)
+            result->push_back (line);
+        else
+            add (line->key ());
+    }
+
+    // New lines go at the end of the owner directory
+    for (auto const& key : created)
+        add (key);
+
+    return result;
+}
+
+} // casinocoin
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_PATHS_CASINOCOINLINEINDEX_H_INCLUDED
+#define CASINOCOIN_APP_PATHS_CASINOCOINLINEINDEX_H_INCLUDED
+
+#include <casinocoin/app/ledger/AcceptedLedger.h>
+#include <casinocoin/app/paths/CasinocoinState.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/ledger/AccountIndex.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <memory>
+#include <vector>
+
+namespace casinocoin {
+
+/** Trust lines of accounts, kept across ledgers.
+
+    The lines of an account are read from the state map the first time
+    they are asked for, in owner directory order, and then kept current
+    from the metadata of each published ledger: lines that were changed
+    are read again, deleted lines are dropped and created lines are
+    appended, the same place the owner directory puts them.
+
+    @see AccountIndex
+*/
+class CasinocoinLineIndex
+{
+public:
+    using Lines = std::vector<CasinocoinState::pointer>;
+
+    CasinocoinLineIndex (std::size_t maxAccounts, beast::Journal journal);
+
+    /** Returns the trust lines of an account in a ledger.
+
+        @param load Read the lines from the ledger if they aren't known.
+
+        @return The lines in owner directory order, or `nullptr` if
+                `ledger` isn't the last published ledger, or they aren't
+                known and `load` is `false`.
+    */
+    std::shared_ptr<Lines const>
+    getLines (ReadView const& ledger, AccountID const& account,
+        bool load = true);
+
+    /** Bring the index up to date with a published ledger. */
+    void
+    update (ReadView const& ledger, AcceptedLedger const& accepted);
+
+    /** Number of accounts whose lines are known */
+    std::size_t
+    size () const;
+
+    /** Sequence of the ledger the index reflects, 0 if none */
+    LedgerIndex
+    seq () const;
+
+private:
+    // A trust line created, changed or deleted by a ledger
+    struct Change
+    {
+        uint256 key;
+        bool created;
+    };
+
+    using Delta = hash_map<AccountID, std::vector<Change>>;
+
+    // Extract the trust line changes from a ledger's metadata
+    static
+    bool
+    getDelta (ReadView const& ledger, AcceptedLedger const& accepted,
+        Delta& delta);
+
+    // Returns the lines of an account after a ledger's changes
+    static
+    std::shared_ptr<Lines const>
+    patch (ReadView const& ledger, AccountID const& account,
+        Lines const& lines, std::vector<Change> const& changes);
+
+    AccountIndex<Lines> index_;
+};
+
+} // casinocoin
+
+#endif
@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/paths/PathCache.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/protocol/Serializer.h>
+#include <casinocoin/protocol/STLedgerEntry.h>
+#include <algorithm>
+
+namespace casinocoin {
+
+PathCache::PathCache (std::size_t maxSize,
+        beast::insight::Collector::ptr const& collector)
+    : maxSize_ (maxSize)
+    , stats_ (std::bind (&PathCache::collectMetrics, this), collector)
+{
+}
+
+uint256
+PathCache::makeKey (
+    AccountID const& srcAccount,
+    AccountID const& dstAccount,
+    Currency const& srcCurrency,
+    STAmount const& dstAmount,
+    boost::optional<STAmount> const& sendMax,
+    int level,
+    int maxPaths)
+{
+    Serializer s (128);
+    s.add160 (srcAccount);
+    s.add160 (dstAccount);
+    s.add160 (srcCurrency);
+    dstAmount.add (s);
+    s.add160 (dstAmount.getCurrency ());
+    if (sendMax)
+    {
+        s.add8 (1);
+        sendMax->add (s);
+        s.add160 (sendMax->getCurrency ());
+    }
+    else
+    {
+        s.add8 (0);
+    }
+    s.add32 (static_cast<std::uint32_t> (level));
+    s.add32 (static_cast<std::uint32_t> (maxPaths));
+    return s.getSHA512Half ();
+}
+
+std::shared_ptr<Pathfinder const>
+PathCache::fetch (ReadView const& ledger, uint256 const& key)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (advance (ledger))
+    {
+        auto const iter = entries_.find (key);
+        if (iter != entries_.end ())
+        {
+            ++hits_;
+            iter->second.used = ++tick_;
+            return iter->second.paths;
+        }
+    }
+    ++misses_;
+    return nullptr;
+}
+
+void
+PathCache::insert (ReadView const& ledger, uint256 const& key,
+    std::shared_ptr<Pathfinder const> const& paths,
+        std::chrono::microseconds elapsed)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    bool const cacheable = advance (ledger);
+    time_ += elapsed;
+    if (! paths || maxSize_ == 0 || ! cacheable)
+        return;
+
+    if (entries_.size () >= maxSize_ && entries_.find (key) == entries_.end ())
+    {
+        // Evict the least recently used entry
+        auto const oldest = std::min_element (
+            entries_.begin (), entries_.end (),
+            [](auto const& a, auto const& b)
+            {
+                return a.second.used < b.second.used;
+            });
+        entries_.erase (oldest);
+    }
+    entries_[key] = Entry {paths, ++tick_};
+}
+
+double
+PathCache::rate () const
+{
+    auto const hit = hits ();
+    auto const total = hit + misses ();
+    return total == 0 ? 0 : (hit * 100.0) / total;
+}
+
+std::size_t
+PathCache::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return entries_.size ();
+}
+
+std::chrono::microseconds
+PathCache::ledgerTime () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return lastTime_;
+}
+
+void
+PathCache::getCounts (Json::Value& ret) const
+{
+    using namespace std::chrono;
+    ret[jss::path_cache_hit_rate] = rate ();
+    ret[jss::path_cache_hits] = std::to_string (hits ());
+    ret[jss::path_cache_misses] = std::to_string (misses ());
+    ret[jss::path_cache_size] = static_cast<Json::UInt> (size ());
+    ret[jss::pathfind_ledger_ms] = static_cast<Json::UInt> (
+        duration_cast<milliseconds> (ledgerTime ()).count ());
+}
+
+bool
+PathCache::advance (ReadView const& ledger)
+{
+    auto const& info = ledger.info ();
+    if (ledger.open () || info.hash.isZero ())
+        return false;
+    if (info.hash == ledgerHash_)
+        return true;
+    // Requests on an older ledger don't move the cache back
+    if (info.seq < ledgerSeq_)
+        return false;
+
+    hash_set<AccountID> accounts;
+    hash_set<Issue> issues;
+    if (info.parentHash == ledgerHash_ &&
+        changes (ledger, accounts, issues))
+    {
+        for (auto iter = entries_.begin (); iter != entries_.end ();)
+        {
+            auto const& paths = *iter->second.paths;
+            bool const changed = std::any_of (
+                paths.accountsUsed ().begin (), paths.accountsUsed ().end (),
+                [&](AccountID const& a) { return accounts.count (a) != 0; }) ||
+                std::any_of (
+                paths.issuesUsed ().begin (), paths.issuesUsed ().end (),
+                [&](Issue const& i) { return issues.count (i) != 0; });
+            if (changed)
+                iter = entries_.erase (iter);
+            else
+                ++iter;
+        }
+    }
+    else
+    {
+        entries_.clear ();
+    }
+
+    ledgerHash_ = info.hash;
+    ledgerSeq_ = info.seq;
+    lastTime_ = time_;
+    time_ = std::chrono::microseconds {0};
+    return true;
+}
+
+bool
+PathCache::changes (ReadView const& ledger,
+    hash_set<AccountID>& accounts, hash_set<Issue>& issues)
+{
+    try
+    {
+        for (auto const& item : ledger.txs)
+        {
+            if (! item.second)
+                return false;
+            for (auto const& node :
+                item.second->getFieldArray (sfAffectedNodes))
+            {
+                auto const& fields = node.getFieldObject (
+                    node.isFieldPresent (sfNewFields) ?
+                        sfNewFields : sfFinalFields);
+
+                switch (node.getFieldU16 (sfLedgerEntryType))
+                {
+                case ltACCOUNT_ROOT:
+                    // Paths through the account list it. CSC books
+                    // only change with their offers, below.
+                    accounts.insert (fields.getAccountID (sfAccount));
+                    break;
+
+                case ltCASINOCOIN_STATE:
+                {
+                    auto const low = fields.getFieldAmount (sfLowLimit);
+                    auto const high = fields.getFieldAmount (sfHighLimit);
+                    accounts.insert (low.getIssuer ());
+                    accounts.insert (high.getIssuer ());
+                    issues.insert (low.issue ());
+                    issues.insert ({low.getCurrency (), high.getIssuer ()});
+                    break;
+                }
+
+                case ltOFFER:
+                    accounts.insert (fields.getAccountID (sfAccount));
+                    issues.insert (fields.getFieldAmount (sfTakerPays).issue ());
+                    issues.insert (fields.getFieldAmount (sfTakerGets).issue ());
+                    break;
+
+                default:
+                    break;
+                }
+            }
+        }
+    }
+    catch (std::exception const&)
+    {
+        // A field was missing, don't guess
+        return false;
+    }
+    return true;
+}
+
+void
+PathCache::collectMetrics ()
+{
+    stats_.size.set (size ());
+    stats_.hit_rate.set (static_cast<std::uint64_t> (rate ()));
+    stats_.ledger_time.set (static_cast<std::uint64_t> (
+        std::chrono::duration_cast<std::chrono::milliseconds> (
+            ledgerTime ()).count ()));
+}
+
+} // casinocoin
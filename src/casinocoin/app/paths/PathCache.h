@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_APP_PATHS_PATHCACHE_H_INCLUDED
+#define CASINOCOIN_APP_PATHS_PATHCACHE_H_INCLUDED
+
+#include <casinocoin/app/paths/Pathfinder.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/beast/insight/Collector.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace casinocoin {
+
+/** Paths found for one ledger, shared between path requests.
+
+    Requests with the same source, destination, currencies, amounts
+    and search level find the same paths in the same ledger, so the
+    Pathfinder of the first one is kept and copied by the others.
+
+    The cache follows the ledgers it is asked about. When a ledger
+    follows the one the cache holds, the entries whose accounts and
+    order books weren't changed by its transactions are kept for it
+    and the rest are dropped. Anything else starts it over. Open
+    ledgers aren't cached.
+*/
+class PathCache
+{
+public:
+    PathCache (std::size_t maxSize,
+        beast::insight::Collector::ptr const& collector);
+
+    /** Returns the key of a path search. */
+    static
+    uint256
+    makeKey (
+        AccountID const& srcAccount,
+        AccountID const& dstAccount,
+        Currency const& srcCurrency,
+        STAmount const& dstAmount,
+        boost::optional<STAmount> const& sendMax,
+        int level,
+        int maxPaths);
+
+    /** Returns the paths found for a key in a ledger, if known.
+
+        @note The result is shared, callers must copy it to use it.
+    */
+    std::shared_ptr<Pathfinder const>
+    fetch (ReadView const& ledger, uint256 const& key);
+
+    /** Remember the paths found for a key in a ledger.
+
+        @param elapsed The time spent finding the paths.
+    */
+    void
+    insert (ReadView const& ledger, uint256 const& key,
+        std::shared_ptr<Pathfinder const> const& paths,
+            std::chrono::microseconds elapsed);
+
+    std::uint64_t
+    hits () const
+    {
+        return hits_;
+    }
+
+    std::uint64_t
+    misses () const
+    {
+        return misses_;
+    }
+
+    /** Percentage of lookups that found the paths. */
+    double
+    rate () const;
+
+    std::size_t
+    size () const;
+
+    /** Time spent finding paths during the last complete ledger. */
+    std::chrono::microseconds
+    ledgerTime () const;
+
+    /** Add cache statistics to a get_counts result */
+    void
+    getCounts (Json::Value& ret) const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Pathfinder const> paths;
+        std::uint64_t used;
+    };
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats (Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge ("path_cache", "size"))
+            , hit_rate (collector->make_gauge ("path_cache", "hit_rate"))
+            , ledger_time (collector->make_gauge ("path_cache", "ledger_time"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+        beast::insight::Gauge ledger_time;
+    };
+
+    /// Move the cache to a ledger, returns false if it can't be cached
+    bool
+    advance (ReadView const& ledger);
+
+    /// Collect what the transactions in a ledger changed
+    static
+    bool
+    changes (ReadView const& ledger,
+        hash_set<AccountID>& accounts, hash_set<Issue>& issues);
+
+    void
+    collectMetrics ();
+
+    std::size_t const maxSize_;
+
+    std::mutex mutable mutex_;
+    hash_map<uint256, Entry> entries_;
+    uint256 ledgerHash_;
+    LedgerIndex ledgerSeq_ = 0;
+    std::uint64_t tick_ = 0;
+    std::chrono::microseconds time_ {0};
+    std::chrono::microseconds lastTime_ {0};
+
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
+
+    Stats stats_;
+};
+
+} // casinocoin
+
+#endif
@@ -28,6 +28,7 @@
 #include <casinocoin/app/paths/CasinocoinCalc.h>
 #include <casinocoin/app/paths/PathRequest.h>
 #include <casinocoin/app/paths/PathRequests.h>
+#include <casinocoin/app/paths/Tuning.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
@@ -151,6 +152,12 @@ bool PathRequest::needsUpdate (bool newOnly, LedgerIndex index)
     return true;
 }
 
+std::chrono::steady_clock::duration PathRequest::lastUpdate ()
+{
+    ScopedLockType sl (mIndexLock);
+    return last_update_;
+}
+
 bool PathRequest::hasCompletion ()
 {
     return bool (fCompletion);
@@ -470,14 +477,32 @@ PathRequest::getPathFinder(std::shared_ptr<CasinocoinLineCache> const& cache,
     auto i = currency_map.find(currency);
     if (i != currency_map.end())
         return i->second;
-    auto pathfinder = std::make_unique<Pathfinder>(
+
+    // Requests for the same paths in the same ledger share the search
+    auto& pathCache = app_.getPathRequests().pathCache();
+    auto const& ledger = *cache->getBaseLedger();
+    auto const key = PathCache::makeKey(*raSrcAccount, *raDstAccount,
+        currency, dst_amount, saSendMax, level, max_paths_);
+    if (auto const cached = pathCache.fetch(ledger, key))
+    {
+        return currency_map[currency] =
+            std::make_unique<Pathfinder>(*cached, cache);
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    auto pathfinder = std::make_shared<Pathfinder>(
         cache, *raSrcAccount, *raDstAccount, currency,
             boost::none, dst_amount, saSendMax, app_);
-    if (pathfinder->findPaths(level))
+    bool const found = pathfinder->findPaths(level);
+    if (found)
         pathfinder->computePathRanks(max_paths_);
-    else
-        pathfinder.reset();  // It's a bad request - clear it.
-    return currency_map[currency] = std::move(pathfinder);
+    pathCache.insert(ledger, key, found ? pathfinder : nullptr,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start));
+    if (! found)
+        return currency_map[currency] = nullptr;  // It's a bad request
+    return currency_map[currency] =
+        std::make_unique<Pathfinder>(*pathfinder, cache);
 }
 
 bool
@@ -628,6 +653,7 @@ Json::Value PathRequest::doUpdate(
     using namespace std::chrono;
     JLOG(m_journal.debug()) << iIdentifier
         << " update " << (fast ? "fast" : "normal");
+    auto const start = steady_clock::now();
 
     {
         ScopedLockType sl (mLock);
@@ -655,7 +681,10 @@ Json::Value PathRequest::doUpdate(
     if (jvId)
         newStatus[jss::id] = jvId;
 
-    bool loaded = app_.getFeeTrack().isLoadedLocal();
+    // A request that ran over its budget last time searches
+    // less deeply, as if the server were loaded
+    bool loaded = app_.getFeeTrack().isLoadedLocal() ||
+        lastUpdate() > milliseconds(PATHFINDER_UPDATE_BUDGET);
 
     if (iLevel == 0)
     {
@@ -719,6 +748,11 @@ Json::Value PathRequest::doUpdate(
         jvStatus = newStatus;
     }
 
+    {
+        ScopedLockType sl(mIndexLock);
+        last_update_ = steady_clock::now() - start;
+    }
+
     return newStatus;
 }
 
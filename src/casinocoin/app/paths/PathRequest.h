@@ -33,6 +33,7 @@
 #include <casinocoin/net/InfoSub.h>
 #include <casinocoin/protocol/types.h>
 #include <boost/optional.hpp>
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <set>
@@ -91,6 +92,9 @@ public:
     bool needsUpdate (bool newOnly, LedgerIndex index);
     void updateComplete ();
 
+    /** How long the last update of this request took */
+    std::chrono::steady_clock::duration lastUpdate ();
+
     std::pair<bool, Json::Value> doCreate (
         std::shared_ptr<CasinocoinLineCache> const&,
         Json::Value const&);
@@ -160,6 +164,7 @@ private:
     std::chrono::steady_clock::time_point const created_;
     std::chrono::steady_clock::time_point quick_reply_;
     std::chrono::steady_clock::time_point full_reply_;
+    std::chrono::steady_clock::duration last_update_ {0};
 
     static unsigned int const max_paths_ = 4;
 };
@@ -28,10 +28,13 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/core/Config.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/resource/Fees.h>
 #include <algorithm>
+#include <thread>
+#include <tuple>
 
 namespace casinocoin {
 
@@ -53,14 +56,73 @@ PathRequests::getLineCache (
          (authoritative && ((lgrSeq + 8)  < lineSeq)) ||   // we jumped way back for some reason
          (lgrSeq > (lineSeq + 8)))                         // we jumped way forward for some reason
     {
-        mLineCache = std::make_shared<CasinocoinLineCache> (ledger);
+        mLineCache = std::make_shared<CasinocoinLineCache> (
+            ledger, &mLineIndex);
     }
     return mLineCache;
 }
 
+std::size_t
+PathRequests::pathWorkers (Config const& config)
+{
+    if (config.PATH_WORKERS != 0)
+        return config.PATH_WORKERS;
+    return std::max (1u, std::thread::hardware_concurrency () / 2);
+}
+
+void PathRequests::schedule (std::vector<PathRequest::wptr>& requests)
+{
+    // Requests that were slow last time go last, so a few
+    // expensive ones don't hold up every other subscriber
+    using clock_type = std::chrono::steady_clock;
+    std::vector<std::tuple<bool, clock_type::duration, PathRequest::wptr>> order;
+    order.reserve (requests.size ());
+    for (auto const& wr : requests)
+    {
+        if (auto r = wr.lock ())
+            order.emplace_back (! r->isNew (), r->lastUpdate (), wr);
+        else
+            order.emplace_back (true, clock_type::duration::max (), wr);
+    }
+
+    std::stable_sort (order.begin (), order.end (),
+        [](auto const& a, auto const& b)
+        {
+            return std::tie (std::get<0> (a), std::get<1> (a)) <
+                std::tie (std::get<0> (b), std::get<1> (b));
+        });
+
+    for (std::size_t i = 0; i < order.size (); ++i)
+        requests[i] = std::move (std::get<2> (order[i]));
+}
+
+void PathRequests::removeRequest (
+    PathRequest::pointer const& request, int& removed)
+{
+    ScopedLockType sl (mLock);
+
+    // Remove any dangling weak pointers or weak
+    // pointers that refer to this path request.
+    auto ret = std::remove_if (
+        requests_.begin(), requests_.end(),
+        [&removed,&request](auto const& wl)
+        {
+            auto r = wl.lock();
+
+            if (r && r != request)
+                return false;
+            ++removed;
+            return true;
+        });
+
+    requests_.erase (ret, requests_.end());
+}
+
 void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
                               Job::CancelCallback shouldCancel)
 {
+    using namespace std::chrono;
+
     auto event =
         app_.getJobQueue().makeLoadEvent(
             jtPATH_FIND, "PathRequest::updateAll");
@@ -76,82 +138,88 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
     }
 
     bool newRequests = app_.getLedgerMaster().isNewPathRequest();
-    bool mustBreak = false;
+    std::atomic<bool> mustBreak {false};
 
     JLOG (mJournal.trace()) <<
         "updateAll seq=" << cache->getLedger()->seq() <<
         ", " << requests.size() << " requests";
 
-    int processed = 0, removed = 0;
+    std::atomic<int> processed {0};
+    int removed = 0;
+
+    // Time from the start of the update to each reply
+    auto const start = steady_clock::now();
+    std::mutex latencyLock;
+    std::vector<milliseconds> latencies;
+    auto const replied = [&]()
+    {
+        auto const elapsed = duration_cast<milliseconds> (
+            steady_clock::now() - start);
+        mUpdate.notify (elapsed);
+        std::lock_guard<std::mutex> lock (latencyLock);
+        latencies.push_back (elapsed);
+    };
 
     do
     {
-        for (auto const& wr : requests)
+        schedule (requests);
+        mustBreak = false;
+
+        // All the workers share the line cache, each takes
+        // the next request in the schedule when it's done
+        std::atomic<std::size_t> next {0};
+        auto work = [&]()
         {
-            if (shouldCancel())
-                break;
+            for (auto i = next++; i < requests.size(); i = next++)
+            {
+                if (mustBreak || shouldCancel())
+                    break;
 
-            auto request = wr.lock ();
-            bool remove = true;
+                auto request = requests[i].lock ();
+                bool remove = true;
 
-            if (request)
-            {
-                if (!request->needsUpdate (newRequests, cache->getLedger()->seq()))
-                    remove = false;
-                else
+                if (request)
                 {
-                    if (auto ipSub = request->getSubscriber ())
+                    if (!request->needsUpdate (newRequests, cache->getLedger()->seq()))
+                        remove = false;
+                    else
                     {
-                        if (!ipSub->getConsumer ().warn ())
+                        if (auto ipSub = request->getSubscriber ())
+                        {
+                            if (!ipSub->getConsumer ().warn ())
+                            {
+                                Json::Value update = request->doUpdate (cache, false);
+                                request->updateComplete ();
+                                update[jss::type] = "path_find";
+                                ipSub->send (update, false);
+                                remove = false;
+                                ++processed;
+                                replied ();
+                            }
+                        }
+                        else if (request->hasCompletion ())
                         {
-                            Json::Value update = request->doUpdate (cache, false);
-                            request->updateComplete ();
-                            update[jss::type] = "path_find";
-                            ipSub->send (update, false);
-                            remove = false;
+                            // One-shot request with completion function
+                            request->doUpdate (cache, false);
+                            request->updateComplete();
                             ++processed;
+                            replied ();
                         }
                     }
-                    else if (request->hasCompletion ())
-                    {
-                        // One-shot request with completion function
-                        request->doUpdate (cache, false);
-                        request->updateComplete();
-                        ++processed;
-                    }
                 }
-            }
 
-            if (remove)
-            {
-                ScopedLockType sl (mLock);
+                if (remove)
+                    removeRequest (request, removed);
 
-                // Remove any dangling weak pointers or weak
-                // pointers that refer to this path request.
-                auto ret = std::remove_if (
-                    requests_.begin(), requests_.end(),
-                    [&removed,&request](auto const& wl)
-                    {
-                        auto r = wl.lock();
-
-                        if (r && r != request)
-                            return false;
-                        ++removed;
-                        return true;
-                    });
-
-                requests_.erase (ret, requests_.end());
+                // We weren't handling new requests and then
+                // there was a new request
+                if (!newRequests &&
+                        app_.getLedgerMaster().isNewPathRequest())
+                    mustBreak = true;
             }
+        };
 
-            mustBreak = !newRequests &&
-                app_.getLedgerMaster().isNewPathRequest();
-
-            // We weren't handling new requests and then
-            // there was a new request
-            if (mustBreak)
-                break;
-
-        }
+        mPool.run (std::max<std::size_t> (1, requests.size()), work);
 
         if (mustBreak)
         { // a new request came in while we were working
@@ -180,11 +248,63 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
     }
     while (!shouldCancel ());
 
+    recordUpdates (cache->getLedger()->seq(), std::move (latencies));
+
     JLOG (mJournal.debug()) <<
         "updateAll complete: " << processed << " processed and " <<
         removed << " removed";
 }
 
+void PathRequests::recordUpdates (LedgerIndex seq,
+    std::vector<std::chrono::milliseconds> latencies)
+{
+    if (latencies.empty())
+        return;
+
+    std::sort (latencies.begin(), latencies.end());
+    auto const percentile = [&latencies](std::size_t p)
+    {
+        return latencies[(latencies.size() - 1) * p / 100];
+    };
+
+    UpdateStats stats;
+    stats.seq = seq;
+    stats.requests = latencies.size();
+    stats.p50 = percentile (50);
+    stats.p90 = percentile (90);
+    stats.p99 = percentile (99);
+    stats.max = latencies.back();
+
+    JLOG (mJournal.debug()) <<
+        "updateAll seq=" << seq << ": " << stats.requests <<
+        " requests, p50=" << stats.p50.count() <<
+        "ms p90=" << stats.p90.count() <<
+        "ms p99=" << stats.p99.count() <<
+        "ms max=" << stats.max.count() << "ms";
+
+    std::lock_guard<std::mutex> lock (mStatsLock);
+    mUpdateStats = stats;
+}
+
+PathRequests::UpdateStats
+PathRequests::updateStats () const
+{
+    std::lock_guard<std::mutex> lock (mStatsLock);
+    return mUpdateStats;
+}
+
+void PathRequests::getCounts (Json::Value& ret) const
+{
+    mPathCache.getCounts (ret);
+
+    auto const stats = updateStats ();
+    ret[jss::pathfind_updates] = static_cast<Json::UInt> (stats.requests);
+    ret[jss::pathfind_update_p50_ms] = static_cast<Json::UInt> (stats.p50.count());
+    ret[jss::pathfind_update_p90_ms] = static_cast<Json::UInt> (stats.p90.count());
+    ret[jss::pathfind_update_p99_ms] = static_cast<Json::UInt> (stats.p99.count());
+    ret[jss::pathfind_update_max_ms] = static_cast<Json::UInt> (stats.max.count());
+}
+
 void PathRequests::insertPathRequest (
     PathRequest::pointer const& req)
 {
@@ -264,7 +384,8 @@ PathRequests::doLegacyPathRequest (
         std::shared_ptr<ReadView const> const& inLedger,
         Json::Value const& request)
 {
-    auto cache = std::make_shared<CasinocoinLineCache> (inLedger);
+    auto cache = std::make_shared<CasinocoinLineCache> (
+        inLedger, &mLineIndex);
 
     auto req = std::make_shared<PathRequest> (app_, []{},
         consumer, ++mLastIdentifier, *this, mJournal);
@@ -27,10 +27,15 @@
 #define CASINOCOIN_APP_PATHS_PATHREQUESTS_H_INCLUDED
 
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/paths/PathCache.h>
 #include <casinocoin/app/paths/PathRequest.h>
 #include <casinocoin/app/paths/CasinocoinLineCache.h>
+#include <casinocoin/app/paths/CasinocoinLineIndex.h>
+#include <casinocoin/app/paths/Tuning.h>
+#include <casinocoin/basics/TaskPool.h>
 #include <casinocoin/core/Job.h>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 
@@ -39,14 +44,36 @@ namespace casinocoin {
 class PathRequests
 {
 public:
+    /** Update latencies of the requests handled for the last ledger */
+    struct UpdateStats
+    {
+        LedgerIndex seq = 0;
+        std::size_t requests = 0;
+        std::chrono::milliseconds p50 {0};
+        std::chrono::milliseconds p90 {0};
+        std::chrono::milliseconds p99 {0};
+        std::chrono::milliseconds max {0};
+    };
+
     PathRequests (Application& app,
             beast::Journal journal, beast::insight::Collector::ptr const& collector)
         : app_ (app)
         , mJournal (journal)
         , mLastIdentifier (0)
+        , mWorkers (pathWorkers (app.config ()))
+        , mPool ("pathfind", mWorkers)
+        , mLineIndex (PATHFINDER_LINE_INDEX_SIZE, journal)
+        , mPathCache (PATHFINDER_CACHE_SIZE, collector)
     {
         mFast = collector->make_event ("pathfind_fast");
         mFull = collector->make_event ("pathfind_full");
+        mUpdate = collector->make_event ("pathfind_update");
+    }
+
+    /** Number of threads updating requests after each ledger */
+    std::size_t workers () const
+    {
+        return mWorkers;
     }
 
     void updateAll (std::shared_ptr<ReadView const> const& ledger,
@@ -79,6 +106,23 @@ public:
         std::shared_ptr<ReadView const> const& inLedger,
         Json::Value const& request);
 
+    /** Trust lines kept across ledgers, shared by all requests */
+    CasinocoinLineIndex& lineIndex ()
+    {
+        return mLineIndex;
+    }
+
+    /** Paths found in the current ledger, shared by all requests */
+    PathCache& pathCache ()
+    {
+        return mPathCache;
+    }
+
+    UpdateStats updateStats () const;
+
+    /** Add path finding statistics to a get_counts result */
+    void getCounts (Json::Value& ret) const;
+
     void reportFast (std::chrono::milliseconds ms)
     {
         mFast.notify (ms);
@@ -90,13 +134,24 @@ public:
     }
 
 private:
+    static std::size_t pathWorkers (Config const& config);
+
     void insertPathRequest (PathRequest::pointer const&);
 
+    /// Put new requests first, then the quickest ones
+    static void schedule (std::vector<PathRequest::wptr>& requests);
+
+    void removeRequest (PathRequest::pointer const& request, int& removed);
+
+    void recordUpdates (LedgerIndex seq,
+        std::vector<std::chrono::milliseconds> latencies);
+
     Application& app_;
     beast::Journal                   mJournal;
 
     beast::insight::Event            mFast;
     beast::insight::Event            mFull;
+    beast::insight::Event            mUpdate;
 
     // Track all requests
     std::vector<PathRequest::wptr> requests_;
@@ -106,6 +161,17 @@ private:
 
     std::atomic<int>                 mLastIdentifier;
 
+    std::size_t const                mWorkers;
+
+    // Threads shared by the updates, started once
+    TaskPool                         mPool;
+
+    std::mutex mutable               mStatsLock;
+    UpdateStats                      mUpdateStats;
+
+    CasinocoinLineIndex              mLineIndex;
+    PathCache                        mPathCache;
+
     using ScopedLockType = std::lock_guard <std::recursive_mutex>;
     std::recursive_mutex mLock;
 
@@ -177,8 +177,38 @@ Pathfinder::Pathfinder (
     assert (! uSrcIssuer || isCSC(uSrcCurrency) == isCSC(uSrcIssuer.get()));
 }
 
+Pathfinder::Pathfinder (
+    Pathfinder const& other,
+    std::shared_ptr<CasinocoinLineCache> const& cache)
+    :   mSrcAccount (other.mSrcAccount),
+        mDstAccount (other.mDstAccount),
+        mEffectiveDst (other.mEffectiveDst),
+        mDstAmount (other.mDstAmount),
+        mSrcCurrency (other.mSrcCurrency),
+        mSrcIssuer (other.mSrcIssuer),
+        mSrcAmount (other.mSrcAmount),
+        mRemainingAmount (other.mRemainingAmount),
+        convert_all_ (other.convert_all_),
+        mLedger (cache->getLedger ()),
+        mRLCache (cache),
+        mSource (other.mSource),
+        mCompletePaths (other.mCompletePaths),
+        mPathRanks (other.mPathRanks),
+        mAccountsUsed (other.mAccountsUsed),
+        mIssuesUsed (other.mIssuesUsed),
+        app_ (other.app_),
+        j_ (other.j_)
+{
+}
+
 bool Pathfinder::findPaths (int searchLevel)
 {
+    mAccountsUsed.insert (mSrcAccount);
+    mAccountsUsed.insert (mDstAccount);
+    mAccountsUsed.insert (mEffectiveDst);
+    if (mSrcIssuer)
+        mAccountsUsed.insert (*mSrcIssuer);
+
     if (mDstAmount == zero)
     {
         // No need to send zero money.
@@ -448,6 +478,26 @@ void Pathfinder::computePathRanks (int maxPaths)
     }
 
     rankPaths (maxPaths, mCompletePaths, mPathRanks);
+
+    // The default path may cross a book, and ranking read
+    // every account and book on the paths.
+    if (mSrcCurrency != mDstAmount.getCurrency ())
+    {
+        mIssuesUsed.insert (mDstAmount.issue ());
+        mIssuesUsed.insert ({mSrcCurrency, mSrcIssuer.value_or (
+            isCSC (mSrcCurrency) ? cscAccount () : mSrcAccount)});
+    }
+    for (auto const& path : mCompletePaths)
+    {
+        for (auto const& element : path)
+        {
+            if (element.isAccount ())
+                mAccountsUsed.insert (element.getAccountID ());
+            else
+                mIssuesUsed.insert ({element.getCurrency (),
+                    element.getIssuerID ()});
+        }
+    }
 }
 
 static bool isDefaultPath (STPath const& path)
@@ -711,6 +761,8 @@ int Pathfinder::getPathsOut (
     if (!it.second)
         return it.first->second;
 
+    mAccountsUsed.insert (account);
+    mIssuesUsed.insert (issue);
     auto sleAccount = mLedger->read(keylet::account (account));
 
     if (!sleAccount)
@@ -851,6 +903,8 @@ bool Pathfinder::isNoCasinocoin (
     AccountID const& toAccount,
     Currency const& currency)
 {
+    mAccountsUsed.insert (fromAccount);
+    mAccountsUsed.insert (toAccount);
     auto sleCasinocoin = mLedger->read(keylet::line(
         toAccount, fromAccount, currency));
 
@@ -930,6 +984,7 @@ void Pathfinder::addLink (
         else
         {
             // search for accounts to add
+            mAccountsUsed.insert (uEndAccount);
             auto const sleEnd = mLedger->read(keylet::account(uEndAccount));
 
             if (sleEnd)
@@ -1066,6 +1121,7 @@ void Pathfinder::addLink (
     }
     if (addFlags & afADD_BOOKS)
     {
+        mIssuesUsed.insert ({uEndCurrency, uEndIssuer});
         // add order books
         if (addFlags & afOB_CSC)
         {
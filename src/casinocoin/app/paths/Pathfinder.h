@@ -28,6 +28,7 @@
 
 #include <casinocoin/app/ledger/Ledger.h>
 #include <casinocoin/app/paths/CasinocoinLineCache.h>
+#include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/core/LoadEvent.h>
 #include <casinocoin/protocol/STAmount.h>
 #include <casinocoin/protocol/STPathSet.h>
@@ -53,6 +54,15 @@ public:
         STAmount const& dstAmount,
         boost::optional<STAmount> const& srcAmount,
         Application& app);
+    /** Construct a copy of the paths found by another pathfinder.
+
+        Extra paths passed to getBestPaths are ranked against the
+        ledger of `cache` rather than the one used to find the paths.
+    */
+    Pathfinder (
+        Pathfinder const& other,
+        std::shared_ptr<CasinocoinLineCache> const& cache);
+
     Pathfinder (Pathfinder const&) = delete;
     Pathfinder& operator= (Pathfinder const&) = delete;
     ~Pathfinder() = default;
@@ -76,6 +86,20 @@ public:
         STPathSet const& extraPaths,
         AccountID const& srcIssuer);
 
+    /** Accounts whose ledger state the paths found depend on. */
+    hash_set<AccountID> const&
+    accountsUsed () const
+    {
+        return mAccountsUsed;
+    }
+
+    /** Issues whose order books the paths found depend on. */
+    hash_set<Issue> const&
+    issuesUsed () const
+    {
+        return mIssuesUsed;
+    }
+
     enum NodeType
     {
         nt_SOURCE,     // The source account: with an issuer account, if needed.
@@ -199,6 +223,9 @@ private:
 
     hash_map<Issue, int> mPathsOutCountMap;
 
+    hash_set<AccountID> mAccountsUsed;
+    hash_set<Issue> mIssuesUsed;
+
     Application& app_;
     beast::Journal j_;
 
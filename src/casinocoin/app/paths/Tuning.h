@@ -36,6 +36,9 @@ int const PATHFINDER_HIGH_PRIORITY = 100000;
 int const PATHFINDER_MAX_PATHS = 50;
 int const PATHFINDER_MAX_COMPLETE_PATHS = 1000;
 int const PATHFINDER_MAX_PATHS_FROM_SOURCE = 10;
+int const PATHFINDER_CACHE_SIZE = 2000;
+int const PATHFINDER_UPDATE_BUDGET = 1000; // milliseconds
+int const PATHFINDER_LINE_INDEX_SIZE = 50000; // accounts
 
 } // casinocoin
 
@@ -33,11 +33,13 @@
 #include <casinocoin/beast/utility/Journal.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace casinocoin {
 
 class Application;
 class HashRouter;
+class TaskPool;
 
 /** Describes the pre-processing validity of a transaction.
 
@@ -85,6 +87,19 @@ void
 forceValidity(HashRouter& router, uint256 const& txid,
     Validity validity);
 
+/** Records that the signature of a given transaction is bad.
+
+    Later calls to checkValidity return `SigBad` without
+    checking the signature again.
+
+    @warning Only use with the result of a check that is
+             at least as strict as `STTx::checkSign`.
+
+    @see checkValidity, forceValidity
+*/
+void
+forceSigBad(HashRouter& router, uint256 const& txid);
+
 /** Apply a transaction to an `OpenView`.
 
     This function is the canonical way to apply a transaction
@@ -158,6 +173,32 @@ applyTransaction(Application& app, OpenView& view,
     STTx const& tx, bool retryAssured, ApplyFlags flags,
     beast::Journal journal);
 
+/** Apply a sequence of transactions, using several threads.
+
+    The effect on `view` and the results are the same as calling
+    `applyTransaction` for each transaction in order.
+
+    Batches of transactions are first applied concurrently, each
+    on its own against the view as it was before the batch, while
+    recording what it read. The outcomes are then committed in
+    order. A transaction that read state written by an earlier
+    one in the batch is applied again against the updated view
+    instead. Pseudo-transactions are always applied in order.
+
+    @param pool The threads to use, shared by every call so no
+        threads are started per batch. With a single thread the
+        transactions are applied serially.
+    @param reapplied If not null, incremented for each
+        transaction that had to be applied again.
+
+    @return The result for each transaction in `txs`.
+*/
+std::vector<ApplyResult>
+applyParallel (Application& app, OpenView& view,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        bool retryAssured, ApplyFlags flags, TaskPool& pool,
+            beast::Journal journal, std::size_t* reapplied = nullptr);
+
 } // casinocoin
 
 #endif
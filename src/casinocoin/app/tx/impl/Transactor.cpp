@@ -364,91 +364,55 @@ Transactor::checkWLT (PreclaimContext const& ctx)
             return tesSUCCESS;
         }
 
-        LedgerConfig const& ledgerConfiguration = ctx.view.ledgerConfig();
-        auto tokenConfigIter = std::find_if(ledgerConfiguration.entries.begin(),
-                                            ledgerConfiguration.entries.end(),
-                                            [](ConfigObjectEntry const& obj)
-            {
-                return obj.getType() == ConfigObjectEntry::Token;
-            });
-        if (tokenConfigIter == ledgerConfiguration.entries.end())
+        auto const& wlt = ctx.view.ledgerConfig().wlt;
+        if (! wlt)
         {
             JLOG(ctx.j.info()) << "No WLT entries found. tx forbidden.";
             return tefNOT_WLT;
         }
 
-        std::function<TER(STObject const&)> recursiveAmountCheckLambda;
-        recursiveAmountCheckLambda = [&](STObject const& obj) -> TER
-        {
-            TER terWLTCompliant = tesSUCCESS;
-            for (auto iter = obj.begin(); iter != obj.end(); ++iter)
-            {
-                if ((*iter).getSType() == STI_AMOUNT)
-                {
-                    terWLTCompliant = isWLTCompliant(static_cast<STAmount const&>((*iter)), *tokenConfigIter, ctx.j);
-                }
-                else if ((*iter).getSType() == STI_OBJECT)
-                {
-                    terWLTCompliant = recursiveAmountCheckLambda(static_cast<STObject const&>((*iter)));
-                }
-                else if ((*iter).getSType() == STI_ARRAY)
-                {
-                    for( auto const& stObj : static_cast<STArray const&>((*iter)))
-                    {
-                        terWLTCompliant = recursiveAmountCheckLambda(stObj);
-                        if (terWLTCompliant != tesSUCCESS)
-                        {
-                            return terWLTCompliant;
-                        }
-                    }
-                }
-                if (terWLTCompliant != tesSUCCESS)
-                {
-                    return terWLTCompliant;
-                }
-            }
-            return tesSUCCESS;
-        };
-
-
-        return recursiveAmountCheckLambda(ctx.tx);
+        return checkWLTAmounts(ctx.tx, *wlt, ctx.j);
     }
 
     return tesSUCCESS;
 }
 
 TER
-Transactor::isWLTCompliant(STAmount const& amount, ConfigObjectEntry const& tokenConfig, beast::Journal const& j)
+Transactor::checkWLTAmounts(STObject const& obj, WLTTable const& wlt, beast::Journal const& j)
 {
-    if (isCSC(amount))
+    for (auto const& field : obj)
     {
-        return tesSUCCESS;
-    }
-    if (tokenConfig.getType() != ConfigObjectEntry::Token)
-    {
-        JLOG(j.warn()) << "isWLTCompliant() non-Token config object passed";
-        return tefFAILURE;
-    }
-
-    auto const& definedTokens = tokenConfig.getData();
-    for (auto const entry : definedTokens)
-    {
-        const TokenDescriptor* token = static_cast<const TokenDescriptor*>(entry);
-        try
+        TER terWLTCompliant = tesSUCCESS;
+        switch (field.getSType())
         {
-            if (token->totalSupply.issue() == amount.issue()
-                    && token->totalSupply >= amount)
+        case STI_AMOUNT:
+            terWLTCompliant = isWLTCompliant(static_cast<STAmount const&>(field), wlt, j);
+            break;
+        case STI_OBJECT:
+            terWLTCompliant = checkWLTAmounts(static_cast<STObject const&>(field), wlt, j);
+            break;
+        case STI_ARRAY:
+            for (auto const& stObj : static_cast<STArray const&>(field))
             {
-                JLOG(j.debug()) << "isWLTCompliant() found matching entry, return OK";
-                return tesSUCCESS;
+                terWLTCompliant = checkWLTAmounts(stObj, wlt, j);
+                if (terWLTCompliant != tesSUCCESS)
+                    break;
             }
+            break;
+        default:
+            break;
         }
-        catch( std::runtime_error const& err)
-        {
-            JLOG(j.warn()) << "isWLTCompliant() caught exception. what: " << err.what();
-            return tefNOT_WLT;
-        }
+        if (terWLTCompliant != tesSUCCESS)
+            return terWLTCompliant;
     }
+    return tesSUCCESS;
+}
+
+TER
+Transactor::isWLTCompliant(STAmount const& amount, WLTTable const& wlt, beast::Journal const& j)
+{
+    if (wlt.compliant(amount))
+        return tesSUCCESS;
 
     JLOG(j.info()) << "isWLTCompliant() not compliant"
                     << " token: " << to_string(amount.issue().currency)
@@ -499,7 +463,7 @@ Transactor::checkSingleSign (PreclaimContext const& ctx)
     {
         JLOG(ctx.j.trace()) << "checkSingleSign: Check if account is blacklisted";
         // check if source accountid is blacklisted and signing accountid is whitelisted
-        if (ctx.app.blacklistedAccounts().listed(toBase58(id)))
+        if (ctx.app.blacklistedAccounts().listed(id))
         {
             JLOG(ctx.j.trace()) << "checkSingleSign: Check if signer account is whitelisted";
             bool bIsTrusted = false;
@@ -695,7 +659,7 @@ TER Transactor::checkBlacklist (PreclaimContext const& ctx)
     if (accountid == zero)
         return temBAD_SRC_ACCOUNT;
 
-    if (ctx.app.blacklistedAccounts().listed(toBase58(accountid)))
+    if (ctx.app.blacklistedAccounts().listed(accountid))
     {
         // account is blacklisted, get full blacklisted account info
         JLOG(ctx.j.debug()) <<  "Account " << toBase58(accountid) << " is blacklisted!";
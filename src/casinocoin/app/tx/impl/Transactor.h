@@ -178,8 +178,17 @@ public:
     static
     TER
     isWLTCompliant(STAmount const& amount,
-                   ConfigObjectEntry const& tokenConfig,
+                   WLTTable const& wlt,
                    beast::Journal const& j);
+
+    /** Check every amount in the object, including nested objects
+        and arrays, against the whitelisted tokens.
+    */
+    static
+    TER
+    checkWLTAmounts(STObject const& obj,
+                    WLTTable const& wlt,
+                    beast::Journal const& j);
     /////////////////////////////////////////////////////
 
 protected:
@@ -109,6 +109,12 @@ forceValidity(HashRouter& router, uint256 const& txid,
         router.setFlags(txid, flags);
 }
 
+void
+forceSigBad(HashRouter& router, uint256 const& txid)
+{
+    router.setFlags(txid, SF_SIGBAD);
+}
+
 std::pair<TER, bool>
 apply (Application& app, OpenView& view,
     STTx const& tx, ApplyFlags flags,
@@ -0,0 +1,361 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/TaskPool.h>
+#include <casinocoin/ledger/OpenView.h>
+#include <casinocoin/protocol/SField.h>
+#include <atomic>
+#include <exception>
+#include <set>
+
+namespace casinocoin {
+
+namespace detail {
+
+/** Presents a view unchanged, recording what is read from it.
+
+    The keys read and the ranges searched by succ() are kept so
+    they can be checked against the writes made afterwards.
+    Iterating the state or looking at the transactions can't be
+    tracked, so it marks the reader as stale.
+*/
+class ReadTracker
+    : public ReadView
+{
+private:
+    struct Range
+    {
+        key_type key;
+        boost::optional<key_type> last;
+        boost::optional<key_type> found;
+    };
+
+    ReadView const& base_;
+    mutable std::vector<key_type> reads_;
+    mutable std::vector<Range> ranges_;
+    mutable bool untracked_ = false;
+
+public:
+    explicit
+    ReadTracker (ReadView const& base)
+        : base_ (base)
+    {
+    }
+
+    /** Returns `true` if any of the keys written affect what was read. */
+    bool
+    stale (std::set<key_type> const& written) const
+    {
+        if (untracked_)
+            return true;
+        if (written.empty())
+            return false;
+        for (auto const& key : reads_)
+            if (written.count (key))
+                return true;
+        for (auto const& range : ranges_)
+        {
+            // A write between key and the item found, or the
+            // end of the search, can change the answer.
+            auto const iter = written.upper_bound (range.key);
+            if (iter == written.end())
+                continue;
+            if (range.found)
+            {
+                if (*iter <= *range.found)
+                    return true;
+            }
+            else if (! range.last || *iter < *range.last)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    LedgerConfig const&
+    ledgerConfig() const override
+    {
+        return base_.ledgerConfig();
+    }
+
+    bool
+    exists (Keylet const& k) const override
+    {
+        reads_.push_back (k.key);
+        return base_.exists (k);
+    }
+
+    boost::optional<key_type>
+    succ (key_type const& key, boost::optional<
+        key_type> const& last = boost::none) const override
+    {
+        auto found = base_.succ (key, last);
+        ranges_.push_back ({key, last, found});
+        return found;
+    }
+
+    std::shared_ptr<SLE const>
+    read (Keylet const& k) const override
+    {
+        reads_.push_back (k.key);
+        return base_.read (k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        untracked_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        untracked_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound (key_type const& key) const override
+    {
+        untracked_ = true;
+        return base_.slesUpperBound (key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        untracked_ = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        untracked_ = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists (key_type const& key) const override
+    {
+        untracked_ = true;
+        return base_.txExists (key);
+    }
+
+    tx_type
+    txRead (key_type const& key) const override
+    {
+        untracked_ = true;
+        return base_.txRead (key);
+    }
+};
+
+/** Commits the changes of one transaction to a view.
+
+    The keys written are remembered, and the metadata is given
+    the index the transaction has in the destination view.
+*/
+class TxCommitter
+    : public TxsRawView
+{
+private:
+    OpenView& to_;
+    std::set<uint256>& written_;
+
+public:
+    TxCommitter (OpenView& to, std::set<uint256>& written)
+        : to_ (to)
+        , written_ (written)
+    {
+    }
+
+    void
+    rawErase (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.insert (sle->key());
+        to_.rawErase (sle);
+    }
+
+    void
+    rawInsert (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.insert (sle->key());
+        to_.rawInsert (sle);
+    }
+
+    void
+    rawReplace (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.insert (sle->key());
+        to_.rawReplace (sle);
+    }
+
+    void
+    rawDestroyCSC (CSCAmount const& fee) override
+    {
+        to_.rawDestroyCSC (fee);
+    }
+
+    void
+    rawTxInsert (uint256 const& key,
+        std::shared_ptr<Serializer const> const& txn,
+            std::shared_ptr<Serializer const> const& metaData) override
+    {
+        if (! metaData)
+            return to_.rawTxInsert (key, txn, metaData);
+
+        // The transaction was the first in its own view
+        SerialIter sit (metaData->slice());
+        STObject meta (sit, sfMetadata);
+        meta.setFieldU32 (sfTransactionIndex,
+            static_cast<std::uint32_t> (to_.txCount()));
+        auto s = std::make_shared<Serializer>();
+        meta.add (*s);
+        to_.rawTxInsert (key, txn, s);
+    }
+};
+
+} // detail
+
+std::vector<ApplyResult>
+applyParallel (Application& app, OpenView& view,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        bool retryAssured, ApplyFlags flags, TaskPool& pool,
+            beast::Journal j, std::size_t* reapplied)
+{
+    std::vector<ApplyResult> results;
+    results.reserve (txs.size());
+
+    auto const workers = pool.size();
+    if (workers <= 1 || txs.size() <= 1)
+    {
+        for (auto const& tx : txs)
+            results.push_back (applyTransaction (
+                app, view, *tx, retryAssured, flags, j));
+        return results;
+    }
+
+    struct Speculation
+    {
+        std::unique_ptr<detail::ReadTracker> reads;
+        std::unique_ptr<OpenView> view;
+        ApplyResult result = ApplyResult::Fail;
+    };
+
+    // Enough work per batch to keep the threads busy, but small
+    // enough that later transactions don't see too old a state.
+    std::size_t const batchSize = workers * 32;
+    std::size_t again = 0;
+
+    for (std::size_t first = 0; first < txs.size(); first += batchSize)
+    {
+        auto const last = std::min (txs.size(), first + batchSize);
+        std::vector<Speculation> batch (last - first);
+
+        std::atomic<std::size_t> next {first};
+        auto work = [&]()
+        {
+            for (auto i = next++; i < last; i = next++)
+            {
+                auto const& tx = *txs[i];
+                // Pseudo-transactions can affect more than the view
+                if (isPseudoTx (tx))
+                    continue;
+
+                auto& s = batch[i - first];
+                try
+                {
+                    s.reads = std::make_unique<
+                        detail::ReadTracker> (view);
+                    s.view = std::make_unique<OpenView> (s.reads.get());
+                    s.result = applyTransaction (
+                        app, *s.view, tx, retryAssured, flags, j);
+                }
+                catch (std::exception const&)
+                {
+                    s.view.reset();
+                }
+            }
+        };
+
+        pool.run (std::min (workers, batch.size()), work);
+
+        // Commit in order, redoing whatever is stale
+        std::set<uint256> written;
+        for (auto i = first; i < last; ++i)
+        {
+            auto& s = batch[i - first];
+            detail::TxCommitter to (view, written);
+            if (s.view && ! s.reads->stale (written))
+            {
+                s.view->apply (to);
+                results.push_back (s.result);
+            }
+            else
+            {
+                if (s.view)
+                    ++again;
+                OpenView redo (&view);
+                results.push_back (applyTransaction (
+                    app, redo, *txs[i], retryAssured, flags, j));
+                redo.apply (to);
+            }
+            s.view.reset();
+            s.reads.reset();
+        }
+    }
+
+    JLOG (j.debug()) << "Applied " << txs.size() << " transactions with " <<
+        workers << " threads, " << again << " applied again";
+    if (reapplied)
+        *reapplied += again;
+    return results;
+}
+
+} // casinocoin
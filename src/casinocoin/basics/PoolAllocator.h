@@ -0,0 +1,256 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_BASICS_POOLALLOCATOR_H_INCLUDED
+#define CASINOCOIN_BASICS_POOLALLOCATOR_H_INCLUDED
+
+#include <casinocoin/basics/contract.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace casinocoin {
+
+namespace detail {
+
+class PoolAllocatorImpl
+{
+private:
+    struct Block
+    {
+        Block* next;
+    };
+
+    // Sizes are rounded up to a multiple of the granularity,
+    // each multiple up to the largest class has a free list.
+    static std::size_t constexpr granularity = alignof(std::max_align_t);
+    static std::size_t constexpr classes = 16;
+
+    std::array<Block*, classes> free_ {};
+    std::size_t count_ = 0;
+    std::size_t maxFree_;
+    std::uint64_t allocated_ = 0;
+    std::uint64_t reused_ = 0;
+
+    static
+    std::size_t
+    sizeClass (std::size_t bytes)
+    {
+        return (bytes + granularity - 1) / granularity - 1;
+    }
+
+public:
+    explicit
+    PoolAllocatorImpl (std::size_t maxFree)
+        : maxFree_ (maxFree)
+    {
+    }
+
+    PoolAllocatorImpl (PoolAllocatorImpl const&) = delete;
+    PoolAllocatorImpl& operator= (PoolAllocatorImpl const&) = delete;
+
+    ~PoolAllocatorImpl()
+    {
+        setMaxFree (0);
+    }
+
+    void*
+    allocate (std::size_t bytes)
+    {
+        auto const c = sizeClass (bytes);
+        if (c >= classes)
+            return ::operator new (bytes);
+        if (auto const b = free_[c])
+        {
+            free_[c] = b->next;
+            --count_;
+            ++reused_;
+            return b;
+        }
+        ++allocated_;
+        return ::operator new ((c + 1) * granularity);
+    }
+
+    void
+    deallocate (void* p, std::size_t bytes)
+    {
+        auto const c = sizeClass (bytes);
+        if (c >= classes || count_ >= maxFree_)
+        {
+            ::operator delete (p);
+            return;
+        }
+        free_[c] = new (p) Block {free_[c]};
+        ++count_;
+    }
+
+    /** Limit the number of free blocks kept for reuse. */
+    void
+    setMaxFree (std::size_t n)
+    {
+        maxFree_ = n;
+        for (auto& head : free_)
+        {
+            while (count_ > maxFree_ && head)
+            {
+                auto const b = head;
+                head = b->next;
+                --count_;
+                ::operator delete (b);
+            }
+        }
+    }
+
+    std::size_t
+    free() const
+    {
+        return count_;
+    }
+
+    std::uint64_t
+    allocated() const
+    {
+        return allocated_;
+    }
+
+    std::uint64_t
+    reused() const
+    {
+        return reused_;
+    }
+};
+
+} // detail
+
+/** Allocator that recycles blocks of the same size.
+
+    Freed blocks are kept on a free list and handed out again
+    for the next allocation of the same size, so node based
+    containers with a steady turnover stop calling into the
+    system allocator. At most a configured number of free
+    blocks is kept, the rest is released.
+
+    Copies share the same pool.
+
+    Thread Safety:
+
+        May not be called concurrently.
+*/
+template <class T>
+class PoolAllocator
+{
+private:
+    template <class>
+    friend class PoolAllocator;
+
+    static_assert (alignof(T) <= alignof(std::max_align_t),
+        "PoolAllocator does not support over-aligned types");
+
+    std::shared_ptr<detail::PoolAllocatorImpl> impl_;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit
+    PoolAllocator (std::size_t maxFree = 4096)
+        : impl_ (std::make_shared<
+            detail::PoolAllocatorImpl>(maxFree))
+    {
+    }
+
+    // Moving would leave the source without a pool
+    PoolAllocator (PoolAllocator const&) = default;
+    PoolAllocator& operator= (PoolAllocator const&) = default;
+
+    template <class U>
+    PoolAllocator (PoolAllocator<U> const& u)
+        : impl_ (u.impl_)
+    {
+    }
+
+    T*
+    allocate (std::size_t n)
+    {
+        if (n > std::numeric_limits<
+                std::size_t>::max() / sizeof(T))
+            Throw<std::bad_alloc> ();
+        return static_cast<T*>(
+            impl_->allocate (n * sizeof(T)));
+    }
+
+    void
+    deallocate (T* p, std::size_t n)
+    {
+        impl_->deallocate (p, n * sizeof(T));
+    }
+
+    /** Limit the number of free blocks kept for reuse. */
+    void
+    setMaxFree (std::size_t n)
+    {
+        impl_->setMaxFree (n);
+    }
+
+    /** Number of free blocks kept for reuse. */
+    std::size_t
+    free() const
+    {
+        return impl_->free();
+    }
+
+    /** Number of blocks taken from the system allocator. */
+    std::uint64_t
+    allocated() const
+    {
+        return impl_->allocated();
+    }
+
+    /** Number of allocations served from a free list. */
+    std::uint64_t
+    reused() const
+    {
+        return impl_->reused();
+    }
+
+    template <class U>
+    bool
+    operator== (PoolAllocator<U> const& u) const
+    {
+        return impl_ == u.impl_;
+    }
+
+    template <class U>
+    bool
+    operator!= (PoolAllocator<U> const& u) const
+    {
+        return ! (*this == u);
+    }
+};
+
+} // casinocoin
+
+#endif
@@ -0,0 +1,642 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+#define CASINOCOIN_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+
+#include <casinocoin/basics/hardened_hash.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/clock/abstract_clock.h>
+#include <casinocoin/beast/insight/Insight.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace casinocoin {
+
+/** Map/cache combination split into independently locked shards.
+
+    Behaves like TaggedCache, but the entries are spread over a fixed
+    number of shards selected by the hash of the key. Each shard has
+    its own mutex, so threads working on different keys rarely wait
+    for each other, and sweep() only ever holds one shard's lock.
+
+    Besides expiring entries by age, a sweep made while the cache is
+    above its target size evicts the entries that were not used since
+    the previous sweep. Used entries get a second chance: their
+    reference bit is cleared and checked again next time.
+
+    Unlike TaggedCache there is no peekMutex(), since there is no
+    single lock covering all entries.
+*/
+template <
+    class Key,
+    class T,
+    class Hash = hardened_hash <>,
+    class KeyEqual = std::equal_to <Key>
+>
+class ShardedTaggedCache
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using weak_mapped_ptr = std::weak_ptr <mapped_type>;
+    using mapped_ptr = std::shared_ptr <mapped_type>;
+    using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+
+    static int const shardBits = 5;
+    static std::size_t const shardCount = std::size_t (1) << shardBits;
+
+public:
+    ShardedTaggedCache (std::string const& name, int size,
+        clock_type::rep expiration_seconds, clock_type& clock, beast::Journal journal,
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New ())
+        : m_journal (journal)
+        , m_clock (clock)
+        , m_stats (name,
+            std::bind (&ShardedTaggedCache::collect_metrics, this),
+                collector)
+        , m_name (name)
+        , m_target_size (size)
+        , m_target_age (expiration_seconds)
+    {
+    }
+
+public:
+    /** Return the clock associated with the cache. */
+    clock_type& clock ()
+    {
+        return m_clock;
+    }
+
+    int getTargetSize () const
+    {
+        return m_target_size;
+    }
+
+    void setTargetSize (int s)
+    {
+        m_target_size = s;
+
+        if (s > 0)
+        {
+            auto const perShard = (s + (s >> 2)) / shardCount + 1;
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard <std::mutex> lock (shard.mutex);
+                shard.cache.rehash (static_cast<std::size_t> (
+                    perShard / shard.cache.max_load_factor () + 1));
+            }
+        }
+
+        JLOG(m_journal.debug()) <<
+            m_name << " target size set to " << s;
+    }
+
+    clock_type::rep getTargetAge () const
+    {
+        return m_target_age;
+    }
+
+    void setTargetAge (clock_type::rep s)
+    {
+        m_target_age = s;
+        JLOG(m_journal.debug()) <<
+            m_name << " target age set to " << s;
+    }
+
+    int getCacheSize () const
+    {
+        int count = 0;
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            count += shard.cacheCount;
+        }
+        return count;
+    }
+
+    int getTrackSize () const
+    {
+        int count = 0;
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            count += shard.cache.size ();
+        }
+        return count;
+    }
+
+    float getHitRate ()
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        stats (hits, misses);
+        auto const total = static_cast<float> (hits + misses);
+        return hits * (100.0f / std::max (1.0f, total));
+    }
+
+    void clearStats ()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            shard.hits = 0;
+            shard.misses = 0;
+        }
+    }
+
+    void clear ()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            shard.cache.clear ();
+            shard.cacheCount = 0;
+        }
+    }
+
+    void sweep ()
+    {
+        int cacheRemovals = 0;
+        int mapRemovals = 0;
+
+        clock_type::time_point const now (m_clock.now());
+        clock_type::duration const targetAge = std::chrono::seconds (m_target_age);
+        int const targetSize = m_target_size;
+        int const tracked = getTrackSize ();
+        bool const full = (targetSize != 0) && (tracked > targetSize);
+        clock_type::time_point when_expire;
+
+        if (! full)
+        {
+            when_expire = now - targetAge;
+        }
+        else
+        {
+            when_expire = now - clock_type::duration (
+                targetAge.count() * targetSize / tracked);
+
+            clock_type::duration const minimumAge (
+                std::chrono::seconds (1));
+            if (when_expire > (now - minimumAge))
+                when_expire = now - minimumAge;
+
+            JLOG(m_journal.trace()) <<
+                m_name << " is growing fast " << tracked << " of " << targetSize <<
+                    " aging at " << (now - when_expire).count() << " of " << targetAge.count();
+        }
+
+        // Keep references to all the stuff we sweep
+        // so that we can destroy them outside the lock.
+        //
+        std::vector <mapped_ptr> stuffToSweep;
+
+        for (auto& shard : m_shards)
+        {
+            {
+                std::lock_guard <std::mutex> lock (shard.mutex);
+
+                stuffToSweep.reserve (shard.cache.size ());
+
+                cache_iterator cit = shard.cache.begin ();
+
+                while (cit != shard.cache.end ())
+                {
+                    Entry& entry = cit->second;
+
+                    if (entry.isWeak ())
+                    {
+                        // weak
+                        if (entry.isExpired ())
+                        {
+                            ++mapRemovals;
+                            cit = shard.cache.erase (cit);
+                        }
+                        else
+                        {
+                            ++cit;
+                        }
+                    }
+                    else if (entry.last_access <= when_expire ||
+                        (full && ! entry.referenced))
+                    {
+                        // strong, expired or not used since the last sweep
+                        --shard.cacheCount;
+                        ++cacheRemovals;
+                        if (entry.ptr.unique ())
+                        {
+                            stuffToSweep.push_back (std::move (entry.ptr));
+                            ++mapRemovals;
+                            cit = shard.cache.erase (cit);
+                        }
+                        else
+                        {
+                            // remains weakly cached
+                            entry.ptr.reset ();
+                            ++cit;
+                        }
+                    }
+                    else
+                    {
+                        // strong, gets a second chance
+                        entry.referenced = false;
+                        ++cit;
+                    }
+                }
+            }
+
+            // Release the swept objects outside the lock
+            stuffToSweep.clear ();
+        }
+
+        if (mapRemovals || cacheRemovals)
+        {
+            JLOG(m_journal.trace()) <<
+                m_name << ": cache = " << tracked <<
+                "-" << cacheRemovals << ", map-=" << mapRemovals;
+        }
+    }
+
+    bool del (const key_type& key, bool valid)
+    {
+        // Remove from cache, if !valid, remove from map too. Returns true if removed from cache
+        HashedKey const hk (hashed (key));
+        Shard& shard = shardFor (hk);
+        std::lock_guard <std::mutex> lock (shard.mutex);
+
+        cache_iterator cit = shard.cache.find (hk);
+
+        if (cit == shard.cache.end ())
+            return false;
+
+        Entry& entry = cit->second;
+
+        bool ret = false;
+
+        if (entry.isCached ())
+        {
+            --shard.cacheCount;
+            entry.ptr.reset ();
+            ret = true;
+        }
+
+        if (!valid || entry.isExpired ())
+            shard.cache.erase (cit);
+
+        return ret;
+    }
+
+    /** Replace aliased objects with originals.
+
+        @see TaggedCache::canonicalize
+    */
+    bool canonicalize (const key_type& key, std::shared_ptr<T>& data, bool replace = false)
+    {
+        // Return canonical value, store if needed, refresh in cache
+        // Return values: true=we had the data already
+        HashedKey const hk (hashed (key));
+        Shard& shard = shardFor (hk);
+        auto const now = m_clock.now();
+        std::lock_guard <std::mutex> lock (shard.mutex);
+
+        cache_iterator cit = shard.cache.find (hk);
+
+        if (cit == shard.cache.end ())
+        {
+            shard.cache.emplace (std::piecewise_construct,
+                std::forward_as_tuple(hk),
+                std::forward_as_tuple(now, data));
+            ++shard.cacheCount;
+            return false;
+        }
+
+        Entry& entry = cit->second;
+        entry.touch (now);
+
+        if (entry.isCached ())
+        {
+            if (replace)
+            {
+                entry.ptr = data;
+                entry.weak_ptr = data;
+            }
+            else
+            {
+                data = entry.ptr;
+            }
+
+            return true;
+        }
+
+        mapped_ptr cachedData = entry.lock ();
+
+        if (cachedData)
+        {
+            if (replace)
+            {
+                entry.ptr = data;
+                entry.weak_ptr = data;
+            }
+            else
+            {
+                entry.ptr = cachedData;
+                data = cachedData;
+            }
+
+            ++shard.cacheCount;
+            return true;
+        }
+
+        entry.ptr = data;
+        entry.weak_ptr = data;
+        ++shard.cacheCount;
+
+        return false;
+    }
+
+    std::shared_ptr<T> fetch (const key_type& key)
+    {
+        // fetch us a shared pointer to the stored data object
+        HashedKey const hk (hashed (key));
+        Shard& shard = shardFor (hk);
+        auto const now = m_clock.now();
+        std::lock_guard <std::mutex> lock (shard.mutex);
+
+        cache_iterator cit = shard.cache.find (hk);
+
+        if (cit == shard.cache.end ())
+        {
+            ++shard.misses;
+            return mapped_ptr ();
+        }
+
+        Entry& entry = cit->second;
+        entry.touch (now);
+
+        if (entry.isCached ())
+        {
+            ++shard.hits;
+            return entry.ptr;
+        }
+
+        entry.ptr = entry.lock ();
+
+        if (entry.isCached ())
+        {
+            // independent of cache size, so not counted as a hit
+            ++shard.cacheCount;
+            return entry.ptr;
+        }
+
+        shard.cache.erase (cit);
+        ++shard.misses;
+        return mapped_ptr ();
+    }
+
+    /** Insert the element into the container.
+        If the key already exists, nothing happens.
+        @return `true` If the element was inserted
+    */
+    bool insert (key_type const& key, T const& value)
+    {
+        mapped_ptr p (std::make_shared <T> (
+            std::cref (value)));
+        return canonicalize (key, p);
+    }
+
+    bool retrieve (const key_type& key, T& data)
+    {
+        // retrieve the value of the stored data
+        mapped_ptr entry = fetch (key);
+
+        if (!entry)
+            return false;
+
+        data = *entry;
+        return true;
+    }
+
+    /** Refresh the expiration time on a key.
+
+        @param key The key to refresh.
+        @return `true` if the key was found and the object is cached.
+    */
+    bool refreshIfPresent (const key_type& key)
+    {
+        HashedKey const hk (hashed (key));
+        Shard& shard = shardFor (hk);
+        auto const now = m_clock.now();
+        std::lock_guard <std::mutex> lock (shard.mutex);
+
+        cache_iterator cit = shard.cache.find (hk);
+
+        if (cit == shard.cache.end ())
+            return false;
+
+        Entry& entry = cit->second;
+
+        if (! entry.isCached ())
+        {
+            // Convert weak to strong.
+            entry.ptr = entry.lock ();
+
+            if (! entry.isCached ())
+            {
+                // Couldn't get strong pointer,
+                // object fell out of the cache so remove the entry.
+                shard.cache.erase (cit);
+                return false;
+            }
+
+            // We just put the object back in cache
+            ++shard.cacheCount;
+        }
+
+        entry.touch (now);
+        return true;
+    }
+
+    std::vector <key_type> getKeys ()
+    {
+        std::vector <key_type> v;
+
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            v.reserve (v.size () + shard.cache.size ());
+            for (auto const& _ : shard.cache)
+                v.push_back (_.first.key);
+        }
+
+        return v;
+    }
+
+private:
+    void stats (std::uint64_t& hits, std::uint64_t& misses) const
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard <std::mutex> lock (shard.mutex);
+            hits += shard.hits;
+            misses += shard.misses;
+        }
+    }
+
+    void collect_metrics ()
+    {
+        m_stats.size.set (getCacheSize ());
+
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            stats (hits, misses);
+
+            beast::insight::Gauge::value_type hit_rate (0);
+            if (hits + misses != 0)
+                hit_rate = (hits * 100) / (hits + misses);
+            m_stats.hit_rate.set (hit_rate);
+        }
+    }
+
+private:
+    struct Stats
+    {
+        template <class Handler>
+        Stats (std::string const& prefix, Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge (prefix, "size"))
+            , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    class Entry
+    {
+    public:
+        mapped_ptr ptr;
+        weak_mapped_ptr weak_ptr;
+        clock_type::time_point last_access;
+        bool referenced = true;
+
+        Entry (clock_type::time_point const& last_access_,
+            mapped_ptr const& ptr_)
+            : ptr (ptr_)
+            , weak_ptr (ptr_)
+            , last_access (last_access_)
+        {
+        }
+
+        bool isWeak () const { return ptr == nullptr; }
+        bool isCached () const { return ptr != nullptr; }
+        bool isExpired () const { return weak_ptr.expired (); }
+        mapped_ptr lock () { return weak_ptr.lock (); }
+        void touch (clock_type::time_point const& now)
+        {
+            last_access = now;
+            referenced = true;
+        }
+    };
+
+    // The hash is computed once per call, the high bits select the
+    // shard and the shard's map buckets the entry with the rest.
+    struct HashedKey
+    {
+        std::size_t hash;
+        key_type key;
+
+        HashedKey (std::size_t hash_, key_type const& key_)
+            : hash (hash_)
+            , key (key_)
+        {
+        }
+    };
+
+    struct HashedKeyHash
+    {
+        std::size_t operator() (HashedKey const& k) const
+        {
+            return k.hash;
+        }
+    };
+
+    struct HashedKeyEqual
+    {
+        KeyEqual equal;
+
+        bool operator() (HashedKey const& lhs, HashedKey const& rhs) const
+        {
+            return lhs.hash == rhs.hash && equal (lhs.key, rhs.key);
+        }
+    };
+
+    using cache_type = std::unordered_map <
+        HashedKey, Entry, HashedKeyHash, HashedKeyEqual>;
+    using cache_iterator = typename cache_type::iterator;
+
+    struct Shard
+    {
+        std::mutex mutable mutex;
+        cache_type cache;
+
+        // Number of items cached
+        int cacheCount = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    HashedKey hashed (key_type const& key) const
+    {
+        return HashedKey (m_hash (key), key);
+    }
+
+    Shard& shardFor (HashedKey const& k)
+    {
+        return m_shards[k.hash >>
+            (std::numeric_limits<std::size_t>::digits - shardBits)];
+    }
+
+    beast::Journal m_journal;
+    clock_type& m_clock;
+    Stats m_stats;
+
+    // Used for logging
+    std::string m_name;
+
+    // Desired number of cache entries (0 = ignore)
+    std::atomic<int> m_target_size;
+
+    // Desired maximum cache age in seconds
+    std::atomic<clock_type::rep> m_target_age;
+
+    Hash m_hash;
+    std::array <Shard, shardCount> m_shards;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_BASICS_TASKPOOL_H_INCLUDED
+#define CASINOCOIN_BASICS_TASKPOOL_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace casinocoin {
+
+/** Threads that run a function together with the caller.
+
+    The threads are started once and wait between calls, so work that
+    is split across threads several times per ledger does not create
+    threads each time.
+
+    The function is typically a loop claiming items from a shared
+    counter, so threads that finish early take the remaining items.
+    The caller always runs it too. Once the caller's call returns, the
+    calls no thread has picked up yet are dropped rather than waited
+    for, so a busy or nested pool can not deadlock.
+
+    Several threads may call run at the same time.
+*/
+class TaskPool
+{
+public:
+    /** Create the pool.
+
+        @param name The name given to the threads.
+        @param threads The number of threads that run the function,
+                       including the caller.
+    */
+    TaskPool (std::string const& name, std::size_t threads);
+
+    TaskPool (TaskPool const&) = delete;
+    TaskPool& operator= (TaskPool const&) = delete;
+
+    ~TaskPool ();
+
+    /** The number of threads that run the function, with the caller. */
+    std::size_t
+    size () const
+    {
+        return threads_.size () + 1;
+    }
+
+    /** Call a function on up to `n` threads, including the caller.
+
+        Returns once every call made has returned. If a call throws,
+        the first exception is rethrown.
+    */
+    void
+    run (std::size_t n, std::function<void ()> const& f);
+
+private:
+    struct Task
+    {
+        std::function<void ()> const& f;
+        std::size_t pending;    // calls not picked up by a thread yet
+        std::size_t running = 0;
+        std::exception_ptr error;
+    };
+
+    void
+    work (std::string const& name);
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    std::deque<Task*> tasks_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // casinocoin
+
+#endif
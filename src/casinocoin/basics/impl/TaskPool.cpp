@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/TaskPool.h>
+#include <casinocoin/beast/core/CurrentThreadName.h>
+#include <algorithm>
+
+namespace casinocoin {
+
+TaskPool::TaskPool (std::string const& name, std::size_t threads)
+{
+    if (threads > 1)
+        threads_.reserve (threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+        threads_.emplace_back (&TaskPool::work, this,
+            name + " #" + std::to_string (i));
+}
+
+TaskPool::~TaskPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_all ();
+    for (auto& thread : threads_)
+        thread.join ();
+}
+
+void
+TaskPool::run (std::size_t n, std::function<void ()> const& f)
+{
+    if (n == 0)
+        return;
+
+    auto const helpers = std::min (n, size ()) - 1;
+    Task task {f, helpers};
+    if (helpers != 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            tasks_.push_back (&task);
+        }
+        if (helpers == 1)
+            wakeup_.notify_one ();
+        else
+            wakeup_.notify_all ();
+    }
+
+    std::exception_ptr error;
+    try
+    {
+        f ();
+    }
+    catch (...)
+    {
+        error = std::current_exception ();
+    }
+
+    if (helpers != 0)
+    {
+        std::unique_lock<std::mutex> lock (mutex_);
+        if (task.pending != 0)
+        {
+            // Drop the calls no thread picked up
+            tasks_.erase (std::find (tasks_.begin (), tasks_.end (), &task));
+            task.pending = 0;
+        }
+        done_.wait (lock, [&task] { return task.running == 0; });
+        if (! error)
+            error = task.error;
+    }
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+void
+TaskPool::work (std::string const& name)
+{
+    beast::setCurrentThreadName (name);
+
+    std::unique_lock<std::mutex> lock (mutex_);
+    for (;;)
+    {
+        wakeup_.wait (lock, [this] { return stop_ || ! tasks_.empty (); });
+        if (stop_)
+            return;
+
+        auto& task = *tasks_.front ();
+        if (--task.pending == 0)
+            tasks_.pop_front ();
+        ++task.running;
+        lock.unlock ();
+
+        std::exception_ptr error;
+        try
+        {
+            task.f ();
+        }
+        catch (...)
+        {
+            error = std::current_exception ();
+        }
+
+        lock.lock ();
+        if (error && ! task.error)
+            task.error = error;
+        if (--task.running == 0)
+            done_.notify_all ();
+    }
+}
+
+} // casinocoin
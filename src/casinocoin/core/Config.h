@@ -63,6 +63,7 @@ enum SizedItemName
     siTreeCacheAge,
     siSLECacheSize,
     siSLECacheAge,
+    siSLECacheBytes,
     siLedgerSize,
     siLedgerAge,
     siLedgerFetch,
@@ -128,6 +129,7 @@ private:
 
 public:
     bool doImport = false;
+    bool doImportAccountTx = false;
     bool ELB_SUPPORT = false;
 
     std::vector<std::string>    IPS;                    // Peer IPs from casinocoind.cfg.
@@ -158,6 +160,9 @@ public:
     // Peer networking parameters
     bool                        PEER_PRIVATE = false;           // True to ask peers not to relay current IP.
     int                         PEERS_MAX = 0;
+    bool                        COMPRESSION = false;            // True to offer lz4 compressed peer messages.
+    bool                        SQUELCH = false;                // True to squelch duplicate validator messages.
+    bool                        LEDGER_REPLAY = false;          // True to acquire ledgers from their parent's deltas.
 
     std::chrono::seconds        WEBSOCKET_PING_FREQ = 5min;
 
@@ -191,6 +196,18 @@ public:
     // Thread pool configuration
     std::size_t                 WORKERS = 0;
 
+    // Concurrent transaction signature verification jobs, 0 for automatic
+    std::size_t                 VERIFY_WORKERS = 0;
+
+    // Threads that speculatively apply transaction sets, 0 or 1 to disable
+    std::size_t                 APPLY_WORKERS = 0;
+
+    // Threads that update path requests after each ledger, 0 for automatic
+    std::size_t                 PATH_WORKERS = 0;
+
+    // Owner directories kept in memory for account requests, 0 to disable
+    std::size_t                 OWNER_INDEX = 0;
+
     // Network the server connects to. production = 0, test = 1, development = 2
     // default is production if not specified in the config
     std::uint32_t               PEER_NETWORK = 0;
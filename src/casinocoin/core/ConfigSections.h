@@ -35,11 +35,14 @@ struct ConfigSection
 {
     static std::string nodeDatabase ()       { return "node_db"; }
     static std::string importNodeDatabase () { return "import_db"; }
+    static std::string accountTxDatabase ()  { return "account_tx_db"; }
 };
 
 // VFALCO TODO Rename and replace these macros with variables.
 #define SECTION_AMENDMENTS              "amendments"
+#define SECTION_APPLY_WORKERS           "apply_workers"
 #define SECTION_CLUSTER_NODES           "cluster_nodes"
+#define SECTION_COMPRESSION             "compression"
 #define SECTION_DEBUG_LOGFILE           "debug_logfile"
 #define SECTION_ELB_SUPPORT             "elb_support"
 #define SECTION_FEE_DEFAULT             "fee_default"
@@ -48,6 +51,7 @@ struct ConfigSection
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
+#define SECTION_LEDGER_REPLAY           "ledger_replay"
 #define SECTION_MAX_MEMO_SIZE           "max_memo_size"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
@@ -55,14 +59,17 @@ struct ConfigSection
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
 #define SECTION_NODE_SIZE               "node_size"
+#define SECTION_OWNER_INDEX             "owner_index"
 #define SECTION_PATH_SEARCH_OLD         "path_search_old"
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
 #define SECTION_PATH_SEARCH_MAX         "path_search_max"
+#define SECTION_PATH_WORKERS            "path_workers"
 #define SECTION_PEER_PRIVATE            "peer_private"
 #define SECTION_PEERS_MAX               "peers_max"
 #define SECTION_RPC_STARTUP             "rpc_startup"
 #define SECTION_SNTP                    "sntp_servers"
+#define SECTION_SQUELCH                 "squelch"
 #define SECTION_SSL_VERIFY              "ssl_verify"
 #define SECTION_SSL_VERIFY_FILE         "ssl_verify_file"
 #define SECTION_SSL_VERIFY_DIR          "ssl_verify_dir"
@@ -75,6 +82,7 @@ struct ConfigSection
 #define SECTION_VALIDATOR_LIST_SITES    "validator_list_sites"
 #define SECTION_VALIDATORS              "validators"
 #define SECTION_VALIDATOR_TOKEN         "validator_token"
+#define SECTION_VERIFY_WORKERS          "verify_workers"
 #define SECTION_VETO_AMENDMENTS         "veto_amendments"
 #define SECTION_WORKERS                 "workers"
 #define SECTION_KYC_SIGNERS             "kyc_trusted_accounts"
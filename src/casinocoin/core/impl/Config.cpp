@@ -427,6 +427,15 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_PEERS_MAX, strTemp, j_))
         PEERS_MAX = std::max (0, beast::lexicalCastThrow <int> (strTemp));
 
+    if (getSingleSection (secConfig, SECTION_COMPRESSION, strTemp, j_))
+        COMPRESSION = beast::lexicalCastThrow <bool> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_SQUELCH, strTemp, j_))
+        SQUELCH = beast::lexicalCastThrow <bool> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
+        LEDGER_REPLAY = beast::lexicalCastThrow <bool> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_NETWORK, strTemp, j_))
     {
         JLOG (j_.info()) << boost::str (
@@ -561,6 +570,18 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_WORKERS, strTemp, j_))
         WORKERS      = beast::lexicalCastThrow <std::size_t> (strTemp);
 
+    if (getSingleSection (secConfig, SECTION_VERIFY_WORKERS, strTemp, j_))
+        VERIFY_WORKERS = beast::lexicalCastThrow <std::size_t> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_APPLY_WORKERS, strTemp, j_))
+        APPLY_WORKERS = beast::lexicalCastThrow <std::size_t> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_PATH_WORKERS, strTemp, j_))
+        PATH_WORKERS = beast::lexicalCastThrow <std::size_t> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_OWNER_INDEX, strTemp, j_))
+        OWNER_INDEX = beast::lexicalCastThrow <std::size_t> (strTemp);
+
     if (auto s = getIniFileSection (secConfig, SECTION_KYC_SIGNERS))
         KYCTrustedAccounts = *s;
 
@@ -662,6 +683,7 @@ int Config::getSize (SizedItemName item) const
 
         { siSLECacheSize,       {   4096,   8192,   16384,  65536,      131072  } },
         { siSLECacheAge,        {   30,     60,     90,     120,        300     } },
+        { siSLECacheBytes,      {   8,      16,     32,     128,        256     } },
 
         { siLedgerSize,         {   32,     128,    256,    384,        768     } },
         { siLedgerAge,          {   30,     90,     180,    240,        900     } },
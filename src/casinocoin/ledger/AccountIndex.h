@@ -0,0 +1,222 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_LEDGER_ACCOUNTINDEX_H_INCLUDED
+#define CASINOCOIN_LEDGER_ACCOUNTINDEX_H_INCLUDED
+
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace casinocoin {
+
+/** Values computed per account, kept across published ledgers.
+
+    A value is read from a ledger the first time it is asked for, and
+    then patched from the changes of each published ledger that follows
+    the one the index reflects. A ledger that doesn't follow it, or
+    whose changes aren't known, starts the index over.
+
+    The index only answers for the ledger it reflects, which is the last
+    published ledger. It does not answer for open ledgers, nor for
+    closed ledgers that are older or not published yet, so callers
+    wanting the index to be used must pass the last validated ledger,
+    and read any other ledger themselves. The values it hands out are
+    immutable and replaced as a whole, so they stay valid for their
+    ledger after the index moves on. When more accounts are known than
+    allowed, those used least recently are dropped.
+*/
+template <class Value>
+class AccountIndex
+{
+public:
+    using pointer = std::shared_ptr<Value const>;
+
+    AccountIndex (std::size_t maxAccounts, beast::Journal journal)
+        : maxAccounts_ (maxAccounts)
+        , j_ (journal)
+    {
+    }
+
+    /** Number of accounts kept */
+    std::size_t
+    limit () const
+    {
+        return maxAccounts_;
+    }
+
+    /** Returns the value for an account in a ledger.
+
+        @param load Called without the lock when the value isn't known,
+                    returns it read from the ledger, or `nullptr`.
+
+        @param ledger The last published ledger. Any other ledger,
+                      including an open one, gets `nullptr`.
+
+        @return `nullptr` if the index doesn't reflect the ledger, or
+                the value isn't known and `load` returned `nullptr`.
+    */
+    template <class Load>
+    pointer
+    get (ReadView const& ledger, AccountID const& account, Load&& load)
+    {
+        auto const& hash = ledger.info ().hash;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            if (ledger.open () || seq_ == 0 || hash != hash_)
+                return nullptr;
+
+            auto const iter = values_.find (account);
+            if (iter != values_.end ())
+            {
+                iter->second.used = seq_;
+                return iter->second.value;
+            }
+        }
+
+        pointer value = load ();
+        if (! value)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock (mutex_);
+        // Only keep the value if no ledger was applied meanwhile
+        if (hash == hash_)
+        {
+            values_.emplace (account, Entry {value, seq_});
+            trim ();
+        }
+        return value;
+    }
+
+    /** Bring the index up to date with a published ledger.
+
+        @param delta The changes of the ledger by account, or `nullptr`
+                     if they aren't known.
+        @param patch Called with the lock held for each known account
+                     in `delta` as `patch (account, value, changes)`.
+                     Returns the value after the changes, or `nullptr`
+                     to have it read again.
+    */
+    template <class Delta, class Patch>
+    void
+    update (LedgerInfo const& info, Delta const* delta, Patch&& patch)
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+
+        // Already reflected
+        if (info.hash == hash_ || (seq_ != 0 && info.seq <= seq_))
+            return;
+
+        if (seq_ != 0 && delta && info.parentHash == hash_)
+        {
+            for (auto const& changes : *delta)
+            {
+                auto iter = values_.find (changes.first);
+                if (iter == values_.end ())
+                    continue;
+
+                if (auto value = patch (changes.first,
+                        *iter->second.value, changes.second))
+                    iter->second.value = std::move (value);
+                else
+                    values_.erase (iter);
+            }
+        }
+        else
+        {
+            JLOG (j_.debug())
+                << "Ledger " << info.seq << " does not follow " << seq_;
+            values_.clear ();
+        }
+
+        hash_ = info.hash;
+        seq_ = info.seq;
+    }
+
+    /** Number of accounts whose value is known */
+    std::size_t
+    size () const
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return values_.size ();
+    }
+
+    /** Sequence of the ledger the index reflects, 0 if none */
+    LedgerIndex
+    seq () const
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return seq_;
+    }
+
+private:
+    struct Entry
+    {
+        pointer value;
+        LedgerIndex used;
+    };
+
+    // Drop the accounts used least recently
+    void
+    trim ()
+    {
+        if (values_.size () <= maxAccounts_)
+            return;
+
+        std::vector<LedgerIndex> used;
+        used.reserve (values_.size ());
+        for (auto const& entry : values_)
+            used.push_back (entry.second.used);
+        auto const middle = used.begin () + used.size () / 2;
+        std::nth_element (used.begin (), middle, used.end ());
+
+        for (auto iter = values_.begin (); iter != values_.end ();)
+        {
+            if (iter->second.used < *middle)
+                iter = values_.erase (iter);
+            else
+                ++iter;
+        }
+
+        // All were used as recently
+        for (auto iter = values_.begin ();
+            values_.size () > maxAccounts_ / 2 && iter != values_.end ();)
+        {
+            iter = values_.erase (iter);
+        }
+    }
+
+    std::size_t const maxAccounts_;
+    beast::Journal j_;
+
+    std::mutex mutable mutex_;
+    uint256 hash_;
+    LedgerIndex seq_ = 0;
+    hash_map<AccountID, Entry> values_;
+};
+
+} // casinocoin
+
+#endif
@@ -27,14 +27,34 @@
 #define CASINOCOIN_LEDGER_CACHEDSLES_H_INCLUDED
 
 #include <casinocoin/basics/chrono.h>
+#include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/protocol/STLedgerEntry.h>
-#include <casinocoin/beast/container/aged_unordered_map.h>
+#include <casinocoin/beast/insight/Insight.h>
+#include <boost/optional.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <array>
+#include <atomic>
+#include <limits>
 #include <memory>
-#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace casinocoin {
 
-/** Caches SLEs by their digest. */
+/** Caches SLEs by their digest.
+
+    The entries are spread over independently locked shards. Lookups
+    only take a shard's lock for reading and record hits with atomic
+    operations, so concurrent readers never wait for each other; only
+    inserting a missing SLE and expiring entries lock a shard
+    exclusively.
+
+    The cache is bounded by the serialized size of the SLEs it holds.
+    When a shard exceeds its share of the budget, entries are evicted
+    in clock order, giving those used since the hand last passed them
+    a second chance.
+*/
 class CachedSLEs
 {
 public:
@@ -43,15 +63,30 @@ public:
     using value_type =
         std::shared_ptr<SLE const>;
 
+    static int const shardBits = 5;
+    static std::size_t const shardCount = std::size_t (1) << shardBits;
+
     CachedSLEs (CachedSLEs const&) = delete;
     CachedSLEs& operator= (CachedSLEs const&) = delete;
 
+    /** Create the cache.
+
+        @param timeToLive Entries unused for this long are expired.
+        @param clock The clock used to age entries.
+        @param maxBytes Budget for the serialized size of the SLEs.
+        @param collector Receives the cache metrics.
+    */
     template <class Rep, class Period>
     CachedSLEs (std::chrono::duration<
         Rep, Period> const& timeToLive,
-            Stopwatch& clock)
+            Stopwatch& clock,
+            std::size_t maxBytes = 32 * 1024 * 1024,
+            beast::insight::Collector::ptr const& collector =
+                beast::insight::NullCollector::New ())
         : timeToLive_ (timeToLive)
-        , map_ (clock)
+        , clock_ (clock)
+        , maxBytes_ (maxBytes)
+        , stats_ (std::bind (&CachedSLEs::collectMetrics, this), collector)
     {
     }
 
@@ -74,44 +109,142 @@ public:
     fetch (digest_type const& digest,
         Handler const& h)
     {
+        auto& shard = shardFor (digest);
         {
-            std::lock_guard<
-                std::mutex> lock(mutex_);
+            boost::shared_lock<
+                boost::shared_mutex> lock(shard.mutex);
             auto iter =
-                map_.find(digest);
-            if (iter != map_.end())
+                shard.map.find(digest);
+            if (iter != shard.map.end())
             {
-                ++hit_;
-                map_.touch(iter);
-                return iter->second;
+                shard.hits.fetch_add (1, std::memory_order_relaxed);
+                iter->second.touch (clock_.now());
+                return iter->second.sle;
             }
         }
         auto sle = h();
         if (! sle)
             return nullptr;
-        std::lock_guard<
-            std::mutex> lock(mutex_);
-        ++miss_;
-        auto const result =
-            map_.emplace(
-                digest, std::move(sle));
-        if (! result.second)
-            map_.touch(result.first);
-        return  result.first->second;
+        shard.misses.fetch_add (1, std::memory_order_relaxed);
+        return insert (shard, digest, std::move(sle));
     }
 
     /** Returns the fraction of cache hits. */
     double
     rate() const;
 
+    /** Returns the number of lookups found in the cache. */
+    std::uint64_t
+    hits() const;
+
+    /** Returns the number of lookups that had to read the SLE. */
+    std::uint64_t
+    misses() const;
+
+    /** Returns the number of cached SLEs. */
+    std::size_t
+    size() const;
+
+    /** Returns the serialized size of the cached SLEs. */
+    std::size_t
+    bytes() const;
+
+    /** Returns the byte budget of the cache. */
+    std::size_t
+    maxBytes() const
+    {
+        return maxBytes_;
+    }
+
 private:
-    std::size_t hit_ = 0;
-    std::size_t miss_ = 0;
-    std::mutex mutable mutex_;
+    struct Entry
+    {
+        value_type sle;
+        std::size_t bytes;
+
+        // Updated by readers holding the shared lock
+        std::atomic<Stopwatch::duration::rep> lastAccess;
+        std::atomic<bool> referenced;
+
+        Entry (value_type sle_, std::size_t bytes_,
+                Stopwatch::time_point now)
+            : sle (std::move(sle_))
+            , bytes (bytes_)
+            , lastAccess (now.time_since_epoch().count())
+            , referenced (true)
+        {
+        }
+
+        void
+        touch (Stopwatch::time_point now)
+        {
+            lastAccess.store (now.time_since_epoch().count(),
+                std::memory_order_relaxed);
+            if (! referenced.load (std::memory_order_relaxed))
+                referenced.store (true, std::memory_order_relaxed);
+        }
+    };
+
+    using map_type = std::unordered_map<digest_type,
+        Entry, hardened_hash<strong_hash>>;
+
+    struct alignas(64) Shard
+    {
+        boost::shared_mutex mutable mutex;
+        map_type map;
+        std::size_t bytes = 0;
+
+        // Where the eviction clock hand stopped
+        boost::optional<digest_type> hand;
+
+        std::atomic<std::uint64_t> hits {0};
+        std::atomic<std::uint64_t> misses {0};
+    };
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats (Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge ("sle_cache", "size"))
+            , bytes (collector->make_gauge ("sle_cache", "bytes"))
+            , hits (collector->make_gauge ("sle_cache", "hits"))
+            , misses (collector->make_gauge ("sle_cache", "misses"))
+            , hit_rate (collector->make_gauge ("sle_cache", "hit_rate"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge bytes;
+        beast::insight::Gauge hits;
+        beast::insight::Gauge misses;
+        beast::insight::Gauge hit_rate;
+    };
+
+    Shard&
+    shardFor (digest_type const& digest)
+    {
+        return shards_[hash_(digest) >>
+            (std::numeric_limits<std::size_t>::digits - shardBits)];
+    }
+
+    value_type
+    insert (Shard& shard, digest_type const& digest, value_type sle);
+
+    // Evict entries until the shard is within its budget
+    void
+    evict (Shard& shard, std::vector<value_type>& trash);
+
+    void
+    collectMetrics ();
+
     Stopwatch::duration timeToLive_;
-    beast::aged_unordered_map <digest_type,
-        value_type, Stopwatch::clock_type,
-            hardened_hash<strong_hash>> map_;
+    Stopwatch& clock_;
+    std::size_t const maxBytes_;
+    hardened_hash<strong_hash> hash_;
+    std::array<Shard, shardCount> shards_;
+    Stats stats_;
 };
 
 } // casinocoin
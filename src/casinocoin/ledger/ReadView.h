@@ -28,8 +28,10 @@
 
 #include <casinocoin/ledger/detail/ReadViewFwdRange.h>
 #include <casinocoin/basics/chrono.h>
+#include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/protocol/Indexes.h>
 #include <casinocoin/protocol/IOUAmount.h>
+#include <casinocoin/protocol/Issue.h>
 #include <casinocoin/protocol/Protocol.h>
 #include <casinocoin/protocol/STLedgerEntry.h>
 #include <casinocoin/protocol/STTx.h>
@@ -173,14 +175,52 @@ public:
     }
 };
 
+/** Whitelisted tokens compiled from a Token configuration entry.
+
+    Maps each whitelisted issue to the largest total supply configured
+    for it, so an amount can be checked with a single hash probe.
+*/
+class WLTTable
+{
+private:
+    hash_map<Issue, STAmount> supply_;
+
+public:
+    explicit
+    WLTTable (ConfigObjectEntry const& tokenConfig);
+
+    /** Returns `true` if the amount is native or does not exceed the
+        total supply of a whitelisted token with the same issue.
+    */
+    bool
+    compliant (STAmount const& amount) const;
+
+    std::size_t
+    size() const
+    {
+        return supply_.size();
+    }
+};
+
 struct LedgerConfig
 {
     LedgerConfig() = default;
     LedgerConfig (LedgerConfig const&) = default;
     LedgerConfig& operator= (LedgerConfig const&) = default;
 
+    /** Rebuild the WLT table from the first Token entry.
+
+        Must be called whenever entries changes. The table is
+        immutable and shared by every copy of this configuration.
+    */
+    void
+    compileWLT();
+
     LedgerIndex lastUpdateIndex = 0;
     std::vector<ConfigObjectEntry> entries;
+
+    // Null if no Token entry is configured
+    std::shared_ptr<WLTTable const> wlt;
 };
 
 //------------------------------------------------------------------------------
@@ -30,6 +30,7 @@
 #include <casinocoin/ledger/RawView.h>
 #include <casinocoin/ledger/ReadView.h>
 #include <casinocoin/ledger/TxMeta.h>
+#include <casinocoin/ledger/detail/StateMap.h>
 #include <casinocoin/protocol/TER.h>
 #include <casinocoin/protocol/CSCAmount.h>
 #include <casinocoin/beast/utility/Journal.h>
@@ -53,8 +54,7 @@ private:
         modify,
     };
 
-    using items_t = std::map<key_type,
-        std::pair<Action, std::shared_ptr<SLE>>>;
+    using items_t = StateMap<Action>;
 
     items_t items_;
     CSCAmount dropsDestroyed_ = 0;
@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_LEDGER_STATEMAP_H_INCLUDED
+#define CASINOCOIN_LEDGER_STATEMAP_H_INCLUDED
+
+#include <casinocoin/basics/base_uint.h>
+#include <casinocoin/protocol/STLedgerEntry.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace casinocoin {
+namespace detail {
+
+/** Number of times state tables on this thread had to grow their storage. */
+inline
+std::uint64_t&
+stateMapAllocations ()
+{
+    static thread_local std::uint64_t count = 0;
+    return count;
+}
+
+/** Ordered map from ledger keys to buffered state table actions.
+
+    The entries are kept sorted in one contiguous vector, so lookups
+    are binary searches, iteration is in key order as succ() and the
+    metadata require, and copying a table is a single allocation.
+
+    Inserting in the middle moves the entries after it, so this suits
+    the small per-transaction tables of ApplyStateTable. The table of
+    an OpenView accumulates a whole ledger and stays a std::map.
+
+    Tables usually live for one transaction. When a table is destroyed
+    its vector is cleared and kept by the thread for the next table,
+    so applying a transaction reuses the capacity grown by the previous
+    ones instead of allocating each layer afresh.
+
+    Inserting or erasing invalidates iterators.
+*/
+template <class Action>
+class StateMap
+{
+public:
+    using key_type = uint256;
+    using mapped_type = std::pair<Action, std::shared_ptr<SLE>>;
+    using value_type = std::pair<key_type, mapped_type>;
+
+private:
+    using storage_type = std::vector<value_type>;
+
+public:
+    using iterator = typename storage_type::iterator;
+    using const_iterator = typename storage_type::const_iterator;
+
+    StateMap ()
+        : items_ (acquire ())
+    {
+    }
+
+    StateMap (StateMap const& other)
+        : items_ (acquire ())
+    {
+        items_.assign (other.items_.begin (), other.items_.end ());
+    }
+
+    StateMap (StateMap&& other) = default;
+
+    StateMap& operator= (StateMap const&) = delete;
+    StateMap& operator= (StateMap&&) = delete;
+
+    ~StateMap ()
+    {
+        release (std::move (items_));
+    }
+
+    iterator begin () { return items_.begin (); }
+    iterator end () { return items_.end (); }
+    const_iterator begin () const { return items_.begin (); }
+    const_iterator end () const { return items_.end (); }
+
+    std::size_t
+    size () const
+    {
+        return items_.size ();
+    }
+
+    bool
+    empty () const
+    {
+        return items_.empty ();
+    }
+
+    iterator
+    lower_bound (key_type const& key)
+    {
+        return std::lower_bound (items_.begin (), items_.end (), key,
+            [](value_type const& v, key_type const& k) { return v.first < k; });
+    }
+
+    const_iterator
+    lower_bound (key_type const& key) const
+    {
+        return std::lower_bound (items_.begin (), items_.end (), key,
+            [](value_type const& v, key_type const& k) { return v.first < k; });
+    }
+
+    const_iterator
+    upper_bound (key_type const& key) const
+    {
+        return std::upper_bound (items_.begin (), items_.end (), key,
+            [](key_type const& k, value_type const& v) { return k < v.first; });
+    }
+
+    iterator
+    find (key_type const& key)
+    {
+        auto const iter = lower_bound (key);
+        if (iter == items_.end () || iter->first != key)
+            return items_.end ();
+        return iter;
+    }
+
+    const_iterator
+    find (key_type const& key) const
+    {
+        auto const iter = lower_bound (key);
+        if (iter == items_.end () || iter->first != key)
+            return items_.end ();
+        return iter;
+    }
+
+    /** Insert an entry unless the key is present.
+
+        @return The entry for the key, and whether it was inserted.
+    */
+    std::pair<iterator, bool>
+    emplace (key_type const& key,
+        Action action, std::shared_ptr<SLE> sle)
+    {
+        auto const iter = lower_bound (key);
+        if (iter != items_.end () && iter->first == key)
+            return { iter, false };
+        return { emplace_hint (iter, key, action, std::move (sle)), true };
+    }
+
+    /** Insert an entry at the position returned by lower_bound.
+
+        The key must not be present.
+    */
+    iterator
+    emplace_hint (iterator hint, key_type const& key,
+        Action action, std::shared_ptr<SLE> sle)
+    {
+        assert (hint == lower_bound (key));
+        assert (hint == items_.end () || hint->first != key);
+        if (items_.size () == items_.capacity ())
+            ++stateMapAllocations ();
+        return items_.emplace (hint, key,
+            mapped_type (action, std::move (sle)));
+    }
+
+    iterator
+    erase (iterator iter)
+    {
+        return items_.erase (iter);
+    }
+
+private:
+    // Tables with more entries than this do not keep their storage
+    static std::size_t const maxRecycled = 4096;
+
+    // Number of cleared vectors a thread keeps
+    static std::size_t const maxPooled = 16;
+
+    struct Pool
+    {
+        std::vector<storage_type> free;
+
+        ~Pool ()
+        {
+            alive () = false;
+        }
+
+        // Tables destroyed while the thread exits skip the pool
+        static bool&
+        alive ()
+        {
+            static thread_local bool value = true;
+            return value;
+        }
+
+        static Pool*
+        get ()
+        {
+            if (! alive ())
+                return nullptr;
+            static thread_local Pool pool;
+            return &pool;
+        }
+    };
+
+    static
+    storage_type
+    acquire ()
+    {
+        auto const pool = Pool::get ();
+        if (! pool || pool->free.empty ())
+            return {};
+        auto items = std::move (pool->free.back ());
+        pool->free.pop_back ();
+        return items;
+    }
+
+    static
+    void
+    release (storage_type&& items)
+    {
+        if (items.capacity () == 0 || items.capacity () > maxRecycled)
+            return;
+        items.clear ();
+        auto const pool = Pool::get ();
+        if (pool && pool->free.size () < maxPooled)
+            pool->free.push_back (std::move (items));
+    }
+
+    storage_type items_;
+};
+
+} // detail
+} // casinocoin
+
+#endif
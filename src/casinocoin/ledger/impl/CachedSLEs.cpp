@@ -25,44 +25,278 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/ledger/CachedSLEs.h>
-#include <vector>
+#include <casinocoin/protocol/Serializer.h>
+#include <casinocoin/protocol/STAccount.h>
+#include <casinocoin/protocol/STAmount.h>
+#include <casinocoin/protocol/STArray.h>
+#include <casinocoin/protocol/STBlob.h>
+#include <casinocoin/protocol/STVector128.h>
+#include <casinocoin/protocol/STVector256.h>
 
 namespace casinocoin {
 
+// The sizes below follow what the add functions of the fields write
+
+static
+std::size_t
+fieldIDSize (SField const& field)
+{
+    return 1 + (field.fieldType >= 16) + (field.fieldValue >= 16);
+}
+
+static
+std::size_t
+vlSize (std::size_t length)
+{
+    if (length <= 192)
+        return 1 + length;
+    if (length <= 12480)
+        return 2 + length;
+    return 3 + length;
+}
+
+static
+std::size_t
+objectSize (STObject const& object);
+
+static
+std::size_t
+fieldSize (STBase const& field)
+{
+    switch (field.getSType ())
+    {
+    case STI_UINT8:   return 1;
+    case STI_UINT16:  return 2;
+    case STI_UINT32:  return 4;
+    case STI_UINT64:  return 8;
+    case STI_HASH128: return 16;
+    case STI_HASH160: return 20;
+    case STI_HASH256: return 32;
+    case STI_AMOUNT:
+        return static_cast<STAmount const&> (field).native () ? 8 : 48;
+    case STI_VL:
+        return vlSize (static_cast<STBlob const&> (field).size ());
+    case STI_ACCOUNT:
+        return vlSize (field.isDefault () ? 0 : uint160::bytes);
+    case STI_VECTOR256:
+        return vlSize (static_cast<STVector256 const&> (
+            field).size () * uint256::bytes);
+    case STI_VECTOR128:
+        return vlSize (static_cast<STVector128 const&> (
+            field).size () * uint128::bytes);
+    case STI_OBJECT:
+        return objectSize (static_cast<STObject const&> (field));
+    case STI_ARRAY:
+    {
+        std::size_t size = 0;
+        for (auto const& object : static_cast<STArray const&> (field))
+        {
+            // Each object is followed by an end of object marker
+            size += fieldIDSize (object.getFName ()) +
+                objectSize (object) + 1;
+        }
+        return size;
+    }
+    default:
+        break;
+    }
+
+    // Path sets and other types not found in ledger entries are counted
+    // the slow way
+    Serializer s;
+    field.add (s);
+    return s.size ();
+}
+
+// The number of bytes object.add writes, without serializing it
+static
+std::size_t
+objectSize (STObject const& object)
+{
+    std::size_t size = 0;
+    for (auto const& field : object)
+    {
+        if (field.getSType () == STI_NOTPRESENT ||
+                ! field.getFName ().shouldInclude (true))
+            continue;
+
+        size += fieldIDSize (field.getFName ()) + fieldSize (field);
+
+        // Inner objects and arrays end with a marker
+        if (field.getSType () == STI_OBJECT ||
+                field.getSType () == STI_ARRAY)
+            size += 1;
+    }
+    return size;
+}
+
+CachedSLEs::value_type
+CachedSLEs::insert (Shard& shard,
+    digest_type const& digest, value_type sle)
+{
+    auto const bytes = objectSize (*sle);
+
+    std::vector<value_type> trash;
+    std::unique_lock<
+        boost::shared_mutex> lock(shard.mutex);
+    auto const result = shard.map.emplace (
+        std::piecewise_construct,
+            std::forward_as_tuple(digest),
+            std::forward_as_tuple(
+                std::move(sle), bytes, clock_.now()));
+    if (! result.second)
+    {
+        // Another thread inserted it first
+        result.first->second.touch (clock_.now());
+        return result.first->second.sle;
+    }
+    shard.bytes += bytes;
+    auto ret = result.first->second.sle;
+    evict (shard, trash);
+    lock.unlock();
+
+    // The evicted SLEs are released outside the lock
+    trash.clear();
+    return ret;
+}
+
+void
+CachedSLEs::evict (Shard& shard,
+    std::vector<value_type>& trash)
+{
+    auto const budget = maxBytes_ / shardCount;
+    if (shard.bytes <= budget || shard.map.empty())
+        return;
+
+    auto iter = shard.map.end();
+    if (shard.hand)
+        iter = shard.map.find (*shard.hand);
+    if (iter == shard.map.end())
+        iter = shard.map.begin();
+
+    // Every entry gets at most one second chance
+    auto steps = 2 * shard.map.size();
+    while (shard.bytes > budget && ! shard.map.empty() && steps-- != 0)
+    {
+        auto& entry = iter->second;
+        if (entry.referenced.load (std::memory_order_relaxed))
+        {
+            entry.referenced.store (false, std::memory_order_relaxed);
+            ++iter;
+        }
+        else
+        {
+            shard.bytes -= entry.bytes;
+            trash.emplace_back (std::move(entry.sle));
+            iter = shard.map.erase (iter);
+        }
+        if (iter == shard.map.end())
+            iter = shard.map.begin();
+    }
+
+    if (iter != shard.map.end())
+        shard.hand = iter->first;
+    else
+        shard.hand = boost::none;
+}
+
 void
 CachedSLEs::expire()
 {
-    std::vector<
-        std::shared_ptr<void const>> trash;
+    auto const expireTime = (clock_.now() -
+        timeToLive_).time_since_epoch().count();
+    std::vector<value_type> trash;
+    for (auto& shard : shards_)
     {
-        auto const expireTime =
-            map_.clock().now() - timeToLive_;
-        std::lock_guard<
-            std::mutex> lock(mutex_);
-        for (auto iter = map_.chronological.begin();
-            iter != map_.chronological.end(); ++iter)
         {
-            if (iter.when() > expireTime)
-                break;
-            if (iter->second.unique())
+            std::lock_guard<
+                boost::shared_mutex> lock(shard.mutex);
+            for (auto iter = shard.map.begin();
+                iter != shard.map.end();)
             {
-                trash.emplace_back(
-                    std::move(iter->second));
-                iter = map_.erase(iter);
+                auto& entry = iter->second;
+                if (entry.lastAccess.load (
+                        std::memory_order_relaxed) <= expireTime &&
+                    entry.sle.unique())
+                {
+                    shard.bytes -= entry.bytes;
+                    trash.emplace_back (std::move(entry.sle));
+                    iter = shard.map.erase (iter);
+                }
+                else
+                {
+                    ++iter;
+                }
             }
         }
+        trash.clear();
     }
 }
 
 double
 CachedSLEs::rate() const
 {
-    std::lock_guard<
-        std::mutex> lock(mutex_);
-    auto const tot = hit_ + miss_;
+    auto const hit = hits();
+    auto const tot = hit + misses();
     if (tot == 0)
         return 0;
-    return double(hit_) / tot;
+    return double(hit) / tot;
+}
+
+std::uint64_t
+CachedSLEs::hits() const
+{
+    std::uint64_t ret = 0;
+    for (auto const& shard : shards_)
+        ret += shard.hits.load (std::memory_order_relaxed);
+    return ret;
+}
+
+std::uint64_t
+CachedSLEs::misses() const
+{
+    std::uint64_t ret = 0;
+    for (auto const& shard : shards_)
+        ret += shard.misses.load (std::memory_order_relaxed);
+    return ret;
+}
+
+std::size_t
+CachedSLEs::size() const
+{
+    std::size_t ret = 0;
+    for (auto const& shard : shards_)
+    {
+        boost::shared_lock<
+            boost::shared_mutex> lock(shard.mutex);
+        ret += shard.map.size();
+    }
+    return ret;
+}
+
+std::size_t
+CachedSLEs::bytes() const
+{
+    std::size_t ret = 0;
+    for (auto const& shard : shards_)
+    {
+        boost::shared_lock<
+            boost::shared_mutex> lock(shard.mutex);
+        ret += shard.bytes;
+    }
+    return ret;
+}
+
+void
+CachedSLEs::collectMetrics ()
+{
+    auto const hit = hits();
+    auto const miss = misses();
+    stats_.size.set (size());
+    stats_.bytes.set (bytes());
+    stats_.hits.set (hit);
+    stats_.misses.set (miss);
+    stats_.hit_rate.set (hit + miss == 0 ? 0 : (hit * 100) / (hit + miss));
 }
 
 } // casinocoin
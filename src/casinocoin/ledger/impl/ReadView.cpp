@@ -26,9 +26,54 @@
 #include <BeastConfig.h>
 #include <casinocoin/ledger/ReadView.h>
 #include <boost/optional.hpp>
+#include <algorithm>
 
 namespace casinocoin {
 
+WLTTable::WLTTable (ConfigObjectEntry const& tokenConfig)
+{
+    assert (tokenConfig.getType() == ConfigObjectEntry::Token);
+
+    auto const& definedTokens = tokenConfig.getData();
+    supply_.reserve (definedTokens.size());
+    for (auto const entry : definedTokens)
+    {
+        auto const& totalSupply =
+            static_cast<TokenDescriptor const*>(entry)->totalSupply;
+        auto const result = supply_.emplace (
+            totalSupply.issue(), totalSupply);
+        if (! result.second && result.first->second < totalSupply)
+            result.first->second = totalSupply;
+    }
+}
+
+bool
+WLTTable::compliant (STAmount const& amount) const
+{
+    if (isCSC (amount))
+        return true;
+
+    auto const iter = supply_.find (amount.issue());
+    return iter != supply_.end() && iter->second >= amount;
+}
+
+void
+LedgerConfig::compileWLT()
+{
+    auto const iter = std::find_if (entries.begin(), entries.end(),
+        [](ConfigObjectEntry const& obj)
+        {
+            return obj.getType() == ConfigObjectEntry::Token;
+        });
+
+    if (iter == entries.end())
+        wlt.reset();
+    else
+        wlt = std::make_shared<WLTTable const> (*iter);
+}
+
+//------------------------------------------------------------------------------
+
 class Rules::Impl
 {
 private:
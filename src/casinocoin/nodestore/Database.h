@@ -26,10 +26,13 @@
 #ifndef CASINOCOIN_NODESTORE_DATABASE_H_INCLUDED
 #define CASINOCOIN_NODESTORE_DATABASE_H_INCLUDED
 
-#include <casinocoin/basics/TaggedCache.h>
+#include <casinocoin/basics/ShardedTaggedCache.h>
 #include <casinocoin/core/Stoppable.h>
 #include <casinocoin/nodestore/NodeObject.h>
 #include <casinocoin/nodestore/Backend.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -97,6 +100,52 @@ public:
     */
     virtual bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) = 0;
 
+    /** Called with the results of a batch fetch.
+        The objects are in the order of the requested hashes, with
+        `nullptr` for those not present.
+    */
+    using BatchCallback = std::function <void (
+        std::vector <std::shared_ptr<NodeObject>> const&)>;
+
+    /** Fetch a group of objects without waiting.
+        Objects found in the cache are returned immediately. The
+        remaining reads are merged with the other pending reads and
+        issued to the backend in batches. Once every object is known
+        the callback is invoked, either on the calling thread or on
+        one of the read threads.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects to retrieve.
+        @param callback Receives the retrieved objects.
+    */
+    virtual void asyncFetchBatch (std::vector <uint256> const& hashes,
+        BatchCallback callback) = 0;
+
+    /** Fetch a group of objects, waiting for the reads to complete.
+        @see asyncFetchBatch
+    */
+    std::vector <std::shared_ptr<NodeObject>>
+    fetchBatch (std::vector <uint256> const& hashes)
+    {
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+        std::vector <std::shared_ptr<NodeObject>> result;
+
+        asyncFetchBatch (hashes,
+            [&](std::vector <std::shared_ptr<NodeObject>> const& objects)
+            {
+                std::lock_guard <std::mutex> lock (m);
+                result = objects;
+                done = true;
+                cv.notify_all ();
+            });
+
+        std::unique_lock <std::mutex> lock (m);
+        cv.wait (lock, [&]{ return done; });
+        return result;
+    }
+
     /** Wait for all currently pending async reads to complete.
     */
     virtual void waitReads () = 0;
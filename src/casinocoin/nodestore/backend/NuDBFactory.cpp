@@ -166,8 +166,11 @@ public:
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        // NuDB has no multi-key read, fetch one at a time
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        for (std::size_t i = 0; i < n; ++i)
+            fetch (keys[i], &results[i]);
+        return results;
     }
 
     void
@@ -69,8 +69,7 @@ public:
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        return std::vector<std::shared_ptr<NodeObject>> (n);
     }
 
     void
@@ -32,6 +32,7 @@
 #include <casinocoin/basics/KeyCache.h>
 #include <casinocoin/basics/chrono.h>
 #include <casinocoin/beast/core/CurrentThreadName.h>
+#include <map>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -46,11 +47,19 @@ private:
     std::unique_ptr <Backend> m_backend;
 protected:
     // Positive cache
-    TaggedCache <uint256, NodeObject> m_cache;
+    ShardedTaggedCache <uint256, NodeObject> m_cache;
 
     // Negative cache
     KeyCache <uint256> m_negCache;
 private:
+    // A batch fetch waiting for some of its reads
+    struct BatchRead
+    {
+        std::vector <std::shared_ptr<NodeObject>> objects;
+        std::size_t remaining = 0;
+        BatchCallback callback;
+    };
+
     std::mutex                m_readLock;
     std::condition_variable   m_readCondVar;
     std::condition_variable   m_readGenCondVar;
@@ -58,6 +67,9 @@ private:
     uint256                   m_readLast;       // last hash read
     std::vector <std::thread> m_readThreads;
     bool                      m_readShut;
+    // batch fetches waiting on each pending read
+    std::map <uint256, std::vector <std::pair <
+        std::shared_ptr <BatchRead>, std::size_t>>> m_readWaiters;
     uint64_t                  m_readGen;        // current read generation
     int                       fdlimit_;
     std::atomic <std::uint32_t> m_storeCount;
@@ -133,6 +145,52 @@ public:
         return false;
     }
 
+    void asyncFetchBatch (std::vector <uint256> const& hashes,
+        BatchCallback callback) override
+    {
+        auto batch = std::make_shared <BatchRead> ();
+        batch->objects.resize (hashes.size ());
+        batch->callback = std::move (callback);
+
+        std::vector <std::size_t> misses;
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            batch->objects[i] = m_cache.fetch (hashes[i]);
+            if (! batch->objects[i] && ! m_negCache.touch_if_exists (hashes[i]))
+                misses.push_back (i);
+        }
+
+        if (! misses.empty ())
+        {
+            {
+                // Post the reads, the read threads complete the batch
+                std::lock_guard <std::mutex> lock (m_readLock);
+                if (! m_readShut && ! m_readThreads.empty ())
+                {
+                    batch->remaining = misses.size ();
+                    for (auto const i : misses)
+                    {
+                        m_readWaiters[hashes[i]].emplace_back (batch, i);
+                        m_readSet.insert (hashes[i]);
+                    }
+                    m_readCondVar.notify_all ();
+                    return;
+                }
+            }
+
+            // No read threads to wait for, read on this one
+            std::vector <uint256> reads;
+            reads.reserve (misses.size ());
+            for (auto const i : misses)
+                reads.push_back (hashes[i]);
+            auto const objects = doTimedFetchBatch (reads);
+            for (std::size_t i = 0; i < misses.size (); ++i)
+                batch->objects[misses[i]] = objects[i];
+        }
+
+        batch->callback (batch->objects);
+    }
+
     void waitReads() override
     {
         {
@@ -231,6 +289,69 @@ public:
         return obj;
     }
 
+    /** Perform the reads for a batch and report the time they took */
+    std::vector <std::shared_ptr<NodeObject>>
+    doTimedFetchBatch (std::vector <uint256> const& hashes)
+    {
+        std::vector <std::shared_ptr<NodeObject>> objects (hashes.size ());
+
+        // Anything stored or read since the reads were
+        // posted doesn't have to go to the backend
+        std::vector <uint256> reads;
+        std::vector <std::size_t> indexes;
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            objects[i] = m_cache.fetch (hashes[i]);
+            if (! objects[i] && ! m_negCache.touch_if_exists (hashes[i]))
+            {
+                reads.push_back (hashes[i]);
+                indexes.push_back (i);
+            }
+        }
+
+        if (reads.empty ())
+            return objects;
+
+        auto const before = std::chrono::steady_clock::now();
+        auto found = fetchBatchFrom (reads);
+        m_fetchTotalCount += reads.size ();
+
+        FetchReport report;
+        report.isAsync = true;
+        report.wentToDisk = true;
+        report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+            (std::chrono::steady_clock::now() - before);
+
+        for (std::size_t i = 0; i < reads.size (); ++i)
+        {
+            auto& obj = found[i];
+            if (obj == nullptr)
+            {
+                // Just in case a write occurred
+                obj = m_cache.fetch (reads[i]);
+
+                if (obj == nullptr)
+                    m_negCache.insert (reads[i]);
+            }
+            else
+            {
+                // Ensure all threads get the same object
+                m_cache.canonicalize (reads[i], obj);
+            }
+
+            report.wasFound = (obj != nullptr);
+            m_scheduler.onFetch (report);
+
+            objects[indexes[i]] = std::move (obj);
+        }
+
+        JLOG(m_journal.trace()) <<
+            "Batch fetch: " << reads.size () << " reads in " <<
+            report.elapsed.count () << " ms";
+
+        return objects;
+    }
+
     virtual std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash)
     {
         return fetchInternal (*m_backend, hash);
@@ -268,6 +389,43 @@ public:
         return object;
     }
 
+    virtual std::vector <std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector <uint256> const& hashes)
+    {
+        return fetchBatchInternal (*m_backend, hashes);
+    }
+
+    std::vector <std::shared_ptr<NodeObject>>
+    fetchBatchInternal (Backend& backend, std::vector <uint256> const& hashes)
+    {
+        std::vector <std::shared_ptr<NodeObject>> objects;
+
+        if (! backend.canFetchBatch ())
+        {
+            objects.reserve (hashes.size ());
+            for (auto const& hash : hashes)
+                objects.push_back (fetchInternal (backend, hash));
+            return objects;
+        }
+
+        std::vector <void const*> keys;
+        keys.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            keys.push_back (hash.begin ());
+
+        objects = backend.fetchBatch (keys.size (), keys.data ());
+        for (auto const& object : objects)
+        {
+            if (object)
+            {
+                ++m_fetchHitCount;
+                m_fetchSize += object->getData().size();
+            }
+        }
+
+        return objects;
+    }
+
     //------------------------------------------------------------------------------
 
     void store (NodeObjectType type,
@@ -331,9 +489,11 @@ public:
     void threadEntry ()
     {
         beast::setCurrentThreadName ("prefetch");
+        std::vector <uint256> hashes;
+        hashes.reserve (batchReadSize);
         while (1)
         {
-            uint256 hash;
+            hashes.clear ();
 
             {
                 std::unique_lock <std::mutex> lock (m_readLock);
@@ -359,16 +519,51 @@ public:
                     m_readGenCondVar.notify_all ();
                 }
 
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
+                // Coalesce the pending reads that follow
+                while (it != m_readSet.end () && hashes.size () < batchReadSize)
+                {
+                    hashes.push_back (*it);
+                    it = m_readSet.erase (it);
+                }
+                m_readLast = hashes.back ();
             }
 
-            // Perform the read
-            doTimedFetch (hash, true);
+            // Perform the reads
+            completeReads (hashes, doTimedFetchBatch (hashes));
          }
      }
 
+    // Hand the results of reads to the batch fetches waiting for them
+    void completeReads (std::vector <uint256> const& hashes,
+        std::vector <std::shared_ptr<NodeObject>> const& objects)
+    {
+        std::vector <std::shared_ptr <BatchRead>> done;
+
+        {
+            std::lock_guard <std::mutex> lock (m_readLock);
+            if (m_readWaiters.empty ())
+                return;
+
+            for (std::size_t i = 0; i < hashes.size (); ++i)
+            {
+                auto it = m_readWaiters.find (hashes[i]);
+                if (it == m_readWaiters.end ())
+                    continue;
+
+                for (auto& waiter : it->second)
+                {
+                    waiter.first->objects[waiter.second] = objects[i];
+                    if (--waiter.first->remaining == 0)
+                        done.push_back (std::move (waiter.first));
+                }
+                m_readWaiters.erase (it);
+            }
+        }
+
+        for (auto const& batch : done)
+            batch->callback (batch->objects);
+    }
+
     //------------------------------------------------------------------------------
 
     void for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
@@ -462,6 +657,24 @@ protected:
 
         for (auto& e : m_readThreads)
             e.join();
+
+        // Reads that will not happen now complete as not found
+        std::vector <std::shared_ptr <BatchRead>> done;
+        {
+            std::lock_guard <std::mutex> lock (m_readLock);
+            for (auto& waiters : m_readWaiters)
+            {
+                for (auto& waiter : waiters.second)
+                {
+                    if (--waiter.first->remaining == 0)
+                        done.push_back (std::move (waiter.first));
+                }
+            }
+            m_readWaiters.clear ();
+        }
+
+        for (auto const& batch : done)
+            batch->callback (batch->objects);
     }
 };
 
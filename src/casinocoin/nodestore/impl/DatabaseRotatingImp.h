@@ -132,7 +132,9 @@ public:
     }
 
     std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash) override;
-    TaggedCache <uint256, NodeObject>& getPositiveCache() override
+    std::vector <std::shared_ptr<NodeObject>> fetchBatchFrom (
+        std::vector <uint256> const& hashes) override;
+    ShardedTaggedCache <uint256, NodeObject>& getPositiveCache() override
     {
         return m_cache;
     }
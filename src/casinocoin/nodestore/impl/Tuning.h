@@ -39,6 +39,9 @@ enum
 
     // Fraction of the cache one query source can take
     ,asyncDivider = 8
+
+    // Maximum number of pending reads passed to the backend at once
+    ,batchReadSize = 64
 };
 
 }
@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 
 namespace casinocoin {
@@ -49,6 +50,11 @@ namespace casinocoin {
 // a string prepended by a header specifying the message length.
 // MessageType should be a Message class generated by the protobuf compiler.
 //
+// When the high bit of the header is set the payload is lz4 compressed,
+// and starts with the size of the uncompressed payload in four bytes.
+// Only peers which offered compression during the handshake are sent
+// compressed messages.
+//
 
 class Message : public std::enable_shared_from_this <Message>
 {
@@ -60,14 +66,24 @@ public:
     */
     static size_t const kHeaderBytes = 6;
 
+    /** Payloads smaller than this are never compressed. */
+    static size_t const kCompressionThreshold = 512;
+
+    /** Largest uncompressed payload accepted from a peer. */
+    static size_t const kMaxUncompressedBytes = 64 * 1024 * 1024;
+
+    /** LZ4 can not expand its input by more than this factor. */
+    static size_t const kMaxCompressionRatio = 255;
+
     Message (::google::protobuf::Message const& message, int type);
 
-    /** Retrieve the packed message data. */
+    /** Retrieve the packed message data.
+
+        @param compressed `true` to get the compressed form, if the
+                          message is large enough and compresses well.
+    */
     std::vector <uint8_t> const&
-    getBuffer () const
-    {
-        return mBuffer;
-    }
+    getBuffer (bool compressed = false) const;
 
     /** Get the traffic category */
     int
@@ -89,15 +105,17 @@ public:
         FwdIter::value_type, std::uint8_t>::value, std::size_t>
     size (FwdIter first, FwdIter last)
     {
-        if (std::distance(first, last) <
+        auto const n = std::distance(first, last);
+        if (n < 0 || static_cast<std::size_t>(n) <
                 Message::kHeaderBytes)
             return 0;
-        std::size_t n;
-        n  = std::size_t{*first++} << 24;
-        n += std::size_t{*first++} << 16;
-        n += std::size_t{*first++} <<  8;
-        n += std::size_t{*first};
-        return n;
+        std::size_t size;
+        size  = std::size_t{static_cast<std::uint8_t>(
+            *first++ & ~kCompressedFlag)} << 24;
+        size += std::size_t{*first++} << 16;
+        size += std::size_t{*first++} <<  8;
+        size += std::size_t{*first};
+        return size;
     }
 
     template <class BufferSequence>
@@ -110,6 +128,39 @@ public:
     }
     /** @} */
 
+    /** Determine whether the payload of a packed message is compressed. */
+    /** @{ */
+    template <class FwdIter>
+    static
+    std::enable_if_t<std::is_same<typename
+        FwdIter::value_type, std::uint8_t>::value, bool>
+    compressed (FwdIter first, FwdIter last)
+    {
+        auto const n = std::distance(first, last);
+        if (n < 0 || static_cast<std::size_t>(n) <
+                Message::kHeaderBytes)
+            return false;
+        return (*first & kCompressedFlag) != 0;
+    }
+
+    template <class BufferSequence>
+    static
+    bool
+    compressed (BufferSequence const& buffers)
+    {
+        return compressed(buffers_begin(buffers),
+            buffers_end(buffers));
+    }
+    /** @} */
+
+    /** Decompress the payload of a compressed message.
+
+        @return `false` if the payload is malformed, or claims to be
+                larger than the limit or than LZ4 could produce.
+    */
+    static bool decompress (std::uint8_t const* in, std::size_t inSize,
+        std::vector <uint8_t>& out);
+
     /** Determine the type of a packed message. */
     /** @{ */
     static int getType (std::vector <uint8_t> const& buf);
@@ -120,7 +171,8 @@ public:
         FwdIter::value_type, std::uint8_t>::value, int>
     type (FwdIter first, FwdIter last)
     {
-        if (std::distance(first, last) <
+        auto const n = std::distance(first, last);
+        if (n < 0 || static_cast<std::size_t>(n) <
                 Message::kHeaderBytes)
             return 0;
         return (int{*std::next(first, 4)} << 8) |
@@ -138,6 +190,9 @@ public:
     /** @} */
 
 private:
+    // Set in the first header byte of compressed messages
+    static std::uint8_t const kCompressedFlag = 0x80;
+
     template <class BufferSequence, class Value = std::uint8_t>
     static
     boost::asio::buffers_iterator<BufferSequence, Value>
@@ -156,12 +211,20 @@ private:
             BufferSequence, Value>::end (buffers);
     }
 
-        // Encodes the size and type into a header at the beginning of buf
+    // Encodes the size and type into a header at the beginning of buf
     //
-    void encodeHeader (unsigned size, int type);
+    static void encodeHeader (std::vector <uint8_t>& buf,
+        unsigned size, int type, bool compressed);
+
+    // Builds the compressed buffer, if it saves any space
+    void compress () const;
 
     std::vector <uint8_t> mBuffer;
 
+    // Built on first use and shared by all peers accepting it
+    std::vector <uint8_t> mutable mBufferCompressed;
+    std::once_flag mutable mCompressOnce;
+
     int mCategory;
 };
 
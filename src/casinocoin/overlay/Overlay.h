@@ -165,7 +165,7 @@ public:
     virtual
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) = 0;
+        uint256 const& uid, PublicKey const& validator) = 0;
 
     /** Visit every active peer and return a value
         The functor must:
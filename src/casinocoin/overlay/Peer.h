@@ -31,6 +31,8 @@
 #include <casinocoin/json/json_value.h>
 #include <casinocoin/protocol/PublicKey.h>
 #include <casinocoin/beast/net/IPEndpoint.h>
+#include <boost/optional.hpp>
+#include <chrono>
 
 namespace casinocoin {
 
@@ -87,6 +89,11 @@ public:
     bool
     isHighLatency() const = 0;
 
+    /** Returns the round trip time measured with pings, if known. */
+    virtual
+    boost::optional<std::chrono::milliseconds>
+    getLatency() const = 0;
+
     virtual
     int
     getScore (bool) const = 0;
@@ -109,6 +116,9 @@ public:
     virtual void cycleStatus () = 0;
     virtual bool supportsVersion (int version) = 0;
     virtual bool hasRange (std::uint32_t uMin, std::uint32_t uMax) = 0;
+
+    /** Returns `true` if ledger deltas can be requested from this peer. */
+    virtual bool supportsLedgerReplay () const = 0;
 };
 
 }
@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_OVERLAY_SQUELCH_H_INCLUDED
+#define CASINOCOIN_OVERLAY_SQUELCH_H_INCLUDED
+
+#include <casinocoin/basics/random.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace casinocoin {
+
+/** Chooses the peers which relay a validator's messages to us.
+
+    Proposals and validations are flooded, so every message from a
+    validator arrives once from nearly every peer. A slot per validator
+    counts the messages each peer delivers. Once enough peers have each
+    delivered a number of them, a few are selected at random to keep
+    relaying that validator and the others are squelched: asked to stop
+    relaying its messages for a random while. If a selected peer
+    disconnects or goes quiet, the squelched peers are released and the
+    slot starts counting again.
+
+    Squelched peers are expected to go quiet and are only forgotten once
+    their squelch expires; if they send anyway they are not counted.
+
+    @tparam Key Identifies a validator.
+    @tparam PeerID Identifies a peer.
+    @tparam Clock The clock providing the time points passed in.
+*/
+template <class Key, class PeerID, class Clock>
+class SquelchSlots
+{
+public:
+    using time_point = typename Clock::time_point;
+
+    struct Setup
+    {
+        /** Messages a peer delivers before it can be selected */
+        std::size_t messageThreshold = 20;
+
+        /** Number of peers selected to relay a validator's messages */
+        std::size_t selectedPeers = 3;
+
+        /** Squelches last a random time in this range */
+        std::chrono::seconds minSquelch {300};
+        std::chrono::seconds maxSquelch {600};
+
+        /** Peers which have not relayed a validator for this long are
+            removed from its slot */
+        std::chrono::seconds idle {8};
+    };
+
+    /** Squelch a validator on a peer, or release it if the duration is 0 */
+    using Handler = std::function <
+        void (Key const&, PeerID const&, std::chrono::seconds)>;
+
+    SquelchSlots (Setup const& setup, Handler handler)
+        : setup_ (setup)
+        , handler_ (std::move (handler))
+    {
+    }
+
+    /** A message from a validator arrived from a peer. */
+    void
+    update (Key const& key, PeerID const& id, time_point now)
+    {
+        auto& slot = slots_[key];
+        auto& peer = slot.peers[id];
+        if (peer.state == State::squelched)
+        {
+            if (now < peer.expire)
+                return;
+            peer.state = State::counting;
+            peer.count = 0;
+        }
+        peer.last = now;
+
+        if (slot.selected)
+        {
+            // A peer showing up after the selection
+            if (peer.state == State::counting)
+                squelch (key, id, peer, now);
+            return;
+        }
+
+        if (++peer.count < setup_.messageThreshold)
+            return;
+
+        std::vector<PeerID> ready;
+        for (auto const& p : slot.peers)
+        {
+            if (p.second.state == State::counting &&
+                    p.second.count >= setup_.messageThreshold)
+                ready.push_back (p.first);
+        }
+        if (ready.size () < setup_.selectedPeers)
+            return;
+
+        std::shuffle (ready.begin (), ready.end (), default_prng ());
+        ready.resize (setup_.selectedPeers);
+        slot.selected = true;
+        for (auto& p : slot.peers)
+        {
+            if (std::find (ready.begin (), ready.end (), p.first) !=
+                    ready.end ())
+                p.second.state = State::selected;
+            else if (p.second.state == State::counting)
+                squelch (key, p.first, p.second, now);
+        }
+    }
+
+    /** A peer disconnected. */
+    void
+    deletePeer (PeerID const& id)
+    {
+        for (auto iter = slots_.begin (); iter != slots_.end ();)
+        {
+            auto& slot = iter->second;
+            auto const peer = slot.peers.find (id);
+            if (peer != slot.peers.end ())
+            {
+                auto const selected = peer->second.state == State::selected;
+                slot.peers.erase (peer);
+                if (selected)
+                    reset (iter->first, slot);
+            }
+
+            if (slot.peers.empty ())
+                iter = slots_.erase (iter);
+            else
+                ++iter;
+        }
+    }
+
+    /** Forget peers and validators which have gone quiet. */
+    void
+    deleteIdle (time_point now)
+    {
+        for (auto iter = slots_.begin (); iter != slots_.end ();)
+        {
+            auto& slot = iter->second;
+            bool lostSelected = false;
+            for (auto peer = slot.peers.begin ();
+                peer != slot.peers.end ();)
+            {
+                auto const& p = peer->second;
+                bool const idle = (p.state == State::squelched) ?
+                    now >= p.expire : now - p.last > setup_.idle;
+                if (idle)
+                {
+                    lostSelected |= p.state == State::selected;
+                    peer = slot.peers.erase (peer);
+                }
+                else
+                {
+                    ++peer;
+                }
+            }
+            if (lostSelected)
+                reset (iter->first, slot);
+
+            if (slot.peers.empty ())
+                iter = slots_.erase (iter);
+            else
+                ++iter;
+        }
+    }
+
+    /** Number of validators being tracked */
+    std::size_t
+    size () const
+    {
+        return slots_.size ();
+    }
+
+    /** Peers selected to relay a validator's messages */
+    std::vector<PeerID>
+    selected (Key const& key) const
+    {
+        return peers (key, State::selected);
+    }
+
+    /** Peers squelched for a validator */
+    std::vector<PeerID>
+    squelched (Key const& key) const
+    {
+        return peers (key, State::squelched);
+    }
+
+private:
+    enum class State
+    {
+        counting,
+        selected,
+        squelched
+    };
+
+    struct Peer
+    {
+        State state = State::counting;
+        std::size_t count = 0;
+        time_point last;
+        time_point expire;
+    };
+
+    struct Slot
+    {
+        std::map<PeerID, Peer> peers;
+        bool selected = false;
+    };
+
+    void
+    squelch (Key const& key, PeerID const& id, Peer& peer, time_point now)
+    {
+        auto const duration = std::chrono::seconds (rand_int (
+            setup_.minSquelch.count (), setup_.maxSquelch.count ()));
+        peer.state = State::squelched;
+        peer.expire = now + duration;
+        handler_ (key, id, duration);
+    }
+
+    // Release the squelched peers and count again
+    void
+    reset (Key const& key, Slot& slot)
+    {
+        slot.selected = false;
+        for (auto& p : slot.peers)
+        {
+            if (p.second.state == State::squelched)
+                handler_ (key, p.first, std::chrono::seconds (0));
+            p.second.state = State::counting;
+            p.second.count = 0;
+        }
+    }
+
+    std::vector<PeerID>
+    peers (Key const& key, State state) const
+    {
+        std::vector<PeerID> ret;
+        auto const iter = slots_.find (key);
+        if (iter != slots_.end ())
+        {
+            for (auto const& p : iter->second.peers)
+                if (p.second.state == state)
+                    ret.push_back (p.first);
+        }
+        return ret;
+    }
+
+    Setup const setup_;
+    Handler const handler_;
+    std::map<Key, Slot> slots_;
+};
+
+/** Validators whose messages a peer asked us not to relay to it. */
+template <class Key, class Clock>
+class Squelched
+{
+public:
+    using time_point = typename Clock::time_point;
+
+    void
+    squelch (Key const& key, std::chrono::seconds duration, time_point now)
+    {
+        if (duration.count () == 0)
+            squelched_.erase (key);
+        else
+            squelched_[key] = now + duration;
+    }
+
+    /** Returns `true` if the validator's messages must not be relayed */
+    bool
+    isSquelched (Key const& key, time_point now)
+    {
+        auto const iter = squelched_.find (key);
+        if (iter == squelched_.end ())
+            return false;
+        if (now < iter->second)
+            return true;
+        squelched_.erase (iter);
+        return false;
+    }
+
+private:
+    std::map<Key, time_point> squelched_;
+};
+
+} // casinocoin
+
+#endif
@@ -26,6 +26,7 @@
 #include <BeastConfig.h>
 #include <casinocoin/overlay/Message.h>
 #include <casinocoin/overlay/impl/TrafficCount.h>
+#include <lz4/lib/lz4.h>
 #include <cstdint>
 
 namespace casinocoin {
@@ -38,7 +39,7 @@ Message::Message (::google::protobuf::Message const& message, int type)
 
     mBuffer.resize (kHeaderBytes + messageBytes);
 
-    encodeHeader (messageBytes, type);
+    encodeHeader (mBuffer, messageBytes, type, false);
 
     if (messageBytes != 0)
     {
@@ -49,6 +50,69 @@ Message::Message (::google::protobuf::Message const& message, int type)
         (message, type, false));
 }
 
+std::vector <uint8_t> const&
+Message::getBuffer (bool compressed) const
+{
+    if (! compressed ||
+            mBuffer.size () < kHeaderBytes + kCompressionThreshold)
+        return mBuffer;
+
+    std::call_once (mCompressOnce, [this] { compress (); });
+
+    if (mBufferCompressed.empty ())
+        return mBuffer;
+    return mBufferCompressed;
+}
+
+void Message::compress () const
+{
+    auto const payload = mBuffer.size () - kHeaderBytes;
+    auto const bound = LZ4_compressBound (static_cast<int> (payload));
+
+    std::vector <uint8_t> buf (kHeaderBytes + 4 + bound);
+    auto const n = LZ4_compress_default (
+        reinterpret_cast<char const*> (&mBuffer[kHeaderBytes]),
+        reinterpret_cast<char*> (&buf[kHeaderBytes + 4]),
+        static_cast<int> (payload), bound);
+
+    // Send it uncompressed unless that saves something
+    if (n <= 0 || static_cast<std::size_t> (n) + 4 >= payload)
+        return;
+
+    buf.resize (kHeaderBytes + 4 + n);
+    encodeHeader (buf, n + 4, getType (mBuffer), true);
+    buf[kHeaderBytes + 0] = static_cast<std::uint8_t> ((payload >> 24) & 0xFF);
+    buf[kHeaderBytes + 1] = static_cast<std::uint8_t> ((payload >> 16) & 0xFF);
+    buf[kHeaderBytes + 2] = static_cast<std::uint8_t> ((payload >> 8) & 0xFF);
+    buf[kHeaderBytes + 3] = static_cast<std::uint8_t> (payload & 0xFF);
+    mBufferCompressed = std::move (buf);
+}
+
+bool Message::decompress (std::uint8_t const* in, std::size_t inSize,
+    std::vector <uint8_t>& out)
+{
+    if (inSize < 4)
+        return false;
+
+    std::size_t size;
+    size  = std::size_t{in[0]} << 24;
+    size += std::size_t{in[1]} << 16;
+    size += std::size_t{in[2]} <<  8;
+    size += std::size_t{in[3]};
+
+    // Check the claimed size before allocating for it
+    if (size == 0 || size > kMaxUncompressedBytes ||
+            size > kMaxCompressionRatio * (inSize - 4))
+        return false;
+
+    out.resize (size);
+    return LZ4_decompress_safe (
+        reinterpret_cast<char const*> (in + 4),
+        reinterpret_cast<char*> (out.data ()),
+        static_cast<int> (inSize - 4),
+        static_cast<int> (size)) == static_cast<int> (size);
+}
+
 bool Message::operator== (Message const& other) const
 {
     return mBuffer == other.mBuffer;
@@ -60,7 +124,7 @@ unsigned Message::getLength (std::vector <uint8_t> const& buf)
 
     if (buf.size () >= Message::kHeaderBytes)
     {
-        result = buf [0];
+        result = buf [0] & ~kCompressedFlag;
         result <<= 8;
         result |= buf [1];
         result <<= 8;
@@ -87,15 +151,19 @@ int Message::getType (std::vector<uint8_t> const& buf)
     return ret;
 }
 
-void Message::encodeHeader (unsigned size, int type)
+void Message::encodeHeader (std::vector <uint8_t>& buf,
+    unsigned size, int type, bool compressed)
 {
-    assert (mBuffer.size () >= Message::kHeaderBytes);
-    mBuffer[0] = static_cast<std::uint8_t> ((size >> 24) & 0xFF);
-    mBuffer[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
-    mBuffer[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
-    mBuffer[3] = static_cast<std::uint8_t> (size & 0xFF);
-    mBuffer[4] = static_cast<std::uint8_t> ((type >> 8) & 0xFF);
-    mBuffer[5] = static_cast<std::uint8_t> (type & 0xFF);
+    assert (buf.size () >= Message::kHeaderBytes);
+    assert ((size >> 24) < kCompressedFlag);
+    buf[0] = static_cast<std::uint8_t> ((size >> 24) & 0xFF);
+    buf[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
+    buf[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
+    buf[3] = static_cast<std::uint8_t> (size & 0xFF);
+    buf[4] = static_cast<std::uint8_t> ((type >> 8) & 0xFF);
+    buf[5] = static_cast<std::uint8_t> (type & 0xFF);
+    if (compressed)
+        buf[0] |= kCompressedFlag;
 }
 
 }
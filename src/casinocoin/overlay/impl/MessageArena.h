@@ -0,0 +1,179 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_OVERLAY_MESSAGEARENA_H_INCLUDED
+#define CASINOCOIN_OVERLAY_MESSAGEARENA_H_INCLUDED
+
+#include "casinocoin.pb.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Arenas are always enabled from protobuf 3.14, before that they
+// need an option in the .proto which older compilers reject.
+#if GOOGLE_PROTOBUF_VERSION >= 3014000
+#include <google/protobuf/arena.h>
+#define CASINOCOIN_PROTOBUF_ARENA 1
+#else
+#define CASINOCOIN_PROTOBUF_ARENA 0
+#endif
+
+namespace casinocoin {
+
+/** Memory for the protocol messages received on one connection.
+
+    Messages are parsed onto an arena whose first block is reused from
+    one message to the next, so that parsing a typical message does not
+    touch the heap. A handler which holds on to a message keeps its
+    arena alive; the connection then starts a new one for the next
+    message.
+
+    Without arena support in protobuf every message is allocated on
+    the heap, as before.
+*/
+class MessageArena
+{
+public:
+    /** Size of the block reused for each message */
+    static std::size_t const blockBytes = 4096;
+
+    /** Largest decompression buffer kept between messages */
+    static std::size_t const maxBufferBytes = 262144;
+
+    MessageArena () = default;
+    MessageArena (MessageArena const&) = delete;
+    MessageArena& operator= (MessageArena const&) = delete;
+
+    /** Create an empty message of type T for parsing. */
+    template <class T>
+    std::shared_ptr<T>
+    create ()
+    {
+#if CASINOCOIN_PROTOBUF_ARENA
+        if (! block_)
+        {
+            ++counter ();
+            block_ = std::make_shared<Block> ();
+        }
+        return std::shared_ptr<T> (block_,
+            google::protobuf::Arena::CreateMessage<T> (&block_->arena));
+#else
+        ++counter ();
+        return std::make_shared<T> ();
+#endif
+    }
+
+    /** Release the messages created since the last call.
+
+        The caller must have dropped its own references to them.
+    */
+    void
+    reset ()
+    {
+#if CASINOCOIN_PROTOBUF_ARENA
+        if (block_.use_count () == 1)
+            block_->arena.Reset ();
+        else
+            block_.reset ();
+#endif
+    }
+
+    /** Scratch space for decompressing a payload. */
+    std::vector<std::uint8_t>&
+    buffer ()
+    {
+        if (buffer_.capacity () > maxBufferBytes)
+            std::vector<std::uint8_t>().swap (buffer_);
+        buffer_.clear ();
+        return buffer_;
+    }
+
+    /** Heap allocations made for message storage since startup.
+
+        Counts arena blocks, or whole messages without arenas. The
+        fields of heap allocated messages are not included.
+    */
+    static
+    std::uint64_t
+    allocations ()
+    {
+        return counter ();
+    }
+
+private:
+    static
+    std::atomic<std::uint64_t>&
+    counter ()
+    {
+        static std::atomic<std::uint64_t> n {0};
+        return n;
+    }
+
+#if CASINOCOIN_PROTOBUF_ARENA
+    struct Block
+    {
+        alignas(std::max_align_t) char memory[blockBytes];
+        google::protobuf::Arena arena;
+
+        Block ()
+            : arena (options (memory))
+        {
+        }
+
+        static
+        google::protobuf::ArenaOptions
+        options (char* memory)
+        {
+            google::protobuf::ArenaOptions o;
+            o.initial_block = memory;
+            o.initial_block_size = blockBytes;
+            o.block_alloc = &allocate;
+            o.block_dealloc = &deallocate;
+            return o;
+        }
+
+        static
+        void*
+        allocate (std::size_t size)
+        {
+            ++counter ();
+            return ::operator new (size);
+        }
+
+        static
+        void
+        deallocate (void* p, std::size_t)
+        {
+            ::operator delete (p);
+        }
+    };
+
+    std::shared_ptr<Block> block_;
+#endif
+
+    std::vector<std::uint8_t> buffer_;
+};
+
+} // casinocoin
+
+#endif
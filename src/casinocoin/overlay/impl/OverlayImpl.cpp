@@ -131,6 +131,8 @@ OverlayImpl::Timer::on_timer (error_code ec)
     if ((++overlay_.timer_count_ % Tuning::checkSeconds) == 0)
         overlay_.check();
 
+    overlay_.deleteIdleSlots();
+
     timer_.expires_from_now (std::chrono::seconds(1));
     timer_.async_wait(overlay_.strand_.wrap(std::bind(
         &Timer::on_timer, shared_from_this(),
@@ -162,6 +164,12 @@ OverlayImpl::OverlayImpl (
     , m_resolver (resolver)
     , next_id_(1)
     , timer_count_(0)
+    , slots_ (Slots::Setup{},
+        [this](PublicKey const& validator, Peer::id_t id,
+            std::chrono::seconds duration)
+        {
+            pendingSquelches_.emplace_back (validator, id, duration);
+        })
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
 }
@@ -592,6 +600,27 @@ OverlayImpl::onChildrenStopped ()
 void
 OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
 {
+    if (auto const writes = m_traffic.getWrites())
+    {
+        beast::PropertyStream::Map item ("writes", stream);
+        item["count"] = beast::lexicalCast<std::string> (writes);
+        item["messages_per_write"] = beast::lexicalCast<std::string>
+            (static_cast<double> (m_traffic.getMessagesWritten()) / writes);
+        item["bytes_per_write"] = beast::lexicalCast<std::string>
+            (m_traffic.getBytesWritten() / writes);
+    }
+
+    {
+        beast::PropertyStream::Map item ("squelch", stream);
+        item["duplicates"] = beast::lexicalCast<std::string> (
+            duplicates_.load());
+        item["squelched"] = beast::lexicalCast<std::string> (
+            squelched_.load());
+        std::lock_guard <std::mutex> lock (squelchMutex_);
+        item["validators"] = beast::lexicalCast<std::string> (
+            slots_.size());
+    }
+
     beast::PropertyStream::Set set ("traffic", stream);
     auto stats = m_traffic.getCounts();
     for (auto& i : stats)
@@ -610,6 +639,12 @@ OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
         item["bytes_out"] =
             beast::lexicalCast<std::string>
                 (i.second.bytesOut.load());
+        item["bytes_in_uncompressed"] =
+            beast::lexicalCast<std::string>
+                (i.second.bytesInUncompressed.load());
+        item["bytes_out_uncompressed"] =
+            beast::lexicalCast<std::string>
+                (i.second.bytesOutUncompressed.load());
         item["messages_out"] =
             beast::lexicalCast<std::string>
                 (i.second.messagesOut.load());
@@ -650,6 +685,8 @@ OverlayImpl::activate (std::shared_ptr<PeerImp> const& peer)
 void
 OverlayImpl::onPeerDeactivate (Peer::id_t id)
 {
+    deleteSlotPeer (id);
+
     std::lock_guard <decltype(mutex_)> lock (mutex_);
     ids_.erase(id);
 }
@@ -731,9 +768,16 @@ void
 OverlayImpl::reportTraffic (
     TrafficCount::category cat,
     bool isInbound,
-    int number)
+    int number,
+    int uncompressed)
+{
+    m_traffic.addCount (cat, isInbound, number, uncompressed);
+}
+
+void
+OverlayImpl::reportWrite (std::size_t messages, std::size_t bytes)
 {
-    m_traffic.addCount (cat, isInbound, number);
+    m_traffic.addWrite (messages, bytes);
 }
 
 std::size_t
@@ -932,20 +976,25 @@ OverlayImpl::relay (protocol::TMProposeSet& m,
     auto const toSkip = app_.getHashRouter().shouldRelay(uid);
     if (!toSkip)
         return;
+    PublicKey const validator (makeSlice(m.nodepubkey()));
     auto const sm = std::make_shared<Message>(
         m, protocol::mtPROPOSE_LEDGER);
     for_each([&](std::shared_ptr<PeerImp>&& p)
     {
         if (toSkip->find(p->id()) != toSkip->end())
             return;
-        if (! m.has_hops() || p->hopsAware())
+        if (m.has_hops() && ! p->hopsAware())
+            return;
+        if (p->isSquelched(validator))
+            ++squelched_;
+        else
             p->send(sm);
     });
 }
 
 void
 OverlayImpl::relay (protocol::TMValidation& m,
-    uint256 const& uid)
+    uint256 const& uid, PublicKey const& validator)
 {
     if (m.has_hops() && m.hops() >= maxTTL)
         return;
@@ -958,11 +1007,84 @@ OverlayImpl::relay (protocol::TMValidation& m,
     {
         if (toSkip->find(p->id()) != toSkip->end())
             return;
-        if (! m.has_hops() || p->hopsAware())
+        if (m.has_hops() && ! p->hopsAware())
+            return;
+        if (p->isSquelched(validator))
+            ++squelched_;
+        else
             p->send(sm);
     });
 }
 
+void
+OverlayImpl::updateSlot (PublicKey const& validator, PeerImp const& from,
+    bool duplicate)
+{
+    if (duplicate)
+        ++duplicates_;
+
+    if (! from.squelchEnabled() || ! app_.validators().trusted(validator))
+        return;
+
+    Squelches squelches;
+    {
+        std::lock_guard <std::mutex> lock (squelchMutex_);
+        slots_.update (validator, from.id(), clock_type::now());
+        squelches.swap (pendingSquelches_);
+    }
+    sendSquelches (squelches);
+}
+
+void
+OverlayImpl::deleteSlotPeer (Peer::id_t id)
+{
+    Squelches squelches;
+    {
+        std::lock_guard <std::mutex> lock (squelchMutex_);
+        slots_.deletePeer (id);
+        squelches.swap (pendingSquelches_);
+    }
+    sendSquelches (squelches);
+}
+
+void
+OverlayImpl::deleteIdleSlots()
+{
+    Squelches squelches;
+    {
+        std::lock_guard <std::mutex> lock (squelchMutex_);
+        slots_.deleteIdle (clock_type::now());
+        squelches.swap (pendingSquelches_);
+    }
+    sendSquelches (squelches);
+}
+
+void
+OverlayImpl::sendSquelches (Squelches const& squelches)
+{
+    for (auto const& s : squelches)
+    {
+        auto const peer = findPeerByShortID (std::get<1>(s));
+        if (! peer)
+            continue;
+
+        auto const& validator = std::get<0>(s);
+        auto const duration = std::get<2>(s);
+        JLOG(journal_.debug()) <<
+            (duration.count() ? "Squelch " : "Unsquelch ") <<
+            toBase58 (TokenType::TOKEN_NODE_PUBLIC, validator) <<
+            " on peer " << std::get<1>(s);
+
+        protocol::TMSquelch m;
+        m.set_squelch (duration.count() != 0);
+        m.set_validatorpubkey (validator.data(), validator.size());
+        if (m.squelch())
+            m.set_squelchduration (
+                static_cast<std::uint32_t>(duration.count()));
+        peer->send (std::make_shared<Message> (m, protocol::mtSQUELCH));
+    }
+}
+
 //------------------------------------------------------------------------------
 
 void
@@ -29,6 +29,7 @@
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/core/Job.h>
 #include <casinocoin/overlay/Overlay.h>
+#include <casinocoin/overlay/Squelch.h>
 #include <casinocoin/overlay/impl/TrafficCount.h>
 #include <casinocoin/server/Handoff.h>
 #include <casinocoin/rpc/ServerHandler.h>
@@ -48,7 +49,9 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 namespace casinocoin {
 
@@ -77,8 +80,10 @@ public:
         virtual void stop() = 0;
     };
 
-private:
     using clock_type = std::chrono::steady_clock;
+    using Slots = SquelchSlots <PublicKey, Peer::id_t, clock_type>;
+
+private:
     using socket_type = boost::asio::ip::tcp::socket;
     using address_type = boost::asio::ip::address;
     using endpoint_type = boost::asio::ip::tcp::endpoint;
@@ -125,6 +130,16 @@ private:
     std::atomic <Peer::id_t> next_id_;
     int timer_count_;
 
+    // Squelches are sent once squelchMutex_ is released, since
+    // peers may be destroyed while mutex_ is held
+    using Squelches = std::vector <std::tuple <
+        PublicKey, Peer::id_t, std::chrono::seconds>>;
+    std::mutex squelchMutex_;
+    Slots slots_;
+    Squelches pendingSquelches_;
+    std::atomic <std::uint64_t> duplicates_ {0};
+    std::atomic <std::uint64_t> squelched_ {0};
+
     //--------------------------------------------------------------------------
 
 public:
@@ -191,7 +206,7 @@ public:
 
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) override;
+        uint256 const& uid, PublicKey const& validator) override;
 
     //--------------------------------------------------------------------------
     //
@@ -266,7 +281,28 @@ public:
     reportTraffic (
         TrafficCount::category cat,
         bool isInbound,
-        int bytes);
+        int bytes,
+        int uncompressedBytes);
+
+    void
+    reportWrite (std::size_t messages, std::size_t bytes);
+
+    /** Count a proposal or validation a peer relayed to us.
+
+        Messages from trusted validators update the validator's slot,
+        which may squelch the validator on some peers.
+
+        @param validator The key which signed the message.
+        @param from The peer the message arrived from.
+        @param duplicate `true` if another peer relayed it first.
+    */
+    void
+    updateSlot (PublicKey const& validator, PeerImp const& from,
+        bool duplicate);
+
+    /** Release the slots of a disconnected peer */
+    void
+    deleteSlotPeer (Peer::id_t id);
 
 private:
     std::shared_ptr<Writer>
@@ -342,6 +378,12 @@ private:
 
     void
     sendEndpoints();
+
+    void
+    sendSquelches (Squelches const& squelches);
+
+    void
+    deleteIdleSlots();
 };
 
 } // casinocoin
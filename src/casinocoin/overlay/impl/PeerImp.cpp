@@ -29,11 +29,13 @@
 #include <casinocoin/overlay/impl/Tuning.h>
 #include <casinocoin/app/ledger/InboundLedgers.h>
 #include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/ledger/LedgerReplay.h>
 #include <casinocoin/consensus/LedgerTiming.h>
 #include <casinocoin/app/ledger/InboundTransactions.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/app/misc/TxVerifier.h>
 #include <casinocoin/app/misc/Transaction.h>
 #include <casinocoin/app/misc/Validations.h>
 #include <casinocoin/app/misc/ValidatorList.h>
@@ -98,6 +100,13 @@ PeerImp::PeerImp (Application& app, id_t id, endpoint_type remote_endpoint,
     , slot_ (slot)
     , request_(std::move(request))
     , headers_(request_.fields)
+    , send_queue_ (Tuning::sendBatchMessages, Tuning::sendBatchBytes)
+    , compressionEnabled_ (app_.config().COMPRESSION &&
+        hello_.has_compression() && hello_.compression())
+    , squelchEnabled_ (app_.config().SQUELCH &&
+        hello_.has_squelch() && hello_.squelch())
+    , ledgerReplayEnabled_ (app_.config().LEDGER_REPLAY &&
+        hello_.has_ledgerreplay() && hello_.ledgerreplay())
 {
 }
 
@@ -205,7 +214,8 @@ PeerImp::send (Message::pointer const& m)
 
     overlay_.reportTraffic (
         static_cast<TrafficCount::category>(m->getCategory()),
-        false, static_cast<int>(m->getBuffer().size()));
+        false, static_cast<int>(m->getBuffer(compressionEnabled_).size()),
+        static_cast<int>(m->getBuffer().size()));
 
     auto sendq_size = send_queue_.size();
 
@@ -228,11 +238,7 @@ PeerImp::send (Message::pointer const& m)
     if(sendq_size != 0)
         return;
 
-    boost::asio::async_write (stream_, boost::asio::buffer(
-        send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
-            &PeerImp::onWriteMessage, shared_from_this(),
-                beast::asio::placeholders::error,
-                    beast::asio::placeholders::bytes_transferred)));
+    sendQueued();
 }
 
 void
@@ -248,6 +254,13 @@ PeerImp::charge (Resource::Charge const& fee)
 
 //------------------------------------------------------------------------------
 
+bool
+PeerImp::isSquelched (PublicKey const& validator)
+{
+    std::lock_guard<std::mutex> lock (squelchLock_);
+    return squelched_.isSquelched (validator, clock_type::now());
+}
+
 bool
 PeerImp::crawl() const
 {
@@ -761,9 +774,13 @@ PeerImp::onReadMessage (error_code ec, std::size_t bytes_transferred)
 
     while (read_buffer_.size() > 0)
     {
+        // Only decompress what we agreed to receive
+        if (! compressionEnabled_ && Message::compressed (read_buffer_.data()))
+            return fail("onReadMessage: Compression not negotiated");
+
         std::size_t bytes_consumed;
         std::tie(bytes_consumed, ec) = invokeProtocolMessage(
-            read_buffer_.data(), *this);
+            read_buffer_.data(), *this, read_arena_);
         if (ec)
             return fail("onReadMessage", ec);
         if (! stream_.next_layer().is_open())
@@ -799,16 +816,12 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
             stream << "onWriteMessage";
     }
 
-    assert(! send_queue_.empty());
-    send_queue_.pop();
+    assert(send_queue_.writing() != 0);
+    overlay_.reportWrite (send_queue_.consume(), bytes_transferred);
     if (! send_queue_.empty())
     {
         // Timeout on writes only
-        return boost::asio::async_write (stream_, boost::asio::buffer(
-            send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
-                &PeerImp::onWriteMessage, shared_from_this(),
-                    beast::asio::placeholders::error,
-                        beast::asio::placeholders::bytes_transferred)));
+        return sendQueued();
     }
 
     if (gracefulClose_)
@@ -819,6 +832,16 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
     }
 }
 
+void
+PeerImp::sendQueued ()
+{
+    boost::asio::async_write (stream_,
+        send_queue_.prepare(compressionEnabled_), strand_.wrap(std::bind(
+            &PeerImp::onWriteMessage, shared_from_this(),
+                beast::asio::placeholders::error,
+                    beast::asio::placeholders::bytes_transferred)));
+}
+
 //------------------------------------------------------------------------------
 //
 // ProtocolHandler
@@ -836,13 +859,13 @@ PeerImp::onMessageUnknown (std::uint16_t type)
 PeerImp::error_code
 PeerImp::onMessageBegin (std::uint16_t type,
     std::shared_ptr <::google::protobuf::Message> const& m,
-    std::size_t size)
+    std::size_t size, std::size_t uncompressedSize)
 {
     load_event_ = app_.getJobQueue ().makeLoadEvent (
         jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
     overlay_.reportTraffic (TrafficCount::categorize (*m, type, true),
-        true, static_cast<int>(size));
+        true, static_cast<int>(size), static_cast<int>(uncompressedSize));
     return error_code{};
 }
 
@@ -1116,15 +1139,29 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
         {
             JLOG(p_journal_.trace()) << "No new transactions until synchronized";
         }
+        else if (checkSignature)
+        {
+            // The verification stage checks the signature, leaving
+            // only the cheaper checks to checkTransaction.
+            if (! app_.getOPs().getTxVerifier().verify (stx,
+                app_.getLedgerMaster().getValidatedRules(),
+                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+                flags] (std::shared_ptr<STTx const> const& stx) {
+                    if (auto peer = weak.lock())
+                        peer->checkTransaction(flags, true, stx);
+                }))
+            {
+                JLOG(p_journal_.info()) << "Transaction verification queue is full";
+            }
+        }
         else
         {
             app_.getJobQueue ().addJob (
                 jtTRANSACTION, "recvTransaction->checkTransaction",
                 [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                flags, checkSignature, stx] (Job&) {
+                flags, stx] (Job&) {
                     if (auto peer = weak.lock())
-                        peer->checkTransaction(flags,
-                            checkSignature, stx);
+                        peer->checkTransaction(flags, false, stx);
                 });
         }
     }
@@ -1259,6 +1296,7 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMProposeSet> const& m)
     if (! app_.getHashRouter ().addSuppressionPeer (suppression, id_))
     {
         JLOG(p_journal_.trace()) << "Proposal: duplicate";
+        overlay_.updateSlot (publicKey, *this, true);
         return;
     }
 
@@ -1593,6 +1631,7 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMValidation> const& m)
             sha512Half(makeSlice(m->validation())), id_))
         {
             JLOG(p_journal_.trace()) << "Validation: duplicate";
+            overlay_.updateSlot (val->getSignerPublic (), *this, true);
             return;
         }
 
@@ -1761,6 +1800,48 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
     }
 }
 
+void
+PeerImp::onMessage (std::shared_ptr <protocol::TMSquelch> const& m)
+{
+    if (! squelchEnabled_)
+    {
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
+
+    auto const key = makeSlice (m->validatorpubkey());
+    if (! publicKeyType (key))
+    {
+        JLOG(p_journal_.debug()) << "Squelch: malformed";
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+
+    // Without a duration a squelch would clear the one in place
+    if (m->squelch() &&
+        (! m->has_squelchduration() || m->squelchduration() == 0))
+    {
+        JLOG(p_journal_.debug()) << "Squelch: no duration";
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+
+    // Squelches never outlast what we would ask of a peer
+    std::chrono::seconds duration {0};
+    if (m->squelch())
+    {
+        duration = std::min (
+            std::chrono::seconds (m->squelchduration()),
+            OverlayImpl::Slots::Setup{}.maxSquelch);
+    }
+
+    JLOG(p_journal_.trace()) << (m->squelch() ? "Squelch " : "Unsquelch ") <<
+        toBase58 (TokenType::TOKEN_NODE_PUBLIC, PublicKey (key));
+
+    std::lock_guard<std::mutex> lock (squelchLock_);
+    squelched_.squelch (PublicKey (key), duration, clock_type::now());
+}
+
 //--------------------------------------------------------------------------
 
 void
@@ -1912,6 +1993,7 @@ PeerImp::checkPropose (Job& job,
 
     if (isTrusted)
     {
+        overlay_.updateSlot (peerPos->getPublicKey (), *this, false);
         app_.getOPs ().processTrustedProposal (
             peerPos, packet, calcNodeID (publicKey_));
     }
@@ -1948,9 +2030,12 @@ PeerImp::checkValidation (STValidation::pointer val,
             return;
         }
 
+        if (isTrusted)
+            overlay_.updateSlot (val->getSignerPublic (), *this, false);
+
         if (app_.getOPs ().recvValidation(
                 val, std::to_string(id())))
-            overlay_.relay(*packet, signingHash);
+            overlay_.relay(*packet, signingHash, val->getSignerPublic ());
     }
     catch (std::exception const&)
     {
@@ -2243,6 +2328,32 @@ PeerImp::getLedger (std::shared_ptr<protocol::TMGetLedger> const& m)
             return;
         }
 
+        if (packet.itype () == protocol::liDELTA)
+        {
+            // they want to replay the ledger from its parent
+            JLOG(p_journal_.trace()) << "GetLedger: Delta";
+            auto const parent = app_.getLedgerMaster ().getLedgerByHash (
+                ledger->info().parentHash);
+            if (! parent || ! makeLedgerDelta (
+                *ledger, *parent, reply, Tuning::maxReplyNodes))
+            {
+                // Send the header, they'll fetch the rest node by node
+                JLOG(p_journal_.debug()) << "GetLedger: No delta " << logMe;
+                Serializer nData (128);
+                addRaw(ledger->info(), nData);
+                reply.clear_nodes ();
+                reply.clear_txcount ();
+                reply.add_nodes ()->set_nodedata (
+                    nData.getDataPtr (), nData.getLength ());
+                reply.set_error (protocol::reNO_NODE);
+            }
+
+            Message::pointer oPacket = std::make_shared<Message> (
+                reply, protocol::mtLEDGER_DATA);
+            send (oPacket);
+            return;
+        }
+
         if (packet.itype () == protocol::liTX_NODE)
         {
             map = &ledger->txMap ();
@@ -2400,4 +2511,13 @@ PeerImp::isHighLatency() const
     return latency_.count() >= Tuning::peerHighLatency;
 }
 
+boost::optional<std::chrono::milliseconds>
+PeerImp::getLatency() const
+{
+    std::lock_guard<std::mutex> sl (recentLock_);
+    if (latency_ == std::chrono::milliseconds (-1))
+        return boost::none;
+    return latency_;
+}
+
 } // casinocoin
@@ -30,8 +30,11 @@
 #include <casinocoin/basics/Log.h> // deprecated
 #include <casinocoin/nodestore/Database.h>
 #include <casinocoin/overlay/predicates.h>
+#include <casinocoin/overlay/impl/MessageArena.h>
 #include <casinocoin/overlay/impl/ProtocolMessage.h>
 #include <casinocoin/overlay/impl/OverlayImpl.h>
+#include <casinocoin/overlay/impl/SendQueue.h>
+#include <casinocoin/overlay/impl/Tuning.h>
 #include <casinocoin/resource/Fees.h>
 #include <casinocoin/core/Config.h>
 #include <casinocoin/core/Job.h>
@@ -158,17 +161,31 @@ private:
     Resource::Charge fee_;
     PeerFinder::Slot::ptr slot_;
     beast::streambuf read_buffer_;
+    MessageArena read_arena_;
     http_request_type request_;
     http_response_type response_;
     beast::http::fields const& headers_;
     beast::streambuf write_buffer_;
-    std::queue<Message::pointer> send_queue_;
+    SendQueue send_queue_;
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     int no_ping_ = 0;
     std::unique_ptr <LoadEvent> load_event_;
     bool hopsAware_ = false;
 
+    // Both ends offered lz4 compressed messages
+    bool const compressionEnabled_;
+
+    // Both ends accept squelch messages
+    bool const squelchEnabled_;
+
+    // We replay ledgers and the peer serves deltas
+    bool const ledgerReplayEnabled_;
+
+    // Validators whose messages this peer asked us not to relay
+    std::mutex squelchLock_;
+    Squelched <PublicKey, clock_type> squelched_;
+
     friend class OverlayImpl;
 
 public:
@@ -264,6 +281,17 @@ public:
         return hopsAware_;
     }
 
+    bool
+    squelchEnabled() const
+    {
+        return squelchEnabled_;
+    }
+
+    /** Returns `true` if the peer asked us not to relay the
+        validator's proposals and validations */
+    bool
+    isSquelched (PublicKey const& validator);
+
     void
     check();
 
@@ -324,6 +352,12 @@ public:
     bool
     hasRange (std::uint32_t uMin, std::uint32_t uMax) override;
 
+    bool
+    supportsLedgerReplay () const override
+    {
+        return ledgerReplayEnabled_;
+    }
+
     // Called to determine our priority for querying
     int
     getScore (bool haveItem) const override;
@@ -331,6 +365,9 @@ public:
     bool
     isHighLatency() const override;
 
+    boost::optional<std::chrono::milliseconds>
+    getLatency() const override;
+
     void
     fail(std::string const& reason);
 
@@ -385,6 +422,10 @@ private:
     void
     onReadMessage (error_code ec, std::size_t bytes_transferred);
 
+    // Write the next batch of queued messages
+    void
+    sendQueued ();
+
     // Called when protocol messages bytes are sent
     void
     onWriteMessage (error_code ec, std::size_t bytes_transferred);
@@ -410,7 +451,7 @@ public:
     error_code
     onMessageBegin (std::uint16_t type,
         std::shared_ptr <::google::protobuf::Message> const& m,
-        std::size_t size);
+        std::size_t size, std::size_t uncompressedSize);
 
     void
     onMessageEnd (std::uint16_t type,
@@ -431,6 +472,7 @@ public:
     void onMessage (std::shared_ptr <protocol::TMHaveTransactionSet> const& m);
     void onMessage (std::shared_ptr <protocol::TMValidation> const& m);
     void onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m);
+    void onMessage (std::shared_ptr <protocol::TMSquelch> const& m);
 
 private:
     State state() const
@@ -509,6 +551,13 @@ PeerImp::PeerImp (Application& app, std::unique_ptr<beast::asio::ssl_bundle>&& s
     , slot_ (std::move(slot))
     , response_(std::move(response))
     , headers_(response_.fields)
+    , send_queue_ (Tuning::sendBatchMessages, Tuning::sendBatchBytes)
+    , compressionEnabled_ (app_.config().COMPRESSION &&
+        hello_.has_compression() && hello_.compression())
+    , squelchEnabled_ (app_.config().SQUELCH &&
+        hello_.has_squelch() && hello_.squelch())
+    , ledgerReplayEnabled_ (app_.config().LEDGER_REPLAY &&
+        hello_.has_ledgerreplay() && hello_.ledgerreplay())
 {
     read_buffer_.commit (boost::asio::buffer_copy(read_buffer_.prepare(
         boost::asio::buffer_size(buffers)), buffers));
@@ -28,10 +28,12 @@
 
 #include "casinocoin.pb.h"
 #include <casinocoin/overlay/Message.h>
+#include <casinocoin/overlay/impl/MessageArena.h>
 #include <casinocoin/overlay/impl/ZeroCopyStream.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -63,6 +65,7 @@ protocolMessageName (int type)
     case protocol::mtHAVE_SET:          return "have_set";
     case protocol::mtVALIDATION:        return "validation";
     case protocol::mtGET_OBJECTS:       return "get_objects";
+    case protocol::mtSQUELCH:           return "squelch";
     default:
         break;
     };
@@ -71,26 +74,84 @@ protocolMessageName (int type)
 
 namespace detail {
 
+// Returns the start of the bytes at offset if they are not split
+// across buffers in the sequence, otherwise nullptr.
+template <class Buffers>
+std::uint8_t const*
+contiguous (Buffers const& buffers, std::size_t offset, std::size_t size)
+{
+    for (auto const& buffer : buffers)
+    {
+        boost::asio::const_buffer const b (buffer);
+        auto const n = boost::asio::buffer_size (b);
+        if (offset < n)
+        {
+            if (n - offset < size)
+                return nullptr;
+            return boost::asio::buffer_cast<
+                std::uint8_t const*>(b) + offset;
+        }
+        offset -= n;
+    }
+    return nullptr;
+}
+
 template <class T, class Buffers, class Handler>
 std::enable_if_t<std::is_base_of<
     ::google::protobuf::Message, T>::value,
         boost::system::error_code>
 invoke (int type, Buffers const& buffers,
-    Handler& handler)
+    Handler& handler, MessageArena& arena)
 {
-    ZeroCopyInputStream<Buffers> stream(buffers);
-    stream.Skip(Message::kHeaderBytes);
-    auto const m (std::make_shared<T>());
-    if (! m->ParseFromZeroCopyStream(&stream))
-        return boost::system::errc::make_error_code(
-            boost::system::errc::invalid_argument);
-    auto ec = handler.onMessageBegin (type, m,
-       Message::kHeaderBytes + Message::size (buffers));
+    auto m (arena.create<T>());
+    auto const size = Message::kHeaderBytes + Message::size (buffers);
+    auto uncompressed = size;
+    auto const payload = contiguous (buffers,
+        Message::kHeaderBytes, size - Message::kHeaderBytes);
+    if (Message::compressed (buffers))
+    {
+        auto& data = arena.buffer ();
+        bool ok;
+        if (payload)
+        {
+            ok = Message::decompress (
+                payload, size - Message::kHeaderBytes, data);
+        }
+        else
+        {
+            std::vector<std::uint8_t> copy (size - Message::kHeaderBytes);
+            std::copy_n (std::next (boost::asio::buffers_begin (buffers),
+                Message::kHeaderBytes), copy.size (), copy.begin ());
+            ok = Message::decompress (copy.data (), copy.size (), data);
+        }
+        if (! ok || ! m->ParseFromArray (data.data (), data.size ()))
+            return boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+        uncompressed = Message::kHeaderBytes + data.size ();
+    }
+    else if (payload)
+    {
+        if (! m->ParseFromArray (payload, size - Message::kHeaderBytes))
+            return boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+    }
+    else
+    {
+        ZeroCopyInputStream<Buffers> stream(buffers);
+        stream.Skip(Message::kHeaderBytes);
+        if (! m->ParseFromZeroCopyStream(&stream))
+            return boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+    }
+    auto ec = handler.onMessageBegin (type, m, size, uncompressed);
     if (! ec)
     {
         handler.onMessage (m);
         handler.onMessageEnd (type, m);
     }
+    // The arena can only be reused if the handler kept no reference
+    m.reset ();
+    arena.reset ();
     return ec;
 }
 
@@ -100,12 +161,15 @@ invoke (int type, Buffers const& buffers,
 
     If there is insufficient data to produce a complete protocol
     message, zero is returned for the number of bytes consumed.
+    The message is parsed onto the passed arena, which is reset
+    once the handler returns.
 
     @return The number of bytes consumed, or the error code if any.
 */
 template <class Buffers, class Handler>
 std::pair <std::size_t, boost::system::error_code>
-invokeProtocolMessage (Buffers const& buffers, Handler& handler)
+invokeProtocolMessage (Buffers const& buffers, Handler& handler,
+    MessageArena& arena)
 {
     std::pair<std::size_t,boost::system::error_code> result = { 0, {} };
     boost::system::error_code& ec = result.second;
@@ -119,21 +183,22 @@ invokeProtocolMessage (Buffers const& buffers, Handler& handler)
 
     switch (type)
     {
-    case protocol::mtHELLO:         ec = detail::invoke<protocol::TMHello> (type, buffers, handler); break;
-    case protocol::mtMANIFESTS:     ec = detail::invoke<protocol::TMManifests> (type, buffers, handler); break;
-    case protocol::mtPING:          ec = detail::invoke<protocol::TMPing> (type, buffers, handler); break;
-    case protocol::mtCLUSTER:       ec = detail::invoke<protocol::TMCluster> (type, buffers, handler); break;
-    case protocol::mtGET_PEERS:     ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler); break;
-    case protocol::mtPEERS:         ec = detail::invoke<protocol::TMPeers> (type, buffers, handler); break;
-    case protocol::mtENDPOINTS:     ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler); break;
-    case protocol::mtTRANSACTION:   ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler); break;
-    case protocol::mtGET_LEDGER:    ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler); break;
-    case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler); break;
-    case protocol::mtPROPOSE_LEDGER:ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler); break;
-    case protocol::mtSTATUS_CHANGE: ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler); break;
-    case protocol::mtHAVE_SET:      ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler); break;
-    case protocol::mtVALIDATION:    ec = detail::invoke<protocol::TMValidation> (type, buffers, handler); break;
-    case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler); break;
+    case protocol::mtHELLO:         ec = detail::invoke<protocol::TMHello> (type, buffers, handler, arena); break;
+    case protocol::mtMANIFESTS:     ec = detail::invoke<protocol::TMManifests> (type, buffers, handler, arena); break;
+    case protocol::mtPING:          ec = detail::invoke<protocol::TMPing> (type, buffers, handler, arena); break;
+    case protocol::mtCLUSTER:       ec = detail::invoke<protocol::TMCluster> (type, buffers, handler, arena); break;
+    case protocol::mtGET_PEERS:     ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler, arena); break;
+    case protocol::mtPEERS:         ec = detail::invoke<protocol::TMPeers> (type, buffers, handler, arena); break;
+    case protocol::mtENDPOINTS:     ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler, arena); break;
+    case protocol::mtTRANSACTION:   ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler, arena); break;
+    case protocol::mtGET_LEDGER:    ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler, arena); break;
+    case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler, arena); break;
+    case protocol::mtPROPOSE_LEDGER:ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler, arena); break;
+    case protocol::mtSTATUS_CHANGE: ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler, arena); break;
+    case protocol::mtHAVE_SET:      ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler, arena); break;
+    case protocol::mtVALIDATION:    ec = detail::invoke<protocol::TMValidation> (type, buffers, handler, arena); break;
+    case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler, arena); break;
+    case protocol::mtSQUELCH:       ec = detail::invoke<protocol::TMSquelch> (type, buffers, handler, arena); break;
     default:
         ec = handler.onMessageUnknown (type);
         break;
@@ -144,6 +209,15 @@ invokeProtocolMessage (Buffers const& buffers, Handler& handler)
     return result;
 }
 
+/** Calls the handler for up to one protocol message in the passed buffers. */
+template <class Buffers, class Handler>
+std::pair <std::size_t, boost::system::error_code>
+invokeProtocolMessage (Buffers const& buffers, Handler& handler)
+{
+    MessageArena arena;
+    return invokeProtocolMessage (buffers, handler, arena);
+}
+
 /** Write a protocol message to a streambuf. */
 template <class Streambuf>
 void
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_OVERLAY_SENDQUEUE_H_INCLUDED
+#define CASINOCOIN_OVERLAY_SENDQUEUE_H_INCLUDED
+
+#include <casinocoin/overlay/Message.h>
+#include <boost/asio/buffer.hpp>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace casinocoin {
+
+/** Messages waiting to be written to a peer.
+
+    Consecutive messages at the front of the queue are written together,
+    up to a number of messages and bytes. A batch is copied into a single
+    buffer, since the SSL stream encrypts only the first buffer of a
+    sequence per write: this way a burst of small messages costs one
+    system call and one TLS record instead of one each. A message which
+    alone reaches the byte limit is written from its own buffer.
+
+    Only one write may be in progress at a time.
+*/
+class SendQueue
+{
+public:
+    SendQueue (std::size_t maxMessages, std::size_t maxBytes)
+        : maxMessages_ (maxMessages)
+        , maxBytes_ (maxBytes)
+    {
+        assert (maxMessages_ > 0);
+    }
+
+    /** Number of messages queued, including those being written */
+    std::size_t
+    size () const
+    {
+        return queue_.size ();
+    }
+
+    bool
+    empty () const
+    {
+        return queue_.empty ();
+    }
+
+    void
+    push (Message::pointer const& m)
+    {
+        queue_.push_back (m);
+    }
+
+    /** Number of messages in the write in progress */
+    std::size_t
+    writing () const
+    {
+        return writing_;
+    }
+
+    /** Take the next batch of messages for writing.
+
+        @param compressed `true` to write the compressed form of messages.
+
+        @return The buffer to write, which remains valid until `consume`.
+    */
+    boost::asio::const_buffer
+    prepare (bool compressed)
+    {
+        assert (writing_ == 0 && ! queue_.empty ());
+
+        auto const& first = queue_.front ()->getBuffer (compressed);
+        std::size_t bytes = first.size ();
+        std::size_t n = 1;
+        while (n < queue_.size () && n < maxMessages_)
+        {
+            auto const size = queue_[n]->getBuffer (compressed).size ();
+            if (bytes + size > maxBytes_)
+                break;
+            bytes += size;
+            ++n;
+        }
+
+        writing_ = n;
+        if (n == 1)
+            return boost::asio::buffer (first);
+
+        buffer_.clear ();
+        buffer_.reserve (bytes);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const& b = queue_[i]->getBuffer (compressed);
+            buffer_.insert (buffer_.end (), b.begin (), b.end ());
+        }
+        return boost::asio::buffer (buffer_);
+    }
+
+    /** Remove the messages of the completed write.
+
+        @return The number of messages written.
+    */
+    std::size_t
+    consume ()
+    {
+        assert (writing_ != 0 && writing_ <= queue_.size ());
+        auto const n = writing_;
+        queue_.erase (queue_.begin (), queue_.begin () + n);
+        writing_ = 0;
+        return n;
+    }
+
+private:
+    std::size_t const maxMessages_;
+    std::size_t const maxBytes_;
+    std::deque<Message::pointer> queue_;
+    std::vector<std::uint8_t> buffer_;
+    std::size_t writing_ = 0;
+};
+
+} // casinocoin
+
+#endif
@@ -127,6 +127,12 @@ buildHello (
     // h.set_ipv4port (portNumber); // ignored now
     h.set_testnet (false); // never used but left for backwards compatability
     h.set_peernetwork(app.config().PEER_NETWORK);
+    if (app.config().COMPRESSION)
+        h.set_compression (true);
+    if (app.config().SQUELCH)
+        h.set_squelch (true);
+    if (app.config().LEDGER_REPLAY)
+        h.set_ledgerreplay (true);
 
     if (remote.is_v4())
     {
@@ -195,6 +201,15 @@ appendHello (beast::http::fields& h,
 
     if (hello.has_peernetwork())
         h.insert ("Peer-Network", std::to_string(hello.peernetwork()));
+
+    if (hello.has_compression() && hello.compression())
+        h.insert ("X-Offer-Compression", "lz4");
+
+    if (hello.has_squelch() && hello.squelch())
+        h.insert ("X-Offer-Squelch", "1");
+
+    if (hello.has_ledgerreplay() && hello.ledgerreplay())
+        h.insert ("X-Offer-Ledger-Replay", "1");
 }
 
 std::vector<ProtocolVersion>
@@ -356,6 +371,30 @@ parseHello (bool request, beast::http::fields const& h, beast::Journal journal)
         }
     }
 
+    {
+        auto const iter = h.find ("X-Offer-Compression");
+        if (iter != h.end())
+        {
+            for (auto const& s : beast::rfc2616::split_commas(iter->second))
+            {
+                if (beast::detail::ci_equal(s, "lz4"))
+                    hello.set_compression (true);
+            }
+        }
+    }
+
+    {
+        auto const iter = h.find ("X-Offer-Squelch");
+        if (iter != h.end() && iter->second == "1")
+            hello.set_squelch (true);
+    }
+
+    {
+        auto const iter = h.find ("X-Offer-Ledger-Replay");
+        if (iter != h.end() && iter->second == "1")
+            hello.set_ledgerreplay (true);
+    }
+
     return hello;
 }
 
@@ -72,7 +72,8 @@ TrafficCount::category TrafficCount::categorize (
     if ((type == protocol::mtMANIFESTS) ||
             (type == protocol::mtENDPOINTS) ||
             (type == protocol::mtPEERS) ||
-            (type == protocol::mtGET_PEERS))
+            (type == protocol::mtGET_PEERS) ||
+            (type == protocol::mtSQUELCH))
         return TrafficCount::category::CT_overlay;
 
     if (type == protocol::mtTRANSACTION)
@@ -49,8 +49,13 @@ public:
         count_t messagesIn;
         count_t messagesOut;
 
+        // What bytesIn and bytesOut would have been without compression
+        count_t bytesInUncompressed;
+        count_t bytesOutUncompressed;
+
         TrafficStats() : bytesIn(0), bytesOut(0),
-            messagesIn(0), messagesOut(0)
+            messagesIn(0), messagesOut(0),
+            bytesInUncompressed(0), bytesOutUncompressed(0)
         { ; }
 
         TrafficStats(const TrafficStats& ts)
@@ -58,6 +63,8 @@ public:
             , bytesOut (ts.bytesOut.load())
             , messagesIn (ts.messagesIn.load())
             , messagesOut (ts.messagesOut.load())
+            , bytesInUncompressed (ts.bytesInUncompressed.load())
+            , bytesOutUncompressed (ts.bytesOutUncompressed.load())
         { ; }
 
         operator bool () const
@@ -87,20 +94,49 @@ public:
         ::google::protobuf::Message const& message,
         int type, bool inbound);
 
-    void addCount (category cat, bool inbound, int number)
+    void addCount (category cat, bool inbound, int number,
+        int uncompressed)
     {
         if (inbound)
         {
             counts_[cat].bytesIn += number;
+            counts_[cat].bytesInUncompressed += uncompressed;
             ++counts_[cat].messagesIn;
         }
         else
         {
             counts_[cat].bytesOut += number;
+            counts_[cat].bytesOutUncompressed += uncompressed;
             ++counts_[cat].messagesOut;
         }
     }
 
+    /** Record a write of queued messages to a peer */
+    void addWrite (std::size_t messages, std::size_t bytes)
+    {
+        ++writes_;
+        messagesWritten_ += messages;
+        bytesWritten_ += bytes;
+    }
+
+    /** Number of writes of queued messages to peers */
+    unsigned long getWrites () const
+    {
+        return writes_.load ();
+    }
+
+    /** Number of messages written by those writes */
+    unsigned long getMessagesWritten () const
+    {
+        return messagesWritten_.load ();
+    }
+
+    /** Number of bytes written by those writes */
+    unsigned long getBytesWritten () const
+    {
+        return bytesWritten_.load ();
+    }
+
     TrafficCount()
     {
         for (category i = category::CT_base;
@@ -130,6 +166,10 @@ public:
     protected:
 
     std::map <category, TrafficStats> counts_;
+
+    count_t writes_ {0};
+    count_t messagesWritten_ {0};
+    count_t bytesWritten_ {0};
 };
 
 }
@@ -80,6 +80,12 @@ enum
 
     /** How often to log send queue size */
     sendQueueLogFreq    =    64,
+
+    /** Most queued messages written to a peer in one write */
+    sendBatchMessages   =    64,
+
+    /** Most bytes of queued messages written to a peer in one write */
+    sendBatchBytes      = 65536,
 };
 
 } // Tuning
@@ -55,7 +55,11 @@ JSS ( OfferSequence );              // field.
 JSS ( Paths );                      // in/out: TransactionSign
 JSS ( TransferRate );               // in: TransferRate
 JSS ( historical_perminute );       // historical_perminute
+JSS ( SLE_cache_bytes );            // out: GetCounts
+JSS ( SLE_cache_size );             // out: GetCounts
 JSS ( SLE_hit_rate );               // out: GetCounts
+JSS ( SLE_hits );                   // out: GetCounts
+JSS ( SLE_misses );                 // out: GetCounts
 JSS ( SettleDelay );                // in: TransactionSign
 JSS ( SendMax );                    // in: TransactionSign
 JSS ( Sequence );                   // in/out: TransactionSign; field.
@@ -90,6 +94,7 @@ JSS ( amendment_blocked );          // out: NetworkOPs
 JSS ( amendments );                 // in: AccountObjects, out: NetworkOPs
 JSS ( amount );                     // out: AccountChannels
 JSS ( apiEndpoint );                // out: Configuration
+JSS ( apply_ms );                   // out: NetworkOPs
 JSS ( asks );                       // out: Subscribe
 JSS ( assets );                     // out: GatewayBalances
 JSS ( authorized );                 // out: AccountLines
@@ -108,12 +113,14 @@ JSS ( both );                       // in: Subscribe, Unsubscribe
 JSS ( both_sides );                 // in: Subscribe, Unsubscribe
 JSS ( build_path );                 // in: TransactionSign
 JSS ( build_version );              // out: NetworkOPs
+JSS ( bytes_per_second );           // out: FetchScheduler
 JSS ( cancel_after );               // out: AccountChannels
 JSS ( can_delete );                 // out: CanDelete
 JSS ( channel_id );                 // out: AccountChannels
 JSS ( channels );                   // out: AccountChannels
 JSS ( check_nodes );                // in: LedgerCleaner
 JSS ( clear );                      // in/out: FetchInfo
+JSS ( close_breakdown );            // out: NetworkOPs
 JSS ( close_flags );                // out: LedgerToJson
 JSS ( close_time );                 // in: Application, out: NetworkOPs,
                                     //      CCLCxPeerPos, LedgerToJson
@@ -190,6 +197,9 @@ JSS ( first );                      // out: rpc/Version
 JSS ( fix_txns );                   // in: LedgerCleaner
 JSS ( flags );                      // out: paths/Node, AccountOffers,
                                     //      NetworkOPs
+JSS ( flush_state_ms );             // out: NetworkOPs
+JSS ( flush_threads );              // out: NetworkOPs
+JSS ( flush_tx_ms );                // out: NetworkOPs
 JSS ( forward );                    // in: AccountTx
 JSS ( freeze );                     // out: AccountLines
 JSS ( freeze_peer );                // out: AccountLines
@@ -210,6 +220,7 @@ JSS ( highest_sequence );           // out: AccountInfo
 JSS ( hostid );                     // out: NetworkOPs
 JSS ( hotwallet );                  // in: GatewayBalances
 JSS ( iconURL );                    // out: Configuration
+JSS ( in_flight );                  // out: FetchScheduler
 JSS ( id );                         // websocket.
 JSS ( ident );                      // in: AccountCurrencies, AccountInfo,
                                     //     OwnerInfo
@@ -269,6 +280,7 @@ JSS ( load_factor_server );         // out: NetworkOPs
 JSS ( load_fee );                   // out: LoadFeeTrackImp, NetworkOPs
 JSS ( local );                      // out: resource/Logic.h
 JSS ( local_txs );                  // out: GetCounts
+JSS ( lost );                       // out: FetchScheduler
 JSS ( lowest_sequence );            // out: AccountInfo
 JSS ( majority );                   // out: RPC feature
 JSS ( marker );                     // in/out: AccountTx, AccountOffers,
@@ -310,6 +322,7 @@ JSS ( node_reads_total );           // out: GetCounts
 JSS ( node_writes );                // out: GetCounts
 JSS ( node_written_bytes );         // out: GetCounts
 JSS ( nodes );                      // out: PathState
+JSS ( nodes_per_second );           // out: FetchScheduler
 JSS ( obligations );                // out: GatewayBalances
 JSS ( offer );                      // in: LedgerEntry
 JSS ( offers );                     // out: NetworkOPs, AccountOffers, Subscribe
@@ -326,6 +339,16 @@ JSS ( parent_hash );                // out: LedgerToJson
 JSS ( partition );                  // in: LogLevel
 JSS ( passphrase );                 // in: WalletPropose
 JSS ( password );                   // in: Subscribe
+JSS ( path_cache_hit_rate );        // out: GetCounts
+JSS ( path_cache_hits );            // out: GetCounts
+JSS ( path_cache_misses );          // out: GetCounts
+JSS ( path_cache_size );            // out: GetCounts
+JSS ( pathfind_ledger_ms );         // out: GetCounts
+JSS ( pathfind_update_max_ms );     // out: GetCounts
+JSS ( pathfind_update_p50_ms );     // out: GetCounts
+JSS ( pathfind_update_p90_ms );     // out: GetCounts
+JSS ( pathfind_update_p99_ms );     // out: GetCounts
+JSS ( pathfind_updates );           // out: GetCounts
 JSS ( paths );                      // in: CasinocoinPathFind
 JSS ( paths_canonical );            // out: CasinocoinPathFind
 JSS ( paths_computed );             // out: PathRequest, CasinocoinPathFind
@@ -356,6 +379,7 @@ JSS ( receive_currencies );         // out: AccountCurrencies
 JSS ( reference_level );            // out: TxQ
 JSS ( regular_seed );               // in/out: LedgerEntry
 JSS ( remote );                     // out: Logic.h
+JSS ( replies );                    // out: FetchScheduler
 JSS ( request );                    // RPC
 JSS ( reserve_base );               // out: NetworkOPs
 JSS ( reserve_base_csc );           // out: NetworkOPs
@@ -363,6 +387,7 @@ JSS ( reserve_inc );                // out: NetworkOPs
 JSS ( reserve_inc_csc );            // out: NetworkOPs
 JSS ( response );                   // websocket
 JSS ( result );                     // RPC
+JSS ( retried );                    // out: FetchScheduler
 JSS ( casinocoin_lines );               // out: NetworkOPs
 JSS ( casinocoin_state );               // in: LedgerEntr
 JSS ( casinocoinrpc );                  // casinocoin RPC version
@@ -400,6 +425,7 @@ JSS ( stand_alone );                // out: NetworkOPs
 JSS ( start );                      // in: TxHistory
 JSS ( state );                      // out: Logic.h, ServerState, LedgerData
 JSS ( state_accounting );           // out: NetworkOPs
+JSS ( state_nodes );                // out: NetworkOPs
 JSS ( state_now );                  // in: Subscribe
 JSS ( status );                     // error
 JSS ( stop );                       // in: LedgerCleaner
@@ -417,8 +443,10 @@ JSS ( taker_gets_funded );          // out: NetworkOPs
 JSS ( taker_pays );                 // in: Subscribe, Unsubscribe, BookOffers
 JSS ( taker_pays_funded );          // out: NetworkOPs
 JSS ( threshold );                  // in: Blacklist
+JSS ( throughput );                 // out: InboundLedgers
 JSS ( ticket );                     // in: AccountObjects
 JSS ( timeouts );                   // out: InboundLedger
+JSS ( total_ms );                   // out: NetworkOPs
 JSS ( traffic );                    // out: Overlay
 JSS ( token );                      // out: RPC token
 JSS ( totalCoins );                 // out: LedgerToJson
@@ -432,6 +460,9 @@ JSS ( transactions );               // out: LedgerToJson,
                                     // in: AccountTx*, Unsubscribe
 JSS ( transitions );                // out: NetworkOPs
 JSS ( treenode_cache_size );        // out: GetCounts
+JSS ( treenode_inner_bytes );       // out: GetCounts
+JSS ( treenode_inner_count );       // out: GetCounts
+JSS ( treenode_inner_node_bytes );  // out: GetCounts
 JSS ( treenode_track_size );        // out: GetCounts
 JSS ( trusted );                    // out: UnlList
 JSS ( tx );                         // out: STTx, AccountTx*
@@ -440,6 +471,7 @@ JSS ( tx_blob );                    // in/out: Submit,
 JSS ( tx_hash );                    // in: TransactionEntry
 JSS ( tx_json );                    // in/out: TransactionSign
                                     // out: TransactionEntry
+JSS ( tx_nodes );                   // out: NetworkOPs
 JSS ( tx_signing_hash );            // out: TransactionSign
 JSS ( tx_unsigned );                // out: TransactionSign
 JSS ( txn_count );                  // out: NetworkOPs
@@ -467,11 +499,16 @@ JSS ( validation_quorum );          // out: NetworkOPs
 JSS ( validation_seed );            // out: ValidationCreate, ValidationSeed
 JSS ( validations );                // out: AmendmentTableImpl
 JSS ( value );                      // out: STAmount
+JSS ( verify_batched );             // out: GetCounts
+JSS ( verify_queue );               // out: GetCounts
+JSS ( verify_rate );                // out: GetCounts
+JSS ( verify_total );               // out: GetCounts
 JSS ( version );                    // out: RPCVersion
 JSS ( vetoed );                     // out: AmendmentTableImpl
 JSS ( vote );                       // in: Feature
 JSS ( warning );                    // rpc:
 JSS ( website );                    // out: Configuration
+JSS ( window );                     // out: FetchScheduler
 JSS ( write_load );                 // out: GetCounts
 
 JSS ( last_refresh_time );          // out: Remote Update Sites
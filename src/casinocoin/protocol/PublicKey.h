@@ -37,6 +37,7 @@
 #include <cstring>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 namespace casinocoin {
 
@@ -247,6 +248,28 @@ verify (PublicKey const& publicKey,
     Slice const& sig,
     bool mustBeFullyCanonical = true);
 
+/** Verify a batch of Ed25519 signatures.
+
+    Shares the expensive curve arithmetic across the batch when all
+    signatures are valid. A failed batch falls back to checking each
+    signature on its own, so a `false` result always matches verify.
+
+    A `true` result does not: the batch equation multiplies out the
+    small order part of a signature, so it can accept a signature
+    that verify rejects. Confirm with verify before trusting one.
+
+    @param publicKeys The Ed25519 public keys.
+    @param messages The signed messages, one per key.
+    @param sigs The signatures, one per key.
+
+    @return The result of each verification, in order.
+*/
+std::vector<bool>
+verifyEd25519Batch (
+    std::vector<PublicKey> const& publicKeys,
+    std::vector<Slice> const& messages,
+    std::vector<Slice> const& sigs);
+
 /** Calculate the 160-bit node ID from a node public key. */
 NodeID
 calcNodeID (PublicKey const&);
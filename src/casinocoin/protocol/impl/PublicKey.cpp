@@ -310,6 +310,56 @@ verify (PublicKey const& publicKey,
     return false;
 }
 
+std::vector<bool>
+verifyEd25519Batch (
+    std::vector<PublicKey> const& publicKeys,
+    std::vector<Slice> const& messages,
+    std::vector<Slice> const& sigs)
+{
+    auto const n = publicKeys.size();
+    assert (messages.size() == n && sigs.size() == n);
+
+    std::vector<bool> result (n, false);
+
+    // Only well formed entries take part in the batch, the
+    // others are rejected exactly as verify would reject them.
+    std::vector<std::size_t> index;
+    std::vector<unsigned char const*> m;
+    std::vector<std::size_t> mlen;
+    std::vector<unsigned char const*> pk;
+    std::vector<unsigned char const*> rs;
+    index.reserve (n);
+    m.reserve (n);
+    mlen.reserve (n);
+    pk.reserve (n);
+    rs.reserve (n);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (publicKeyType (publicKeys[i]) != KeyType::ed25519 ||
+                ! ed25519Canonical (sigs[i]))
+            continue;
+        index.push_back (i);
+        m.push_back (messages[i].data());
+        mlen.push_back (messages[i].size());
+        // Strip our 0xED key type prefix
+        pk.push_back (publicKeys[i].data() + 1);
+        rs.push_back (sigs[i].data());
+    }
+
+    if (index.empty())
+        return result;
+
+    std::vector<int> valid (index.size(), 0);
+    ed25519_sign_open_batch (m.data(), mlen.data(), pk.data(),
+        rs.data(), index.size(), valid.data());
+
+    for (std::size_t i = 0; i < index.size(); ++i)
+        result[index[i]] = valid[i] == 1;
+
+    return result;
+}
+
 NodeID
 calcNodeID (PublicKey const& pk)
 {
@@ -30,15 +30,32 @@
 #include <casinocoin/net/InfoSub.h>
 #include <casinocoin/rpc/Context.h>
 #include <casinocoin/rpc/Status.h>
+#include <functional>
+
+namespace Json {
+class Object;
+}
 
 namespace casinocoin {
 namespace RPC {
 
 struct Context;
 
+/** Writes the result of a command that has passed its checks. */
+using ResultWriter = std::function <void (Json::Object&)>;
+
 /** Execute an RPC command and store the results in a Json::Value. */
 Status doCommand (RPC::Context&, Json::Value&);
 
+/** Execute an RPC command whose result may be streamed.
+
+    If the command can stream its result and the request passes its
+    checks, `writer` is set to a function that writes the result into a
+    Json::Object and nothing is stored in the Json::Value. Otherwise this
+    behaves like the other overload.
+*/
+Status doCommand (RPC::Context&, Json::Value&, ResultWriter& writer);
+
 Role roleRequired (std::string const& method );
 
 } // RPC
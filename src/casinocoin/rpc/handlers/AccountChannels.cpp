@@ -24,6 +24,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/ledger/ReadView.h>
 #include <casinocoin/ledger/View.h>
@@ -153,8 +154,8 @@ Json::Value doAccountChannels (RPC::Context& context)
         visitData.items.reserve (++reserve);
     }
 
-    if (! forEachItemAfter(*ledger, accountID,
-            startAfter, startHint, reserve,
+    if (! context.app.getOwnerDirIndex ().forEachItemAfter (
+            *ledger, accountID, ltPAYCHAN, startAfter, startHint, reserve,
         [&visitData](std::shared_ptr<SLE const> const& sleCur)
         {
 
@@ -24,8 +24,10 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/paths/CasinocoinState.h>
+#include <casinocoin/app/paths/PathRequests.h>
 #include <casinocoin/ledger/ReadView.h>
 #include <casinocoin/net/RPCErr.h>
 #include <casinocoin/protocol/ErrorCodes.h>
@@ -34,6 +36,7 @@
 #include <casinocoin/rpc/Context.h>
 #include <casinocoin/rpc/impl/RPCHelpers.h>
 #include <casinocoin/rpc/impl/Tuning.h>
+#include <algorithm>
 
 namespace casinocoin {
 
@@ -172,9 +175,39 @@ Json::Value doAccountLines (RPC::Context& context)
         visitData.items.reserve (++reserve);
     }
 
+    // The lines of the ledger the trust line index reflects are
+    // kept in memory, in owner directory order
+    if (auto const lines = context.app.getPathRequests ().lineIndex ()
+        .getLines (*ledger, accountID, false))
     {
-        if (! forEachItemAfter(*ledger, accountID,
-                startAfter, startHint, reserve,
+        auto iter = lines->begin ();
+        if (params.isMember (jss::marker))
+        {
+            iter = std::find_if (lines->begin (), lines->end (),
+                [&startAfter](CasinocoinState::pointer const& line)
+                {
+                    return line->key () == startAfter;
+                });
+            if (iter == lines->end ())
+                return rpcError (rpcINVALID_PARAMS);
+            ++iter;
+        }
+
+        for (; iter != lines->end () &&
+            visitData.items.size () < reserve; ++iter)
+        {
+            if (! visitData.hasPeer ||
+                visitData.raPeerAccount == (*iter)->getAccountIDPeer ())
+            {
+                visitData.items.emplace_back (*iter);
+            }
+        }
+    }
+    else
+    {
+        if (! context.app.getOwnerDirIndex ().forEachItemAfter (
+                *ledger, accountID, ltCASINOCOIN_STATE,
+                    startAfter, startHint, reserve,
             [&visitData](std::shared_ptr<SLE const> const& sleCur)
             {
                 auto const line =
@@ -25,6 +25,7 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/json/json_writer.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/ledger/ReadView.h>
 #include <casinocoin/net/RPCErr.h>
@@ -115,7 +116,8 @@ Json::Value doAccountObjects (RPC::Context& context)
     }
 
     if (! RPC::getAccountObjects (*ledger, accountID, type.second,
-        dirIndex, entryIndex, limit, result))
+        dirIndex, entryIndex, limit, result,
+            &context.app.getOwnerDirIndex ()))
     {
         result[jss::account_objects] = Json::arrayValue;
     }
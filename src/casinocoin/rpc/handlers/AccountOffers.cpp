@@ -24,6 +24,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/json/json_value.h>
 #include <casinocoin/ledger/ReadView.h>
@@ -127,8 +128,8 @@ Json::Value doAccountOffers (RPC::Context& context)
         offers.reserve (++reserve);
     }
 
-    if (! forEachItemAfter(*ledger, accountID,
-            startAfter, startHint, reserve,
+    if (! context.app.getOwnerDirIndex ().forEachItemAfter (
+            *ledger, accountID, ltOFFER, startAfter, startHint, reserve,
         [&offers](std::shared_ptr<SLE const> const& offer)
         {
             if (offer->getType () == ltOFFER)
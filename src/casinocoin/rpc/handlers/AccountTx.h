@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012-2014 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+//==============================================================================
+/*
+    2017-06-30  ajochems        Refactored for casinocoin
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_RPC_HANDLERS_ACCOUNTTX_H_INCLUDED
+#define CASINOCOIN_RPC_HANDLERS_ACCOUNTTX_H_INCLUDED
+
+#include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/app/misc/Transaction.h>
+#include <casinocoin/json/Object.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/rpc/Context.h>
+#include <casinocoin/rpc/Status.h>
+#include <casinocoin/rpc/impl/Handler.h>
+#include <casinocoin/rpc/impl/RPCHelpers.h>
+#include <casinocoin/rpc/Role.h>
+
+namespace casinocoin {
+namespace RPC {
+
+// {
+//   account: account,
+//   ledger_index_min: ledger_index  // optional, defaults to earliest
+//   ledger_index_max: ledger_index, // optional, defaults to latest
+//   binary: boolean,                // optional, defaults to false
+//   forward: boolean,               // optional, defaults to false
+//   limit: integer,                 // optional
+//   marker: opaque                  // optional, resume previous query
+// }
+//
+// Requests using the parameters of the old account_tx (offset, count,
+// descending, ledger_min or ledger_max) are answered by doAccountTxOld.
+class AccountTxHandler
+{
+public:
+    explicit AccountTxHandler (Context&);
+
+    Status check ();
+
+    template <class Object>
+    void writeResult (Object&);
+
+    static const char* const name()
+    {
+        return "account_tx";
+    }
+
+    static Role role()
+    {
+        return Role::USER;
+    }
+
+    static Condition condition()
+    {
+        return NO_CONDITION;
+    }
+
+private:
+    bool isValidated (std::uint32_t ledgerIndex) const
+    {
+        return validated_ &&
+            validatedMin_ <= ledgerIndex &&
+            validatedMax_ >= ledgerIndex;
+    }
+
+    Context& context_;
+    Json::Value oldResult_;
+    bool old_ = false;
+
+    AccountID account_;
+    int limit_ = -1;
+    bool binary_ = false;
+    bool validated_ = false;
+    std::uint32_t ledgerMin_ = 0;
+    std::uint32_t ledgerMax_ = 0;
+    std::uint32_t validatedMin_ = 0;
+    std::uint32_t validatedMax_ = 0;
+    Json::Value resumeToken_;
+    NetworkOPs::AccountTxs txns_;
+    NetworkOPs::MetaTxsList binaryTxns_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation.
+
+template <class Object>
+void AccountTxHandler::writeResult (Object& value)
+{
+    if (old_)
+    {
+        Json::copyFrom (value, oldResult_);
+        return;
+    }
+
+    value[jss::account] = context_.app.accountIDCache().toBase58(account_);
+
+    {
+        auto&& jvTxns = Json::setArray (value, jss::transactions);
+
+        for (auto const& it: binaryTxns_)
+        {
+            auto&& jvObj = Json::appendObject (jvTxns);
+
+            jvObj[jss::tx_blob] = std::get<0> (it);
+            jvObj[jss::meta] = std::get<1> (it);
+
+            std::uint32_t uLedgerIndex = std::get<2> (it);
+
+            jvObj[jss::ledger_index] = uLedgerIndex;
+            jvObj[jss::validated] = isValidated (uLedgerIndex);
+        }
+
+        for (auto const& it: txns_)
+        {
+            auto&& jvObj = Json::appendObject (jvTxns);
+
+            if (it.first)
+                jvObj[jss::tx] = it.first->getJson (1);
+
+            if (it.second)
+            {
+                auto meta = it.second->getJson (1);
+                addPaymentDeliveredAmount (meta, context_, it.first, it.second);
+                jvObj[jss::meta] = meta;
+                jvObj[jss::validated] = isValidated (it.second->getLgrSeq ());
+            }
+        }
+    }
+
+    //Add information about the original query
+    value[jss::ledger_index_min] = ledgerMin_;
+    value[jss::ledger_index_max] = ledgerMax_;
+    if (context_.params.isMember (jss::limit))
+        value[jss::limit] = limit_;
+    if (resumeToken_)
+        value[jss::marker] = resumeToken_;
+}
+
+} // RPC
+} // casinocoin
+
+#endif
@@ -29,6 +29,8 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/app/misc/TxVerifier.h>
+#include <casinocoin/app/paths/PathRequests.h>
 #include <casinocoin/basics/UptimeTimer.h>
 #include <casinocoin/core/DatabaseCon.h>
 #include <casinocoin/json/json_value.h>
@@ -38,6 +40,7 @@
 #include <casinocoin/protocol/ErrorCodes.h>
 #include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/rpc/Context.h>
+#include <casinocoin/shamap/SHAMapTreeNode.h>
 
 namespace casinocoin {
 
@@ -105,9 +108,19 @@ Json::Value doGetCounts (RPC::Context& context)
 
     ret[jss::write_load] = context.app.getNodeStore ().getWriteLoad ();
 
+    context.app.getOPs ().getTxVerifier ().getCounts (ret);
+    context.app.getPathRequests ().getCounts (ret);
+
     ret[jss::historical_perminute] = static_cast<int>(
         context.app.getInboundLedgers().fetchRate());
-    ret[jss::SLE_hit_rate] = context.app.cachedSLEs().rate();
+    {
+        auto const& sles = context.app.cachedSLEs();
+        ret[jss::SLE_hit_rate] = sles.rate();
+        ret[jss::SLE_hits] = std::to_string (sles.hits());
+        ret[jss::SLE_misses] = std::to_string (sles.misses());
+        ret[jss::SLE_cache_size] = static_cast<Json::UInt> (sles.size());
+        ret[jss::SLE_cache_bytes] = static_cast<Json::UInt> (sles.bytes());
+    }
     ret[jss::node_hit_rate] = context.app.getNodeStore ().getCacheHitRate ();
     ret[jss::ledger_hit_rate] = context.app.getLedgerMaster ().getCacheHitRate ();
     ret[jss::AL_hit_rate] = context.app.getAcceptedLedgerCache ().getHitRate ();
@@ -116,6 +129,16 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::treenode_cache_size] = context.app.family().treecache().getCacheSize();
     ret[jss::treenode_track_size] = context.app.family().treecache().getTrackSize();
 
+    {
+        auto const count = SHAMapInnerNode::getCount ();
+        auto const bytes = SHAMapInnerNode::getBytes ();
+        ret[jss::treenode_inner_count] = std::to_string (count);
+        ret[jss::treenode_inner_bytes] = std::to_string (bytes);
+        if (count > 0)
+            ret[jss::treenode_inner_node_bytes] =
+                static_cast<Json::UInt> (bytes / count);
+    }
+
     std::string uptime;
     int s = UptimeTimer::getInstance ().getElapsedSeconds ();
     textTime (uptime, s, "year", 365 * 24 * 60 * 60);
@@ -25,7 +25,9 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/rpc/impl/Handler.h>
+#include <casinocoin/rpc/handlers/AccountTx.h>
 #include <casinocoin/rpc/handlers/Handlers.h>
+#include <casinocoin/rpc/handlers/LedgerData.h>
 #include <casinocoin/rpc/handlers/Version.h>
 
 namespace casinocoin {
@@ -62,6 +64,23 @@ Status handle (Context& context, Object& object)
     return status;
 };
 
+/** Check a request now and write its result later, when streaming. */
+template <class HandlerImpl>
+Status stream (Context& context, ResultWriter& writer)
+{
+    auto handler = std::make_shared<HandlerImpl> (context);
+
+    auto status = handler->check ();
+    if (! status)
+    {
+        writer = [handler] (Json::Object& object)
+        {
+            handler->writeResult (object);
+        };
+    }
+    return status;
+}
+
 class HandlerTable {
   public:
     template<std::size_t N>
@@ -76,8 +95,13 @@ class HandlerTable {
         }
 
         // This is where the new-style handlers are added.
-        addHandler<LedgerHandler>();
         addHandler<VersionHandler>();
+
+        // Handlers whose results can be large enough to be worth
+        // streaming to the client.
+        addStreamingHandler<AccountTxHandler>();
+        addStreamingHandler<LedgerHandler>();
+        addStreamingHandler<LedgerDataHandler>();
     }
 
     const Handler* getHandler(std::string name) const {
@@ -101,6 +125,13 @@ class HandlerTable {
 
         table_[HandlerImpl::name()] = h;
     };
+
+    template <class HandlerImpl>
+    void addStreamingHandler()
+    {
+        addHandler<HandlerImpl>();
+        table_[HandlerImpl::name()].streamMethod_ = &stream<HandlerImpl>;
+    };
 };
 
 Handler handlerArray[] {
@@ -112,7 +143,6 @@ Handler handlerArray[] {
     {   "account_channels",     byRef (&doAccountChannels),     Role::USER,  NO_CONDITION               },
     {   "account_objects",      byRef (&doAccountObjects),      Role::USER,  NO_CONDITION               },
     {   "account_offers",       byRef (&doAccountOffers),       Role::USER,  NO_CONDITION               },
-    {   "account_tx",           byRef (&doAccountTxSwitch),     Role::USER,  NO_CONDITION               },
     {   "blacklist",            byRef (&doBlackList),           Role::ADMIN, NO_CONDITION               },
     {   "blacklisted_accounts", byRef (&doBlacklistedAccounts), Role::ADMIN, NO_CONDITION               },
     {   "book_offers",          byRef (&doBookOffers),          Role::USER,  NO_CONDITION               },
@@ -134,7 +164,6 @@ Handler handlerArray[] {
     {   "ledger_cleaner",       byRef (&doLedgerCleaner),       Role::ADMIN, NEEDS_NETWORK_CONNECTION   },
     {   "ledger_closed",        byRef (&doLedgerClosed),        Role::USER,  NO_CONDITION               },
     {   "ledger_current",       byRef (&doLedgerCurrent),       Role::USER,  NEEDS_CURRENT_LEDGER       },
-    {   "ledger_data",          byRef (&doLedgerData),          Role::USER,  NO_CONDITION               },
     {   "ledger_entry",         byRef (&doLedgerEntry),         Role::USER,  NO_CONDITION               },
     {   "ledger_header",        byRef (&doLedgerHeader),        Role::USER,  NO_CONDITION               },
     {   "ledger_request",       byRef (&doLedgerRequest),       Role::ADMIN, NO_CONDITION               },
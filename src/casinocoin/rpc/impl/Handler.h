@@ -50,10 +50,16 @@ struct Handler
     template <class JsonValue>
     using Method = std::function <Status (Context&, JsonValue&)>;
 
+    /** Checks a request and, on success, returns a writer for its result. */
+    using StreamMethod = std::function <Status (Context&, ResultWriter&)>;
+
     const char* name_;
     Method<Json::Value> valueMethod_;
     Role role_;
     RPC::Condition condition_;
+
+    // Set for handlers whose result can be streamed to the client.
+    StreamMethod streamMethod_;
 };
 
 const Handler* getHandler (std::string const&);
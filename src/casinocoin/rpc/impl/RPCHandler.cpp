@@ -232,30 +232,21 @@ void getResult (
     }
 }
 
-} // namespace
-
-Status doCommand (
-    RPC::Context& context, Json::Value& result)
+Status callHandler (
+    RPC::Context& context, Handler const& handler, Json::Value& result)
 {
-    Handler const * handler = nullptr;
-    if (auto error = fillHandler (context, handler))
-    {
-        inject_error (error, result);
-        return error;
-    }
-
-    if (auto method = handler->valueMethod_)
+    if (auto method = handler.valueMethod_)
     {
         if (! context.headers.user.empty() ||
             ! context.headers.forwardedFor.empty())
         {
-            JLOG(context.j.debug()) << "start command: " << handler->name_ <<
+            JLOG(context.j.debug()) << "start command: " << handler.name_ <<
                 ", X-User: " << context.headers.user << ", X-Forwarded-For: " <<
                     context.headers.forwardedFor;
 
-            auto ret = callMethod (context, method, handler->name_, result);
+            auto ret = callMethod (context, method, handler.name_, result);
 
-            JLOG(context.j.debug()) << "finish command: " << handler->name_ <<
+            JLOG(context.j.debug()) << "finish command: " << handler.name_ <<
                 ", X-User: " << context.headers.user << ", X-Forwarded-For: " <<
                     context.headers.forwardedFor;
 
@@ -263,13 +254,53 @@ Status doCommand (
         }
         else
         {
-            return callMethod (context, method, handler->name_, result);
+            return callMethod (context, method, handler.name_, result);
         }
     }
 
     return rpcUNKNOWN_COMMAND;
 }
 
+} // namespace
+
+Status doCommand (
+    RPC::Context& context, Json::Value& result)
+{
+    Handler const * handler = nullptr;
+    if (auto error = fillHandler (context, handler))
+    {
+        inject_error (error, result);
+        return error;
+    }
+
+    return callHandler (context, *handler, result);
+}
+
+Status doCommand (
+    RPC::Context& context, Json::Value& result, ResultWriter& writer)
+{
+    Handler const * handler = nullptr;
+    if (auto error = fillHandler (context, handler))
+    {
+        inject_error (error, result);
+        return error;
+    }
+
+    if (auto method = handler->streamMethod_)
+    {
+        return callMethod (context,
+            [&] (Context& c, Json::Value& r)
+            {
+                auto status = method (c, writer);
+                if (status)
+                    status.inject (r);
+                return status;
+            }, handler->name_, result);
+    }
+
+    return callHandler (context, *handler, result);
+}
+
 Role roleRequired (std::string const& method)
 {
     auto handler = RPC::getHandler(method);
@@ -25,6 +25,7 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/Transaction.h>
 #include <casinocoin/ledger/View.h>
@@ -89,11 +90,91 @@ accountFromString(
     return Json::objectValue;
 }
 
+// Same as getAccountObjects, reading the directory pages from an index
+// and only the objects of the requested type from the ledger
+static
+bool
+getIndexedObjects (ReadView const& ledger,
+    OwnerDirIndex::Directory const& dir, LedgerEntryType const type,
+    uint256 const& dirIndex, uint256 const& entryIndex,
+    std::uint32_t const limit, Json::Value& jvResult)
+{
+    auto page = dir.begin ();
+    if (page == dir.end ())
+        return false;
+
+    std::size_t first = 0;
+    if (dirIndex.isNonZero ())
+    {
+        page = std::find_if (dir.begin (), dir.end (),
+            [&dirIndex](OwnerDirIndex::Directory::value_type const& p)
+            {
+                return p.second->key == dirIndex;
+            });
+        if (page == dir.end ())
+            return false;
+
+        auto const& entries = page->second->entries;
+        auto const iter = std::find_if (entries.begin (), entries.end (),
+            [&entryIndex](OwnerDirIndex::Entry const& e)
+            {
+                return e.key == entryIndex;
+            });
+        if (iter == entries.end ())
+            return false;
+
+        first = iter - entries.begin ();
+    }
+
+    std::uint32_t i = 0;
+    auto& jvObjects = jvResult[jss::account_objects];
+    for (; page != dir.end (); ++page, first = 0)
+    {
+        auto const& entries = page->second->entries;
+        for (auto j = first; j < entries.size (); ++j)
+        {
+            if (type != ltINVALID && entries[j].type != type)
+                continue;
+
+            jvObjects.append (
+                ledger.read (keylet::child (entries[j].key))->getJson (0));
+
+            if (++i == limit)
+            {
+                if (++j == entries.size ())
+                {
+                    // Resume at the start of the next page, if any
+                    if (++page == dir.end ())
+                        return true;
+                    j = 0;
+                    if (page->second->entries.empty ())
+                        return true;
+                }
+
+                jvResult[jss::limit] = limit;
+                jvResult[jss::marker] = to_string (page->second->key) +
+                    ',' + to_string (page->second->entries[j].key);
+                return true;
+            }
+        }
+    }
+    return true;
+}
+
 bool
 getAccountObjects(ReadView const& ledger, AccountID const& account,
     LedgerEntryType const type, uint256 dirIndex, uint256 const& entryIndex,
-    std::uint32_t const limit, Json::Value& jvResult)
+    std::uint32_t const limit, Json::Value& jvResult, OwnerDirIndex* index)
 {
+    if (index)
+    {
+        if (auto const dir = index->getDirectory (ledger, account))
+        {
+            return getIndexedObjects (ledger, *dir, type,
+                dirIndex, entryIndex, limit, jvResult);
+        }
+    }
+
     auto const rootDirIndex = getOwnerDirIndex (account);
     auto found = false;
 
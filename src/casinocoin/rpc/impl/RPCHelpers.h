@@ -44,6 +44,7 @@ namespace casinocoin {
 class ReadView;
 class Transaction;
 class LedgerMaster;
+class OwnerDirIndex;
 class STTx;
 
 namespace RPC {
@@ -70,11 +71,14 @@ accountFromString (AccountID& result, std::string const& strIdent,
     @param entryIndex Begin gathering objects from this directory node.
     @param limit Maximum number of objects to find.
     @param jvResult A JSON result that holds the request objects.
+    @param index Owner directories to read the directory from, if they
+                 reflect the ledger.
 */
 bool
 getAccountObjects (ReadView const& ledger, AccountID const& account,
     LedgerEntryType const type, uint256 dirIndex, uint256 const& entryIndex,
-    std::uint32_t const limit, Json::Value& jvResult);
+    std::uint32_t const limit, Json::Value& jvResult,
+    OwnerDirIndex* index = nullptr);
 
 /** Extracts Account Ledger Entry
     at given /ledgerSeq/
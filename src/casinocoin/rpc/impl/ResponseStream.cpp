@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/rpc/impl/ResponseStream.h>
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace casinocoin {
+namespace RPC {
+
+class ResponseStream::HTTPWriter : public Writer
+{
+private:
+    std::shared_ptr<ResponseStream> stream_;
+
+public:
+    explicit
+    HTTPWriter (std::shared_ptr<ResponseStream> stream)
+        : stream_ (std::move (stream))
+    {
+    }
+
+    ~HTTPWriter () override
+    {
+        stream_->cancel ();
+    }
+
+    bool
+    complete () override
+    {
+        return stream_->sent_ == stream_->sending_.size () &&
+            stream_->drained ();
+    }
+
+    void
+    consume (std::size_t bytes) override
+    {
+        stream_->sent_ += bytes;
+    }
+
+    bool
+    prepare (std::size_t, std::function<void(void)> resume) override
+    {
+        if (stream_->sent_ < stream_->sending_.size ())
+            return true;
+        // A cancelled stream is never resumed, the session is closed
+        return bool (stream_->take (std::move (resume)));
+    }
+
+    std::vector<boost::asio::const_buffer>
+    data () override
+    {
+        auto const& s = stream_->sending_;
+        return {boost::asio::buffer (
+            s.data () + stream_->sent_, s.size () - stream_->sent_)};
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class ResponseStream::StreamWSMsg : public WSMsg
+{
+private:
+    std::shared_ptr<ResponseStream> stream_;
+    std::size_t n_ = 0;
+
+public:
+    explicit
+    StreamWSMsg (std::shared_ptr<ResponseStream> stream)
+        : stream_ (std::move (stream))
+    {
+    }
+
+    ~StreamWSMsg () override
+    {
+        stream_->cancel ();
+    }
+
+    std::pair<boost::tribool,
+        std::vector<boost::asio::const_buffer>>
+    prepare (std::size_t bytes,
+        std::function<void(void)> resume) override
+    {
+        auto& s = *stream_;
+
+        // The previous frame has been written
+        s.sent_ += n_;
+        n_ = 0;
+
+        if (s.sent_ == s.sending_.size ())
+        {
+            auto const taken = s.take (std::move (resume));
+            if (boost::indeterminate (taken))
+                return {boost::indeterminate, {}};
+            if (! taken)
+                return {true, {}};
+        }
+
+        n_ = std::min (bytes, s.sending_.size () - s.sent_);
+        boost::tribool const last =
+            s.sent_ + n_ == s.sending_.size () && s.drained ();
+        return {last, {boost::asio::buffer (
+            s.sending_.data () + s.sent_, n_)}};
+    }
+};
+
+//------------------------------------------------------------------------------
+
+ResponseStream::ResponseStream (std::shared_ptr<JobQueue::Coro> coro,
+        std::size_t limit, bool chunked)
+    : coro_ (std::move (coro))
+    , limit_ (limit)
+    , chunked_ (chunked)
+{
+}
+
+void
+ResponseStream::setHeader (std::string header)
+{
+    header_ = std::move (header);
+}
+
+void
+ResponseStream::write (boost::string_ref const& data)
+{
+    std::function<void(void)> resume;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (cancelled_)
+            return;
+
+        pending_.append (data.data (), data.size ());
+        size_ += data.size ();
+        peak_ = std::max (peak_, pending_.size () + inFlight_);
+
+        // Wake the connection once there is enough to be worth sending
+        if (resume_ && pending_.size () >= limit_ / 4)
+            std::swap (resume, resume_);
+    }
+    if (resume)
+        resume ();
+
+    if (! coro_)
+        return;
+
+    // Wait for the connection to catch up
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            if (cancelled_ || pending_.size () < limit_)
+                return;
+            waiting_ = true;
+        }
+        coro_->yield ();
+    }
+}
+
+Json::Output
+ResponseStream::output ()
+{
+    return [self = shared_from_this ()] (boost::string_ref const& data)
+    {
+        self->write (data);
+    };
+}
+
+void
+ResponseStream::finish ()
+{
+    std::function<void(void)> resume;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        finished_ = true;
+        std::swap (resume, resume_);
+    }
+    if (resume)
+        resume ();
+}
+
+void
+ResponseStream::cancel ()
+{
+    std::function<void(void)> resume;
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (cancelled_ || drained_)
+            return;
+        cancelled_ = true;
+        pending_ = std::string ();
+        std::swap (resume, resume_);
+        wake = std::exchange (waiting_, false);
+    }
+    if (wake)
+        coro_->post ();
+    if (resume)
+        resume ();
+}
+
+bool
+ResponseStream::cancelled () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return cancelled_;
+}
+
+std::size_t
+ResponseStream::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return size_;
+}
+
+std::size_t
+ResponseStream::peak () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return peak_;
+}
+
+std::shared_ptr<Writer>
+ResponseStream::makeWriter ()
+{
+    return std::make_shared<HTTPWriter> (shared_from_this ());
+}
+
+std::shared_ptr<WSMsg>
+ResponseStream::makeWSMsg ()
+{
+    return std::make_shared<StreamWSMsg> (shared_from_this ());
+}
+
+boost::tribool
+ResponseStream::take (std::function<void(void)> resume)
+{
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (cancelled_)
+            return false;
+
+        if (pending_.empty () && (drained_ || ! finished_))
+        {
+            resume_ = std::move (resume);
+            return boost::indeterminate;
+        }
+
+        sending_.clear ();
+        sent_ = 0;
+        if (! header_.empty ())
+            std::swap (sending_, header_);
+
+        if (chunked_ && ! pending_.empty ())
+        {
+            char size[20];
+            std::snprintf (size, sizeof(size), "%zx\r\n", pending_.size ());
+            sending_ += size;
+            sending_ += pending_;
+            sending_ += "\r\n";
+        }
+        else if (sending_.empty ())
+        {
+            // Hand the buffer over, keeping the old one's capacity
+            std::swap (sending_, pending_);
+        }
+        else
+        {
+            sending_ += pending_;
+        }
+        pending_.clear ();
+
+        if (finished_)
+        {
+            if (chunked_)
+                sending_ += "0\r\n\r\n";
+            drained_ = true;
+        }
+
+        inFlight_ = sending_.size ();
+        wake = std::exchange (waiting_, false);
+    }
+    if (wake)
+        coro_->post ();
+    return true;
+}
+
+bool
+ResponseStream::drained () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return drained_;
+}
+
+} // RPC
+} // casinocoin
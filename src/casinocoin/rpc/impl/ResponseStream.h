@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_RPC_RESPONSESTREAM_H_INCLUDED
+#define CASINOCOIN_RPC_RESPONSESTREAM_H_INCLUDED
+
+#include <casinocoin/core/JobQueue.h>
+#include <casinocoin/json/Output.h>
+#include <casinocoin/server/Writer.h>
+#include <casinocoin/server/WSSession.h>
+#include <boost/logic/tribool.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace casinocoin {
+namespace RPC {
+
+/** A bounded buffer between an RPC coroutine and a client connection.
+
+    The coroutine writes the response through output() while the
+    connection pulls it through the Writer or WSMsg returned by
+    makeWriter() or makeWSMsg(). Once `limit` bytes are waiting the
+    coroutine yields until the connection has taken them, so a response
+    is held in at most about twice `limit` bytes however large it is.
+
+    If the connection goes away the stream is cancelled: the coroutine
+    is resumed and everything it writes afterwards is discarded.
+*/
+class ResponseStream
+    : public std::enable_shared_from_this <ResponseStream>
+{
+public:
+    /** Create a stream.
+
+        @param coro The coroutine writing the response. If null the
+                    writer can't wait and the buffer is not bounded.
+        @param limit The number of buffered bytes at which the writer
+                     waits for the connection.
+        @param chunked `true` to frame the data with HTTP chunked
+                       transfer encoding.
+    */
+    ResponseStream (std::shared_ptr<JobQueue::Coro> coro,
+        std::size_t limit, bool chunked);
+
+    ResponseStream (ResponseStream const&) = delete;
+    ResponseStream& operator= (ResponseStream const&) = delete;
+
+    /** Set data sent ahead of the framed body, like HTTP headers.
+        Must be called before anything is written.
+    */
+    void
+    setHeader (std::string header);
+
+    /** Append data to the response.
+        This may suspend the calling coroutine.
+    */
+    void
+    write (boost::string_ref const& data);
+
+    /** Return an Output appending to this stream. */
+    Json::Output
+    output ();
+
+    /** Mark the response as complete. */
+    void
+    finish ();
+
+    /** Abandon the response, closing the message early. */
+    void
+    cancel ();
+
+    /** Return `true` if the response was cancelled. */
+    bool
+    cancelled () const;
+
+    /** Total number of bytes written, excluding header and framing. */
+    std::size_t
+    size () const;
+
+    /** Largest number of bytes held by the stream at any time. */
+    std::size_t
+    peak () const;
+
+    /** Return a Writer sending the response over HTTP. */
+    std::shared_ptr<Writer>
+    makeWriter ();
+
+    /** Return a WSMsg sending the response over a websocket. */
+    std::shared_ptr<WSMsg>
+    makeWSMsg ();
+
+private:
+    class HTTPWriter;
+    class StreamWSMsg;
+
+    // Move the pending data to the connection's buffer. Returns
+    // indeterminate, and calls `resume` later, if there is none yet,
+    // and `false` if the stream was cancelled.
+    boost::tribool
+    take (std::function<void(void)> resume);
+
+    // Returns `true` once the last of the data has been taken
+    bool
+    drained () const;
+
+    std::shared_ptr<JobQueue::Coro> const coro_;
+    std::size_t const limit_;
+    bool const chunked_;
+    std::string header_;
+
+    std::mutex mutable mutex_;
+    std::string pending_;
+    std::function<void(void)> resume_;
+    bool waiting_ = false;
+    bool finished_ = false;
+    bool cancelled_ = false;
+    bool drained_ = false;
+    std::size_t size_ = 0;
+    std::size_t inFlight_ = 0;
+    std::size_t peak_ = 0;
+
+    // Only touched by the connection
+    std::string sending_;
+    std::size_t sent_ = 0;
+};
+
+} // RPC
+} // casinocoin
+
+#endif
@@ -29,10 +29,13 @@
 #include <casinocoin/beast/rfc2616.h>
 #include <casinocoin/beast/net/IPAddressConversion.h>
 #include <casinocoin/json/json_reader.h>
+#include <casinocoin/json/Object.h>
+#include <casinocoin/json/Writer.h>
 #include <casinocoin/rpc/json_body.h>
 #include <casinocoin/rpc/ServerHandler.h>
 #include <casinocoin/server/Server.h>
 #include <casinocoin/server/impl/JSONRPCUtil.h>
+#include <casinocoin/rpc/impl/ResponseStream.h>
 #include <casinocoin/rpc/impl/ServerHandlerImp.h>
 #include <casinocoin/basics/contract.h>
 #include <casinocoin/basics/Log.h>
@@ -372,6 +375,12 @@ ServerHandlerImp::onWSMessage(
         {
             auto const jr =
                 this->processSession(session, c, jv);
+            // A null reply has already been streamed to the session
+            if (jr.isNull())
+            {
+                session->complete();
+                return;
+            }
             auto const s = to_string(jr);
             auto const n = s.length();
             beast::streambuf sb(n);
@@ -466,7 +475,51 @@ ServerHandlerImp::processSession(
             is,
             {is->user(), is->forwarded_for()}
             };
-        RPC::doCommand(context, jr[jss::result]);
+        RPC::ResultWriter writer;
+        RPC::doCommand(context, jr[jss::result], writer);
+        if (writer)
+        {
+            // The request passed its checks, write the reply straight
+            // to the session instead of building it in memory first.
+            auto const stream = std::make_shared<RPC::ResponseStream>(
+                coro, RPC::Tuning::streamBufferSize, false);
+            session->send(stream->makeWSMsg());
+            try
+            {
+                Json::Writer w(stream->output());
+                {
+                    Json::Object::Root reply(w);
+                    {
+                        auto&& result = Json::addObject(reply, jss::result);
+                        writer(result);
+                    }
+
+                    is->getConsumer().charge(loadType);
+                    if (is->getConsumer().warn())
+                        reply[jss::warning] = jss::load;
+                    reply[jss::status] = jss::success;
+                    if (jv.isMember(jss::id))
+                        reply[jss::id] = jv[jss::id];
+                    if (jv.isMember(jss::jsonrpc))
+                        reply[jss::jsonrpc] = jv[jss::jsonrpc];
+                    if (jv.isMember(jss::casinocoinrpc))
+                        reply[jss::casinocoinrpc] = jv[jss::casinocoinrpc];
+                    reply[jss::type] = jss::response;
+                }
+                stream->finish();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(m_journal.warn()) <<
+                    "Streamed reply failed: " << e.what();
+                stream->cancel();
+                session->close();
+            }
+            JLOG(m_journal.debug()) <<
+                "Streamed reply: " << stream->size() <<
+                " bytes, at most " << stream->peak() << " buffered";
+            return Json::Value();
+        }
     }
 
     is->getConsumer().charge(loadType);
@@ -510,7 +563,11 @@ void
 ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
     std::shared_ptr<JobQueue::Coro> coro)
 {
-    processRequest (
+    // Chunked replies need HTTP/1.1
+    auto const streamTo = session->request().version >= 11 ?
+        session : nullptr;
+
+    auto const streamed = processRequest (
         session->port(), buffers_to_string(
             session->request().body.data()),
                 session->remoteAddress().at_port (0),
@@ -532,7 +589,11 @@ ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
             if(iter != session->request().fields.end())
                 return iter->second;
             return std::string{};
-        }());
+        }(),
+        streamTo);
+
+    if (streamed)
+        return;
 
     if(is_keep_alive(session->request()))
         session->complete();
@@ -540,11 +601,12 @@ ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
         session->close (true);
 }
 
-void
+bool
 ServerHandlerImp::processRequest (Port const& port,
     std::string const& request, beast::IP::Endpoint const& remoteIPAddress,
         Output&& output, std::shared_ptr<JobQueue::Coro> coro,
-        std::string forwardedFor, std::string user)
+        std::string forwardedFor, std::string user,
+        std::shared_ptr<Session> const& streamTo)
 {
     auto rpcJ = app_.journal ("RPC");
 
@@ -557,7 +619,7 @@ ServerHandlerImp::processRequest (Port const& port,
             ! jsonRPC.isObject ())
         {
             HTTPReply (400, "Unable to parse request", output, rpcJ);
-            return;
+            return false;
         }
     }
 
@@ -593,7 +655,7 @@ ServerHandlerImp::processRequest (Port const& port,
         if (usage.disconnect())
         {
             HTTPReply(503, "Server is overloaded", output, rpcJ);
-            return;
+            return false;
         }
     }
 
@@ -601,21 +663,21 @@ ServerHandlerImp::processRequest (Port const& port,
     {
         usage.charge(Resource::feeInvalidRPC);
         HTTPReply (403, "Forbidden", output, rpcJ);
-        return;
+        return false;
     }
 
     if (! method)
     {
         usage.charge(Resource::feeInvalidRPC);
         HTTPReply (400, "Null method", output, rpcJ);
-        return;
+        return false;
     }
 
     if (! method.isString ())
     {
         usage.charge(Resource::feeInvalidRPC);
         HTTPReply (400, "method is not string", output, rpcJ);
-        return;
+        return false;
     }
 
     std::string strMethod = method.asString ();
@@ -623,7 +685,7 @@ ServerHandlerImp::processRequest (Port const& port,
     {
         usage.charge(Resource::feeInvalidRPC);
         HTTPReply (400, "method is empty", output, rpcJ);
-        return;
+        return false;
     }
 
     // Extract request parameters from the request Json as `params`.
@@ -641,7 +703,7 @@ ServerHandlerImp::processRequest (Port const& port,
     {
         usage.charge(Resource::feeInvalidRPC);
         HTTPReply (400, "params unparseable", output, rpcJ);
-        return;
+        return false;
     }
     else
     {
@@ -650,7 +712,7 @@ ServerHandlerImp::processRequest (Port const& port,
         {
             usage.charge(Resource::feeInvalidRPC);
             HTTPReply (400, "params unparseable", output, rpcJ);
-            return;
+            return false;
         }
     }
 
@@ -690,7 +752,70 @@ ServerHandlerImp::processRequest (Port const& port,
         {user, forwardedFor}
     };
     Json::Value result;
-    RPC::doCommand (context, result);
+    RPC::ResultWriter writer;
+    if (streamTo)
+        RPC::doCommand (context, result, writer);
+    else
+        RPC::doCommand (context, result);
+
+    if (writer)
+    {
+        // The request passed its checks, write the reply straight to
+        // the session instead of building it in memory first.
+        auto const stream = std::make_shared<RPC::ResponseStream> (
+            coro, RPC::Tuning::streamBufferSize, true);
+        {
+            std::string header;
+            HTTPChunkedReplyHeader (Json::stringOutput (header), rpcJ);
+            stream->setHeader (std::move (header));
+        }
+        streamTo->write (stream->makeWriter (),
+            is_keep_alive (streamTo->request ()));
+
+        try
+        {
+            Json::Writer w (stream->output ());
+            {
+                Json::Object::Root reply (w);
+                {
+                    auto&& r = Json::addObject (reply, jss::result);
+                    writer (r);
+                    r[jss::status] = jss::success;
+
+                    usage.charge (loadType);
+                    if (usage.warn())
+                        r[jss::warning] = jss::load;
+                }
+                if (jsonRPC.isMember(jss::jsonrpc))
+                    reply[jss::jsonrpc] = jsonRPC[jss::jsonrpc];
+                if (jsonRPC.isMember(jss::casinocoinrpc))
+                    reply[jss::casinocoinrpc] = jsonRPC[jss::casinocoinrpc];
+                if (jsonRPC.isMember(jss::id))
+                    reply[jss::id] = jsonRPC[jss::id];
+            }
+            stream->write ("\n\r\n");
+            stream->finish ();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (m_journal.warn()) <<
+                "Streamed reply failed: " << e.what();
+            stream->cancel ();
+            streamTo->close (false);
+        }
+
+        rpc_time_.notify (static_cast <beast::insight::Event::value_type> (
+            std::chrono::duration_cast <std::chrono::milliseconds> (
+                std::chrono::high_resolution_clock::now () - start)));
+        ++rpc_requests_;
+        rpc_size_.notify (static_cast <beast::insight::Event::value_type> (
+            stream->size ()));
+
+        JLOG (m_journal.debug()) <<
+            "Streamed reply: " << stream->size () <<
+            " bytes, at most " << stream->peak () << " buffered";
+        return true;
+    }
 
     // Always report "status".  On an error report the request as received.
     if (result.isMember (jss::error))
@@ -739,6 +864,7 @@ ServerHandlerImp::processRequest (Port const& port,
     }
 
     HTTPReply (200, response, output, rpcJ);
+    return false;
 }
 
 //------------------------------------------------------------------------------
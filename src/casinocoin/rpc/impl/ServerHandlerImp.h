@@ -165,11 +165,14 @@ private:
     processSession (std::shared_ptr<Session> const&,
         std::shared_ptr<JobQueue::Coro> coro);
 
-    void
+    // Returns `true` if the reply was streamed to `streamTo`, which
+    // then completes the exchange on its own.
+    bool
     processRequest (Port const& port, std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress, Output&&,
         std::shared_ptr<JobQueue::Coro> coro,
-        std::string forwardedFor, std::string user);
+        std::string forwardedFor, std::string user,
+        std::shared_ptr<Session> const& streamTo = nullptr);
 
     Handoff
     statusResponse(http_request_type const& request) const;
@@ -65,6 +65,10 @@ using namespace std::chrono_literals;
 auto constexpr maxValidatedLedgerAge = 30min;
 static int const maxRequestSize = 1000000;
 
+/** Bytes of a streamed response buffered before the handler waits for the
+    client to catch up. */
+static int const streamBufferSize = 256 * 1024;
+
 /** Maximum number of pages in one response from a binary LedgerData request. */
 static int const binaryPageLength = 2048;
 
@@ -402,9 +402,11 @@ do_writer(std::shared_ptr <Writer> const& writer,
         if(! writer->prepare(bufferSize, resume))
             return;
         error_code ec;
+        start_timer();
         auto const bytes_transferred = boost::asio::async_write(
             impl().stream_, writer->data(), boost::asio::transfer_at_least(1),
                 do_yield[ec]);
+        cancel_timer();
         if(ec)
             return fail(ec, "writer");
         writer->consume(bytes_transferred);
@@ -415,6 +417,7 @@ do_writer(std::shared_ptr <Writer> const& writer,
     if(! keep_alive)
         return do_close();
 
+    message_ = {};
     boost::asio::spawn(strand_, std::bind(&BaseHTTPPeer<Handler, Impl>::do_read,
         impl().shared_from_this(), std::placeholders::_1));
 }
@@ -124,4 +124,21 @@ void HTTPReply (
     output ("\r\n");
 }
 
+void HTTPChunkedReplyHeader (Json::Output const& output, beast::Journal j)
+{
+    JLOG (j.trace())
+        << "HTTP Reply 200 (chunked)";
+
+    output ("HTTP/1.1 200 OK\r\n");
+    output (getHTTPHeaderTimestamp ());
+    output ("Connection: Keep-Alive\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "Content-Type: application/json; charset=UTF-8\r\n");
+
+    output ("Server: " + systemName () + "-json-rpc/");
+    output (BuildInfo::getFullVersionString ());
+    output ("\r\n"
+            "\r\n");
+}
+
 } // casinocoin
@@ -34,6 +34,9 @@ namespace casinocoin {
 void HTTPReply (
     int nStatus, std::string const& strMsg, Json::Output const&, beast::Journal j);
 
+/** Write the header of a successful reply whose body follows in chunks. */
+void HTTPChunkedReplyHeader (Json::Output const&, beast::Journal j);
+
 } // casinocoin
 
 #endif
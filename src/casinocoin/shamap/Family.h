@@ -27,10 +27,12 @@
 #define CASINOCOIN_SHAMAP_FAMILY_H_INCLUDED
 
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/TaskPool.h>
 #include <casinocoin/shamap/FullBelowCache.h>
 #include <casinocoin/shamap/TreeNodeCache.h>
 #include <casinocoin/nodestore/Database.h>
 #include <casinocoin/beast/utility/Journal.h>
+#include <cstddef>
 #include <cstdint>
 
 namespace casinocoin {
@@ -68,6 +70,11 @@ public:
     NodeStore::Database const&
     db() const = 0;
 
+    /** Threads that flush the subtrees of a map, shared by all maps */
+    virtual
+    TaskPool&
+    flushPool() = 0;
+
     virtual
     void
     missing_node (std::uint32_t refNum) = 0;
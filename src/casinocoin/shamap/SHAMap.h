@@ -250,6 +250,10 @@ public:
 private:
     using SharedPtrNodeStack =
         std::stack<std::pair<std::shared_ptr<SHAMapAbstractNode>, SHAMapNodeID>>;
+    // Read only traversal. The nodes are kept alive by the tree,
+    // so there is no reference count to touch at every step.
+    using NodeStack =
+        std::stack<std::pair<SHAMapAbstractNode*, SHAMapNodeID>>;
     using DeltaRef = std::pair<std::shared_ptr<SHAMapItem const> const&,
                                std::shared_ptr<SHAMapItem const> const&>;
 
@@ -261,6 +265,8 @@ private:
 
     // database operations
     std::shared_ptr<SHAMapAbstractNode> fetchNodeFromDB (SHAMapHash const& hash) const;
+    std::shared_ptr<SHAMapAbstractNode> fetchNodeFromObject (
+        SHAMapHash const& hash, NodeObject const& obj) const;
     std::shared_ptr<SHAMapAbstractNode> fetchNodeNT (SHAMapHash const& hash) const;
     std::shared_ptr<SHAMapAbstractNode> fetchNodeNT (
         SHAMapHash const& hash,
@@ -277,6 +283,8 @@ private:
         if the return is nullptr, and if not, if the node->peekItem()->key() == id */
     SHAMapTreeNode*
         walkTowardsKey(uint256 const& id, SharedPtrNodeStack* stack = nullptr) const;
+    SHAMapTreeNode*
+        walkTowardsKey(uint256 const& id, NodeStack* stack) const;
     /** Return nullptr if key not found */
     SHAMapTreeNode*
         findKey(uint256 const& id) const;
@@ -296,8 +304,8 @@ private:
         writeNode(NodeObjectType t, std::uint32_t seq,
                   std::shared_ptr<SHAMapAbstractNode> node) const;
 
-    SHAMapTreeNode* firstBelow (std::shared_ptr<SHAMapAbstractNode>,
-                                SharedPtrNodeStack& stack, int branch = 0) const;
+    SHAMapTreeNode* firstBelow (SHAMapAbstractNode*,
+                                NodeStack& stack, int branch = 0) const;
 
     // Simple descent
     // Get a child of the specified node
@@ -315,9 +323,11 @@ private:
         int branch, SHAMapSyncFilter* filter) const;
 
     // Non-storing
-    // Does not hook the returned node to its parent
-    std::shared_ptr<SHAMapAbstractNode>
-        descendNoStore (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
+    // Does not hook the returned node to its parent. A node that had
+    // to be fetched is returned in owner, which must keep it alive.
+    SHAMapAbstractNode*
+        descendNoStore (SHAMapInnerNode*, int branch,
+            std::shared_ptr<SHAMapAbstractNode>& owner) const;
 
     /** If there is only one leaf below this node, get its contents */
     std::shared_ptr<SHAMapItem const> const& onlyBelow (SHAMapAbstractNode*) const;
@@ -325,12 +335,17 @@ private:
     bool hasInnerNode (SHAMapNodeID const& nodeID, SHAMapHash const& hash) const;
     bool hasLeafNode (uint256 const& tag, SHAMapHash const& hash) const;
 
-    SHAMapTreeNode const* peekFirstItem(SharedPtrNodeStack& stack) const;
-    SHAMapTreeNode const* peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const;
+    SHAMapTreeNode const* peekFirstItem(NodeStack& stack) const;
+    SHAMapTreeNode const* peekNextItem(uint256 const& id, NodeStack& stack) const;
     bool walkBranch (SHAMapAbstractNode* node,
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
                      bool isFirstMap, Delta & differences, int & maxCount) const;
     int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    /** Hash, share and optionally write the dirty nodes of a subtree,
+        replacing it with the flushed node. Subtrees may be flushed
+        concurrently, as long as each belongs to only one thread. */
+    int flushSubTree (std::shared_ptr<SHAMapAbstractNode>& subtree,
+        bool doWrite, NodeObjectType t, std::uint32_t seq) const;
     bool isInconsistentNode(std::shared_ptr<SHAMapAbstractNode> const& node) const;
 
     // Structure to track information about call to
@@ -452,7 +467,7 @@ public:
     using pointer           = value_type const*;
 
 private:
-    SharedPtrNodeStack stack_;
+    NodeStack          stack_;
     SHAMap const*      map_  = nullptr;
     pointer            item_ = nullptr;
 
@@ -468,7 +483,7 @@ public:
 private:
     explicit const_iterator(SHAMap const* map);
     const_iterator(SHAMap const* map, pointer item);
-    const_iterator(SHAMap const* map, pointer item, SharedPtrNodeStack&& stack);
+    const_iterator(SHAMap const* map, pointer item, NodeStack&& stack);
 
     friend bool operator==(const_iterator const& x, const_iterator const& y);
     friend class SHAMap;
@@ -493,7 +508,7 @@ SHAMap::const_iterator::const_iterator(SHAMap const* map, pointer item)
 
 inline
 SHAMap::const_iterator::const_iterator(SHAMap const* map, pointer item,
-                                       SharedPtrNodeStack&& stack)
+                                       NodeStack&& stack)
     : stack_(std::move(stack))
     , map_(map)
     , item_(item)
@@ -31,6 +31,8 @@
 #include <casinocoin/basics/TaggedCache.h>
 #include <casinocoin/beast/utility/Journal.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -153,14 +155,40 @@ class SHAMapInnerNodeV2;
 class SHAMapInnerNode
     : public SHAMapAbstractNode
 {
-    std::array<SHAMapHash, 16>          mHashes;
-    std::shared_ptr<SHAMapAbstractNode> mChildren[16];
-    int                             mIsBranch = 0;
+    struct Branch
+    {
+        SHAMapHash                          hash;
+        std::shared_ptr<SHAMapAbstractNode> child;
+    };
+
+    // Only the non-empty branches are stored, in branch order. Most
+    // inner nodes have just a few, so the array grows on demand.
+    std::unique_ptr<Branch[]>       mBranches;
+    std::uint16_t                   mIsBranch = 0;
+    std::uint8_t                    mCapacity = 0;
     std::uint32_t                   mFullBelowGen = 0;
 
-    static std::mutex               childLock;
+    // Children are hooked up under one of a set of locks chosen
+    // by node address, so unrelated nodes rarely contend.
+    static std::size_t const        childLockCount = 64;
+    static std::array<std::mutex, childLockCount> childLocks;
+
+    static std::atomic<std::int64_t> innerCount;
+    static std::atomic<std::int64_t> innerBytes;
+
+    std::mutex& childLock () const;
+
+    // Position of a non-empty branch in mBranches
+    int position (int m) const;
+    Branch* findBranch (int m) const;
+    Branch& insertBranch (int m);
+    void eraseBranch (int m);
+    void reserve (int capacity);
+    void setHashes (std::array<SHAMapHash, 16> const& hashes);
+
 public:
     SHAMapInnerNode(std::uint32_t seq);
+    ~SHAMapInnerNode() override;
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
 
     bool isEmpty () const;
@@ -186,6 +214,12 @@ public:
     uint256 const& key() const override;
     void invariants(bool is_v2, bool is_root = false) const override;
 
+    /** Number of inner nodes in memory */
+    static std::int64_t getCount ();
+
+    /** Bytes used by the inner nodes in memory, including their branches */
+    static std::int64_t getBytes ();
+
     friend std::shared_ptr<SHAMapAbstractNode>
         SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
              SHANodeFormat format, SHAMapHash const& hash, bool hashValid,
@@ -346,6 +380,29 @@ inline
 SHAMapInnerNode::SHAMapInnerNode(std::uint32_t seq)
     : SHAMapAbstractNode(tnINNER, seq)
 {
+    ++innerCount;
+    innerBytes += sizeof (SHAMapInnerNode);
+}
+
+inline
+int
+SHAMapInnerNode::position (int m) const
+{
+    // Count the non-empty branches below m
+    unsigned v = mIsBranch & ((1u << m) - 1);
+    v = v - ((v >> 1) & 0x5555);
+    v = (v & 0x3333) + ((v >> 2) & 0x3333);
+    v = (v + (v >> 4)) & 0x0F0F;
+    return (v + (v >> 8)) & 0x1F;
+}
+
+inline
+SHAMapInnerNode::Branch*
+SHAMapInnerNode::findBranch (int m) const
+{
+    if (isEmptyBranch (m))
+        return nullptr;
+    return &mBranches[position (m)];
 }
 
 inline
@@ -360,7 +417,10 @@ SHAMapHash const&
 SHAMapInnerNode::getChildHash (int m) const
 {
     assert ((m >= 0) && (m < 16) && (getType() == tnINNER));
-    return mHashes[m];
+    static SHAMapHash const zero;
+    if (auto const b = findBranch (m))
+        return b->hash;
+    return zero;
 }
 
 inline
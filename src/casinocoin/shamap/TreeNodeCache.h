@@ -26,14 +26,14 @@
 #ifndef CASINOCOIN_SHAMAP_TREENODECACHE_H_INCLUDED
 #define CASINOCOIN_SHAMAP_TREENODECACHE_H_INCLUDED
 
-#include <casinocoin/shamap/TreeNodeCache.h>
+#include <casinocoin/basics/ShardedTaggedCache.h>
 #include <casinocoin/shamap/SHAMapTreeNode.h>
 
 namespace casinocoin {
 
 class SHAMapAbstractNode;
 
-using TreeNodeCache = TaggedCache <uint256, SHAMapAbstractNode>;
+using TreeNodeCache = ShardedTaggedCache <uint256, SHAMapAbstractNode>;
 
 } // casinocoin
 
@@ -26,6 +26,8 @@
 #include <BeastConfig.h>
 #include <casinocoin/basics/contract.h>
 #include <casinocoin/shamap/SHAMap.h>
+#include <array>
+#include <atomic>
 
 namespace casinocoin {
 
@@ -95,7 +97,7 @@ SHAMap::make_v2() const
     assert(!is_v2());
     auto ret = std::make_shared<SHAMap>(type_, f_, version{2});
     ret->seq_ = seq_ + 1;
-    SharedPtrNodeStack stack;
+    NodeStack stack;
     for (auto leaf = peekFirstItem(stack); leaf != nullptr;
          leaf = peekNextItem(leaf->peekItem()->key(), stack))
     {
@@ -128,7 +130,7 @@ SHAMap::make_v1() const
     assert(is_v2());
     auto ret = std::make_shared<SHAMap>(type_, f_, version{1});
     ret->seq_ = seq_ + 1;
-    SharedPtrNodeStack stack;
+    NodeStack stack;
     for (auto leaf = peekFirstItem(stack); leaf != nullptr;
          leaf = peekNextItem(leaf->peekItem()->key(), stack))
     {
@@ -187,7 +189,11 @@ SHAMap::dirtyUp (SharedPtrNodeStack& stack,
 SHAMapTreeNode*
 SHAMap::walkTowardsKey(uint256 const& id, SharedPtrNodeStack* stack) const
 {
-    assert(stack == nullptr || stack->empty());
+    // Only callers about to modify the tree need to own the nodes
+    if (stack == nullptr)
+        return walkTowardsKey(id, static_cast<NodeStack*>(nullptr));
+
+    assert(stack->empty());
     auto inNode = root_;
     SHAMapNodeID nodeID;
     auto const isv2 = is_v2();
@@ -237,6 +243,59 @@ SHAMap::walkTowardsKey(uint256 const& id, SharedPtrNodeStack* stack) const
     return static_cast<SHAMapTreeNode*>(inNode.get());
 }
 
+SHAMapTreeNode*
+SHAMap::walkTowardsKey(uint256 const& id, NodeStack* stack) const
+{
+    assert(stack == nullptr || stack->empty());
+    auto inNode = root_.get();
+    SHAMapNodeID nodeID;
+    auto const isv2 = is_v2();
+
+    while (inNode->isInner())
+    {
+        if (stack != nullptr)
+            stack->push({inNode, nodeID});
+
+        if (isv2)
+        {
+            auto n = static_cast<SHAMapInnerNodeV2*>(inNode);
+            if (!n->has_common_prefix(id))
+                return nullptr;
+        }
+        auto const inner = static_cast<SHAMapInnerNode*>(inNode);
+        auto const branch = nodeID.selectBranch (id);
+        if (inner->isEmptyBranch (branch))
+            return nullptr;
+
+        inNode = descendThrow (inner, branch);
+        if (isv2)
+        {
+            if (inNode->isInner())
+            {
+                auto n = dynamic_cast<SHAMapInnerNodeV2*>(inNode);
+                if (n == nullptr)
+                {
+                    assert (false);
+                    return nullptr;
+                }
+                nodeID = SHAMapNodeID{n->depth(), n->common()};
+            }
+            else
+            {
+                nodeID = SHAMapNodeID{64, inNode->key()};
+            }
+        }
+        else
+        {
+            nodeID = nodeID.getChildNodeID (branch);
+        }
+    }
+
+    if (stack != nullptr)
+        stack->push({inNode, nodeID});
+    return static_cast<SHAMapTreeNode*>(inNode);
+}
+
 SHAMapTreeNode*
 SHAMap::findKey(uint256 const& id) const
 {
@@ -256,39 +315,7 @@ SHAMap::fetchNodeFromDB (SHAMapHash const& hash) const
         std::shared_ptr<NodeObject> obj = f_.db().fetch (hash.as_uint256());
         if (obj)
         {
-            try
-            {
-                node = SHAMapAbstractNode::make(makeSlice(obj->getData()),
-                    0, snfPREFIX, hash, true, f_.journal());
-                if (node && node->isInner())
-                {
-                    bool isv2 = std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) != nullptr;
-                    if (isv2 != is_v2())
-                    {
-                        auto root =  std::dynamic_pointer_cast<SHAMapInnerNode>(root_);
-                        assert(root);
-                        assert(root->isEmpty());
-                        if (isv2)
-                        {
-                            auto temp = make_v2();
-                            swap(temp->root_, const_cast<std::shared_ptr<SHAMapAbstractNode>&>(root_));
-                        }
-                        else
-                        {
-                            auto temp = make_v1();
-                            swap(temp->root_, const_cast<std::shared_ptr<SHAMapAbstractNode>&>(root_));
-                        }
-                    }
-                }
-                if (node)
-                    canonicalize (hash, node);
-            }
-            catch (std::exception const&)
-            {
-                JLOG(journal_.warn()) <<
-                    "Invalid DB node " << hash;
-                return std::shared_ptr<SHAMapTreeNode> ();
-            }
+            node = fetchNodeFromObject (hash, *obj);
         }
         else if (ledgerSeq_ != 0)
         {
@@ -300,6 +327,49 @@ SHAMap::fetchNodeFromDB (SHAMapHash const& hash) const
     return node;
 }
 
+// Make a node from an object read from the database
+std::shared_ptr<SHAMapAbstractNode>
+SHAMap::fetchNodeFromObject (SHAMapHash const& hash, NodeObject const& obj) const
+{
+    std::shared_ptr<SHAMapAbstractNode> node;
+
+    try
+    {
+        node = SHAMapAbstractNode::make(makeSlice(obj.getData()),
+            0, snfPREFIX, hash, true, f_.journal());
+        if (node && node->isInner())
+        {
+            bool isv2 = std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) != nullptr;
+            if (isv2 != is_v2())
+            {
+                auto root =  std::dynamic_pointer_cast<SHAMapInnerNode>(root_);
+                assert(root);
+                assert(root->isEmpty());
+                if (isv2)
+                {
+                    auto temp = make_v2();
+                    swap(temp->root_, const_cast<std::shared_ptr<SHAMapAbstractNode>&>(root_));
+                }
+                else
+                {
+                    auto temp = make_v1();
+                    swap(temp->root_, const_cast<std::shared_ptr<SHAMapAbstractNode>&>(root_));
+                }
+            }
+        }
+        if (node)
+            canonicalize (hash, node);
+    }
+    catch (std::exception const&)
+    {
+        JLOG(journal_.warn()) <<
+            "Invalid DB node " << hash;
+        return std::shared_ptr<SHAMapTreeNode> ();
+    }
+
+    return node;
+}
+
 // See if a sync filter has a node
 std::shared_ptr<SHAMapAbstractNode>
 SHAMap::checkFilter(SHAMapHash const& hash,
@@ -420,13 +490,15 @@ SHAMap::descend (std::shared_ptr<SHAMapInnerNode> const& parent, int branch) con
 
 // Gets the node that would be hooked to this branch,
 // but doesn't hook it up.
-std::shared_ptr<SHAMapAbstractNode>
-SHAMap::descendNoStore (std::shared_ptr<SHAMapInnerNode> const& parent, int branch) const
+SHAMapAbstractNode*
+SHAMap::descendNoStore (SHAMapInnerNode* parent, int branch,
+    std::shared_ptr<SHAMapAbstractNode>& owner) const
 {
-    std::shared_ptr<SHAMapAbstractNode> ret = parent->getChild (branch);
-    if (!ret && backed_)
-        ret = fetchNode (parent->getChildHash (branch));
-    return ret;
+    if (auto ret = parent->getChildPointer (branch))
+        return ret;
+    if (backed_)
+        owner = fetchNode (parent->getChildHash (branch));
+    return owner.get ();
 }
 
 std::pair <SHAMapAbstractNode*, SHAMapNodeID>
@@ -531,24 +603,24 @@ SHAMap::unshareNode (std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
 }
 
 SHAMapTreeNode*
-SHAMap::firstBelow(std::shared_ptr<SHAMapAbstractNode> node,
-                   SharedPtrNodeStack& stack, int branch) const
+SHAMap::firstBelow(SHAMapAbstractNode* node,
+                   NodeStack& stack, int branch) const
 {
     // Return the first item at or below this node
     if (node->isLeaf())
     {
-        auto n = std::static_pointer_cast<SHAMapTreeNode>(node);
+        auto n = static_cast<SHAMapTreeNode*>(node);
         stack.push({node, {64, n->peekItem()->key()}});
-        return n.get();
+        return n;
     }
-    auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+    auto inner = static_cast<SHAMapInnerNode*>(node);
     if (stack.empty())
         stack.push({inner, SHAMapNodeID{}});
     else
     {
         if (is_v2())
         {
-            auto inner2 = std::dynamic_pointer_cast<SHAMapInnerNodeV2>(inner);
+            auto inner2 = dynamic_cast<SHAMapInnerNodeV2*>(inner);
             assert(inner2 != nullptr);
             stack.push({inner2, {inner2->depth(), inner2->common()}});
         }
@@ -565,14 +637,14 @@ SHAMap::firstBelow(std::shared_ptr<SHAMapAbstractNode> node,
             assert(!stack.empty());
             if (node->isLeaf())
             {
-                auto n = std::static_pointer_cast<SHAMapTreeNode>(node);
+                auto n = static_cast<SHAMapTreeNode*>(node);
                 stack.push({n, {64, n->peekItem()->key()}});
-                return n.get();
+                return n;
             }
-            inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+            inner = static_cast<SHAMapInnerNode*>(node);
             if (is_v2())
             {
-                auto inner2 = std::static_pointer_cast<SHAMapInnerNodeV2>(inner);
+                auto inner2 = static_cast<SHAMapInnerNodeV2*>(inner);
                 stack.push({inner2, {inner2->depth(), inner2->common()}});
             }
             else
@@ -630,10 +702,10 @@ static std::shared_ptr<
     SHAMapItem const> const nullConstSHAMapItem;
 
 SHAMapTreeNode const*
-SHAMap::peekFirstItem(SharedPtrNodeStack& stack) const
+SHAMap::peekFirstItem(NodeStack& stack) const
 {
     assert(stack.empty());
-    SHAMapTreeNode* node = firstBelow(root_, stack);
+    SHAMapTreeNode* node = firstBelow(root_.get(), stack);
     if (!node)
     {
         while (!stack.empty())
@@ -644,7 +716,7 @@ SHAMap::peekFirstItem(SharedPtrNodeStack& stack) const
 }
 
 SHAMapTreeNode const*
-SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
+SHAMap::peekNextItem(uint256 const& id, NodeStack& stack) const
 {
     assert(!stack.empty());
     assert(stack.top().first->isLeaf());
@@ -654,7 +726,7 @@ SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
         auto node = stack.top().first;
         auto nodeID = stack.top().second;
         assert(!node->isLeaf());
-        auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+        auto inner = static_cast<SHAMapInnerNode*>(node);
         for (auto i = nodeID.selectBranch(id) + 1; i < 16; ++i)
         {
             if (!inner->isEmptyBranch(i))
@@ -713,9 +785,9 @@ SHAMap::upper_bound(uint256 const& id) const
 {
     // Get a const_iterator to the next item in the tree after a given item
     // item need not be in tree
-    SharedPtrNodeStack stack;
+    NodeStack stack;
     walkTowardsKey(id, &stack);
-    std::shared_ptr<SHAMapAbstractNode> node;
+    SHAMapAbstractNode* node;
     SHAMapNodeID nodeID;
     auto const isv2 = is_v2();
     while (!stack.empty())
@@ -723,17 +795,17 @@ SHAMap::upper_bound(uint256 const& id) const
         std::tie(node, nodeID) = stack.top();
         if (node->isLeaf())
         {
-            auto leaf = static_cast<SHAMapTreeNode*>(node.get());
+            auto leaf = static_cast<SHAMapTreeNode*>(node);
             if (leaf->peekItem()->key() > id)
                 return const_iterator(this, leaf->peekItem().get(), std::move(stack));
         }
         else
         {
-            auto inner = std::static_pointer_cast<SHAMapInnerNode>(node);
+            auto inner = static_cast<SHAMapInnerNode*>(node);
             int branch;
             if (isv2)
             {
-                auto n = std::static_pointer_cast<SHAMapInnerNodeV2>(inner);
+                auto n = static_cast<SHAMapInnerNodeV2*>(inner);
                 if (n->has_common_prefix(id))
                     branch = nodeID.selectBranch(id) + 1;
                 else if (id < n->common())
@@ -1164,22 +1236,11 @@ int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
 int
 SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 {
-    int flushed = 0;
-    Serializer s;
-
     if (!root_ || (root_->getSeq() == 0))
-        return flushed;
+        return 0;
 
     if (root_->isLeaf())
-    { // special case -- root_ is leaf
-        root_ = preFlushNode (std::move(root_));
-        root_->updateHash();
-        if (doWrite && backed_)
-            root_ = writeNode(t, seq, std::move(root_));
-        else
-            root_->setSeq (0);
-        return 1;
-    }
+        return flushSubTree (root_, doWrite, t, seq);
 
     auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
 
@@ -1192,12 +1253,100 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         return 1;
     }
 
+    // Collect the dirty subtrees below the root
+    std::array<std::shared_ptr<SHAMapAbstractNode>, 16> children;
+    std::size_t dirty = 0;
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (node->isEmptyBranch (branch))
+            continue;
+
+        auto child = node->getChild (branch);
+        if (child && (child->getSeq() != 0))
+        {
+            children[branch] = std::move (child);
+            ++dirty;
+        }
+    }
+
+    // Only writing is worth handing to other threads
+    auto& pool = f_.flushPool ();
+    auto const threads = doWrite ? std::min (pool.size (), dirty) : 1;
+    if (threads <= 1)
+        return flushSubTree (root_, doWrite, t, seq);
+
+    // Each thread takes the next unclaimed subtree until none are
+    // left. Every subtree stores its children before its own root,
+    // and the map's root is only written once all of them are done.
+    std::atomic<int> next {0};
+    std::atomic<int> flushed {0};
+    pool.run (threads, [&]()
+    {
+        try
+        {
+            for (int branch; (branch = next++) < 16;)
+            {
+                if (children[branch])
+                {
+                    flushed += flushSubTree (
+                        children[branch], doWrite, t, seq);
+                }
+            }
+        }
+        catch (...)
+        {
+            // Stop the other threads, the pool rethrows
+            next = 16;
+            throw;
+        }
+    });
+
+    node = preFlushNode (std::move (node));
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (children[branch])
+            node->shareChild (branch, children[branch]);
+    }
+
+    node->updateHashDeep();
+
+    if (doWrite && backed_)
+        root_ = writeNode (t, seq, std::move (node));
+    else
+    {
+        node->setSeq (0);
+        root_ = std::move (node);
+    }
+
+    return flushed + 1;
+}
+
+int
+SHAMap::flushSubTree (std::shared_ptr<SHAMapAbstractNode>& subtree,
+    bool doWrite, NodeObjectType t, std::uint32_t seq) const
+{
+    assert (subtree->getSeq() != 0);
+
+    if (subtree->isLeaf())
+    {
+        subtree = preFlushNode (std::move(subtree));
+        subtree->updateHash();
+        if (doWrite && backed_)
+            subtree = writeNode(t, seq, std::move(subtree));
+        else
+            subtree->setSeq (0);
+        return 1;
+    }
+
+    int flushed = 0;
+
     // Stack of {parent,index,child} pointers representing
     // inner nodes we are in the process of flushing
     using StackEntry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
+    auto node = preFlushNode(
+        std::static_pointer_cast<SHAMapInnerNode>(std::move(subtree)));
 
     int pos = 0;
 
@@ -1279,8 +1428,8 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         ++pos;
     }
 
-    // Last inner node is the new root_
-    root_ = std::move (node);
+    // Last inner node is the new root of the subtree
+    subtree = std::move (node);
 
     return flushed;
 }
@@ -1361,7 +1510,7 @@ SHAMap::invariants() const
     auto node = root_.get();
     assert(node != nullptr);
     assert(!node->isLeaf());
-    SharedPtrNodeStack stack;
+    NodeStack stack;
     for (auto leaf = peekFirstItem(stack); leaf != nullptr;
          leaf = peekNextItem(leaf->peekItem()->key(), stack))
         ;
@@ -238,27 +238,36 @@ void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissi
     if (!root_->isInner ())  // root_ is only node, and we have it
         return;
 
-    using StackEntry = std::shared_ptr<SHAMapInnerNode>;
+    // Nodes that are not hooked into the tree are owned by their entry
+    using StackEntry = std::pair <SHAMapInnerNode*,
+        std::shared_ptr<SHAMapAbstractNode>>;
     std::stack <StackEntry, std::vector <StackEntry>> nodeStack;
 
-    nodeStack.push (std::static_pointer_cast<SHAMapInnerNode>(root_));
+    nodeStack.emplace (static_cast<SHAMapInnerNode*>(root_.get()), nullptr);
 
     while (!nodeStack.empty ())
     {
-        std::shared_ptr<SHAMapInnerNode> node = std::move (nodeStack.top());
+        auto const entry = std::move (nodeStack.top());
+        auto const node = entry.first;
         nodeStack.pop ();
 
         for (int i = 0; i < 16; ++i)
         {
             if (!node->isEmptyBranch (i))
             {
-                std::shared_ptr<SHAMapAbstractNode> nextNode = descendNoStore (node, i);
+                std::shared_ptr<SHAMapAbstractNode> owner;
+                auto const nextNode = descendNoStore (node, i, owner);
 
                 if (nextNode)
                 {
+                    // A child hooked under a node we own lives as long
+                    // as that node does
+                    if (!owner)
+                        owner = entry.second;
                     if (nextNode->isInner ())
-                        nodeStack.push(
-                            std::static_pointer_cast<SHAMapInnerNode>(nextNode));
+                        nodeStack.emplace (
+                            static_cast<SHAMapInnerNode*>(nextNode),
+                            std::move (owner));
                 }
                 else
                 {
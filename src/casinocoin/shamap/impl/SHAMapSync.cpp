@@ -56,20 +56,23 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
     if (!root_->isInner ())
         return;
 
-    using StackEntry = std::pair <int, std::shared_ptr<SHAMapInnerNode>>;
+    // Nodes that are not hooked into the tree are owned by their entry
+    using StackEntry = std::tuple <int, SHAMapInnerNode*,
+        std::shared_ptr<SHAMapAbstractNode>>;
     std::stack <StackEntry, std::vector <StackEntry>> stack;
 
-    auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    auto node = static_cast<SHAMapInnerNode*>(root_.get());
+    std::shared_ptr<SHAMapAbstractNode> owner;
     int pos = 0;
 
     while (1)
     {
         while (pos < 16)
         {
-            uint256 childHash;
             if (!node->isEmptyBranch (pos))
             {
-                std::shared_ptr<SHAMapAbstractNode> child = descendNoStore (node, pos);
+                std::shared_ptr<SHAMapAbstractNode> childOwner;
+                auto child = descendNoStore (node, pos, childOwner);
                 if (function (*child))
                     return;
 
@@ -77,6 +80,11 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
                     ++pos;
                 else
                 {
+                    // A child hooked under a node we own lives as long
+                    // as that node does
+                    if (!childOwner)
+                        childOwner = owner;
+
                     // If there are no more children, don't push this node
                     while ((pos != 15) && (node->isEmptyBranch (pos + 1)))
                            ++pos;
@@ -84,11 +92,12 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
                     if (pos != 15)
                     {
                         // save next position to resume at
-                        stack.push (std::make_pair(pos + 1, std::move (node)));
+                        stack.emplace (pos + 1, node, std::move (owner));
                     }
 
                     // descend to the child's first position
-                    node = std::static_pointer_cast<SHAMapInnerNode>(child);
+                    node = static_cast<SHAMapInnerNode*>(child);
+                    owner = std::move (childOwner);
                     pos = 0;
                 }
             }
@@ -101,7 +110,7 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
         if (stack.empty ())
             break;
 
-        std::tie(pos, node) = stack.top ();
+        std::tie(pos, node, owner) = std::move (stack.top ());
         stack.pop ();
     }
 }
@@ -188,25 +197,40 @@ void SHAMap::gmn_ProcessNodes (MissingNodes& mn, MissingNodes::StackEntry& se)
 // process their results
 void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
 {
-    // Wait for our deferred reads to finish
+    auto const count = mn.deferredReads_.size ();
+
+    std::vector <uint256> hashes;
+    hashes.reserve (count);
+    for (auto const& deferredNode : mn.deferredReads_)
+    {
+        hashes.push_back (std::get<0>(deferredNode)->getChildHash (
+            std::get<2>(deferredNode)).as_uint256());
+    }
+
+    // Wait for our deferred reads to finish. They are already
+    // posted, so this only waits for the nodes we need
     auto const before = std::chrono::steady_clock::now();
-    f_.db().waitReads();
+    auto const objects = f_.db().fetchBatch (hashes);
     auto const after = std::chrono::steady_clock::now();
 
     auto const elapsed = std::chrono::duration_cast
         <std::chrono::milliseconds> (after - before);
-    auto const count = mn.deferredReads_.size ();
 
     // Process all deferred reads
     int hits = 0;
-    for (auto const& deferredNode : mn.deferredReads_)
+    for (std::size_t i = 0; i < count; ++i)
     {
+        auto const& deferredNode = mn.deferredReads_[i];
         auto parent = std::get<0>(deferredNode);
         auto const& parentID = std::get<1>(deferredNode);
         auto branch = std::get<2>(deferredNode);
         auto const& nodeHash = parent->getChildHash (branch);
 
-        auto nodePtr = fetchNodeNT(nodeHash, mn.filter_);
+        std::shared_ptr<SHAMapAbstractNode> nodePtr;
+        if (objects[i])
+            nodePtr = fetchNodeFromObject (nodeHash, *objects[i]);
+        if (! nodePtr)
+            nodePtr = fetchNodeNT(nodeHash, mn.filter_);
         if (nodePtr)
         { // Got the node
             ++hits;
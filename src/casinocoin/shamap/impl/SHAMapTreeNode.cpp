@@ -38,23 +38,120 @@
 
 namespace casinocoin {
 
-std::mutex SHAMapInnerNode::childLock;
+std::array<std::mutex, SHAMapInnerNode::childLockCount>
+    SHAMapInnerNode::childLocks;
+
+std::atomic<std::int64_t> SHAMapInnerNode::innerCount {0};
+std::atomic<std::int64_t> SHAMapInnerNode::innerBytes {0};
 
 SHAMapAbstractNode::~SHAMapAbstractNode() = default;
 
+std::mutex&
+SHAMapInnerNode::childLock () const
+{
+    // Nodes are larger than 64 bytes, the low address bits
+    // would only spread them over a few of the locks
+    auto const p = reinterpret_cast<std::uintptr_t>(this);
+    return childLocks[(p >> 6) % childLockCount];
+}
+
+SHAMapInnerNode::~SHAMapInnerNode()
+{
+    --innerCount;
+    innerBytes -= sizeof (SHAMapInnerNode) + mCapacity * sizeof (Branch);
+}
+
+std::int64_t
+SHAMapInnerNode::getCount ()
+{
+    return innerCount;
+}
+
+std::int64_t
+SHAMapInnerNode::getBytes ()
+{
+    return innerBytes;
+}
+
+// Make room for at least capacity branches
+void
+SHAMapInnerNode::reserve (int capacity)
+{
+    assert (capacity <= 16);
+    if (capacity <= mCapacity)
+        return;
+
+    std::unique_ptr<Branch[]> branches (new Branch[capacity]);
+    auto const count = position (16);
+    for (int i = 0; i < count; ++i)
+        branches[i] = std::move (mBranches[i]);
+
+    innerBytes += (capacity - mCapacity) * sizeof (Branch);
+    mBranches = std::move (branches);
+    mCapacity = capacity;
+}
+
+// Make branch m non-empty, keeping the other branches in order
+SHAMapInnerNode::Branch&
+SHAMapInnerNode::insertBranch (int m)
+{
+    auto const pos = position (m);
+    if (!isEmptyBranch (m))
+        return mBranches[pos];
+
+    auto const count = position (16);
+    if (count == mCapacity)
+        reserve (std::min (16, std::max (2, 2 * count)));
+
+    for (int i = count; i > pos; --i)
+        mBranches[i] = std::move (mBranches[i - 1]);
+    mBranches[pos] = Branch{};
+    mIsBranch |= (1 << m);
+    return mBranches[pos];
+}
+
+void
+SHAMapInnerNode::eraseBranch (int m)
+{
+    if (isEmptyBranch (m))
+        return;
+
+    auto const count = position (16);
+    for (int i = position (m); i < count - 1; ++i)
+        mBranches[i] = std::move (mBranches[i + 1]);
+    mBranches[count - 1] = Branch{};
+    mIsBranch &= ~ (1 << m);
+}
+
+// Set the hashes of a node read from the network or the database
+void
+SHAMapInnerNode::setHashes (std::array<SHAMapHash, 16> const& hashes)
+{
+    int count = 0;
+    for (auto const& hh : hashes)
+        if (hh.isNonZero ())
+            ++count;
+    reserve (count);
+
+    for (int i = 0; i < 16; ++i)
+        if (hashes[i].isNonZero ())
+            insertBranch (i).hash = hashes[i];
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMapInnerNode::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNode>(seq);
     p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
-    std::lock_guard <std::mutex> lock(childLock);
-    for (int i = 0; i < 16; ++i)
+    auto const count = position (16);
+    p->reserve (count);
+    p->mIsBranch = mIsBranch;
+    std::lock_guard <std::mutex> lock (childLock ());
+    for (int i = 0; i < count; ++i)
     {
-        p->mChildren[i] = mChildren[i];
-        assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) == nullptr);
+        p->mBranches[i] = mBranches[i];
+        assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mBranches[i].child) == nullptr);
     }
     return std::move(p);
 }
@@ -64,18 +161,19 @@ SHAMapInnerNodeV2::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNodeV2>(seq);
     p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
     p->common_ = common_;
     p->depth_ = depth_;
-    std::lock_guard <std::mutex> lock(childLock);
-    for (int i = 0; i < 16; ++i)
+    auto const count = position (16);
+    p->reserve (count);
+    p->mIsBranch = mIsBranch;
+    std::lock_guard <std::mutex> lock (childLock ());
+    for (int i = 0; i < count; ++i)
     {
-        p->mChildren[i] = mChildren[i];
-        if (p->mChildren[i] != nullptr)
-            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) != nullptr ||
-                   std::dynamic_pointer_cast<SHAMapTreeNode>(p->mChildren[i]) != nullptr);
+        p->mBranches[i] = mBranches[i];
+        if (p->mBranches[i].child != nullptr)
+            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mBranches[i].child) != nullptr ||
+                   std::dynamic_pointer_cast<SHAMapTreeNode>(p->mBranches[i].child) != nullptr);
     }
     return std::move(p);
 }
@@ -154,13 +252,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                 Throw<std::runtime_error> ("invalid FI node");
 
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -171,6 +266,7 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         {
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
             // compressed inner
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -178,10 +274,9 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -213,13 +308,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                 Throw<std::runtime_error> ("invalid FI node");
 
             auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -231,6 +323,7 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         {
             auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
             // compressed v2 inner
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -238,10 +331,9 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -311,13 +403,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             else
                 ret = std::make_shared<SHAMapInnerNode>(seq);
 
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
 
             if (isV2)
             {
@@ -374,8 +463,8 @@ SHAMapInnerNode::updateHash()
         sha512_half_hasher h;
         using beast::hash_append;
         hash_append(h, HashPrefix::innerNode);
-        for(auto const& hh : mHashes)
-            hash_append(h, hh);
+        for (int i = 0; i < 16; ++i)
+            hash_append(h, getChildHash (i));
         nh = static_cast<typename
             sha512_half_hasher::result_type>(h);
     }
@@ -388,10 +477,12 @@ SHAMapInnerNode::updateHash()
 void
 SHAMapInnerNode::updateHashDeep()
 {
-    for (auto pos = 0; pos < 16; ++pos)
+    auto const count = position (16);
+    for (auto pos = 0; pos < count; ++pos)
     {
-        if (mChildren[pos] != nullptr)
-            mHashes[pos] = mChildren[pos]->getNodeHash();
+        auto& b = mBranches[pos];
+        if (b.child != nullptr)
+            b.hash = b.child->getNodeHash();
     }
     updateHash();
 }
@@ -447,18 +538,18 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
         {
             s.add32 (HashPrefix::innerNode);
 
-            for (auto const& hh : mHashes)
-                s.add256 (hh.as_uint256());
+            for (int i = 0; i < 16; ++i)
+                s.add256 (getChildHash (i).as_uint256());
         }
         else  // format == snfWIRE
         {
             if (getBranchCount () < 12)
             {
                 // compressed node
-                for (int i = 0; i < mHashes.size(); ++i)
+                for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i].as_uint256());
+                        s.add256 (getChildHash (i).as_uint256());
                         s.add8 (i);
                     }
 
@@ -466,8 +557,8 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             }
             else
             {
-                for (auto const& hh : mHashes)
-                    s.add256 (hh.as_uint256());
+                for (int i = 0; i < 16; ++i)
+                    s.add256 (getChildHash (i).as_uint256());
 
                 s.add8 (2);
             }
@@ -485,7 +576,7 @@ SHAMapInnerNodeV2::addRaw(Serializer& s, SHANodeFormat format) const
         s.add32 (HashPrefix::innerNodeV2);
 
         for (int i = 0 ; i < 16; ++i)
-            s.add256 (mHashes[i].as_uint256());
+            s.add256 (getChildHash (i).as_uint256());
 
         s.add8(depth_);
 
@@ -598,13 +689,7 @@ bool SHAMapInnerNode::isEmpty () const
 int SHAMapInnerNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return position (16);
 }
 
 #ifdef BEAST_DEBUG
@@ -633,14 +718,14 @@ std::string
 SHAMapInnerNode::getString(const SHAMapNodeID & id) const
 {
     std::string ret = SHAMapAbstractNode::getString(id);
-    for (int i = 0; i < mHashes.size(); ++i)
+    for (int i = 0; i < 16; ++i)
     {
         if (!isEmptyBranch (i))
         {
             ret += "\nb";
             ret += beast::lexicalCastThrow <std::string> (i);
             ret += " = ";
-            ret += to_string (mHashes[i]);
+            ret += to_string (getChildHash (i));
         }
     }
     return ret;
@@ -676,13 +761,17 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapAbstractNode> const& chil
     assert (mType == tnINNER);
     assert (mSeq != 0);
     assert (child.get() != this);
-    mHashes[m].zero();
     mHash.zero();
     if (child)
-        mIsBranch |= (1 << m);
+    {
+        auto& b = insertBranch (m);
+        b.hash.zero();
+        b.child = child;
+    }
     else
-        mIsBranch &= ~ (1 << m);
-    mChildren[m] = child;
+    {
+        eraseBranch (m);
+    }
 }
 
 // finished modifying, now make shareable
@@ -693,8 +782,9 @@ void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> con
     assert (mSeq != 0);
     assert (child);
     assert (child.get() != this);
+    assert (!isEmptyBranch (m));
 
-    mChildren[m] = child;
+    findBranch (m)->child = child;
 }
 
 SHAMapAbstractNode*
@@ -703,8 +793,10 @@ SHAMapInnerNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    std::lock_guard <std::mutex> lock (childLock ());
+    if (auto const b = findBranch (branch))
+        return b->child.get ();
+    return nullptr;
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -713,8 +805,10 @@ SHAMapInnerNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch];
+    std::lock_guard <std::mutex> lock (childLock ());
+    if (auto const b = findBranch (branch))
+        return b->child;
+    return {};
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -723,20 +817,21 @@ SHAMapInnerNode::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractNod
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    std::lock_guard <std::mutex> lock (childLock ());
+    auto& child = findBranch (branch)->child;
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         // Hook this node up
         // node must not be a v2 inner node
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) == nullptr);
-        mChildren[branch] = node;
+        child = node;
     }
     return node;
 }
@@ -747,13 +842,14 @@ SHAMapInnerNodeV2::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractN
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    std::lock_guard <std::mutex> lock (childLock ());
+    auto& child = findBranch (branch)->child;
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
@@ -761,7 +857,7 @@ SHAMapInnerNodeV2::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractN
         // node must not be a v1 inner node
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) != nullptr ||
                std::dynamic_pointer_cast<SHAMapTreeNode>(node)    != nullptr);
-        mChildren[branch] = node;
+        child = node;
     }
     return node;
 }
@@ -833,10 +929,9 @@ SHAMapInnerNodeV2::setChildren(std::shared_ptr<SHAMapTreeNode> const& child1,
         b2 = *k2 >> 4;
         depth_ = 2*depth_;
     }
-    mChildren[b1] = child1;
-    mIsBranch |= 1 << b1;
-    mChildren[b2] = child2;
-    mIsBranch |= 1 << b2;
+    reserve (2);
+    insertBranch (b1).child = child1;
+    insertBranch (b2).child = child2;
 }
 
 void
@@ -874,11 +969,11 @@ SHAMapInnerNode::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash (i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
-                mChildren[i]->invariants(is_v2);
+            if (auto const& child = findBranch (i)->child)
+                child->invariants(is_v2);
             ++count;
         }
         else
@@ -902,21 +997,21 @@ SHAMapInnerNodeV2::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash (i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
+            if (auto const& child = findBranch (i)->child)
             {
-                assert(mHashes[i] == mChildren[i]->getNodeHash());
+                assert(getChildHash (i) == child->getNodeHash());
 #ifndef NDEBUG
-                auto const& childID = mChildren[i]->key();
+                auto const& childID = child->key();
 
                 // Make sure this child it attached to the correct branch
                 SHAMapNodeID nodeID {depth(), common()};
                 assert (i == nodeID.selectBranch(childID));
 #endif
                 assert(has_common_prefix(childID));
-                mChildren[i]->invariants(is_v2);
+                child->invariants(is_v2);
             }
             ++count;
         }
@@ -34,12 +34,14 @@
 #include <casinocoin/app/misc/Validations.cpp>
 
 #include <casinocoin/app/misc/impl/AccountTxPaging.cpp>
+#include <casinocoin/app/misc/impl/AccountTxStore.cpp>
 #include <casinocoin/app/misc/impl/AmendmentTable.cpp>
 #include <casinocoin/app/misc/impl/configuration/VotableConfiguration.cpp>
 #include <casinocoin/app/misc/impl/LoadFeeTrack.cpp>
 #include <casinocoin/app/misc/impl/Manifest.cpp>
 #include <casinocoin/app/misc/impl/Transaction.cpp>
 #include <casinocoin/app/misc/impl/TxQ.cpp>
+#include <casinocoin/app/misc/impl/TxVerifier.cpp>
 #include <casinocoin/app/misc/impl/ValidatorList.cpp>
 #include <casinocoin/app/misc/impl/ValidatorSite.cpp>
 
@@ -29,12 +29,14 @@
 #include <casinocoin/app/paths/AccountCurrencies.cpp>
 #include <casinocoin/app/paths/Credit.cpp>
 #include <casinocoin/app/paths/Pathfinder.cpp>
+#include <casinocoin/app/paths/PathCache.cpp>
 #include <casinocoin/app/paths/Node.cpp>
 #include <casinocoin/app/paths/PathRequest.cpp>
 #include <casinocoin/app/paths/PathRequests.cpp>
 #include <casinocoin/app/paths/PathState.cpp>
 #include <casinocoin/app/paths/CasinocoinCalc.cpp>
 #include <casinocoin/app/paths/CasinocoinLineCache.cpp>
+#include <casinocoin/app/paths/CasinocoinLineIndex.cpp>
 #include <casinocoin/app/paths/Flow.cpp>
 #include <casinocoin/app/paths/impl/PaySteps.cpp>
 #include <casinocoin/app/paths/impl/DirectStep.cpp>
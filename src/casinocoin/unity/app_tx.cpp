@@ -26,6 +26,7 @@
 #include <BeastConfig.h>
 
 #include <casinocoin/app/tx/impl/apply.cpp>
+#include <casinocoin/app/tx/impl/applyParallel.cpp>
 #include <casinocoin/app/tx/impl/applySteps.cpp>
 #include <casinocoin/app/tx/impl/BookTip.cpp>
 #include <casinocoin/app/tx/impl/CancelOffer.cpp>
@@ -37,6 +37,7 @@
 #include <casinocoin/basics/impl/strHex.cpp>
 #include <casinocoin/basics/impl/StringUtilities.cpp>
 #include <casinocoin/basics/impl/Sustain.cpp>
+#include <casinocoin/basics/impl/TaskPool.cpp>
 #include <casinocoin/basics/impl/Time.cpp>
 #include <casinocoin/basics/impl/UptimeTimer.cpp>
 
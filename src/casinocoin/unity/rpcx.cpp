@@ -44,7 +44,6 @@
 #include <casinocoin/rpc/handlers/AccountOffers.cpp>
 #include <casinocoin/rpc/handlers/AccountTx.cpp>
 #include <casinocoin/rpc/handlers/AccountTxOld.cpp>
-#include <casinocoin/rpc/handlers/AccountTxSwitch.cpp>
 #include <casinocoin/rpc/handlers/BlackList.cpp>
 #include <casinocoin/rpc/handlers/BookOffers.cpp>
 #include <casinocoin/rpc/handlers/CanDelete.cpp>
@@ -101,6 +100,7 @@
 
 #include <casinocoin/rpc/impl/Handler.cpp>
 #include <casinocoin/rpc/impl/LegacyPathFind.cpp>
+#include <casinocoin/rpc/impl/ResponseStream.cpp>
 #include <casinocoin/rpc/impl/Role.cpp>
 #include <casinocoin/rpc/impl/RPCHelpers.cpp>
 #include <casinocoin/rpc/impl/ServerHandlerImp.cpp>
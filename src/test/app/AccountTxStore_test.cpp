@@ -0,0 +1,477 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/misc/AccountTxStore.h>
+#include <casinocoin/app/misc/impl/AccountTxPaging.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+#include <casinocoin/core/ConfigSections.h>
+#include <casinocoin/core/SociDB.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <test/jtx.h>
+#include <chrono>
+
+namespace casinocoin {
+namespace test {
+
+class AccountTxStore_test : public beast::unit_test::suite
+{
+    using Seqs = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+    static
+    AccountTxStore::Record
+    record (std::uint8_t id, std::uint32_t txnSeq,
+        std::vector<AccountID> accounts)
+    {
+        AccountTxStore::Record r;
+        r.id = uint256 (id);
+        r.txnSeq = txnSeq;
+        r.accounts = std::move (accounts);
+        return r;
+    }
+
+    static
+    Blob
+    rawTxn (std::uint8_t id)
+    {
+        return Blob (10 + id, id);
+    }
+
+    static
+    Blob
+    rawMeta (std::uint8_t id)
+    {
+        return Blob (20 + id, id);
+    }
+
+    // Save a ledger the way it's saved with the Transactions table
+    static
+    void
+    save (DatabaseCon& txnDB, AccountTxStore& store, std::uint32_t seq,
+        std::vector<AccountTxStore::Record> const& records)
+    {
+        {
+            auto db = txnDB.checkoutDb ();
+            *db << "DELETE FROM Transactions WHERE LedgerSeq = " << seq << ";";
+            for (auto const& r : records)
+            {
+                // The records are numbered by the last byte of their ID
+                auto const id = static_cast<std::uint8_t> (
+                    *(r.id.cend () - 1));
+                *db << "INSERT OR REPLACE INTO Transactions (TransID, "
+                    "LedgerSeq, Status, RawTxn, TxnMeta) VALUES ('" <<
+                    to_string (r.id) << "'," << seq << ",'V',X'" <<
+                    strHex (rawTxn (id)) << "',X'" << strHex (rawMeta (id)) <<
+                    "');";
+            }
+        }
+        store.saveLedger (seq, records);
+    }
+
+    static
+    Seqs
+    entries (AccountTxStore& store, AccountID const& account,
+        bool forward = true, std::uint32_t minLedger = 0,
+        std::uint32_t maxLedger = 1000, boost::optional<
+            std::pair<std::uint32_t, std::uint32_t>> start = boost::none)
+    {
+        Seqs result;
+        store.forEach (account, minLedger, maxLedger, forward, start,
+            [&](AccountTxStore::Entry const& e)
+            {
+                result.emplace_back (e.ledgerSeq, e.txnSeq);
+                return true;
+            });
+        return result;
+    }
+
+    void
+    testStore (Section const& section)
+    {
+        testcase ("Store " + get<std::string> (section, "type"));
+
+        jtx::Env env (*this);
+        auto& txnDB = env.app ().getTxnDB ();
+        auto store = make_AccountTxStore (section, txnDB, beast::Journal ());
+        if (! BEAST_EXPECT(store))
+            return;
+
+        AccountID const alice (1);
+        AccountID const bob (2);
+        AccountID const carol (3);
+
+        save (txnDB, *store, 10,
+            {record (1, 0, {alice, bob}), record (2, 1, {alice})});
+        save (txnDB, *store, 11, {record (3, 0, {bob})});
+        save (txnDB, *store, 12, {record (4, 0, {alice, carol})});
+
+        BEAST_EXPECT(entries (*store, alice) ==
+            Seqs ({{10, 0}, {10, 1}, {12, 0}}));
+        BEAST_EXPECT(entries (*store, alice, false) ==
+            Seqs ({{12, 0}, {10, 1}, {10, 0}}));
+        BEAST_EXPECT(entries (*store, alice, true, 11) == Seqs ({{12, 0}}));
+        BEAST_EXPECT(entries (*store, alice, false, 0, 11) ==
+            Seqs ({{10, 1}, {10, 0}}));
+        BEAST_EXPECT(entries (*store, alice, true, 0, 1000,
+            std::make_pair (10u, 1u)) == Seqs ({{10, 1}, {12, 0}}));
+        BEAST_EXPECT(entries (*store, alice, false, 0, 1000,
+            std::make_pair (10u, 1u)) == Seqs ({{10, 1}, {10, 0}}));
+        BEAST_EXPECT(entries (*store, bob) == Seqs ({{10, 0}, {11, 0}}));
+        BEAST_EXPECT(entries (*store, AccountID (4)).empty ());
+
+        // The transactions are read from the Transactions table
+        std::size_t n = 0;
+        store->forEach (bob, 0, 1000, true, boost::none,
+            [&](AccountTxStore::Entry const& e)
+            {
+                auto const id = e.ledgerSeq == 10 ? 1 : 3;
+                BEAST_EXPECT(e.status == "V");
+                BEAST_EXPECT(e.rawTxn == rawTxn (id));
+                BEAST_EXPECT(e.rawMeta == rawMeta (id));
+                return ++n < 1;
+            });
+        BEAST_EXPECT(n == 1);
+
+        // Saving a ledger again replaces it
+        save (txnDB, *store, 12, {record (5, 0, {carol})});
+        BEAST_EXPECT(entries (*store, alice) == Seqs ({{10, 0}, {10, 1}}));
+        BEAST_EXPECT(entries (*store, carol) == Seqs ({{12, 0}}));
+
+        // A transaction saved with another ledger is only reported there
+        save (txnDB, *store, 13, {record (1, 2, {alice})});
+        BEAST_EXPECT(entries (*store, alice) == Seqs ({{10, 1}, {13, 2}}));
+        BEAST_EXPECT(entries (*store, bob) == Seqs ({{11, 0}}));
+
+        store->deleteBefore (12);
+        BEAST_EXPECT(entries (*store, alice) == Seqs ({{13, 2}}));
+        BEAST_EXPECT(entries (*store, bob).empty ());
+        BEAST_EXPECT(entries (*store, carol) == Seqs ({{12, 0}}));
+    }
+
+    void
+    testStores ()
+    {
+        {
+            Section section ("account_tx_db");
+            section.set ("type", "memory");
+            testStore (section);
+        }
+#if CASINOCOIN_ROCKSDB_AVAILABLE
+        {
+            beast::temp_dir dir;
+            Section section ("account_tx_db");
+            section.set ("type", "rocksdb");
+            section.set ("path", dir.path ());
+            testStore (section);
+        }
+#endif
+        Section section ("account_tx_db");
+        section.set ("type", "flat_file");
+        jtx::Env env (*this);
+        except ([&]
+        {
+            make_AccountTxStore (section,
+                env.app ().getTxnDB (), beast::Journal ());
+        });
+    }
+
+    // Some transactions between three accounts over several ledgers
+    static
+    void
+    history (jtx::Env& env)
+    {
+        using namespace jtx;
+        Account const gw ("gw");
+        env.fund (CSC (10000), "alice", "bob", gw);
+        env.close ();
+        env.trust (gw["USD"] (1000), "alice", "bob");
+        env.close ();
+        for (int i = 0; i < 10; ++i)
+        {
+            env (pay ("alice", "bob", CSC (1 + i)));
+            env (pay (gw, "alice", gw["USD"] (10)));
+            if (i % 3 == 0)
+                env (offer ("bob", gw["USD"] (5), CSC (5)));
+            env.close ();
+        }
+    }
+
+    // Page through account_tx, returning the transactions and markers
+    static
+    std::vector<Json::Value>
+    pages (jtx::Env& env, jtx::Account const& account, Json::Value params)
+    {
+        std::vector<Json::Value> result;
+        params[jss::account] = account.human ();
+        for (;;)
+        {
+            auto const page = env.rpc ("json", "account_tx",
+                to_string (params))[jss::result];
+            result.push_back (page[jss::transactions]);
+            if (! page.isMember (jss::marker))
+                break;
+            result.push_back (page[jss::marker]);
+            params[jss::marker] = page[jss::marker];
+        }
+        return result;
+    }
+
+    void
+    testAccountTx ()
+    {
+        testcase ("account_tx");
+
+        using namespace jtx;
+
+        // The same history, from the table and from the store
+        auto run = [&](bool stored)
+        {
+            Env env (*this, envconfig ([stored](std::unique_ptr<Config> cfg)
+            {
+                if (stored)
+                {
+                    cfg->section (ConfigSection::accountTxDatabase ()).set (
+                        "type", "memory");
+                }
+                return cfg;
+            }));
+            BEAST_EXPECT(! env.app ().getAccountTxStore () == ! stored);
+            history (env);
+
+            std::vector<std::vector<Json::Value>> result;
+            for (auto const& name : {"alice", "bob", "gw"})
+            {
+                Json::Value params;
+                params[jss::ledger_index_min] = -1;
+                params[jss::ledger_index_max] = -1;
+                params[jss::limit] = 3;
+                for (bool const forward : {false, true})
+                {
+                    params[jss::forward] = forward;
+                    result.push_back (pages (env, Account (name), params));
+                }
+
+                // The old request, by offset
+                Json::Value old;
+                old[jss::account] = Account (name).human ();
+                old[jss::offset] = 2;
+                old[jss::limit] = 5;
+                old[jss::descending] = true;
+                result.push_back ({env.rpc ("json", "account_tx",
+                    to_string (old))[jss::result][jss::transactions]});
+            }
+            return result;
+        };
+
+        auto const expected = run (false);
+        auto const actual = run (true);
+        if (! BEAST_EXPECT(expected.size () == actual.size ()))
+            return;
+        for (std::size_t i = 0; i < expected.size (); ++i)
+        {
+            BEAST_EXPECT(expected[i].size () > 1 || i % 3 == 2);
+            BEAST_EXPECT(expected[i] == actual[i]);
+        }
+    }
+
+    void
+    testImport ()
+    {
+        testcase ("Import");
+
+        using namespace jtx;
+        Env env (*this);
+        history (env);
+
+        Section section ("account_tx_db");
+        section.set ("type", "memory");
+        auto store = make_AccountTxStore (section,
+            env.app ().getTxnDB (), beast::Journal ());
+        BEAST_EXPECT(store->import () > 20);
+
+        auto sql = [&](auto&&... args)
+        {
+            accountTxPage (env.app ().getTxnDB (),
+                env.app ().accountIDCache (), args...);
+        };
+        auto stored = [&](auto&&... args)
+        {
+            accountTxPage (*store, args...);
+        };
+
+        using Page = std::vector<std::pair<std::uint32_t, Blob>>;
+        auto page = [&](auto const& from, AccountID const& account,
+            bool forward, Json::Value& marker)
+        {
+            Page result;
+            from ([](std::uint32_t) {},
+                [&](std::uint32_t seq, std::string const&,
+                    Blob const& rawTxn, Blob const& rawMeta)
+                {
+                    BEAST_EXPECT(! rawMeta.empty ());
+                    result.emplace_back (seq, rawTxn);
+                },
+                account, 0, -1, forward, marker, 4, false, 200);
+            return result;
+        };
+
+        for (auto const& name : {"alice", "bob", "gw"})
+        {
+            for (bool const forward : {false, true})
+            {
+                Json::Value sqlMarker;
+                Json::Value storeMarker;
+                std::size_t n = 0;
+                do
+                {
+                    auto const expected = page (sql,
+                        Account (name).id (), forward, sqlMarker);
+                    auto const actual = page (stored,
+                        Account (name).id (), forward, storeMarker);
+                    BEAST_EXPECT(! expected.empty ());
+                    BEAST_EXPECT(expected == actual);
+                    BEAST_EXPECT(sqlMarker == storeMarker);
+                    n += actual.size ();
+                }
+                while (sqlMarker.isObject ());
+                BEAST_EXPECT(n > 4);
+            }
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testStores ();
+        testAccountTx ();
+        testImport ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Pages through the history of a busy account in the transaction
+// database and in a RocksDB store
+class AccountTxStoreBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+public:
+    void
+    run () override
+    {
+#if CASINOCOIN_ROCKSDB_AVAILABLE
+        using namespace jtx;
+        using namespace std::chrono;
+        std::uint32_t const ledgers = 20000;
+        std::uint32_t const perLedger = 10;
+
+        Env env (*this);
+        Account const busy ("busy");
+
+        // Synthetic history, written directly to the tables
+        {
+            auto db = env.app ().getTxnDB ().checkoutDb ();
+            soci::transaction tr (*db);
+            std::string const account = busy.human ();
+            for (std::uint32_t seq = 1; seq <= ledgers; ++seq)
+            {
+                for (std::uint32_t i = 0; i < perLedger; ++i)
+                {
+                    auto const id = to_string (
+                        sha512Half (std::uint64_t (seq) << 32 | i));
+                    *db << "INSERT INTO AccountTransactions "
+                        "(TransID, Account, LedgerSeq, TxnSeq) VALUES ('" <<
+                        id << "','" << account << "'," << seq << "," << i <<
+                        ");";
+                    *db << "INSERT INTO Transactions (TransID, LedgerSeq, "
+                        "Status, RawTxn, TxnMeta) VALUES ('" << id << "'," <<
+                        seq << ",'V',X'" << std::string (400, 'A') << "',X'" <<
+                        std::string (800, 'B') << "');";
+                }
+            }
+            tr.commit ();
+        }
+
+        beast::temp_dir dir;
+        Section section ("account_tx_db");
+        section.set ("type", "rocksdb");
+        section.set ("path", dir.path ());
+        auto store = make_AccountTxStore (section,
+            env.app ().getTxnDB (), beast::Journal ());
+        {
+            auto const start = clock_type::now ();
+            auto const n = store->import ();
+            log << "imported " << n << " transactions in " <<
+                duration_cast<milliseconds> (
+                    clock_type::now () - start).count () << "ms" << std::endl;
+        }
+
+        auto sql = [&](auto&&... args)
+        {
+            accountTxPage (env.app ().getTxnDB (),
+                env.app ().accountIDCache (), args...);
+        };
+        auto stored = [&](auto&&... args)
+        {
+            accountTxPage (*store, args...);
+        };
+
+        auto bench = [&](char const* name, auto const& from)
+        {
+            for (bool const forward : {false, true})
+            {
+                auto const start = clock_type::now ();
+                Json::Value marker;
+                std::size_t pages = 0;
+                std::size_t n = 0;
+                do
+                {
+                    from ([](std::uint32_t) {},
+                        [&](std::uint32_t, std::string const&,
+                            Blob const&, Blob const&) { ++n; },
+                        busy.id (), 0, -1, forward, marker, 200, false, 200);
+                    ++pages;
+                }
+                while (marker.isObject ());
+                auto const elapsed =
+                    duration<double>(clock_type::now () - start);
+
+                log << name << (forward ? " forward: " : " backward: ") <<
+                    n << " transactions, " << pages << " pages, " <<
+                    static_cast<std::size_t> (pages / elapsed.count ()) <<
+                    " pages/sec" << std::endl;
+            }
+        };
+
+        bench ("transaction.db", sql);
+        bench ("rocksdb", stored);
+#endif
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountTxStore, app, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(AccountTxStoreBench, app, casinocoin);
+
+} // test
+} // casinocoin
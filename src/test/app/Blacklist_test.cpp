@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <casinocoin/app/misc/Blacklist.h>
+#include <casinocoin/basics/strHex.h>
+#include <casinocoin/beast/utility/rngfill.h>
+#include <casinocoin/beast/xor_shift_engine.h>
+#include <casinocoin/protocol/SecretKey.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+namespace casinocoin {
+namespace test {
+
+namespace detail {
+
+// Produces the fields BlacklistUpdater passes to refreshAccountOnList
+struct BlacklistSigner
+{
+    std::pair<PublicKey, SecretKey> keys =
+        randomKeyPair (KeyType::ed25519);
+
+    void
+    refresh (Blacklist& list, std::string const& account, bool enabled)
+    {
+        auto const sig = sign (keys.first, keys.second,
+            makeSlice (strHex (account)));
+        list.refreshAccountOnList (account, strHex (sig),
+            strHex (keys.first), "2019-04-04", "2019-04-04", enabled);
+    }
+};
+
+inline
+std::vector<AccountID>
+randomAccounts (std::size_t n, beast::xor_shift_engine& g)
+{
+    std::vector<AccountID> result (n);
+    for (auto& id : result)
+        beast::rngfill (id.data (), id.size (), g);
+    return result;
+}
+
+} // detail
+
+class Blacklist_test : public beast::unit_test::suite
+{
+    void
+    testListed ()
+    {
+        testcase ("Listed");
+
+        jtx::Env env (*this);
+        Blacklist list (env.timeKeeper (), beast::Journal{});
+        detail::BlacklistSigner signer;
+
+        beast::xor_shift_engine g (42);
+        auto const accounts = detail::randomAccounts (3, g);
+
+        for (auto const& id : accounts)
+        {
+            BEAST_EXPECT(! list.listed (id));
+            BEAST_EXPECT(! list.listed (toBase58 (id)));
+        }
+
+        signer.refresh (list, toBase58 (accounts[0]), true);
+        signer.refresh (list, toBase58 (accounts[1]), true);
+        signer.refresh (list, toBase58 (accounts[2]), false);
+        BEAST_EXPECT(list.getSize () == 2);
+
+        // The string lookup sees the change immediately, the AccountID
+        // index only after publishing
+        BEAST_EXPECT(list.listed (toBase58 (accounts[0])));
+        BEAST_EXPECT(! list.listed (accounts[0]));
+        list.publish ();
+        BEAST_EXPECT(list.listed (accounts[0]));
+        BEAST_EXPECT(list.listed (accounts[1]));
+        BEAST_EXPECT(! list.listed (accounts[2]));
+        BEAST_EXPECT(list.getAccount (toBase58 (accounts[1])).enabled);
+
+        // Disabling removes the account
+        signer.refresh (list, toBase58 (accounts[0]), false);
+        list.publish ();
+        BEAST_EXPECT(! list.listed (accounts[0]));
+        BEAST_EXPECT(! list.listed (toBase58 (accounts[0])));
+        BEAST_EXPECT(list.listed (accounts[1]));
+        BEAST_EXPECT(list.getSize () == 1);
+
+        // Entries with a bad signature are ignored
+        list.refreshAccountOnList (toBase58 (accounts[2]), "00",
+            strHex (signer.keys.first), "2019-04-04", "2019-04-04", true);
+        list.publish ();
+        BEAST_EXPECT(! list.listed (accounts[2]));
+        BEAST_EXPECT(list.getSize () == 1);
+    }
+
+    void
+    testConcurrentLookup ()
+    {
+        testcase ("Concurrent lookup");
+
+        jtx::Env env (*this);
+        Blacklist list (env.timeKeeper (), beast::Journal{});
+        detail::BlacklistSigner signer;
+
+        beast::xor_shift_engine g (7);
+        auto const accounts = detail::randomAccounts (64, g);
+
+        std::atomic<bool> done {false};
+        std::atomic<std::size_t> lookups {0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t)
+        {
+            readers.emplace_back ([&]
+            {
+                while (! done)
+                {
+                    for (auto const& id : accounts)
+                        list.listed (id);
+                    ++lookups;
+                }
+            });
+        }
+
+        for (auto const& id : accounts)
+        {
+            signer.refresh (list, toBase58 (id), true);
+            list.publish ();
+        }
+
+        done = true;
+        for (auto& t : readers)
+            t.join ();
+
+        for (auto const& id : accounts)
+            BEAST_EXPECT(list.listed (id));
+        BEAST_EXPECT(lookups > 0);
+    }
+
+public:
+    void
+    run () override
+    {
+        testListed ();
+        testConcurrentLookup ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Measures lookup cost on a blacklist with 100k entries
+class BlacklistLookup_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class Lookup>
+    void
+    measure (std::string const& what, std::size_t n, Lookup&& lookup)
+    {
+        using namespace std::chrono;
+        std::size_t found = 0;
+        auto const start = clock_type::now ();
+        for (std::size_t i = 0; i < n; ++i)
+            found += lookup (i) ? 1 : 0;
+        auto const elapsed = clock_type::now () - start;
+        log << std::setw (16) << what << " " <<
+            duration_cast<nanoseconds>(elapsed).count () / n <<
+            " ns/lookup (" << found << " hits)" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        std::size_t const listSize = 100000;
+        std::size_t const lookups = 1000000;
+
+        jtx::Env env (*this);
+        Blacklist list (env.timeKeeper (), beast::Journal{});
+        detail::BlacklistSigner signer;
+
+        beast::xor_shift_engine g (1);
+        auto const listed = detail::randomAccounts (listSize, g);
+        auto const probes = detail::randomAccounts (1024, g);
+
+        std::vector<std::string> linear;
+        linear.reserve (listSize);
+        for (auto const& id : listed)
+        {
+            linear.push_back (toBase58 (id));
+            signer.refresh (list, linear.back (), true);
+        }
+        list.publish ();
+        BEAST_EXPECT(list.getSize () == listSize);
+
+        // Half the lookups hit a listed account, half miss
+        auto probe = [&](std::size_t i) -> AccountID const&
+        {
+            return (i & 1) ? listed[(i * 7919) % listSize]
+                : probes[i % probes.size ()];
+        };
+
+        measure ("vector scan", lookups / 1000, [&](std::size_t i)
+        {
+            auto const s = toBase58 (probe (i));
+            return std::find (linear.begin (), linear.end (), s) !=
+                linear.end ();
+        });
+        measure ("base58 string", lookups, [&](std::size_t i)
+        {
+            return list.listed (toBase58 (probe (i)));
+        });
+        measure ("AccountID", lookups, [&](std::size_t i)
+        {
+            return list.listed (probe (i));
+        });
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Blacklist, app, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(BlacklistLookup, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,232 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/AcceptedLedger.h>
+#include <casinocoin/app/paths/CasinocoinLineIndex.h>
+#include <casinocoin/app/paths/PathRequests.h>
+#include <casinocoin/beast/xor_shift_engine.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class CasinocoinLineIndex_test : public beast::unit_test::suite
+{
+    // Check that the index holds the lines of the ledger, in order
+    void
+    expectLines (CasinocoinLineIndex& index, ReadView const& ledger,
+        AccountID const& account)
+    {
+        auto const expected = getCasinocoinStateItems (account, ledger);
+        auto const actual = index.getLines (ledger, account);
+        if (! BEAST_EXPECT(actual) ||
+            ! BEAST_EXPECT(actual->size () == expected.size ()))
+            return;
+        for (std::size_t i = 0; i < expected.size (); ++i)
+        {
+            auto const& a = *(*actual)[i];
+            auto const& e = *expected[i];
+            BEAST_EXPECT(a.key () == e.key ());
+            BEAST_EXPECT(a.getAccountID () == account);
+            BEAST_EXPECT(a.getBalance () == e.getBalance ());
+            BEAST_EXPECT(a.getLimit () == e.getLimit ());
+            BEAST_EXPECT(a.getLimitPeer () == e.getLimitPeer ());
+        }
+    }
+
+    static
+    void
+    feed (jtx::Env& env, CasinocoinLineIndex& index)
+    {
+        auto const ledger = env.closed ();
+        AcceptedLedger const accepted (ledger,
+            env.app ().accountIDCache (), env.app ().logs ());
+        index.update (*ledger, accepted);
+    }
+
+    void
+    testIncremental ()
+    {
+        testcase ("Incremental");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        std::vector<Account> const accounts {
+            "alice", "bob", "carol", "dave", "eve"};
+        env.fund (CSC (100000), gw);
+        for (auto const& a : accounts)
+            env.fund (CSC (100000), a);
+        env.close ();
+
+        std::vector<std::string> const currencies {
+            "USD", "EUR", "JPY", "GBP", "CAD", "AUD"};
+
+        CasinocoinLineIndex index (100, beast::Journal ());
+        BEAST_EXPECT(! index.getLines (*env.closed (), gw.id ()));
+        feed (env, index);
+        BEAST_EXPECT(index.seq () == env.closed ()->seq ());
+
+        // Lines of the open ledger aren't known
+        BEAST_EXPECT(! index.getLines (*env.current (), gw.id ()));
+
+        auto check = [&]()
+        {
+            expectLines (index, *env.closed (), gw.id ());
+            for (auto const& a : accounts)
+                expectLines (index, *env.closed (), a.id ());
+        };
+        check ();
+
+        beast::xor_shift_engine engine (42);
+        auto random = [&engine](std::size_t n)
+        {
+            return static_cast<std::size_t> (engine () % n);
+        };
+
+        std::size_t kept = 0;
+        for (int i = 0; i < 200; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                auto const& a = accounts[random (accounts.size ())];
+                auto const iou = gw[currencies[random (currencies.size ())]];
+                switch (random (4))
+                {
+                case 0:
+                    // Create or change a line
+                    env (trust (a, iou (1000 + random (100))));
+                    break;
+                case 1:
+                    // Move a balance, which may fail without a line
+                    env (pay (gw, a, iou (1 + random (10))),
+                        ter (std::ignore));
+                    break;
+                case 2:
+                    // Pay back everything and delete the line
+                    {
+                        auto const balance = env.balance (a, iou);
+                        if (balance.value () > zero)
+                            env (pay (a, gw, balance));
+                        env (trust (a, iou (0)), ter (std::ignore));
+                    }
+                    break;
+                default:
+                    // Lines between two users
+                    {
+                        auto const& b = accounts[random (accounts.size ())];
+                        if (a.id () != b.id ())
+                            env (trust (a, b[currencies[0]] (100)));
+                    }
+                    break;
+                }
+            }
+
+            env.close ();
+            feed (env, index);
+            for (auto const& a : accounts)
+                kept += index.getLines (*env.closed (), a.id (), false) ? 1 : 0;
+            check ();
+        }
+
+        // Most lines were patched rather than read again
+        BEAST_EXPECT(kept > 100 * accounts.size ());
+    }
+
+    void
+    testAccountLines ()
+    {
+        testcase ("account_lines");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        Account const alice ("alice");
+        env.fund (CSC (10000), gw, alice);
+        env.close ();
+        for (int i = 0; i < 30; ++i)
+            env (trust (alice, gw["C" + std::to_string (10 + i)] (100)));
+        env.close ();
+
+        auto const ledger = env.closed ();
+        auto const expected = getCasinocoinStateItems (alice.id (), *ledger);
+        if (! BEAST_EXPECT(expected.size () == 30))
+            return;
+
+        auto lines = [&](std::string const& marker)
+        {
+            Json::Value params;
+            params[jss::account] = toBase58 (alice.id ());
+            params[jss::ledger_index] = ledger->seq ();
+            params[jss::limit] = 7;
+            if (! marker.empty ())
+                params[jss::marker] = marker;
+            return env.rpc ("json", "account_lines",
+                to_string (params))[jss::result];
+        };
+
+        // Page through the lines from the state map, then from memory
+        for (bool const indexed : {false, true})
+        {
+            if (indexed)
+            {
+                auto& index = env.app ().getPathRequests ().lineIndex ();
+                feed (env, index);
+                BEAST_EXPECT(index.getLines (*ledger, alice.id ()));
+            }
+
+            std::string marker;
+            std::size_t n = 0;
+            do
+            {
+                auto const result = lines (marker);
+                if (! BEAST_EXPECT(result[jss::lines].isArray ()))
+                    break;
+                for (auto const& line : result[jss::lines])
+                {
+                    if (BEAST_EXPECT(n < expected.size ()))
+                    {
+                        BEAST_EXPECT(line[jss::currency] == to_string (
+                            expected[n]->getBalance ().getCurrency ()));
+                    }
+                    ++n;
+                }
+                marker = result[jss::marker].asString ();
+            }
+            while (! marker.empty ());
+            BEAST_EXPECT(n == expected.size ());
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testIncremental ();
+        testAccountLines ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CasinocoinLineIndex, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/ledger/FetchScheduler.h>
+#include <casinocoin/beast/clock/manual_clock.h>
+#include <casinocoin/beast/unit_test.h>
+#include <casinocoin/protocol/JsonFields.h>
+
+namespace casinocoin {
+namespace test {
+
+class FetchScheduler_test : public beast::unit_test::suite
+{
+    using clock_type = beast::manual_clock <std::chrono::steady_clock>;
+
+    static
+    Json::UInt
+    field (FetchScheduler& scheduler, clock_type& clock,
+        Peer::id_t peer, Json::StaticString const& name)
+    {
+        return scheduler.getJson (clock.now ())[jss::peers][
+            std::to_string (peer)][name].asUInt ();
+    }
+
+    void
+    testWindow ()
+    {
+        testcase ("Window");
+
+        using namespace std::chrono_literals;
+        clock_type clock;
+        FetchScheduler scheduler (clock.now ());
+        uint256 const ledger (1);
+        Peer::id_t const fast = 1;
+        Peer::id_t const slow = 2;
+
+        // Both peers are asked for all they may take, the fast one
+        // answers in 50ms and the slow one in 400ms
+        for (int round = 0; round < 10; ++round)
+        {
+            auto const selected = scheduler.select (
+                {{fast, boost::none}, {slow, boost::none}}, clock.now ());
+            BEAST_EXPECT(selected.size () == 2);
+            for (auto const& choice : selected)
+                scheduler.sent (choice.first, ledger,
+                    choice.second, clock.now ());
+
+            for (auto const& choice : selected)
+            {
+                clock.advance (choice.first == fast ? 50ms : 350ms);
+                BEAST_EXPECT(scheduler.received (choice.first, ledger,
+                    choice.second, 100 * choice.second, clock.now ()));
+            }
+        }
+
+        auto const fastWindow = field (scheduler, clock, fast, jss::window);
+        auto const slowWindow = field (scheduler, clock, slow, jss::window);
+        BEAST_EXPECT(fastWindow > 2 * slowWindow);
+        BEAST_EXPECT(slowWindow > 32);
+        BEAST_EXPECT(field (scheduler, clock, fast, jss::in_flight) == 0);
+        BEAST_EXPECT(field (scheduler, clock, fast, jss::latency) == 50);
+
+        // The fast peer comes first and may take its whole window
+        auto const selected = scheduler.select (
+            {{slow, boost::none}, {fast, boost::none}}, clock.now ());
+        BEAST_EXPECT(selected.size () == 2);
+        BEAST_EXPECT(selected[0].first == fast);
+        BEAST_EXPECT(selected[0].second == fastWindow);
+        BEAST_EXPECT(selected[1].first == slow);
+
+        // A slow peer is given up on later
+        BEAST_EXPECT(scheduler.timeout (fast) < scheduler.timeout (slow));
+    }
+
+    void
+    testLost ()
+    {
+        testcase ("Lost");
+
+        using namespace std::chrono_literals;
+        clock_type clock;
+        FetchScheduler scheduler (clock.now ());
+        uint256 const ledger (1);
+        Peer::id_t const peer = 3;
+
+        // A peer is first timed by its pings
+        auto selected = scheduler.select ({{peer, 100ms}}, clock.now ());
+        BEAST_EXPECT(selected.size () == 1);
+        BEAST_EXPECT(selected[0].second == 32);
+        BEAST_EXPECT(scheduler.timeout (peer) == 250ms);
+
+        // A full window takes no more requests
+        scheduler.sent (peer, ledger, 32, clock.now ());
+        BEAST_EXPECT(scheduler.select (
+            {{peer, 100ms}}, clock.now ()).empty ());
+
+        // An unanswered request shrinks the window and
+        // lengthens the wait for the next one
+        clock.advance (300ms);
+        selected = scheduler.select ({{peer, 100ms}}, clock.now ());
+        BEAST_EXPECT(selected.size () == 1);
+        BEAST_EXPECT(selected[0].second == 16);
+        BEAST_EXPECT(scheduler.timeout (peer) == 500ms);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::lost) == 1);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::in_flight) == 0);
+
+        // A late reply still counts toward the throughput
+        BEAST_EXPECT(! scheduler.received (
+            peer, ledger, 32, 4096, clock.now ()));
+        scheduler.retried (32);
+
+        auto const json = scheduler.getJson (clock.now ());
+        BEAST_EXPECT(json[jss::nodes_per_second].asUInt () > 0);
+        BEAST_EXPECT(json[jss::bytes_per_second].asUInt () > 0);
+        BEAST_EXPECT(json[jss::retried].asUInt () == 32);
+
+        // Idle peers are forgotten
+        clock.advance (std::chrono::minutes (10));
+        scheduler.sweep (clock.now ());
+        BEAST_EXPECT(scheduler.getJson (
+            clock.now ())[jss::peers].size () == 0);
+    }
+
+    void
+    testReorder ()
+    {
+        testcase ("Reorder");
+
+        using namespace std::chrono_literals;
+        clock_type clock;
+        FetchScheduler scheduler (clock.now ());
+        uint256 const first (1);
+        uint256 const second (2);
+        Peer::id_t const peer = 4;
+
+        auto const start = clock.now ();
+        scheduler.sent (peer, first, 8, clock.now ());
+        clock.advance (10ms);
+        scheduler.sent (peer, second, 8, clock.now ());
+        clock.advance (10ms);
+
+        // Replies are matched to the request for the same ledger
+        auto const answered = scheduler.received (
+            peer, second, 8, 1024, clock.now ());
+        BEAST_EXPECT(answered && *answered == start + 10ms);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::in_flight) == 8);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::lost) == 0);
+
+        auto const earlier = scheduler.received (
+            peer, first, 8, 1024, clock.now ());
+        BEAST_EXPECT(earlier && *earlier == start);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::in_flight) == 0);
+        BEAST_EXPECT(field (scheduler, clock, peer, jss::replies) == 2);
+    }
+
+public:
+    void
+    run () override
+    {
+        testWindow ();
+        testLost ();
+        testReorder ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FetchScheduler, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,229 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/ledger/LedgerReplay.h>
+#include <casinocoin/overlay/Message.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class LedgerReplay_test : public beast::unit_test::suite
+{
+    using Ledgers = std::vector<std::shared_ptr<Ledger const>>;
+
+    // Same as the overlay's limit on nodes in a reply
+    static int const maxNodes = 8192;
+
+    // Close n ledgers which create, modify and delete state entries
+    static
+    Ledgers
+    makeLedgers (jtx::Env& env, int n)
+    {
+        using namespace jtx;
+        Account const gw ("gateway");
+        Account const alice ("alice");
+        Account const bob ("bob");
+        env.fund (CSC (100000), gw, alice, bob);
+        env.close ();
+
+        Ledgers ledgers;
+        ledgers.push_back (env.app ().getLedgerMaster ().getClosedLedger ());
+        std::uint32_t offerSeq = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            env (pay (alice, bob, CSC (1)));
+            if (i % 4 == 0)
+            {
+                offerSeq = env.seq (alice);
+                env (offer (alice, gw["USD"](10), CSC (10)));
+            }
+            else if (i % 4 == 2)
+            {
+                env (offer_cancel (alice, offerSeq));
+            }
+            if (i % 10 == 0)
+                env.fund (CSC (1000), Account ("acct" + std::to_string (i)));
+            env.close ();
+            ledgers.push_back (
+                env.app ().getLedgerMaster ().getClosedLedger ());
+        }
+        return ledgers;
+    }
+
+    // The delta from the parent, as a peer receives it
+    std::shared_ptr<protocol::TMLedgerData>
+    makeDelta (Ledger const& ledger, Ledger const& parent)
+    {
+        protocol::TMLedgerData reply;
+        reply.set_ledgerhash (
+            ledger.info().hash.begin (), ledger.info().hash.size ());
+        reply.set_ledgerseq (ledger.info().seq);
+        reply.set_type (protocol::liDELTA);
+        if (! BEAST_EXPECT(makeLedgerDelta (ledger, parent, reply, maxNodes)))
+            return nullptr;
+
+        auto const& buffer = Message (
+            reply, protocol::mtLEDGER_DATA).getBuffer ();
+        auto delta = std::make_shared<protocol::TMLedgerData> ();
+        if (! BEAST_EXPECT(delta->ParseFromArray (
+                buffer.data () + Message::kHeaderBytes,
+                buffer.size () - Message::kHeaderBytes)))
+            return nullptr;
+        return delta;
+    }
+
+    void
+    testReplay ()
+    {
+        testcase ("Replay");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const ledgers = makeLedgers (env, 1000);
+
+        // Sync every ledger from the one replayed before it
+        auto parent = ledgers.front ();
+        std::size_t nodes = 0;
+        for (std::size_t i = 1; i < ledgers.size (); ++i)
+        {
+            auto const& expected = ledgers[i]->info();
+            auto const delta = makeDelta (*ledgers[i], *ledgers[i - 1]);
+            if (! delta)
+                return;
+            nodes += delta->nodes_size ();
+
+            auto const ledger = applyLedgerDelta (*parent, expected.hash,
+                *delta, env.app ().config (), env.journal);
+            if (! BEAST_EXPECT(ledger))
+                return;
+            BEAST_EXPECT(ledger->info().seq == expected.seq);
+            BEAST_EXPECT(ledger->info().hash == expected.hash);
+            BEAST_EXPECT(ledger->info().accountHash == expected.accountHash);
+            BEAST_EXPECT(ledger->info().txHash == expected.txHash);
+            BEAST_EXPECT(ledger->info().drops == expected.drops);
+            BEAST_EXPECT(ledger->isImmutable ());
+            parent = ledger;
+        }
+
+        // A few entries per ledger instead of whole maps
+        log << ledgers.size () - 1 << " ledgers replayed from " <<
+            nodes << " nodes" << std::endl;
+        BEAST_EXPECT(nodes < 20 * (ledgers.size () - 1));
+
+        // The replayed ledger reads like the original
+        jtx::Account const alice ("alice");
+        auto const sle = parent->read (keylet::account (alice.id ()));
+        auto const original =
+            ledgers.back ()->read (keylet::account (alice.id ()));
+        if (BEAST_EXPECT(sle && original))
+            BEAST_EXPECT(sle->getSerializer () == original->getSerializer ());
+    }
+
+    void
+    testBadDelta ()
+    {
+        testcase ("Bad delta");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const ledgers = makeLedgers (env, 4);
+        auto const& config = env.app ().config ();
+        auto const& ledger = *ledgers[3];
+        auto const& parent = *ledgers[2];
+        auto const hash = ledger.info().hash;
+
+        auto delta = makeDelta (ledger, parent);
+        if (! delta)
+            return;
+        BEAST_EXPECT(applyLedgerDelta (
+            parent, hash, *delta, config, env.journal));
+
+        // Not the parent
+        {
+            protocol::TMLedgerData reply;
+            BEAST_EXPECT(! makeLedgerDelta (
+                ledger, *ledgers[1], reply, maxNodes));
+            BEAST_EXPECT(! applyLedgerDelta (
+                *ledgers[1], hash, *delta, config, env.journal));
+        }
+
+        // Too large for the reply
+        {
+            protocol::TMLedgerData reply;
+            BEAST_EXPECT(! makeLedgerDelta (ledger, parent, reply, 2));
+        }
+
+        // Another ledger's hash
+        BEAST_EXPECT(! applyLedgerDelta (
+            parent, parent.info().hash, *delta, config, env.journal));
+
+        // A changed state entry
+        {
+            auto bad = *delta;
+            auto const first = 1 + static_cast<int> (bad.txcount ());
+            auto node = std::find_if (
+                bad.mutable_nodes ()->begin () + first,
+                bad.mutable_nodes ()->end (),
+                [](auto const& n) { return ! n.nodedata ().empty (); });
+            if (BEAST_EXPECT(node != bad.mutable_nodes ()->end ()))
+            {
+                auto data = node->nodedata ();
+                data[data.size () / 2] ^= 1;
+                node->set_nodedata (data);
+                BEAST_EXPECT(! applyLedgerDelta (
+                    parent, hash, bad, config, env.journal));
+            }
+        }
+
+        // A missing state entry
+        {
+            auto bad = *delta;
+            bad.mutable_nodes ()->RemoveLast ();
+            BEAST_EXPECT(! applyLedgerDelta (
+                parent, hash, bad, config, env.journal));
+        }
+
+        // Transactions counted as state
+        {
+            auto bad = *delta;
+            bad.set_txcount (0);
+            BEAST_EXPECT(! applyLedgerDelta (
+                parent, hash, bad, config, env.journal));
+            bad.set_txcount (bad.nodes_size ());
+            BEAST_EXPECT(! applyLedgerDelta (
+                parent, hash, bad, config, env.journal));
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testReplay ();
+        testBadDelta ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerReplay,app,casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/ledger/AcceptedLedger.h>
+#include <casinocoin/app/ledger/OrderBookDB.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <test/jtx.h>
+#include <deque>
+#include <map>
+#include <set>
+
+namespace casinocoin {
+namespace test {
+
+class OrderBookDB_test : public beast::unit_test::suite
+{
+    using BookSet = std::map<Issue, std::set<uint256>>;
+
+    // The books in a ledger, found by scanning all of its entries
+    static
+    BookSet
+    scan (ReadView const& ledger, std::set<Issue>& toCSC)
+    {
+        BookSet books;
+        for (auto const& sle : ledger.sles)
+        {
+            if (sle->getType () == ltDIR_NODE &&
+                sle->isFieldPresent (sfExchangeRate) &&
+                sle->getFieldH256 (sfRootIndex) == sle->key ())
+            {
+                Book book;
+                book.in.currency.copyFrom (
+                    sle->getFieldH160 (sfTakerPaysCurrency));
+                book.in.account.copyFrom (
+                    sle->getFieldH160 (sfTakerPaysIssuer));
+                book.out.currency.copyFrom (
+                    sle->getFieldH160 (sfTakerGetsCurrency));
+                book.out.account.copyFrom (
+                    sle->getFieldH160 (sfTakerGetsIssuer));
+                books[book.in].insert (getBookBase (book));
+                if (isCSC (book.out))
+                    toCSC.insert (book.in);
+            }
+        }
+        return books;
+    }
+
+    // Check that the index holds exactly the books in the ledger
+    void
+    expectBooks (OrderBookDB& db, ReadView const& ledger,
+        std::vector<Issue> const& issues)
+    {
+        std::set<Issue> toCSC;
+        auto const expected = scan (ledger, toCSC);
+        for (auto const& issue : issues)
+        {
+            std::set<uint256> actual;
+            for (auto const& ob : db.getBooksByTakerPays (issue))
+                actual.insert (ob->getBookBase ());
+
+            auto const it = expected.find (issue);
+            if (it == expected.end ())
+                BEAST_EXPECT(actual.empty ());
+            else
+                BEAST_EXPECT(actual == it->second);
+            BEAST_EXPECT(db.getBookSize (issue) == actual.size ());
+            BEAST_EXPECT(db.isBookToCSC (issue) == (toCSC.count (issue) > 0));
+        }
+    }
+
+    void
+    testIncremental ()
+    {
+        testcase ("Incremental");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        Account const alice ("alice");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        auto const JPY = gw["JPY"];
+
+        env.fund (CSC (100000), gw, alice);
+        env.close ();
+        env.trust (USD (100000), alice);
+        env.trust (EUR (100000), alice);
+        env.trust (JPY (100000), alice);
+        env.close ();
+        env (pay (gw, alice, USD (50000)));
+        env (pay (gw, alice, EUR (50000)));
+        env (pay (gw, alice, JPY (50000)));
+        env.close ();
+
+        std::vector<Issue> const issues {
+            cscIssue (), USD.issue (), EUR.issue (), JPY.issue ()};
+
+        auto amount = [&](std::size_t which, int n) -> STAmount
+        {
+            switch (which)
+            {
+            case 0: return CSC (n);
+            case 1: return USD (n);
+            case 2: return EUR (n);
+            default: return JPY (n);
+            }
+        };
+
+        // in and out of the books the offers are placed in
+        std::vector<std::pair<std::size_t, std::size_t>> const pairs {
+            {1, 0}, {0, 1}, {2, 1}, {1, 2}, {3, 0}, {2, 3}};
+
+        // An index fed only from the metadata of each closed ledger
+        RootStoppable parent ("TestRootStoppable");
+        OrderBookDB db (env.app (), parent);
+        db.setup (env.closed ());
+        expectBooks (db, *env.closed (), issues);
+
+        auto feed = [&]()
+        {
+            auto const ledger = env.closed ();
+            AcceptedLedger const accepted (ledger,
+                env.app ().accountIDCache (), env.app ().logs ());
+            db.update (ledger, accepted);
+        };
+
+        std::deque<std::uint32_t> offers;
+        for (int i = 0; i < 300; ++i)
+        {
+            auto const& p = pairs[i % pairs.size ()];
+
+            // Several qualities, so books have more than one directory
+            auto const rate = 1 + (i / pairs.size ()) % 3;
+            offers.push_back (env.seq (alice));
+            env (offer (alice, amount (p.first, 10 * rate),
+                amount (p.second, 10)));
+
+            if (i % 3 == 2)
+            {
+                env (offer_cancel (alice, offers.front ()));
+                offers.pop_front ();
+            }
+
+            // Created and deleted in the same ledger
+            if (i % 7 == 0)
+            {
+                auto const seq = env.seq (alice);
+                env (offer (alice, amount (p.second, 7), amount (p.first, 3)));
+                env (offer_cancel (alice, seq));
+            }
+
+            // Empty the books now and then
+            if (i % 50 == 49)
+            {
+                while (! offers.empty ())
+                {
+                    env (offer_cancel (alice, offers.front ()));
+                    offers.pop_front ();
+                }
+            }
+
+            env.close ();
+
+            // Skipping a ledger makes the index rescan the next one
+            if (i % 100 == 42)
+                continue;
+
+            feed ();
+            expectBooks (db, *env.closed (), issues);
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testIncremental ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OrderBookDB, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,572 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/AcceptedLedger.h>
+#include <casinocoin/app/ledger/OpenLedger.h>
+#include <casinocoin/app/ledger/OwnerDirIndex.h>
+#include <casinocoin/app/paths/CasinocoinState.h>
+#include <casinocoin/ledger/Sandbox.h>
+#include <casinocoin/ledger/View.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/rpc/impl/RPCHelpers.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <set>
+
+namespace casinocoin {
+namespace test {
+
+class OwnerDirIndex_test : public beast::unit_test::suite
+{
+    // Check that the index holds the owner directory of the ledger
+    void
+    expectDirectory (OwnerDirIndex& index, ReadView const& ledger,
+        AccountID const& account)
+    {
+        auto const dir = index.getDirectory (ledger, account);
+        if (! BEAST_EXPECT(dir))
+            return;
+
+        auto const root = keylet::ownerDir (account);
+        auto page = dir->begin ();
+        std::uint64_t n = 0;
+        do
+        {
+            auto const sle = ledger.read (keylet::page (root, n));
+            if (! sle)
+                break;
+            if (! BEAST_EXPECT(page != dir->end ()) ||
+                ! BEAST_EXPECT(page->first == n) ||
+                ! BEAST_EXPECT(page->second->key == sle->key ()))
+                return;
+
+            auto const& keys = sle->getFieldV256 (sfIndexes);
+            auto const& entries = page->second->entries;
+            if (! BEAST_EXPECT(keys.size () == entries.size ()))
+                return;
+            for (std::size_t i = 0; i < keys.size (); ++i)
+            {
+                BEAST_EXPECT(entries[i].key == keys[i]);
+                BEAST_EXPECT(entries[i].type ==
+                    ledger.read (keylet::child (keys[i]))->getType ());
+            }
+
+            ++page;
+            n = sle->getFieldU64 (sfIndexNext);
+        }
+        while (n != 0);
+        BEAST_EXPECT(page == dir->end ());
+    }
+
+    // Objects of several types owned by alice, and how to remove each
+    class Owner
+    {
+    public:
+        Owner (jtx::Env& env)
+            : env_ (env)
+            , gw_ ("gw")
+            , alice_ ("alice")
+        {
+            env_.fund (jtx::CSC (100000), gw_, alice_, "bob");
+            env_.close ();
+        }
+
+        AccountID
+        id () const
+        {
+            return alice_.id ();
+        }
+
+        void
+        addLines (int n)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                auto const iou = gw_["C" + std::to_string (next_++)];
+                env_ (jtx::trust (alice_, iou (100)));
+                remove_[keylet::line (alice_.id (), iou.issue ()).key] =
+                    [this, iou]() { env_ (jtx::trust (alice_, iou (0))); };
+            }
+        }
+
+        void
+        addOffers (int n)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                auto const seq = env_.seq (alice_);
+                env_ (jtx::offer (alice_, gw_["USD"] (10),
+                    jtx::CSC (10 + i)));
+                remove_[keylet::offer (alice_.id (), seq).key] =
+                    [this, seq]() { env_ (jtx::offer_cancel (alice_, seq)); };
+            }
+        }
+
+        void
+        addSignerList ()
+        {
+            env_ (jtx::signers (alice_, 1, {{"bob", 1}}));
+            remove_[keylet::signers (alice_.id ()).key] =
+                [this]() { env_ (jtx::signers (alice_, jtx::none)); };
+        }
+
+        // Remove every object on a page of the last closed ledger
+        void
+        empty (std::uint64_t n)
+        {
+            auto const sle = env_.closed ()->read (
+                keylet::page (keylet::ownerDir (alice_.id ()), n));
+            if (! sle)
+                return;
+            for (auto const& key : sle->getFieldV256 (sfIndexes))
+            {
+                auto const iter = remove_.find (key);
+                if (iter != remove_.end ())
+                {
+                    iter->second ();
+                    remove_.erase (iter);
+                }
+            }
+        }
+
+    private:
+        jtx::Env& env_;
+        jtx::Account const gw_;
+        jtx::Account const alice_;
+        int next_ = 10;
+        std::map<uint256, std::function<void ()>> remove_;
+    };
+
+    // Three pages with objects of each type spread over them
+    static
+    void
+    fill (Owner& owner)
+    {
+        owner.addSignerList ();
+        owner.addLines (20);
+        owner.addOffers (5);
+        owner.addLines (40);
+        owner.addOffers (3);
+    }
+
+    void
+    testPages ()
+    {
+        testcase ("Pages");
+
+        using namespace jtx;
+        Env env (*this, features (featureMultiSign));
+        Owner owner (env);
+        fill (owner);
+        env.close ();
+
+        OwnerDirIndex index (10, beast::Journal ());
+        auto ledger = publish (env, index);
+        expectDirectory (index, *ledger, owner.id ());
+        auto const before = index.getDirectory (*ledger, owner.id ());
+        if (! BEAST_EXPECT(before && before->size () == 3))
+            return;
+
+        std::set<LedgerEntryType> types;
+        for (auto const& page : *before)
+        {
+            for (auto const& entry : page.second->entries)
+                types.insert (entry.type);
+        }
+        BEAST_EXPECT(types == std::set<LedgerEntryType> ({
+            ltCASINOCOIN_STATE, ltOFFER, ltSIGNER_LIST}));
+
+        // An emptied page in the middle is removed
+        owner.empty (1);
+        env.close ();
+        ledger = publish (env, index);
+        expectDirectory (index, *ledger, owner.id ());
+        auto const removed = index.getDirectory (*ledger, owner.id ());
+        if (! BEAST_EXPECT(removed && removed->size () == 2))
+            return;
+        BEAST_EXPECT(removed->count (1) == 0);
+
+        // Objects are added to the last page, the others are shared
+        // with the previous version
+        owner.addLines (3);
+        env.close ();
+        ledger = publish (env, index);
+        expectDirectory (index, *ledger, owner.id ());
+        auto const added = index.getDirectory (*ledger, owner.id ());
+        if (! BEAST_EXPECT(added && added->size () == 2))
+            return;
+        BEAST_EXPECT(added->at (0) == removed->at (0));
+        BEAST_EXPECT(added->at (2) != removed->at (2));
+
+        // The last page is kept when emptied
+        owner.empty (2);
+        env.close ();
+        ledger = publish (env, index);
+        expectDirectory (index, *ledger, owner.id ());
+        auto const emptied = index.getDirectory (*ledger, owner.id ());
+        if (! BEAST_EXPECT(emptied && emptied->count (2) == 1))
+            return;
+        BEAST_EXPECT(emptied->at (2)->entries.empty ());
+
+        // and filled again before a page is added after it
+        owner.addLines (40);
+        owner.addOffers (2);
+        env.close ();
+        ledger = publish (env, index);
+        expectDirectory (index, *ledger, owner.id ());
+        auto const reused = index.getDirectory (*ledger, owner.id ());
+        if (! BEAST_EXPECT(reused && reused->size () == 3))
+            return;
+        BEAST_EXPECT(reused->at (2)->entries.size () == 32);
+        BEAST_EXPECT(reused->count (3) == 1);
+    }
+
+    void
+    testMarkers ()
+    {
+        testcase ("Markers");
+
+        using namespace jtx;
+        Env env (*this, features (featureMultiSign));
+        Owner owner (env);
+        fill (owner);
+        env.close ();
+
+        OwnerDirIndex index (10, beast::Journal ());
+        auto const ledger = publish (env, index);
+        BEAST_EXPECT(index.getDirectory (*ledger, owner.id ()));
+
+        // Page through account_objects reading the directory from the
+        // ledger and from the index, the results and markers must match
+        for (auto const type : {ltINVALID, ltCASINOCOIN_STATE,
+            ltOFFER, ltSIGNER_LIST})
+        {
+            for (std::uint32_t const limit : {1, 7, 31, 32, 33})
+            {
+                uint256 dirIndex;
+                uint256 entryIndex;
+                std::size_t pages = 0;
+                for (;;)
+                {
+                    Json::Value expected;
+                    Json::Value actual;
+                    BEAST_EXPECT(RPC::getAccountObjects (*ledger, owner.id (),
+                        type, dirIndex, entryIndex, limit, expected) ==
+                        RPC::getAccountObjects (*ledger, owner.id (), type,
+                            dirIndex, entryIndex, limit, actual, &index));
+                    BEAST_EXPECT(expected == actual);
+                    ++pages;
+
+                    if (! expected.isMember (jss::marker) || pages > 100)
+                        break;
+
+                    auto const marker = expected[jss::marker].asString ();
+                    auto const comma = marker.find (',');
+                    if (! BEAST_EXPECT(comma != std::string::npos))
+                        break;
+                    dirIndex.SetHex (marker.substr (0, comma));
+                    entryIndex.SetHex (marker.substr (comma + 1));
+                }
+                if (type == ltINVALID)
+                    BEAST_EXPECT(pages >= 69 / limit);
+            }
+        }
+    }
+
+    void
+    testDisabled ()
+    {
+        testcase ("Disabled");
+
+        using namespace jtx;
+        Env env (*this);
+        env.fund (CSC (10000), "alice");
+        env.close ();
+
+        OwnerDirIndex index (0, beast::Journal ());
+        auto const ledger = publish (env, index);
+        BEAST_EXPECT(! index.enabled ());
+        BEAST_EXPECT(! index.getDirectory (*ledger, Account ("alice").id ()));
+        BEAST_EXPECT(index.seq () == 0);
+    }
+
+    // Page through an account request, returning every page and marker
+    static
+    std::vector<Json::Value>
+    pages (jtx::Env& env, std::string const& method, Json::Value params,
+        Json::StaticString const& field)
+    {
+        std::vector<Json::Value> result;
+        params[jss::ledger_index] = env.closed ()->seq ();
+        params[jss::limit] = 7;
+        for (;;)
+        {
+            auto const page = env.rpc ("json", method,
+                to_string (params))[jss::result];
+            result.push_back (page[field]);
+            if (! page.isMember (jss::marker))
+                break;
+            result.push_back (page[jss::marker]);
+            params[jss::marker] = page[jss::marker];
+        }
+        return result;
+    }
+
+    void
+    testRequests ()
+    {
+        testcase ("Requests");
+
+        using namespace jtx;
+        Account const gw ("gw");
+        Account const alice ("alice");
+
+        // The same ledgers, served from the state map and from the index
+        auto run = [&](bool indexed)
+        {
+            Env env (*this, envconfig ([indexed](std::unique_ptr<Config> cfg)
+            {
+                cfg->OWNER_INDEX = indexed ? 100 : 0;
+                return cfg;
+            }));
+            env.fund (CSC (100000), gw, alice);
+            env.close ();
+            for (int i = 0; i < 40; ++i)
+            {
+                auto const iou = gw["C" + std::to_string (10 + i)];
+                env (trust (alice, iou (100)));
+                if (i % 3 == 0)
+                    env (offer (alice, iou (10), CSC (10 + i)));
+            }
+            env.close ();
+
+            auto& index = env.app ().getOwnerDirIndex ();
+            publish (env, index);
+            BEAST_EXPECT(! index.getDirectory (
+                *env.closed (), alice.id ()) == ! indexed);
+
+            Json::Value params;
+            params[jss::account] = alice.human ();
+            std::vector<std::vector<Json::Value>> result;
+            result.push_back (pages (env, "account_lines",
+                params, jss::lines));
+            result.push_back (pages (env, "account_offers",
+                params, jss::offers));
+            result.push_back (pages (env, "account_objects",
+                params, jss::account_objects));
+            for (auto const type : {"state", "offer"})
+            {
+                params[jss::type] = type;
+                result.push_back (pages (env, "account_objects",
+                    params, jss::account_objects));
+            }
+            return result;
+        };
+
+        auto const expected = run (false);
+        auto const actual = run (true);
+        if (! BEAST_EXPECT(expected.size () == actual.size ()))
+            return;
+        for (std::size_t i = 0; i < expected.size (); ++i)
+        {
+            BEAST_EXPECT(expected[i].size () > 1);
+            BEAST_EXPECT(expected[i] == actual[i]);
+        }
+    }
+
+public:
+    // Apply the last closed ledger to an index
+    static
+    std::shared_ptr<ReadView const>
+    publish (jtx::Env& env, OwnerDirIndex& index)
+    {
+        auto const ledger = env.closed ();
+        AcceptedLedger const accepted (ledger,
+            env.app ().accountIDCache (), env.app ().logs ());
+        index.update (*ledger, accepted);
+        return ledger;
+    }
+
+    void
+    run () override
+    {
+        testPages ();
+        testMarkers ();
+        testDisabled ();
+        testRequests ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Pages through the lines and offers of a gateway with a large
+// owner directory, from the state map and from the index
+class OwnerDirIndexBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // Page through a directory the way account_lines and account_offers
+    // do, returning the number of pages
+    template <class ForEach>
+    static
+    std::size_t
+    paging (ReadView const& ledger, AccountID const& account,
+        LedgerEntryType type, unsigned int limit, ForEach&& forEach)
+    {
+        std::size_t n = 0;
+        uint256 after;
+        std::uint64_t hint = 0;
+        for (;; ++n)
+        {
+            std::vector<std::shared_ptr<SLE const>> items;
+            forEach (after, hint, limit + 1,
+                [&](std::shared_ptr<SLE const> const& sle)
+                {
+                    if (sle->getType () != type)
+                        return false;
+                    items.push_back (sle);
+                    return true;
+                });
+            if (items.size () <= limit)
+                return n + 1;
+
+            after = items[limit - 1]->key ();
+            auto const& sle = *items[limit - 1];
+            if (type == ltOFFER)
+                hint = sle.getFieldU64 (sfOwnerNode);
+            else if (sle.getFieldAmount (sfLowLimit).getIssuer () == account)
+                hint = sle.getFieldU64 (sfLowNode);
+            else
+                hint = sle.getFieldU64 (sfHighNode);
+        }
+    }
+
+    void
+    bench (ReadView const& ledger, AccountID const& account,
+        OwnerDirIndex& index, LedgerEntryType type, char const* name)
+    {
+        using namespace std::chrono;
+        unsigned int const limit = 400;
+
+        for (bool const indexed : {false, true})
+        {
+            auto const start = clock_type::now ();
+            auto const n = paging (ledger, account, type, limit,
+                [&](uint256 const& after, std::uint64_t hint,
+                    unsigned int reserve, std::function<
+                        bool (std::shared_ptr<SLE const> const&)> f)
+                {
+                    if (indexed)
+                        index.forEachItemAfter (ledger, account, type,
+                            after, hint, reserve, std::move (f));
+                    else
+                        forEachItemAfter (ledger, account,
+                            after, hint, reserve, std::move (f));
+                });
+            auto const elapsed = duration<double>(clock_type::now () - start);
+
+            log << name << (indexed ? ", index: " : ", state map: ") <<
+                n << " pages in " <<
+                duration_cast<milliseconds> (elapsed).count () << "ms, " <<
+                static_cast<std::size_t> (n / elapsed.count ()) <<
+                " pages/sec" << std::endl;
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        using namespace jtx;
+        std::size_t const lines = 200000;
+
+        Env env (*this);
+        Account const gw ("gateway");
+        env.fund (CSC (100000), gw);
+        env.close ();
+
+        // Holders are added directly, there are too many to submit
+        auto const start = clock_type::now ();
+        env.app ().openLedger ().modify (
+            [&](OpenView& view, beast::Journal j)
+            {
+                Sandbox sb (&view, tapNONE);
+                for (std::uint32_t i = 0; i < lines; ++i)
+                {
+                    AccountID holder;
+                    holder.data ()[0] = 0xCC;
+                    std::memcpy (holder.data () + 1, &i, sizeof (i));
+
+                    auto const sle = std::make_shared<SLE> (
+                        keylet::account (holder));
+                    sle->setAccountID (sfAccount, holder);
+                    sle->setFieldAmount (sfBalance, CSCAmount (100000000));
+                    sle->setFieldU32 (sfSequence, 1);
+                    sb.insert (sle);
+
+                    bool const high = gw.id () < holder;
+                    auto const issue = Issue (to_currency ("USD"), holder);
+                    trustCreate (sb, high, holder, gw.id (),
+                        keylet::line (holder, gw.id (), issue.currency).key,
+                            sle, false, false, false,
+                                STAmount ({issue.currency, noAccount ()}),
+                                    STAmount (issue, 1000), 0, 0, j);
+                }
+                sb.apply (view);
+                return true;
+            });
+
+        // Some offers at the end of the directory
+        for (int i = 0; i < 100; ++i)
+            env (offer (gw, CSC (10 + i), gw["USD"] (10)));
+        env.close ();
+
+        log << lines << " lines created in " <<
+            std::chrono::duration_cast<std::chrono::milliseconds> (
+                clock_type::now () - start).count () << "ms" << std::endl;
+
+        auto const ledger = env.closed ();
+        OwnerDirIndex index (10, beast::Journal ());
+        OwnerDirIndex_test::publish (env, index);
+        {
+            auto const loading = clock_type::now ();
+            index.getDirectory (*ledger, gw.id ());
+            log << "directory loaded in " <<
+                std::chrono::duration_cast<std::chrono::milliseconds> (
+                    clock_type::now () - loading).count () << "ms" <<
+                std::endl;
+        }
+
+        bench (*ledger, gw.id (), index, ltCASINOCOIN_STATE, "account_lines");
+        bench (*ledger, gw.id (), index, ltOFFER, "account_offers");
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OwnerDirIndex, app, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(OwnerDirIndexBench, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,267 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/ledger/Ledger.h>
+#include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/misc/CanonicalTXSet.h>
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/basics/TaskPool.h>
+#include <casinocoin/beast/xor_shift_engine.h>
+#include <casinocoin/core/TimeKeeper.h>
+#include <casinocoin/ledger/OpenView.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class ParallelApply_test : public beast::unit_test::suite
+{
+    using Txs = std::vector<std::shared_ptr<STTx const>>;
+
+    struct Built
+    {
+        uint256 hash;
+        std::vector<ApplyResult> results;
+        std::size_t reapplied = 0;
+    };
+
+    // Apply the transactions to a ledger following the last closed one
+    static
+    Built
+    build (jtx::Env& env, Txs const& txs, TaskPool& pool)
+    {
+        auto& app = env.app ();
+        auto const parent = app.getLedgerMaster ().getClosedLedger ();
+        auto const closeTime = parent->info ().closeTime +
+            parent->info ().closeTimeResolution;
+        auto ledger = std::make_shared<Ledger> (*parent, closeTime);
+
+        Built built;
+        {
+            OpenView accum (&*ledger);
+            built.results = applyParallel (app, accum, txs, true,
+                tapNO_CHECK_SIGN, pool, env.journal, &built.reapplied);
+            accum.apply (*ledger);
+        }
+        ledger->updateSkipList ();
+        ledger->setAccepted (closeTime, parent->info ().closeTimeResolution,
+            true, app.config ());
+        built.hash = ledger->info ().hash;
+        return built;
+    }
+
+    // Transactions in canonical order
+    static
+    Txs
+    canonical (Txs const& txs, uint256 const& salt)
+    {
+        CanonicalTXSet set (salt);
+        for (auto const& tx : txs)
+            set.insert (tx);
+        Txs result;
+        for (auto const& item : set)
+            result.push_back (item.second);
+        return result;
+    }
+
+    void
+    testDisjoint ()
+    {
+        testcase ("Disjoint");
+
+        using namespace jtx;
+        Env env (*this);
+        std::vector<Account> accounts;
+        for (int i = 0; i < 40; ++i)
+        {
+            accounts.emplace_back ("acct" + std::to_string (i));
+            env.fund (CSC (10000), accounts.back ());
+        }
+        env.close ();
+
+        // Each transaction touches its own pair of accounts
+        Txs txs;
+        for (std::size_t i = 0; i < accounts.size (); i += 2)
+        {
+            txs.push_back (env.jt (pay (accounts[i], accounts[i + 1],
+                CSC (i + 1)), fee (1000)).stx);
+        }
+        txs = canonical (txs, uint256 (1));
+
+        TaskPool serialPool ("serial", 1);
+        TaskPool pool ("apply", 4);
+        auto const serial = build (env, txs, serialPool);
+        auto const parallel = build (env, txs, pool);
+        BEAST_EXPECT(serial.hash == parallel.hash);
+        BEAST_EXPECT(serial.results == parallel.results);
+        BEAST_EXPECT(std::all_of (parallel.results.begin (),
+            parallel.results.end (), [](ApplyResult r)
+            {
+                return r == ApplyResult::Success;
+            }));
+        BEAST_EXPECT(parallel.reapplied == 0);
+    }
+
+    void
+    testRandom ()
+    {
+        testcase ("Random");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        auto const USD = gw["USD"];
+        std::vector<Account> accounts;
+        for (int i = 0; i < 24; ++i)
+            accounts.emplace_back ("acct" + std::to_string (i));
+
+        env.fund (CSC (100000), gw);
+        for (auto const& a : accounts)
+            env.fund (CSC (100000), a);
+        env.close ();
+        for (auto const& a : accounts)
+            env.trust (USD (1000000), a);
+        env.close ();
+        for (auto const& a : accounts)
+            env (pay (gw, a, USD (10000)));
+        env.close ();
+
+        // Each pool is reused by every build below
+        TaskPool serialPool ("serial", 1);
+        std::vector<std::unique_ptr<TaskPool>> pools;
+        for (std::size_t workers : {2, 4, 8})
+            pools.push_back (std::make_unique<TaskPool> (
+                "apply", workers));
+
+        std::size_t reapplied = 0;
+        for (std::uint64_t seed = 1; seed <= 10; ++seed)
+        {
+            beast::xor_shift_engine g (seed);
+            auto pick = [&](std::size_t n)
+            {
+                return static_cast<std::size_t> (g () % n);
+            };
+
+            // A few busy accounts make conflicts likely
+            auto account = [&]() -> Account const&
+            {
+                return accounts[pick (4) == 0 ?
+                    pick (3) : pick (accounts.size ())];
+            };
+
+            std::map<AccountID, std::uint32_t> seqs;
+            for (auto const& a : accounts)
+                seqs[a.id ()] = env.seq (a);
+
+            Txs txs;
+            for (int i = 0; i < 300; ++i)
+            {
+                auto const& from = account ();
+                auto const& to = account ();
+                auto const n = static_cast<int> (pick (100) + 1);
+
+                // Mostly the next sequence, sometimes one that
+                // has to wait or one that was already used
+                auto s = seqs[from.id ()];
+                switch (pick (20))
+                {
+                case 0:  s += 1; break;
+                case 1:  s -= 1; break;
+                default: ++seqs[from.id ()];
+                }
+
+                switch (pick (5))
+                {
+                case 0:
+                    txs.push_back (env.jt (pay (from, to, CSC (n)),
+                        seq (s), fee (1000)).stx);
+                    break;
+                case 1:
+                    txs.push_back (env.jt (pay (from, to, USD (n)),
+                        seq (s), fee (1000)).stx);
+                    break;
+                case 2:
+                    txs.push_back (env.jt (offer (from, USD (n), CSC (n)),
+                        seq (s), fee (1000)).stx);
+                    break;
+                case 3:
+                    txs.push_back (env.jt (offer (from, CSC (n), USD (n)),
+                        seq (s), fee (1000)).stx);
+                    break;
+                default:
+                    txs.push_back (env.jt (pay (from, gw, USD (n)),
+                        seq (s), fee (1000)).stx);
+                }
+            }
+            txs = canonical (txs, uint256 (seed));
+
+            auto const serial = build (env, txs, serialPool);
+            for (auto& pool : pools)
+            {
+                auto const parallel = build (env, txs, *pool);
+                BEAST_EXPECT(serial.hash == parallel.hash);
+                BEAST_EXPECT(serial.results == parallel.results);
+                reapplied += parallel.reapplied;
+            }
+        }
+        log << "Reapplied " << reapplied << " of " << 10 * 3 * 300 <<
+            " transactions" << std::endl;
+    }
+
+    void
+    testConfig ()
+    {
+        testcase ("Config");
+
+        using namespace jtx;
+        Env env (*this, envconfig ([](std::unique_ptr<Config> cfg)
+        {
+            cfg->APPLY_WORKERS = 4;
+            return cfg;
+        }));
+        Account const alice ("alice");
+        Account const bob ("bob");
+        env.fund (CSC (100000), alice, bob);
+        env.close ();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            env (pay (alice, bob, CSC (1)));
+            env (pay (bob, alice, CSC (2)));
+        }
+        env.close ();
+        env.require (balance (bob, CSC (100000) - CSC (20) -
+            drops (20 * env.current ()->fees ().base)));
+    }
+
+public:
+    void
+    run () override
+    {
+        testDisjoint ();
+        testRandom ();
+        testConfig ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelApply, app, casinocoin);
+
+} // test
+} // casinocoin
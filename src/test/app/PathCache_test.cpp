@@ -0,0 +1,330 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/paths/PathCache.h>
+#include <casinocoin/app/paths/PathRequests.h>
+#include <casinocoin/beast/insight/NullCollector.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/resource/ResourceManager.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class PathCache_test : public beast::unit_test::suite
+{
+    using microseconds = std::chrono::microseconds;
+
+    static
+    jtx::Account
+    alice ()
+    {
+        return jtx::Account ("alice");
+    }
+
+    static
+    jtx::Account
+    bob ()
+    {
+        return jtx::Account ("bob");
+    }
+
+    // Find the paths for alice paying bob in the last closed ledger
+    static
+    std::shared_ptr<Pathfinder const>
+    find (jtx::Env& env, STAmount const& amount, int level = 7)
+    {
+        auto const ledger = env.closed ();
+        auto pathfinder = std::make_shared<Pathfinder> (
+            std::make_shared<CasinocoinLineCache> (ledger),
+            alice ().id (), bob ().id (),
+            amount.getCurrency (), boost::none, amount, boost::none,
+            env.app ());
+        if (! pathfinder->findPaths (level))
+            return nullptr;
+        pathfinder->computePathRanks (4);
+        return pathfinder;
+    }
+
+    static
+    uint256
+    key (STAmount const& amount, int level = 7)
+    {
+        return PathCache::makeKey (
+            alice ().id (), bob ().id (),
+            amount.getCurrency (), amount, boost::none, level, 4);
+    }
+
+    void
+    testKey ()
+    {
+        testcase ("Key");
+
+        using namespace jtx;
+        Account const gw ("gateway");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+
+        BEAST_EXPECT(key (USD (5)) == key (USD (5)));
+        BEAST_EXPECT(key (USD (5)) != key (USD (6)));
+        BEAST_EXPECT(key (USD (5)) != key (EUR (5)));
+        BEAST_EXPECT(key (USD (5)) != key (USD (5), 4));
+        BEAST_EXPECT(PathCache::makeKey (alice ().id (), bob ().id (),
+            USD.currency, USD (5), boost::none, 7, 4) !=
+                PathCache::makeKey (alice ().id (), bob ().id (),
+                    USD.currency, USD (5), STAmount (USD (10)), 7, 4));
+    }
+
+    void
+    testLedgers ()
+    {
+        testcase ("Ledgers");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        auto const USD = gw["USD"];
+        env.fund (CSC (10000), alice (), bob (), "carol", "dave", gw);
+        env.trust (USD (600), alice ());
+        env.trust (USD (700), bob ());
+        env (pay (gw, alice (), USD (70)));
+        env (pay (gw, bob (), USD (50)));
+        env.close ();
+
+        PathCache cache (4, beast::insight::NullCollector::New ());
+        auto const amount = STAmount (bob ()["USD"] (5));
+        auto const k = key (amount);
+
+        // Nothing is known about the open ledger
+        BEAST_EXPECT(! cache.fetch (*env.current (), k));
+
+        auto const found = find (env, amount);
+        if (! BEAST_EXPECT(found))
+            return;
+        BEAST_EXPECT(found->accountsUsed ().count (gw.id ()) != 0);
+        cache.insert (*env.current (), k, found, microseconds (10));
+        BEAST_EXPECT(cache.size () == 0);
+
+        BEAST_EXPECT(! cache.fetch (*env.closed (), k));
+        cache.insert (*env.closed (), k, found, microseconds (10));
+        BEAST_EXPECT(cache.fetch (*env.closed (), k) == found);
+        BEAST_EXPECT(cache.size () == 1);
+
+        // Copies find the same paths in their own line cache
+        {
+            auto const lines = std::make_shared<CasinocoinLineCache> (
+                env.closed ());
+            Pathfinder copy (*found, lines);
+            STPath full;
+            auto const paths = copy.getBestPaths (
+                4, full, STPathSet (), gw.id ());
+            BEAST_EXPECT(paths.size () == 1);
+        }
+
+        // Paths sending CSC depend on the CSC books
+        auto const fromCSC = std::make_shared<Pathfinder> (
+            std::make_shared<CasinocoinLineCache> (env.closed ()),
+            alice ().id (), bob ().id (), cscCurrency (), boost::none,
+            amount, boost::none, env.app ());
+        fromCSC->findPaths (7);
+        fromCSC->computePathRanks (4);
+        BEAST_EXPECT(fromCSC->issuesUsed ().count (cscIssue ()) != 0);
+        auto const kCSC = PathCache::makeKey (alice ().id (), bob ().id (),
+            cscCurrency (), amount, boost::none, 7, 4);
+        cache.insert (*env.closed (), kCSC, fromCSC, microseconds (10));
+
+        // Payments between other accounts keep the paths,
+        // including the ones using CSC
+        env (pay ("carol", "dave", CSC (10)));
+        env.close ();
+        BEAST_EXPECT(cache.fetch (*env.closed (), k) == found);
+        BEAST_EXPECT(cache.fetch (*env.closed (), kCSC) == fromCSC);
+
+        // A ledger that doesn't follow starts over
+        auto const previous = env.closed ();
+        env.close ();
+        env.close ();
+        BEAST_EXPECT(! cache.fetch (*env.closed (), k));
+        BEAST_EXPECT(cache.size () == 0);
+
+        // Older ledgers are left alone
+        BEAST_EXPECT(! cache.fetch (*previous, k));
+        cache.insert (*previous, k, found, microseconds (10));
+        BEAST_EXPECT(cache.size () == 0);
+
+        // Changing a trust line on the path drops the paths
+        cache.insert (*env.closed (), k, find (env, amount), microseconds (10));
+        BEAST_EXPECT(cache.size () == 1);
+        env (pay (gw, bob (), USD (5)));
+        env.close ();
+        BEAST_EXPECT(! cache.fetch (*env.closed (), k));
+        BEAST_EXPECT(cache.size () == 0);
+
+        BEAST_EXPECT(cache.hits () == 3);
+        BEAST_EXPECT(cache.misses () == 5);
+    }
+
+    void
+    testLimit ()
+    {
+        testcase ("Limit");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        env.fund (CSC (10000), alice (), bob (), gw);
+        env.close ();
+
+        PathCache cache (4, beast::insight::NullCollector::New ());
+        auto const found = std::make_shared<Pathfinder> (
+            std::make_shared<CasinocoinLineCache> (env.closed ()),
+            alice ().id (), bob ().id (), cscCurrency (), boost::none,
+            CSC (5), boost::none, env.app ());
+
+        auto const& ledger = *env.closed ();
+        for (int i = 1; i <= 6; ++i)
+        {
+            cache.insert (ledger, key (CSC (i)), found, microseconds (100));
+            if (i == 2)
+                BEAST_EXPECT(cache.fetch (ledger, key (CSC (1))));
+        }
+        BEAST_EXPECT(cache.size () == 4);
+
+        // The least recently used entries were dropped
+        BEAST_EXPECT(cache.fetch (ledger, key (CSC (1))));
+        BEAST_EXPECT(! cache.fetch (ledger, key (CSC (2))));
+        BEAST_EXPECT(! cache.fetch (ledger, key (CSC (3))));
+        BEAST_EXPECT(cache.fetch (ledger, key (CSC (6))));
+
+        // The search time moves to the ledger once it's done
+        BEAST_EXPECT(cache.ledgerTime () == microseconds (0));
+        env.close ();
+        BEAST_EXPECT(cache.fetch (*env.closed (), key (CSC (6))));
+        BEAST_EXPECT(cache.ledgerTime () == microseconds (600));
+    }
+
+    // Ask for alice's paths to bob through the path requests
+    static
+    Json::Value
+    request (jtx::Env& env, std::shared_ptr<ReadView const> const& ledger,
+        STAmount const& amount)
+    {
+        Json::Value jv (Json::objectValue);
+        jv[jss::source_account] = alice ().human ();
+        jv[jss::destination_account] = bob ().human ();
+        jv[jss::destination_amount] = amount.getJson (0);
+        auto consumer = env.app ().getResourceManager ()
+            .newUnlimitedEndpoint ("PathCache_test");
+        return env.app ().getPathRequests ().doLegacyPathRequest (
+            consumer, ledger, jv);
+    }
+
+    // The first hop of the first alternative of a path request
+    static
+    std::string
+    firstHop (Json::Value const& result)
+    {
+        auto const& alternatives = result[jss::alternatives];
+        if (! alternatives.isArray () || alternatives.size () == 0)
+            return {};
+        auto const& paths = alternatives[0u][jss::paths_computed];
+        if (! paths.isArray () || paths.size () == 0 ||
+                paths[0u].size () == 0)
+            return {};
+        return paths[0u][0u][jss::account].asString ();
+    }
+
+    void
+    testRequests ()
+    {
+        testcase ("Requests");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gateway");
+        Account const gw2 ("gateway2");
+        env.fund (CSC (10000), alice (), bob (), "carol", "dave", gw, gw2);
+        env.trust (gw["USD"] (600), alice ());
+        env.trust (gw2["USD"] (600), alice ());
+        env.trust (gw["USD"] (700), bob ());
+        env.trust (gw2["USD"] (700), bob ());
+        env (pay (gw, alice (), gw["USD"] (70)));
+        env.close ();
+
+        auto const& cache = env.app ().getPathRequests ().pathCache ();
+        auto const amount = STAmount (bob ()["USD"] (5));
+
+        // Only the first gateway can carry the payment
+        auto result = request (env, env.closed (), amount);
+        BEAST_EXPECT(firstHop (result) == gw.human ());
+        auto const hits = cache.hits ();
+
+        // Requests in a following ledger share the searches
+        // from both of alice's currencies
+        env (pay ("carol", "dave", CSC (10)));
+        env.close ();
+        result = request (env, env.closed (), amount);
+        BEAST_EXPECT(firstHop (result) == gw.human ());
+        BEAST_EXPECT(cache.hits () == hits + 2);
+
+        // Moving alice's funds to the second gateway in the next ledger
+        // must be seen by the next request rather than answered with the
+        // paths of the previous ledger
+        env (pay (alice (), gw, gw["USD"] (70)));
+        env (pay (gw2, alice (), gw2["USD"] (70)));
+        env.close ();
+        result = request (env, env.closed (), amount);
+        BEAST_EXPECT(firstHop (result) == gw2.human ());
+        BEAST_EXPECT(cache.hits () == hits + 2);
+
+        log << "path cache hit rate: " << cache.rate () << "% of " <<
+            cache.hits () + cache.misses () << " lookups" << std::endl;
+    }
+
+    void
+    testCounts ()
+    {
+        testcase ("Counts");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const result = env.rpc ("get_counts")[jss::result];
+        BEAST_EXPECT(result.isMember (jss::path_cache_hit_rate));
+        BEAST_EXPECT(result.isMember (jss::path_cache_size));
+        BEAST_EXPECT(result.isMember (jss::pathfind_ledger_ms));
+    }
+
+public:
+    void
+    run () override
+    {
+        testKey ();
+        testLedgers ();
+        testLimit ();
+        testRequests ();
+        testCounts ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(PathCache, app, casinocoin);
+
+} // test
+} // casinocoin
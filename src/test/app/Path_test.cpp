@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/app/paths/AccountCurrencies.h>
+#include <casinocoin/app/paths/PathRequests.h>
 #include <casinocoin/basics/contract.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/json/json_reader.h>
@@ -32,6 +33,7 @@
 #include <casinocoin/rpc/RPCHandler.h>
 #include <test/jtx.h>
 #include <casinocoin/beast/unit_test.h>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
@@ -459,6 +461,63 @@ public:
         BEAST_EXPECT(equal(sa, Account("alice")["USD"](5)));
     }
 
+    void
+    update_all()
+    {
+        testcase("update all");
+        using namespace jtx;
+        using namespace std::chrono_literals;
+        Env env(*this, envconfig([](std::unique_ptr<Config> cfg)
+        {
+            cfg->PATH_WORKERS = 4;
+            return cfg;
+        }));
+        auto const gw = Account("gateway");
+        auto const USD = gw["USD"];
+        env.fund(CSC(10000), "alice", "bob", gw);
+        env.trust(USD(600), "alice");
+        env.trust(USD(700), "bob");
+        env(pay(gw, "alice", USD(70)));
+        env.close();
+
+        auto& pathRequests = env.app().getPathRequests();
+        BEAST_EXPECT(pathRequests.workers() == 4);
+
+        // Legacy requests complete once they have been updated
+        std::size_t const n = 40;
+        std::atomic<std::size_t> completed {0};
+        Resource::Consumer consumer;
+        std::vector<PathRequest::pointer> requests;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            Json::Value params = Json::objectValue;
+            params[jss::source_account] = toBase58(Account("alice").id());
+            params[jss::destination_account] = toBase58(Account("bob").id());
+            params[jss::destination_amount] =
+                STAmount(Account("bob")["USD"](i + 1)).getJson(0);
+            PathRequest::pointer request;
+            pathRequests.makeLegacyPathRequest(request,
+                [&completed]{ ++completed; }, consumer, env.closed(), params);
+            if (BEAST_EXPECT(request))
+                requests.push_back(request);
+        }
+
+        pathRequests.updateAll(env.closed(), []{ return false; });
+        for (int i = 0; i < 500 && completed < n; ++i)
+            std::this_thread::sleep_for(10ms);
+        BEAST_EXPECT(completed == n);
+
+        auto const stats = pathRequests.updateStats();
+        BEAST_EXPECT(stats.requests > 0);
+        BEAST_EXPECT(stats.p50 <= stats.p90);
+        BEAST_EXPECT(stats.p90 <= stats.p99);
+        BEAST_EXPECT(stats.p99 <= stats.max);
+
+        auto const counts = env.rpc("get_counts")[jss::result];
+        BEAST_EXPECT(counts.isMember(jss::pathfind_update_p50_ms));
+        BEAST_EXPECT(counts.isMember(jss::pathfind_update_p99_ms));
+    }
+
     void
     csc_to_csc()
     {
@@ -1404,6 +1463,7 @@ public:
         trust_auto_clear_trust_normal_clear();
         trust_auto_clear_trust_auto_clear();
         csc_to_csc();
+        update_all();
 
         // The following path_find_NN tests are data driven tests
         // that were originally implemented in js/coffee and migrated
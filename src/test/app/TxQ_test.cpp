@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <casinocoin/app/ledger/OpenLedger.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/TxQ.h>
@@ -32,6 +33,7 @@
 #include <test/jtx.h>
 #include <test/jtx/ticket.h>
 #include <boost/optional.hpp>
+#include <chrono>
 #include <test/jtx/WSClient.h>
 
 namespace casinocoin {
@@ -2818,7 +2820,104 @@ public:
     }
 };
 
+//------------------------------------------------------------------------------
+
+// Queues transactions from many accounts and reports how long
+// the queue takes to accept them and to fill new open ledgers
+class TxQBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        std::size_t const accountCount = 10000;
+        std::size_t const perAccount = 10;
+
+        auto cfg = envconfig();
+        auto& section = cfg->section("transaction_queue");
+        section.set("ledgers_in_queue", "200");
+        section.set("maximum_txn_per_account", std::to_string(perAccount));
+        section.set("minimum_txn_in_ledger_standalone", "1000");
+        Env env(*this, std::move(cfg), features(featureFeeEscalation));
+        auto& app = env.app();
+        auto& txq = app.getTxQ();
+
+        std::vector<Account> accounts;
+        accounts.reserve(accountCount);
+        for (std::size_t i = 0; i < accountCount; ++i)
+        {
+            accounts.emplace_back("bench" + std::to_string(i),
+                KeyType::ed25519);
+            env.fund(CSC(10000), noCasinocoin(accounts.back()));
+            if (i % 500 == 499)
+                env.close();
+        }
+        env.close();
+
+        auto const baseFee = env.current()->fees().base;
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve(accountCount * perAccount);
+        for (std::size_t n = 0; n < perAccount; ++n)
+        {
+            for (std::size_t i = 0; i < accountCount; ++i)
+            {
+                auto const& from = accounts[i];
+                auto const& to = accounts[(i + 1) % accountCount];
+                txs.push_back(env.jt(pay(from, to, drops(1000)),
+                    seq(env.seq(from) + n), fee(baseFee)).stx);
+            }
+        }
+
+        std::size_t queued = 0;
+        std::size_t applied = 0;
+        auto const start = clock_type::now();
+        app.openLedger().modify(
+            [&](OpenView& view, beast::Journal j)
+            {
+                for (auto const& tx : txs)
+                {
+                    auto const result = txq.apply(
+                        app, view, tx, tapNO_CHECK_SIGN, j);
+                    if (result.first == terQUEUED)
+                        ++queued;
+                    else if (result.second)
+                        ++applied;
+                }
+                return true;
+            });
+        auto const elapsed = duration<double>(clock_type::now() - start);
+        log << txs.size() << " transactions from " << accountCount <<
+            " accounts: " << queued << " queued, " << applied <<
+            " applied, " << static_cast<std::size_t>(
+                1e9 * elapsed.count() / txs.size()) <<
+            " ns per apply" << std::endl;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            auto const before = txq.getMetrics(*env.current());
+            auto const closeStart = clock_type::now();
+            env.close();
+            auto const closeTime = duration_cast<milliseconds>(
+                clock_type::now() - closeStart);
+            auto const after = txq.getMetrics(*env.current());
+            if (! before || ! after)
+                break;
+            log << "close " << i << ": " << closeTime.count() << "ms, " <<
+                before->txCount << " queued before, " <<
+                after->txInLedger << " accepted into the open ledger" <<
+                std::endl;
+        }
+        pass();
+    }
+};
+
 BEAST_DEFINE_TESTSUITE(TxQ,app,casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(TxQBench,app,casinocoin);
 
 }
 }
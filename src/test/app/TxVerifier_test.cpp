@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <casinocoin/app/misc/HashRouter.h>
+#include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/app/misc/TxVerifier.h>
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/protocol/SecretKey.h>
+#include <test/jtx.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace casinocoin {
+namespace test {
+
+class TxVerifier_test : public beast::unit_test::suite
+{
+    // Wait until count reaches n, giving up after a while
+    static
+    bool
+    waitFor (std::atomic<std::size_t> const& count, std::size_t n)
+    {
+        using namespace std::chrono_literals;
+        for (int i = 0; i < 1000 && count < n; ++i)
+            std::this_thread::sleep_for (10ms);
+        return count >= n;
+    }
+
+    void
+    testBatchVerify ()
+    {
+        testcase ("Ed25519 batch");
+
+        std::size_t const n = 100;
+        std::vector<std::string> text;
+        std::vector<PublicKey> keys;
+        std::vector<Buffer> sigs;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const kp = randomKeyPair (KeyType::ed25519);
+            text.push_back ("message " + std::to_string (i));
+            keys.push_back (kp.first);
+            sigs.push_back (sign (kp.first, kp.second, makeSlice (text[i])));
+        }
+
+        auto verifyAll = [&]()
+        {
+            std::vector<Slice> m;
+            std::vector<Slice> s;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                m.push_back (makeSlice (text[i]));
+                s.push_back (Slice (sigs[i].data (), sigs[i].size ()));
+            }
+            return verifyEd25519Batch (keys, m, s);
+        };
+
+        auto valid = verifyAll ();
+        BEAST_EXPECT(std::all_of (valid.begin (), valid.end (),
+            [](bool v) { return v; }));
+
+        // Corrupt a few signatures, only those may fail
+        text[3] += "!";
+        sigs[42].data ()[7] ^= 0x01;
+        keys[77] = derivePublicKey (KeyType::secp256k1, randomSecretKey ());
+        valid = verifyAll ();
+        for (std::size_t i = 0; i < n; ++i)
+            BEAST_EXPECT(valid[i] == (i != 3 && i != 42 && i != 77));
+    }
+
+    void
+    testBatchTorsion ()
+    {
+        testcase ("Ed25519 batch with small order component");
+
+        // A valid signature whose R has a point of order 8 added
+        // and S adjusted to match. verify rejects it, the batch
+        // equation multiplies the small order part out and may
+        // accept it.
+        auto const pk = strUnHex (
+            "ED03A107BFF3CE10BE1D70DD18E74BC09967E4D6309BA50D5F"
+            "1DDC8664125531B8");
+        auto const sig = strUnHex (
+            "2AE0BEA9AD099A0797DF2453B046200FE1EB27D6A9482AF368"
+            "11BD7DCBDC83416EC053BCC02D9CF033C662B144B25C2B1B749C"
+            "3FE3A3C6985621F52858BB580D");
+        std::string const text ("torsion");
+        if (! BEAST_EXPECT(pk.second && sig.second))
+            return;
+
+        PublicKey const key (makeSlice (pk.first));
+        BEAST_EXPECT(! verify (key, makeSlice (text), makeSlice (sig.first)));
+
+        // Mixed with valid signatures, the others are still accepted
+        // and the batch is not trusted when it accepts this one.
+        int accepted = 0;
+        for (int round = 0; round < 20; ++round)
+        {
+            std::vector<std::string> m (1, text);
+            std::vector<PublicKey> keys (1, key);
+            std::vector<Buffer> sigs (1, Buffer (
+                sig.first.data (), sig.first.size ()));
+            for (int i = 0; i < 7; ++i)
+            {
+                auto const kp = randomKeyPair (KeyType::ed25519);
+                m.push_back ("message " + std::to_string (i));
+                keys.push_back (kp.first);
+                sigs.push_back (sign (kp.first, kp.second, makeSlice (m.back ())));
+            }
+
+            std::vector<Slice> ms;
+            std::vector<Slice> ss;
+            for (std::size_t i = 0; i < m.size (); ++i)
+            {
+                ms.push_back (makeSlice (m[i]));
+                ss.push_back (Slice (sigs[i].data (), sigs[i].size ()));
+            }
+
+            auto const valid = verifyEd25519Batch (keys, ms, ss);
+            for (std::size_t i = 1; i < m.size (); ++i)
+                BEAST_EXPECT(valid[i]);
+            if (valid[0])
+                ++accepted;
+        }
+        log << "batch accepted the signature in " << accepted <<
+            " of 20 rounds" << std::endl;
+    }
+
+    void
+    testVerify ()
+    {
+        testcase ("Verify");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const alice ("alice", KeyType::ed25519);
+        Account const bob ("bob", KeyType::secp256k1);
+        env.fund (CSC (10000), alice, bob);
+        env.close ();
+
+        auto& router = env.app ().getHashRouter ();
+        auto& verifier = env.app ().getOPs ().getTxVerifier ();
+        auto const rules = env.current ()->rules ();
+
+        std::vector<std::shared_ptr<STTx const>> good;
+        for (std::uint32_t i = 0; i < 10; ++i)
+        {
+            good.push_back (env.jt (pay (alice, bob, CSC (1)),
+                seq (env.seq (alice) + i), fee (1000)).stx);
+            good.push_back (env.jt (pay (bob, alice, CSC (1)),
+                seq (env.seq (bob) + i), fee (1000)).stx);
+        }
+
+        // Signed by the wrong key
+        std::vector<std::shared_ptr<STTx const>> bad;
+        bad.push_back (env.jt (pay (alice, bob, CSC (1)),
+            sig (Account ("carol", KeyType::ed25519)), fee (1000)).stx);
+        bad.push_back (env.jt (pay (bob, alice, CSC (1)),
+            sig (Account ("dave")), fee (1000)).stx);
+
+        std::atomic<std::size_t> handled {0};
+        auto const total = verifier.verified ();
+        for (auto const& txs : {good, bad})
+        {
+            for (auto const& stx : txs)
+            {
+                BEAST_EXPECT(verifier.verify (stx, rules,
+                    [&](std::shared_ptr<STTx const> const&) { ++handled; }));
+            }
+        }
+
+        if (! BEAST_EXPECT(waitFor (handled, good.size () + bad.size ())))
+            return;
+        BEAST_EXPECT(verifier.verified () - total == good.size () + bad.size ());
+
+        // The results are cached, so only the local checks are redone
+        for (auto const& stx : good)
+            BEAST_EXPECT(checkValidity (router, *stx, rules,
+                env.app ().config ()).first == Validity::Valid);
+        for (auto const& stx : bad)
+            BEAST_EXPECT(checkValidity (router, *stx, rules,
+                env.app ().config ()).first == Validity::SigBad);
+    }
+
+public:
+    void
+    run () override
+    {
+        testBatchVerify ();
+        testBatchTorsion ();
+        testVerify ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Floods a standalone node with signed transactions and
+// reports how fast the verification stage checks them
+class TxVerifierFlood_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    void
+    flood (KeyType type, std::size_t n)
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        Env env (*this);
+        auto& verifier = env.app ().getOPs ().getTxVerifier ();
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 100; ++i)
+            accounts.emplace_back ("flood" + std::to_string (i), type);
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const& from = accounts[i % accounts.size ()];
+            auto const& to = accounts[(i + 1) % accounts.size ()];
+            txs.push_back (env.jt (pay (from, to, CSC (1)),
+                seq (i / accounts.size () + 1), fee (1000)).stx);
+        }
+
+        auto const before = verifier.verified ();
+        auto const start = clock_type::now ();
+        for (auto const& stx : txs)
+        {
+            // Stay below the queue limit instead of dropping
+            while (verifier.size () >= TxVerifier::maxQueued - 1)
+                std::this_thread::yield ();
+            env.app ().getOPs ().submitTransaction (stx);
+        }
+        while (verifier.verified () - before < n)
+            std::this_thread::sleep_for (milliseconds (1));
+        auto const elapsed = duration<double>(clock_type::now () - start);
+
+        log << (type == KeyType::ed25519 ? "ed25519" : "secp256k1") <<
+            ": " << n << " transactions, " << verifier.workers () <<
+            " workers, " << static_cast<std::size_t> (n / elapsed.count ()) <<
+            " verifications/sec" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        flood (KeyType::secp256k1, 20000);
+        flood (KeyType::ed25519, 20000);
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxVerifier, app, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(TxVerifierFlood, app, casinocoin);
+
+} // test
+} // casinocoin
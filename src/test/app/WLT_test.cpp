@@ -0,0 +1,245 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <casinocoin/app/tx/impl/Transactor.h>
+#include <casinocoin/ledger/ReadView.h>
+#include <casinocoin/protocol/ConfigObjectEntry.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <iomanip>
+
+namespace casinocoin {
+namespace test {
+
+inline
+Json::Value
+makeTokenJson (jtx::IOU const& iou, std::string const& supply)
+{
+    Json::Value token (Json::objectValue);
+    token[jss::token] = to_string (iou.currency);
+    token[jss::issuer] = toBase58 (iou.account.id());
+    token[jss::totalSupply] = supply;
+    token[jss::fullName] = iou.account.name() + " " + to_string (iou.currency);
+    token[jss::flags] = 0;
+    token[jss::website] = "";
+    token[jss::contactEmail] = "";
+    token[jss::iconURL] = "";
+    token[jss::apiEndpoint] = "";
+    return token;
+}
+
+inline
+ConfigObjectEntry
+makeTokenEntry (std::vector<jtx::IOU> const& ious, std::string const& supply)
+{
+    Json::Value jv (Json::objectValue);
+    jv[sfConfigID.getName()] = 1;
+    jv[sfConfigType.getName()] = "Token";
+    Json::Value& data = (jv[sfConfigData.getName()] = Json::arrayValue);
+    for (auto const& iou : ious)
+        data.append (makeTokenJson (iou, supply));
+
+    ConfigObjectEntry entry;
+    entry.fromJson (jv);
+    return entry;
+}
+
+class WLT_test : public beast::unit_test::suite
+{
+    void
+    testCompile ()
+    {
+        testcase ("Compile");
+
+        using namespace jtx;
+        Account const gw1 ("gw1");
+        Account const gw2 ("gw2");
+
+        LedgerConfig config;
+        config.compileWLT ();
+        BEAST_EXPECT(! config.wlt);
+
+        config.entries.push_back (makeTokenEntry (
+            {gw1["USD"], gw2["USD"], gw1["EUR"]}, "1000"));
+        config.compileWLT ();
+        BEAST_EXPECT(config.wlt && config.wlt->size () == 3);
+
+        // Copies share the compiled table
+        LedgerConfig const copy (config);
+        BEAST_EXPECT(copy.wlt == config.wlt);
+
+        config.entries.clear ();
+        config.compileWLT ();
+        BEAST_EXPECT(! config.wlt);
+        BEAST_EXPECT(copy.wlt && copy.wlt->size () == 3);
+    }
+
+    void
+    testCompliant ()
+    {
+        testcase ("Compliant");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        Account const alice ("alice");
+        Account const bob ("bob");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+
+        LedgerConfig config;
+        config.entries.push_back (makeTokenEntry ({USD}, "1000"));
+        config.compileWLT ();
+        WLTTable const& wlt = *config.wlt;
+        beast::Journal const j;
+
+        BEAST_EXPECT(wlt.compliant (CSC (10)));
+        BEAST_EXPECT(wlt.compliant (USD (1000)));
+        BEAST_EXPECT(! wlt.compliant (USD (1001)));
+        BEAST_EXPECT(! wlt.compliant (EUR (1)));
+        BEAST_EXPECT(! wlt.compliant (bob["USD"] (1)));
+
+        auto check = [&](JTx const& jt)
+        {
+            return Transactor::checkWLTAmounts (*jt.stx, wlt, j);
+        };
+
+        BEAST_EXPECT(check (env.jt (pay (alice, bob, USD (10)))) == tesSUCCESS);
+        BEAST_EXPECT(check (env.jt (pay (alice, bob, USD (2000)))) == tefNOT_WLT);
+        BEAST_EXPECT(check (env.jt (pay (alice, bob, EUR (10)))) == tefNOT_WLT);
+        BEAST_EXPECT(check (env.jt (offer (alice, USD (10), CSC (10)))) == tesSUCCESS);
+        BEAST_EXPECT(check (env.jt (offer (alice, CSC (10), EUR (10)))) == tefNOT_WLT);
+        BEAST_EXPECT(check (env.jt (trust (alice, USD (100)))) == tesSUCCESS);
+        BEAST_EXPECT(check (env.jt (trust (alice, EUR (100)))) == tefNOT_WLT);
+
+        // Every amount field of the transaction is checked
+        BEAST_EXPECT(check (env.jt (pay (alice, bob, USD (10)),
+            sendmax (USD (20)))) == tesSUCCESS);
+        BEAST_EXPECT(check (env.jt (pay (alice, bob, USD (10)),
+            sendmax (EUR (20)))) == tefNOT_WLT);
+    }
+
+public:
+    void
+    run () override
+    {
+        testCompile ();
+        testCompliant ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Measures WLT checks of payments against hundreds of configured tokens
+class WLTLookup_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // The scan performed before the WLT table was compiled
+    static
+    bool
+    linearCompliant (STAmount const& amount, ConfigObjectEntry const& config)
+    {
+        if (isCSC (amount))
+            return true;
+        for (auto const entry : config.getData ())
+        {
+            auto const token = static_cast<TokenDescriptor const*>(entry);
+            if (token->totalSupply.issue () == amount.issue () &&
+                    token->totalSupply >= amount)
+                return true;
+        }
+        return false;
+    }
+
+    template <class Check>
+    void
+    measure (std::string const& what, std::size_t n, Check&& check)
+    {
+        using namespace std::chrono;
+        std::size_t passed = 0;
+        auto const start = clock_type::now ();
+        for (std::size_t i = 0; i < n; ++i)
+            passed += check (i) ? 1 : 0;
+        auto const elapsed = clock_type::now () - start;
+        log << std::setw (12) << what << " " <<
+            duration_cast<nanoseconds>(elapsed).count () / n <<
+            " ns/tx (" << passed << " compliant)" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        using namespace jtx;
+        std::size_t const tokens = 500;
+        std::size_t const iterations = 200000;
+
+        Env env (*this);
+        Account const alice ("alice");
+        Account const bob ("bob");
+
+        std::vector<IOU> ious;
+        ious.reserve (tokens);
+        for (std::size_t i = 0; i < tokens; ++i)
+            ious.push_back (Account ("gw" + std::to_string (i))["USD"]);
+
+        LedgerConfig config;
+        config.entries.push_back (makeTokenEntry (ious, "1000000"));
+        config.compileWLT ();
+        BEAST_EXPECT(config.wlt->size () == tokens);
+
+        // Payments cycling through every configured token
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve (tokens);
+        for (auto const& iou : ious)
+            txs.push_back (env.jt (pay (alice, bob, iou (10)),
+                sendmax (iou (11))).stx);
+
+        beast::Journal const j;
+        auto const& wlt = *config.wlt;
+        auto const& tokenConfig = config.entries.front ();
+
+        measure ("linear", iterations / 10, [&](std::size_t i)
+        {
+            auto const& tx = *txs[i % txs.size ()];
+            for (auto const& field : tx)
+            {
+                if (field.getSType () == STI_AMOUNT &&
+                        ! linearCompliant (
+                            static_cast<STAmount const&>(field), tokenConfig))
+                    return false;
+            }
+            return true;
+        });
+        measure ("table", iterations, [&](std::size_t i)
+        {
+            return Transactor::checkWLTAmounts (
+                *txs[i % txs.size ()], wlt, j) == tesSUCCESS;
+        });
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(WLT, app, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(WLTLookup, app, casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/PoolAllocator.h>
+#include <casinocoin/beast/unit_test.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace casinocoin {
+namespace test {
+
+class PoolAllocator_test : public beast::unit_test::suite
+{
+    void
+    testReuse ()
+    {
+        testcase ("Reuse");
+
+        using Map = std::map<int, std::string, std::less<int>,
+            PoolAllocator<std::pair<int const, std::string>>>;
+        PoolAllocator<int> pool (100);
+
+        Map m (pool);
+        for (int i = 0; i < 50; ++i)
+            m.emplace (i, std::to_string (i));
+        BEAST_EXPECT(pool.allocated () == 50);
+        BEAST_EXPECT(pool.free () == 0);
+
+        // Nodes freed by one map are used by another
+        m.clear ();
+        BEAST_EXPECT(pool.free () == 50);
+        Map other (pool);
+        for (int i = 0; i < 30; ++i)
+            other.emplace (i, std::to_string (i));
+        BEAST_EXPECT(pool.reused () == 30);
+        BEAST_EXPECT(pool.allocated () == 50);
+        BEAST_EXPECT(pool.free () == 20);
+
+        // Moving keeps the pool
+        Map moved (std::move (other));
+        BEAST_EXPECT(moved.get_allocator () == pool);
+        BEAST_EXPECT(moved.size () == 30);
+        BEAST_EXPECT(moved.at (7) == "7");
+    }
+
+    void
+    testBounded ()
+    {
+        testcase ("Bounded");
+
+        PoolAllocator<std::uint64_t> pool (10);
+        std::vector<std::uint64_t*> p;
+        for (int i = 0; i < 25; ++i)
+            p.push_back (pool.allocate (1));
+        for (auto q : p)
+            pool.deallocate (q, 1);
+        BEAST_EXPECT(pool.free () == 10);
+
+        pool.setMaxFree (4);
+        BEAST_EXPECT(pool.free () == 4);
+
+        // Large allocations aren't pooled
+        auto big = pool.allocate (1000);
+        pool.deallocate (big, 1000);
+        BEAST_EXPECT(pool.free () == 4);
+        BEAST_EXPECT(pool.allocated () == 25);
+    }
+
+public:
+    void
+    run () override
+    {
+        testReuse ();
+        testBounded ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(PoolAllocator, basics, casinocoin);
+
+} // test
+} // casinocoin
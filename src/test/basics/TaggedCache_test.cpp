@@ -18,10 +18,16 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/basics/base_uint.h>
 #include <casinocoin/basics/chrono.h>
+#include <casinocoin/basics/ShardedTaggedCache.h>
 #include <casinocoin/basics/TaggedCache.h>
 #include <casinocoin/beast/unit_test.h>
 #include <casinocoin/beast/clock/manual_clock.h>
+#include <atomic>
+#include <iomanip>
+#include <random>
+#include <thread>
 
 namespace casinocoin {
 
@@ -37,17 +43,15 @@ original object.
 
 class TaggedCache_test : public beast::unit_test::suite
 {
-public:
-    void run ()
+    template <class Cache>
+    void testCache ()
     {
         beast::Journal const j;
 
         TestStopwatch clock;
         clock.set (0);
 
-        using Key = int;
-        using Value = std::string;
-        using Cache = TaggedCache <Key, Value>;
+        using Value = typename Cache::mapped_type;
 
         Cache c ("test", 1, 1, clock, j);
 
@@ -79,7 +83,7 @@ public:
             BEAST_EXPECT(c.getTrackSize() == 1);
 
             {
-                Cache::mapped_ptr p (c.fetch (2));
+                typename Cache::mapped_ptr p (c.fetch (2));
                 BEAST_EXPECT(p != nullptr);
                 ++clock;
                 c.sweep ();
@@ -99,8 +103,8 @@ public:
             BEAST_EXPECT(! c.insert (3, "three"));
 
             {
-                Cache::mapped_ptr const p1 (c.fetch (3));
-                Cache::mapped_ptr p2 (std::make_shared <Value> ("three"));
+                typename Cache::mapped_ptr const p1 (c.fetch (3));
+                typename Cache::mapped_ptr p2 (std::make_shared <Value> ("three"));
                 c.canonicalize (3, p2);
                 BEAST_EXPECT(p1.get() == p2.get());
             }
@@ -121,7 +125,7 @@ public:
 
             {
                 // Keep a strong pointer to it
-                Cache::mapped_ptr p1 (c.fetch (4));
+                typename Cache::mapped_ptr p1 (c.fetch (4));
                 BEAST_EXPECT(p1 != nullptr);
                 BEAST_EXPECT(c.getCacheSize() == 1);
                 BEAST_EXPECT(c.getTrackSize() == 1);
@@ -131,7 +135,7 @@ public:
                 BEAST_EXPECT(c.getCacheSize() == 0);
                 BEAST_EXPECT(c.getTrackSize() == 1);
                 // Canonicalize a new object with the same key
-                Cache::mapped_ptr p2 (std::make_shared <std::string> ("four"));
+                typename Cache::mapped_ptr p2 (std::make_shared <std::string> ("four"));
                 BEAST_EXPECT(c.canonicalize (4, p2, false));
                 BEAST_EXPECT(c.getCacheSize() == 1);
                 BEAST_EXPECT(c.getTrackSize() == 1);
@@ -145,8 +149,137 @@ public:
             BEAST_EXPECT(c.getTrackSize() == 0);
         }
     }
+
+    // Above the target size, entries not used since the
+    // previous sweep are evicted before they get old.
+    void testSecondChance ()
+    {
+        beast::Journal const j;
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        using Cache = ShardedTaggedCache <int, std::string>;
+
+        Cache c ("test", 4, 60, clock, j);
+
+        for (int i = 0; i < 8; ++i)
+            BEAST_EXPECT(! c.insert (i, std::to_string (i)));
+        BEAST_EXPECT(c.getCacheSize() == 8);
+
+        // Newly inserted entries count as used
+        c.sweep ();
+        BEAST_EXPECT(c.getCacheSize() == 8);
+        BEAST_EXPECT(c.getTrackSize() == 8);
+
+        for (int i = 0; i < 4; ++i)
+            BEAST_EXPECT(c.refreshIfPresent (i));
+
+        c.sweep ();
+        BEAST_EXPECT(c.getCacheSize() == 4);
+        BEAST_EXPECT(c.getTrackSize() == 4);
+        for (int i = 0; i < 8; ++i)
+            BEAST_EXPECT((c.fetch (i) != nullptr) == (i < 4));
+
+        // Within the target size only age matters
+        c.sweep ();
+        c.sweep ();
+        BEAST_EXPECT(c.getCacheSize() == 4);
+        clock.set (60);
+        c.sweep ();
+        BEAST_EXPECT(c.getCacheSize() == 0);
+        BEAST_EXPECT(c.getTrackSize() == 0);
+    }
+
+public:
+    void run ()
+    {
+        testcase ("TaggedCache");
+        testCache <TaggedCache <int, std::string>> ();
+        testcase ("ShardedTaggedCache");
+        testCache <ShardedTaggedCache <int, std::string>> ();
+        testcase ("Second chance");
+        testSecondChance ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Hammers a cache from many threads and reports lookups per second
+class TaggedCacheContention_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class Cache>
+    void
+    measure (std::string const& what, std::size_t threads)
+    {
+        using namespace std::chrono;
+
+        std::size_t const keys = 1 << 16;
+        std::size_t const iterations = 500000;
+
+        beast::Journal const j;
+        TestStopwatch clock;
+        Cache c ("test", keys, 60, clock, j);
+        std::vector<uint256> ids;
+        for (std::size_t i = 0; i <= keys * 10 / 9; ++i)
+            ids.emplace_back (i);
+        for (std::size_t i = 0; i < keys; ++i)
+            c.insert (ids[i], i);
+
+        // One lookup in ten misses and is canonicalized
+        std::atomic<std::size_t> found {0};
+        auto work = [&](std::size_t seed)
+        {
+            std::minstd_rand gen (seed);
+            std::uniform_int_distribution<std::size_t> dist (0, ids.size () - 1);
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                auto const k = dist (gen);
+                if (c.fetch (ids[k]))
+                {
+                    ++n;
+                }
+                else
+                {
+                    auto p = std::make_shared<std::size_t> (k);
+                    c.canonicalize (ids[k], p);
+                }
+            }
+            found += n;
+        };
+
+        std::vector<std::thread> workers;
+        auto const start = clock_type::now ();
+        for (std::size_t i = 0; i < threads; ++i)
+            workers.emplace_back (work, i + 1);
+        for (auto& t : workers)
+            t.join ();
+        auto const elapsed = duration<double>(clock_type::now () - start);
+
+        log << std::setw (8) << what << " " << threads << " threads: " <<
+            static_cast<std::size_t> (threads * iterations / elapsed.count ()) <<
+            " ops/sec (" << c.getHitRate () << "% hits)" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        auto const threads = std::max<std::size_t> (
+            16, std::thread::hardware_concurrency ());
+        for (std::size_t n : {std::size_t (1), threads})
+        {
+            measure <TaggedCache <uint256, std::size_t>> ("single", n);
+            measure <ShardedTaggedCache <uint256, std::size_t>> ("sharded", n);
+        }
+        pass ();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(TaggedCache,common,casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(TaggedCacheContention,common,casinocoin);
 
 }
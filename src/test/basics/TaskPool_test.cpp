@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/TaskPool.h>
+#include <casinocoin/beast/unit_test.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+
+namespace casinocoin {
+
+class TaskPool_test : public beast::unit_test::suite
+{
+    // Runs f on the pool with items claimed from a shared counter,
+    // returns the threads that did some of the work
+    static
+    std::set<std::thread::id>
+    share (TaskPool& pool, std::size_t n, std::size_t items,
+        std::function<void (std::size_t)> const& f)
+    {
+        std::mutex lock;
+        std::set<std::thread::id> ids;
+        std::atomic<std::size_t> next {0};
+        pool.run (n, [&]()
+        {
+            for (auto i = next++; i < items; i = next++)
+            {
+                f (i);
+                std::lock_guard<std::mutex> l (lock);
+                ids.insert (std::this_thread::get_id ());
+            }
+        });
+        return ids;
+    }
+
+    void
+    testRun ()
+    {
+        testcase ("Run");
+
+        TaskPool pool ("TaskPool_test", 4);
+        BEAST_EXPECT(pool.size () == 4);
+
+        std::vector<std::atomic<int>> done (1000);
+        for (auto& d : done)
+            d = 0;
+
+        // Every item is done once, by no more threads than asked for
+        std::set<std::thread::id> all;
+        for (std::size_t n : {1, 2, 4, 8})
+        {
+            auto const ids = share (pool, n, done.size (),
+                [&](std::size_t i)
+                {
+                    ++done[i];
+                    std::this_thread::sleep_for (
+                        std::chrono::microseconds (10));
+                });
+            BEAST_EXPECT(ids.size () <= std::min<std::size_t> (n, 4));
+            if (n == 1)
+                BEAST_EXPECT(ids.count (std::this_thread::get_id ()) == 1);
+            all.insert (ids.begin (), ids.end ());
+        }
+        BEAST_EXPECT(std::all_of (done.begin (), done.end (),
+            [](std::atomic<int> const& d) { return d == 4; }));
+
+        // The same threads are used for every run
+        BEAST_EXPECT(all.size () <= 4);
+
+        // Nothing to do
+        pool.run (0, [&]() { fail ("called"); });
+
+        // A pool without threads runs on the caller
+        TaskPool none ("TaskPool_test", 1);
+        auto const ids = share (none, 4, 10, [](std::size_t) {});
+        BEAST_EXPECT(ids.size () == 1 &&
+            ids.count (std::this_thread::get_id ()) == 1);
+    }
+
+    void
+    testException ()
+    {
+        testcase ("Exception");
+
+        TaskPool pool ("TaskPool_test", 4);
+        std::atomic<int> calls {0};
+        try
+        {
+            pool.run (4, [&]()
+            {
+                if (++calls == 2)
+                    throw std::runtime_error ("two");
+                std::this_thread::sleep_for (std::chrono::milliseconds (10));
+            });
+            fail ("no exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(std::string (e.what ()) == "two");
+        }
+
+        // Still usable
+        std::atomic<int> items {0};
+        share (pool, 4, 100, [&](std::size_t) { ++items; });
+        BEAST_EXPECT(items == 100);
+    }
+
+    void
+    testConcurrent ()
+    {
+        testcase ("Concurrent");
+
+        TaskPool pool ("TaskPool_test", 3);
+        std::atomic<std::size_t> items {0};
+
+        // Several callers share the threads
+        std::vector<std::thread> callers;
+        for (int i = 0; i < 4; ++i)
+        {
+            callers.emplace_back ([&]()
+            {
+                for (int j = 0; j < 50; ++j)
+                    share (pool, 3, 20, [&](std::size_t) { ++items; });
+            });
+        }
+        for (auto& caller : callers)
+            caller.join ();
+        BEAST_EXPECT(items == 4 * 50 * 20);
+
+        // Runs from inside a run don't wait for busy threads
+        items = 0;
+        share (pool, 3, 6, [&](std::size_t)
+        {
+            share (pool, 3, 10, [&](std::size_t) { ++items; });
+        });
+        BEAST_EXPECT(items == 60);
+    }
+
+public:
+    void
+    run () override
+    {
+        testRun ();
+        testException ();
+        testConcurrent ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TaskPool, basics, casinocoin);
+
+} // casinocoin
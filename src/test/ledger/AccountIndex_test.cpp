@@ -0,0 +1,226 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/ledger/AccountIndex.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class AccountIndex_test : public beast::unit_test::suite
+{
+    // Each account holds a number, and a ledger adds to it
+    using Index = AccountIndex<int>;
+    using Delta = hash_map<AccountID, int>;
+
+    static
+    std::shared_ptr<int const>
+    add (int const& value, int n)
+    {
+        if (n == 0)
+            return nullptr;
+        return std::make_shared<int const> (value + n);
+    }
+
+    static
+    void
+    update (Index& index, ReadView const& ledger, Delta const* delta)
+    {
+        index.update (ledger.info (), delta,
+            [](AccountID const&, int const& value, int n)
+            {
+                return add (value, n);
+            });
+    }
+
+    // Closed ledgers to feed the index with
+    static
+    std::vector<std::shared_ptr<ReadView const>>
+    ledgers (jtx::Env& env, int n)
+    {
+        std::vector<std::shared_ptr<ReadView const>> result;
+        for (int i = 0; i < n; ++i)
+        {
+            env.close ();
+            result.push_back (env.closed ());
+        }
+        return result;
+    }
+
+    void
+    testFollow ()
+    {
+        testcase ("Follow");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const alice = Account ("alice").id ();
+        auto const bob = Account ("bob").id ();
+        auto const carol = Account ("carol").id ();
+        auto const history = ledgers (env, 3);
+
+        Index index (10, beast::Journal ());
+        int loads = 0;
+        auto load = [&loads]()
+        {
+            ++loads;
+            return std::make_shared<int const> (1);
+        };
+
+        // Nothing is known before the first ledger
+        BEAST_EXPECT(! index.get (*history[0], alice, load));
+        BEAST_EXPECT(index.seq () == 0);
+
+        update (index, *history[0], nullptr);
+        BEAST_EXPECT(index.seq () == history[0]->seq ());
+        BEAST_EXPECT(! index.get (*env.current (), alice, load));
+        BEAST_EXPECT(loads == 0);
+
+        auto const first = index.get (*history[0], alice, load);
+        BEAST_EXPECT(first && *first == 1);
+        BEAST_EXPECT(index.get (*history[0], alice, load) == first);
+        BEAST_EXPECT(index.get (*history[0], bob, load));
+        BEAST_EXPECT(loads == 2);
+
+        // Values are patched from the ledgers that follow
+        Delta const delta {{alice, 5}, {carol, 7}};
+        update (index, *history[1], &delta);
+        BEAST_EXPECT(index.seq () == history[1]->seq ());
+        BEAST_EXPECT(! index.get (*history[0], alice, load));
+
+        auto const second = index.get (*history[1], alice, load);
+        BEAST_EXPECT(second && *second == 6);
+        BEAST_EXPECT(*first == 1);
+        BEAST_EXPECT(index.get (*history[1], bob, load));
+        BEAST_EXPECT(index.size () == 2);
+        BEAST_EXPECT(loads == 2);
+
+        // A patch that fails drops the value
+        Delta const none {{alice, 0}};
+        update (index, *history[2], &none);
+        BEAST_EXPECT(index.size () == 1);
+        BEAST_EXPECT(index.get (*history[2], alice, load));
+        BEAST_EXPECT(loads == 3);
+
+        // Ledgers already reflected are ignored
+        update (index, *history[1], &delta);
+        BEAST_EXPECT(index.seq () == history[2]->seq ());
+        BEAST_EXPECT(index.size () == 2);
+
+        // A value that can't be read isn't kept
+        BEAST_EXPECT(! index.get (*history[2], carol,
+            []() { return std::shared_ptr<int const> (); }));
+        BEAST_EXPECT(index.size () == 2);
+    }
+
+    void
+    testStartOver ()
+    {
+        testcase ("Start over");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const alice = Account ("alice").id ();
+        auto const history = ledgers (env, 5);
+        auto load = []()
+        {
+            return std::make_shared<int const> (1);
+        };
+
+        Index index (10, beast::Journal ());
+        Delta const delta {{alice, 1}};
+        update (index, *history[0], &delta);
+        BEAST_EXPECT(index.get (*history[0], alice, load));
+
+        // Skipping a ledger
+        update (index, *history[2], &delta);
+        BEAST_EXPECT(index.seq () == history[2]->seq ());
+        BEAST_EXPECT(index.size () == 0);
+        BEAST_EXPECT(index.get (*history[2], alice, load));
+
+        // A ledger whose changes aren't known
+        update (index, *history[3], nullptr);
+        BEAST_EXPECT(index.size () == 0);
+        BEAST_EXPECT(index.get (*history[3], alice, load));
+
+        // A ledger applied while a value is read
+        auto const value = index.get (*history[3], Account ("bob").id (),
+            [&]()
+            {
+                update (index, *history[4], &delta);
+                return std::make_shared<int const> (1);
+            });
+        BEAST_EXPECT(value);
+        BEAST_EXPECT(index.size () == 1);
+        BEAST_EXPECT(*index.get (*history[4], alice, load) == 2);
+    }
+
+    void
+    testLimit ()
+    {
+        testcase ("Limit");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const history = ledgers (env, 3);
+        auto load = []()
+        {
+            return std::make_shared<int const> (1);
+        };
+        std::vector<AccountID> accounts;
+        for (auto const& name : {"alice", "bob", "carol", "dave"})
+            accounts.push_back (Account (name).id ());
+
+        Index index (2, beast::Journal ());
+        Delta const delta;
+        update (index, *history[0], &delta);
+        index.get (*history[0], accounts[0], load);
+        update (index, *history[1], &delta);
+        index.get (*history[1], accounts[1], load);
+        update (index, *history[2], &delta);
+        index.get (*history[2], accounts[2], load);
+
+        // The account used least recently goes first
+        auto none = []()
+        {
+            return std::shared_ptr<int const> ();
+        };
+        BEAST_EXPECT(index.size () <= 2);
+        BEAST_EXPECT(! index.get (*history[2], accounts[0], none));
+
+        BEAST_EXPECT(index.get (*history[2], accounts[3], load));
+        BEAST_EXPECT(index.size () <= 2);
+    }
+
+public:
+    void
+    run () override
+    {
+        testFollow ();
+        testStartOver ();
+        testLimit ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountIndex, ledger, casinocoin);
+
+} // test
+} // casinocoin
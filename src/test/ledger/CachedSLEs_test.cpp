@@ -0,0 +1,286 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/ledger/Ledger.h>
+#include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/ledger/CachedSLEs.h>
+#include <casinocoin/ledger/CachedView.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <thread>
+
+namespace casinocoin {
+namespace test {
+
+class CachedSLEs_test : public beast::unit_test::suite
+{
+    static
+    std::shared_ptr<SLE const>
+    makeSLE (std::uint32_t n)
+    {
+        AccountID const id (n);
+        auto sle = std::make_shared<SLE> (keylet::account (id));
+        sle->setAccountID (sfAccount, id);
+        sle->setFieldU32 (sfSequence, n);
+        return sle;
+    }
+
+    static
+    uint256
+    digest (std::uint32_t n)
+    {
+        return sha512Half (n);
+    }
+
+    void
+    testFetch ()
+    {
+        testcase ("Fetch");
+
+        TestStopwatch clock;
+        CachedSLEs cache (std::chrono::minutes (1), clock);
+
+        int reads = 0;
+        auto const sle = makeSLE (1);
+        auto read = [&]() { ++reads; return sle; };
+
+        BEAST_EXPECT(cache.fetch (digest (1), read) == sle);
+        BEAST_EXPECT(cache.fetch (digest (1), read) == sle);
+        BEAST_EXPECT(reads == 1);
+        BEAST_EXPECT(cache.hits () == 1);
+        BEAST_EXPECT(cache.misses () == 1);
+        BEAST_EXPECT(cache.rate () == 0.5);
+        BEAST_EXPECT(cache.size () == 1);
+        BEAST_EXPECT(cache.bytes () == sle->getSerializer ().size ());
+
+        // Missing entries are not cached
+        BEAST_EXPECT(! cache.fetch (digest (2),
+            []() { return std::shared_ptr<SLE const> (); }));
+        BEAST_EXPECT(cache.size () == 1);
+    }
+
+    void
+    testBudget ()
+    {
+        testcase ("Byte budget");
+
+        TestStopwatch clock;
+        auto const budget = CachedSLEs::shardCount * 512;
+        CachedSLEs cache (std::chrono::minutes (1), clock, budget);
+
+        std::vector<std::shared_ptr<SLE const>> sles;
+        for (std::uint32_t i = 0; i < 2000; ++i)
+            sles.push_back (makeSLE (i));
+
+        for (std::uint32_t i = 0; i < sles.size (); ++i)
+        {
+            cache.fetch (digest (i), [&]() { return sles[i]; });
+            BEAST_EXPECT(cache.bytes () <= budget);
+        }
+        BEAST_EXPECT(cache.size () < sles.size ());
+        BEAST_EXPECT(cache.size () > 0);
+
+        // Recently used entries survive the eviction of others
+        std::uint32_t const hot = 1999;
+        int reads = 0;
+        for (std::uint32_t i = 0; i < 200; ++i)
+        {
+            cache.fetch (digest (hot),
+                [&]() { ++reads; return sles[hot]; });
+            cache.fetch (digest (3000 + i),
+                [&]() { return makeSLE (3000 + i); });
+        }
+        BEAST_EXPECT(reads == 0);
+    }
+
+    void
+    testExpire ()
+    {
+        testcase ("Expire");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        CachedSLEs cache (1min, clock);
+
+        auto const held = makeSLE (1);
+        cache.fetch (digest (1), [&]() { return held; });
+        cache.fetch (digest (2), []() { return makeSLE (2); });
+        BEAST_EXPECT(cache.size () == 2);
+
+        clock.advance (30s);
+        cache.expire ();
+        BEAST_EXPECT(cache.size () == 2);
+
+        // Entries still referenced elsewhere are kept
+        clock.advance (31s);
+        cache.expire ();
+        BEAST_EXPECT(cache.size () == 1);
+        BEAST_EXPECT(cache.bytes () == held->getSerializer ().size ());
+    }
+
+    void
+    testSize ()
+    {
+        testcase ("Serialized size");
+
+        std::vector<std::shared_ptr<SLE>> sles;
+
+        // Blobs, an inner object and a field with an uncommon name
+        auto root = std::make_shared<SLE> (keylet::account (AccountID (1)));
+        root->setAccountID (sfAccount, AccountID (1));
+        root->setAccountID (sfRegularKey, AccountID (2));
+        root->setFieldAmount (sfBalance, CSCAmount (123456789));
+        root->setFieldU32 (sfSequence, 7);
+        root->setFieldH128 (sfEmailHash, uint128 (3));
+        root->setFieldVL (sfMessageKey, Blob (33, 0x02));
+        root->setFieldVL (sfDomain, Blob (200, 'a'));
+        root->setFieldU8 (sfTickSize, 5);
+        STObject kyc (sfKYC);
+        kyc.setFieldU32 (sfKYCTime, 1);
+        kyc.setFieldV128 (sfKYCVerifications,
+            STVector128 (std::vector<uint128> (3, uint128 (4))));
+        root->setFieldObject (sfKYC, kyc);
+        sles.push_back (root);
+
+        // Issued amounts
+        auto const usd = Issue (to_currency ("USD"), AccountID (1));
+        auto line = std::make_shared<SLE> (keylet::line (
+            AccountID (1), AccountID (2), usd.currency));
+        line->setFieldAmount (sfBalance, STAmount (usd, -5));
+        line->setFieldAmount (sfLowLimit, STAmount (usd, 100));
+        line->setFieldAmount (sfHighLimit, STAmount (usd));
+        line->setFieldU64 (sfLowNode, 12);
+        sles.push_back (line);
+
+        // Lengths of one, two and three bytes
+        for (std::size_t n : {6, 300, 400})
+        {
+            auto dir = std::make_shared<SLE> (keylet::page (uint256 (n)));
+            dir->setFieldV256 (sfIndexes, STVector256 (
+                std::vector<uint256> (n, uint256 (5))));
+            dir->setFieldH256 (sfRootIndex, uint256 (n));
+            sles.push_back (dir);
+        }
+
+        // An array of objects
+        auto signers = std::make_shared<SLE> (
+            keylet::signers (AccountID (1)));
+        STArray entries (sfSignerEntries);
+        for (std::uint16_t i = 0; i < 3; ++i)
+        {
+            entries.emplace_back (sfSignerEntry);
+            entries.back ().setAccountID (sfAccount, AccountID (10 + i));
+            entries.back ().setFieldU16 (sfSignerWeight, i);
+        }
+        signers->setFieldArray (sfSignerEntries, entries);
+        signers->setFieldU32 (sfSignerQuorum, 2);
+        sles.push_back (signers);
+
+        TestStopwatch clock;
+        for (std::uint32_t i = 0; i < sles.size (); ++i)
+        {
+            CachedSLEs cache (std::chrono::minutes (1), clock);
+            cache.fetch (digest (i), [&]() { return sles[i]; });
+            BEAST_EXPECT(cache.bytes () == sles[i]->getSerializer ().size ());
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testFetch ();
+        testBudget ();
+        testExpire ();
+        testSize ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Reads every account root of a ledger through fresh CachedViews
+// from several threads and reports the read rate
+class CachedViewRead_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    void
+    readAll (std::shared_ptr<Ledger const> const& ledger,
+        CachedSLEs& cache, std::vector<Keylet> const& keys,
+        std::size_t threads, std::size_t rounds)
+    {
+        using namespace std::chrono;
+
+        auto const start = clock_type::now ();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&]()
+            {
+                for (std::size_t r = 0; r < rounds; ++r)
+                {
+                    CachedLedger view (ledger, cache);
+                    for (auto const& k : keys)
+                        view.read (k);
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join ();
+        auto const elapsed = duration<double>(clock_type::now () - start);
+
+        log << threads << " threads: " << static_cast<std::size_t> (
+            threads * rounds * keys.size () / elapsed.count ()) <<
+            " reads/sec, hit rate " << cache.rate () << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        using namespace jtx;
+        Env env (*this);
+
+        std::vector<Keylet> keys;
+        for (int i = 0; i < 2000; ++i)
+        {
+            Account const a ("reader" + std::to_string (i));
+            env.fund (CSC (1000), a);
+            keys.push_back (keylet::account (a.id ()));
+        }
+        env.close ();
+
+        auto const ledger = env.app ().getLedgerMaster ().getClosedLedger ();
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            CachedSLEs cache (std::chrono::minutes (1), stopwatch ());
+            readAll (ledger, cache, keys, threads, 100);
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CachedSLEs, ledger, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(CachedViewRead, ledger, casinocoin);
+
+} // test
+} // casinocoin
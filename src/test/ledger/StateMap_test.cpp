@@ -0,0 +1,233 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/ledger/OpenView.h>
+#include <casinocoin/ledger/detail/StateMap.h>
+#include <casinocoin/protocol/Indexes.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <map>
+
+namespace casinocoin {
+namespace test {
+
+class StateMap_test : public beast::unit_test::suite
+{
+    enum class Action
+    {
+        erase,
+        insert,
+    };
+
+    using Map = detail::StateMap<Action>;
+
+    static
+    std::shared_ptr<SLE>
+    makeSLE (std::uint64_t n)
+    {
+        return std::make_shared<SLE> (
+            keylet::account (AccountID (n)));
+    }
+
+    void
+    testOrder ()
+    {
+        testcase ("Order");
+
+        Map map;
+        std::map<uint256, Action> expected;
+        for (std::uint64_t i = 0; i < 500; ++i)
+        {
+            auto const sle = makeSLE ((i * 7919) % 1000);
+            auto const action = i % 2 ? Action::erase : Action::insert;
+            auto const result = map.emplace (sle->key (), action, sle);
+            BEAST_EXPECT(result.first->first == sle->key ());
+            BEAST_EXPECT(result.second ==
+                expected.emplace (sle->key (), action).second);
+        }
+        BEAST_EXPECT(map.size () == expected.size ());
+
+        auto check = [&]()
+        {
+            if (! BEAST_EXPECT(map.size () == expected.size ()))
+                return;
+            auto iter = map.begin ();
+            for (auto const& e : expected)
+            {
+                BEAST_EXPECT(iter->first == e.first);
+                BEAST_EXPECT(iter->second.first == e.second);
+                BEAST_EXPECT(iter->second.second->key () == e.first);
+                ++iter;
+            }
+        };
+        check ();
+
+        // Lookups agree with std::map
+        for (std::uint64_t i = 0; i < 1000; ++i)
+        {
+            auto const key = keylet::account (AccountID (i)).key;
+            auto const found = map.find (key);
+            BEAST_EXPECT((found != map.end ()) == (expected.count (key) == 1));
+
+            auto const lower = map.lower_bound (key);
+            auto const elower = expected.lower_bound (key);
+            BEAST_EXPECT((lower == map.end ()) == (elower == expected.end ()));
+            if (lower != map.end () && elower != expected.end ())
+                BEAST_EXPECT(lower->first == elower->first);
+
+            auto const upper = static_cast<Map const&> (map).upper_bound (key);
+            auto const eupper = expected.upper_bound (key);
+            BEAST_EXPECT((upper == map.end ()) == (eupper == expected.end ()));
+            if (upper != map.end () && eupper != expected.end ())
+                BEAST_EXPECT(upper->first == eupper->first);
+        }
+
+        // Erase every third entry
+        int n = 0;
+        for (auto iter = map.begin (); iter != map.end ();)
+        {
+            if (n++ % 3 == 0)
+            {
+                expected.erase (iter->first);
+                iter = map.erase (iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+        check ();
+
+        // Copies are independent
+        Map copy (map);
+        auto const sle = makeSLE (5000);
+        copy.emplace (sle->key (), Action::insert, sle);
+        BEAST_EXPECT(copy.size () == map.size () + 1);
+        check ();
+    }
+
+    void
+    testRecycle ()
+    {
+        testcase ("Recycle");
+
+        auto fill = []()
+        {
+            Map map;
+            for (std::uint64_t i = 0; i < 100; ++i)
+            {
+                auto const sle = makeSLE (i);
+                map.emplace (sle->key (), Action::insert, sle);
+            }
+        };
+
+        fill ();
+        auto const before = detail::stateMapAllocations ();
+        for (int i = 0; i < 10; ++i)
+            fill ();
+        BEAST_EXPECT(detail::stateMapAllocations () == before);
+    }
+
+public:
+    void
+    run () override
+    {
+        testOrder ();
+        testRecycle ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Applies signed payments to a closed view, generating metadata as
+// consensus does, and reports the time and the state table
+// allocations per transaction
+class ApplyPayments_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // Applies 10k payments to one open view. When each payment creates
+    // its destination the view ends up holding a large ledger's worth
+    // of entries, otherwise it only holds the 100 payers.
+    void
+    bench (bool create)
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        Env env (*this);
+        std::vector<Account> accounts;
+        for (int i = 0; i < 100; ++i)
+        {
+            accounts.emplace_back ("payer" + std::to_string (i));
+            env.fund (CSC (1000000), accounts.back ());
+        }
+        env.close ();
+
+        std::size_t const n = 10000;
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const& from = accounts[i % accounts.size ()];
+            auto const to = create ?
+                Account ("payee" + std::to_string (i)) :
+                accounts[(i + 1) % accounts.size ()];
+            txs.push_back (env.jt (pay (from, to, CSC (create ? 1000 : 1)),
+                seq (env.seq (from) + i / accounts.size ()),
+                    fee (1000)).stx);
+        }
+
+        OpenView view (&*env.closed ());
+        std::size_t applied = 0;
+        auto const allocations = casinocoin::detail::stateMapAllocations ();
+        auto const start = clock_type::now ();
+        for (auto const& stx : txs)
+        {
+            if (apply (env.app (), view, *stx,
+                    tapNO_CHECK_SIGN, env.journal).second)
+                ++applied;
+        }
+        auto const elapsed = duration_cast<nanoseconds> (
+            clock_type::now () - start);
+        BEAST_EXPECT(applied == n);
+
+        log << n << (create ? " payments creating accounts: " :
+            " payments: ") << elapsed.count () / n << " ns/tx, " <<
+            double (casinocoin::detail::stateMapAllocations () - allocations) / n <<
+            " state table allocations/tx" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        bench (false);
+        bench (true);
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StateMap, ledger, casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(ApplyPayments, ledger, casinocoin);
+
+} // test
+} // casinocoin
@@ -19,16 +19,374 @@
 
 #include <BeastConfig.h>
 #include <test/nodestore/TestBase.h>
+#include <casinocoin/basics/contract.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
 #include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/nodestore/impl/DatabaseImp.h>
 #include <casinocoin/beast/utility/temp_dir.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace casinocoin {
 namespace NodeStore {
 
 class Database_test : public TestBase
 {
+    // A backend whose reads can be held back by the test
+    class GatedBackend : public Backend
+    {
+        std::unique_ptr <Backend> backend_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool open_ = true;
+        int waiting_ = 0;
+        int reads_ = 0;
+
+    public:
+        explicit
+        GatedBackend (std::unique_ptr <Backend> backend)
+            : backend_ (std::move (backend))
+        {
+        }
+
+        // Hold back the reads that follow
+        void
+        shut ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            open_ = false;
+        }
+
+        // Let the reads through
+        void
+        open ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            open_ = true;
+            cond_.notify_all ();
+        }
+
+        // Wait until a read is held back
+        bool
+        waitForReader ()
+        {
+            using namespace std::chrono_literals;
+            std::unique_lock <std::mutex> lock (mutex_);
+            return cond_.wait_for (lock, 5s, [&]{ return waiting_ != 0; });
+        }
+
+        // The number of objects read from the backend
+        int
+        reads ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            return reads_;
+        }
+
+        std::string
+        getName () override
+        {
+            return backend_->getName ();
+        }
+
+        void
+        close () override
+        {
+            backend_->close ();
+        }
+
+        Status
+        fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override
+        {
+            {
+                std::unique_lock <std::mutex> lock (mutex_);
+                ++waiting_;
+                cond_.notify_all ();
+                cond_.wait (lock, [&]{ return open_; });
+                --waiting_;
+                ++reads_;
+            }
+            return backend_->fetch (key, pObject);
+        }
+
+        bool
+        canFetchBatch () override
+        {
+            return false;
+        }
+
+        std::vector <std::shared_ptr<NodeObject>>
+        fetchBatch (std::size_t, void const* const*) override
+        {
+            Throw<std::runtime_error> ("pure virtual called");
+            return {};
+        }
+
+        void
+        store (std::shared_ptr<NodeObject> const& object) override
+        {
+            backend_->store (object);
+        }
+
+        void
+        storeBatch (Batch const& batch) override
+        {
+            backend_->storeBatch (batch);
+        }
+
+        void
+        for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override
+        {
+            backend_->for_each (f);
+        }
+
+        int
+        getWriteLoad () override
+        {
+            return backend_->getWriteLoad ();
+        }
+
+        void
+        setDeletePath () override
+        {
+            backend_->setDeletePath ();
+        }
+
+        void
+        verify () override
+        {
+            backend_->verify ();
+        }
+
+        int
+        fdlimit () const override
+        {
+            return backend_->fdlimit ();
+        }
+    };
+
+    // A database with a single read thread the test can stop
+    class GatedDatabase : public DatabaseImp
+    {
+    public:
+        GatedDatabase (Scheduler& scheduler, Stoppable& parent,
+                std::unique_ptr <Backend> backend, beast::Journal journal)
+            : DatabaseImp ("test", scheduler, 1, parent,
+                std::move (backend), journal)
+        {
+        }
+
+        ~GatedDatabase () override
+        {
+            stopThreads ();
+        }
+
+        using DatabaseImp::stopThreads;
+    };
+
+    // Collects the results of a batch fetch
+    class Fetched
+    {
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        int calls_ = 0;
+        std::vector <std::shared_ptr<NodeObject>> objects_;
+
+    public:
+        Database::BatchCallback
+        callback ()
+        {
+            return [this](std::vector <std::shared_ptr<NodeObject>> const& objects)
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                ++calls_;
+                objects_ = objects;
+                cond_.notify_all ();
+            };
+        }
+
+        bool
+        wait ()
+        {
+            using namespace std::chrono_literals;
+            std::unique_lock <std::mutex> lock (mutex_);
+            return cond_.wait_for (lock, 5s, [&]{ return calls_ != 0; });
+        }
+
+        int
+        calls ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            return calls_;
+        }
+
+        std::vector <std::shared_ptr<NodeObject>>
+        objects ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            return objects_;
+        }
+    };
+
+    static
+    std::unique_ptr <GatedBackend>
+    makeGatedBackend (Scheduler& scheduler, beast::temp_dir const& dir)
+    {
+        Section params;
+        params.set ("type", "memory");
+        params.set ("path", dir.path ());
+        return std::make_unique <GatedBackend> (
+            Manager::instance ().make_Backend (
+                params, scheduler, beast::Journal ()));
+    }
+
+    bool
+    expectObjects (std::vector <std::shared_ptr<NodeObject>> const& objects,
+        std::vector <std::shared_ptr<NodeObject>> const& expected)
+    {
+        if (! BEAST_EXPECT(objects.size () == expected.size ()))
+            return false;
+        bool same = true;
+        for (std::size_t i = 0; i < objects.size (); ++i)
+        {
+            if (! expected[i])
+                same = ! objects[i] && same;
+            else
+                same = objects[i] && isSame (objects[i], expected[i]) && same;
+        }
+        return BEAST_EXPECT(same);
+    }
+
 public:
+    void testBatchReads ()
+    {
+        testcase ("batch reads");
+
+        DummyScheduler scheduler;
+        RootStoppable parent ("TestRootStoppable");
+        beast::temp_dir node_db;
+        auto const batch = createPredictableBatch (8, 51);
+        std::shared_ptr<NodeObject> const none;
+
+        auto backend = makeGatedBackend (scheduler, node_db);
+        auto& gate = *backend;
+        GatedDatabase db (scheduler, parent, std::move (backend),
+            beast::Journal ());
+
+        // The first objects are cached, the others are only in the backend
+        for (int i = 0; i < 4; ++i)
+            db.store (batch[i]->getType (), Blob (batch[i]->getData ()),
+                batch[i]->getHash ());
+        for (int i = 4; i < 8; ++i)
+            gate.store (batch[i]);
+
+        {
+            // Cache hits and misses in one batch
+            uint256 unknown;
+            unknown.SetHex ("1234");
+            Fetched fetched;
+            db.asyncFetchBatch ({batch[0]->getHash (), batch[4]->getHash (),
+                unknown, batch[1]->getHash (), batch[5]->getHash ()},
+                    fetched.callback ());
+            BEAST_EXPECT(fetched.wait ());
+            expectObjects (fetched.objects (),
+                {batch[0], batch[4], none, batch[1], batch[5]});
+            BEAST_EXPECT(fetched.calls () == 1);
+            BEAST_EXPECT(gate.reads () == 3);
+
+            // A batch of hits completes on the calling thread
+            Fetched hits;
+            db.asyncFetchBatch ({batch[4]->getHash (), unknown,
+                batch[2]->getHash ()}, hits.callback ());
+            BEAST_EXPECT(hits.calls () == 1);
+            expectObjects (hits.objects (), {batch[4], none, batch[2]});
+            BEAST_EXPECT(gate.reads () == 3);
+        }
+
+        {
+            // Hold the read thread in the backend so the
+            // following reads are queued behind it
+            gate.shut ();
+            Fetched first;
+            db.asyncFetchBatch ({batch[6]->getHash ()}, first.callback ());
+            BEAST_EXPECT(gate.waitForReader ());
+
+            // Several batches wait on the same pending read
+            Fetched second;
+            Fetched third;
+            db.asyncFetchBatch ({batch[7]->getHash (), batch[3]->getHash ()},
+                second.callback ());
+            db.asyncFetchBatch ({batch[7]->getHash ()}, third.callback ());
+            BEAST_EXPECT(second.calls () == 0);
+            BEAST_EXPECT(third.calls () == 0);
+
+            gate.open ();
+            BEAST_EXPECT(first.wait ());
+            BEAST_EXPECT(second.wait ());
+            BEAST_EXPECT(third.wait ());
+            expectObjects (first.objects (), {batch[6]});
+            expectObjects (second.objects (), {batch[7], batch[3]});
+            expectObjects (third.objects (), {batch[7]});
+            BEAST_EXPECT(first.calls () == 1);
+            BEAST_EXPECT(second.calls () == 1);
+            BEAST_EXPECT(third.calls () == 1);
+
+            // The shared key was read once
+            BEAST_EXPECT(gate.reads () == 5);
+        }
+    }
+
+    void testBatchShutdown ()
+    {
+        testcase ("batch reads at shutdown");
+
+        DummyScheduler scheduler;
+        RootStoppable parent ("TestRootStoppable");
+        beast::temp_dir node_db;
+        auto const batch = createPredictableBatch (3, 52);
+        std::shared_ptr<NodeObject> const none;
+
+        auto backend = makeGatedBackend (scheduler, node_db);
+        auto& gate = *backend;
+        GatedDatabase db (scheduler, parent, std::move (backend),
+            beast::Journal ());
+        for (auto const& object : batch)
+            gate.store (object);
+
+        // Queue reads behind one held in the backend
+        gate.shut ();
+        Fetched reading;
+        db.asyncFetchBatch ({batch[0]->getHash ()}, reading.callback ());
+        BEAST_EXPECT(gate.waitForReader ());
+        Fetched queued;
+        db.asyncFetchBatch ({batch[1]->getHash (), batch[2]->getHash ()},
+            queued.callback ());
+
+        // Stop while the read is held back, waitReads
+        // returns once the read threads are told to stop
+        std::thread stopper ([&db]{ db.stopThreads (); });
+        db.waitReads ();
+        gate.open ();
+        stopper.join ();
+
+        // The read in progress completes, the queued reads complete
+        // as not found
+        BEAST_EXPECT(reading.calls () == 1);
+        expectObjects (reading.objects (), {batch[0]});
+        BEAST_EXPECT(queued.calls () == 1);
+        expectObjects (queued.objects (), {none, none});
+
+        // Later batches read on the calling thread
+        Fetched later;
+        db.asyncFetchBatch ({batch[1]->getHash ()}, later.callback ());
+        BEAST_EXPECT(later.calls () == 1);
+        expectObjects (later.objects (), {batch[1]});
+    }
+
+    //--------------------------------------------------------------------------
+
     void testImport (std::string const& destBackendType,
         std::string const& srcBackendType, std::int64_t seedValue)
     {
@@ -190,6 +548,9 @@ public:
     {
         std::int64_t const seedValue = 50;
 
+        testBatchReads ();
+        testBatchShutdown ();
+
         testNodeStore ("memory", false, seedValue);
 
         runBackendTests (seedValue);
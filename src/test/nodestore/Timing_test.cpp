@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <test/nodestore/TestBase.h>
+#include <casinocoin/nodestore/Database.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
 #include <casinocoin/nodestore/Manager.h>
 #include <casinocoin/basics/BasicConfig.h>
@@ -144,6 +145,9 @@ public:
     {
         // percent of fetches for missing nodes
         missingNodePercent = 20
+
+        // number of keys in each batch fetch
+        ,batchFetchSize = 64
     };
 
     std::size_t const default_repeat = 3;
@@ -397,6 +401,65 @@ public:
         backend->close();
     }
 
+    // Fetch existing keys in batches through the Database
+    void
+    do_batch (Section const& config, Params const& params)
+    {
+        beast::Journal journal;
+        DummyScheduler scheduler;
+        RootStoppable parent ("TestRootStoppable");
+        auto db = Manager::instance().make_Database (
+            "test", scheduler, 4, parent, config, journal);
+        BEAST_EXPECT(db != nullptr);
+
+        class Body
+        {
+        private:
+            suite& suite_;
+            Database& db_;
+            Sequence seq1_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body (std::size_t id, suite& s,
+                    Params const& params, Database& db)
+                : suite_(s)
+                , db_ (db)
+                , seq1_ (1)
+                , gen_ (id + 1)
+                , dist_ (0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                try
+                {
+                    std::vector<std::shared_ptr<NodeObject>> objs;
+                    std::vector<uint256> hashes;
+                    for (std::size_t n = 0; n < batchFetchSize; ++n)
+                    {
+                        objs.push_back (seq1_.obj(dist_(gen_)));
+                        hashes.push_back (objs.back()->getHash());
+                    }
+                    auto const results = db_.fetchBatch (hashes);
+                    for (std::size_t n = 0; n < batchFetchSize; ++n)
+                        suite_.expect(results[n] && isSame(results[n], objs[n]));
+                }
+                catch(std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        parallel_for_id<Body>(
+            (params.items + batchFetchSize - 1) / batchFetchSize,
+                params.threads, std::ref(*this), std::ref(params),
+                    std::ref(*db));
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing (Section const& config, Params const& params)
@@ -740,6 +803,7 @@ public:
             {
                  { "Insert",    &Timing_test::do_insert }
                 ,{ "Fetch",     &Timing_test::do_fetch }
+                ,{ "Batch",     &Timing_test::do_batch }
                 ,{ "Missing",   &Timing_test::do_missing }
                 ,{ "Mixed",     &Timing_test::do_mixed }
                 ,{ "Work",      &Timing_test::do_work }
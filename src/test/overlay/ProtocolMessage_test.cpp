@@ -0,0 +1,519 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/overlay/Message.h>
+#include <casinocoin/overlay/impl/MessageArena.h>
+#include <casinocoin/overlay/impl/ProtocolMessage.h>
+#include <casinocoin/overlay/impl/ZeroCopyStream.h>
+#include <casinocoin/beast/unit_test.h>
+#include <boost/asio/buffer.hpp>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <random>
+
+namespace casinocoin {
+namespace test {
+
+// Records what invokeProtocolMessage hands to a peer
+struct ProtocolMessageHandler
+{
+    bool keep = false;
+    std::vector<std::shared_ptr<::google::protobuf::Message>> kept;
+    std::vector<std::string> parsed;
+
+    boost::system::error_code
+    onMessageUnknown (std::uint16_t)
+    {
+        return {};
+    }
+
+    boost::system::error_code
+    onMessageBegin (std::uint16_t,
+        std::shared_ptr <::google::protobuf::Message> const& m,
+        std::size_t, std::size_t)
+    {
+        parsed.push_back (m->SerializeAsString ());
+        if (keep)
+            kept.push_back (m);
+        return {};
+    }
+
+    template <class T>
+    void
+    onMessage (std::shared_ptr <T> const&)
+    {
+    }
+
+    void
+    onMessageEnd (std::uint16_t,
+        std::shared_ptr <::google::protobuf::Message> const&)
+    {
+    }
+};
+
+// Messages like those seen on the network, by type
+static
+std::vector<std::pair<std::string, std::vector<std::uint8_t>>>
+makeCorpus ()
+{
+    std::mt19937 gen;
+    auto bytes = [&](std::size_t n)
+    {
+        std::string s (n, 0);
+        for (auto& c : s)
+            c = static_cast<char> (gen ());
+        return s;
+    };
+
+    std::vector<std::pair<std::string, std::vector<std::uint8_t>>> corpus;
+    auto add = [&](::google::protobuf::Message const& m, int type)
+    {
+        corpus.emplace_back (protocolMessageName (type),
+            Message (m, type).getBuffer ());
+    };
+
+    {
+        protocol::TMProposeSet m;
+        m.set_proposeseq (3);
+        m.set_currenttxhash (bytes (32));
+        m.set_nodepubkey (bytes (33));
+        m.set_closetime (600000000);
+        m.set_signature (bytes (71));
+        m.set_previousledger (bytes (32));
+        add (m, protocol::mtPROPOSE_LEDGER);
+    }
+    {
+        protocol::TMValidation m;
+        m.set_validation (bytes (220));
+        add (m, protocol::mtVALIDATION);
+    }
+    {
+        protocol::TMTransaction m;
+        m.set_rawtransaction (bytes (180));
+        m.set_status (protocol::tsNEW);
+        m.set_receivetimestamp (600000000);
+        add (m, protocol::mtTRANSACTION);
+    }
+    {
+        protocol::TMPing m;
+        m.set_type (protocol::TMPing::ptPING);
+        m.set_seq (42);
+        add (m, protocol::mtPING);
+    }
+    {
+        protocol::TMStatusChange m;
+        m.set_newevent (protocol::neACCEPTED_LEDGER);
+        m.set_ledgerseq (1000);
+        m.set_ledgerhash (bytes (32));
+        m.set_ledgerhashprevious (bytes (32));
+        m.set_networktime (600000000);
+        m.set_firstseq (1);
+        m.set_lastseq (1000);
+        add (m, protocol::mtSTATUS_CHANGE);
+    }
+    {
+        protocol::TMManifests m;
+        for (int i = 0; i < 16; ++i)
+            m.add_list ()->set_stobject (bytes (150));
+        add (m, protocol::mtMANIFESTS);
+    }
+    {
+        protocol::TMLedgerData m;
+        m.set_ledgerhash (bytes (32));
+        m.set_ledgerseq (1000);
+        m.set_type (protocol::liAS_NODE);
+        for (int i = 0; i < 200; ++i)
+        {
+            auto node = m.add_nodes ();
+            node->set_nodedata (bytes (120));
+            node->set_nodeid (bytes (33));
+        }
+        add (m, protocol::mtLEDGER_DATA);
+    }
+    return corpus;
+}
+
+class ProtocolMessage_test : public beast::unit_test::suite
+{
+    void
+    testArena ()
+    {
+        testcase ("Arena");
+
+        auto const corpus = makeCorpus ();
+        MessageArena arena;
+        ProtocolMessageHandler h;
+        auto const before = MessageArena::allocations ();
+        for (int i = 0; i < 100; ++i)
+        {
+            for (auto const& item : corpus)
+            {
+                auto const result = invokeProtocolMessage (
+                    boost::asio::buffer (item.second), h, arena);
+                BEAST_EXPECT(! result.second);
+                BEAST_EXPECT(result.first == item.second.size ());
+            }
+        }
+        auto const allocations = MessageArena::allocations () - before;
+
+        BEAST_EXPECT(h.parsed.size () == corpus.size () * 100);
+        for (std::size_t i = 0; i < h.parsed.size (); ++i)
+        {
+            auto const& item = corpus[i % corpus.size ()];
+            BEAST_EXPECT(h.parsed[i] == std::string (
+                item.second.begin () + Message::kHeaderBytes,
+                    item.second.end ()));
+        }
+
+#if CASINOCOIN_PROTOBUF_ARENA
+        // The first block is reused, only the large ledger data
+        // message needs more
+        BEAST_EXPECT(allocations > 1);
+        auto const small = MessageArena::allocations ();
+        for (int i = 0; i < 100; ++i)
+            for (std::size_t j = 0; j + 1 < corpus.size (); ++j)
+                invokeProtocolMessage (
+                    boost::asio::buffer (corpus[j].second), h, arena);
+        BEAST_EXPECT(MessageArena::allocations () == small);
+#else
+        BEAST_EXPECT(allocations == 100 * corpus.size ());
+#endif
+    }
+
+    void
+    testKept ()
+    {
+        testcase ("Kept");
+
+        // Messages a handler holds on to survive those parsed later
+        auto const corpus = makeCorpus ();
+        MessageArena arena;
+        ProtocolMessageHandler h;
+        h.keep = true;
+        for (int i = 0; i < 3; ++i)
+            for (auto const& item : corpus)
+                invokeProtocolMessage (
+                    boost::asio::buffer (item.second), h, arena);
+
+        if (! BEAST_EXPECT(h.kept.size () == 3 * corpus.size ()))
+            return;
+        for (std::size_t i = 0; i < h.kept.size (); ++i)
+            BEAST_EXPECT(h.kept[i]->SerializeAsString () == h.parsed[i]);
+    }
+
+    void
+    testSplit ()
+    {
+        testcase ("Split");
+
+        // Payloads straddling the buffers of a sequence
+        auto const corpus = makeCorpus ();
+        MessageArena arena;
+        for (bool compressed : {false, true})
+        {
+            auto const& item = corpus.back ();
+            auto buf = item.second;
+            if (compressed)
+            {
+                protocol::TMLedgerData ld;
+                ld.ParseFromArray (buf.data () + Message::kHeaderBytes,
+                    buf.size () - Message::kHeaderBytes);
+                for (auto& node : *ld.mutable_nodes ())
+                    node.set_nodedata (std::string (120, 'x'));
+                buf = Message (ld, protocol::mtLEDGER_DATA).getBuffer (true);
+                BEAST_EXPECT(Message::compressed (boost::asio::buffer (buf)));
+            }
+
+            ProtocolMessageHandler whole;
+            invokeProtocolMessage (boost::asio::buffer (buf), whole, arena);
+            for (std::size_t split : {std::size_t{3}, std::size_t{100},
+                buf.size () / 2, buf.size () - 1})
+            {
+                std::array<boost::asio::const_buffer, 2> const buffers {{
+                    boost::asio::buffer (buf.data (), split),
+                    boost::asio::buffer (buf.data () + split,
+                        buf.size () - split) }};
+                ProtocolMessageHandler h;
+                auto const result = invokeProtocolMessage (buffers, h, arena);
+                BEAST_EXPECT(! result.second);
+                BEAST_EXPECT(result.first == buf.size ());
+                BEAST_EXPECT(h.parsed == whole.parsed);
+            }
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testArena ();
+        testKept ();
+        testSplit ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Compares parsing inbound messages onto the heap and onto an arena.
+
+    Reads a corpus of captured messages in wire format, as received on a
+    peer connection after TLS, from the file named by the suite argument.
+    Without an argument a synthetic corpus of common messages is used.
+    Compressed messages are measured after decompression.
+
+    Allocations for the heap path are estimated from the parsed fields.
+*/
+class ProtocolMessageBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Handler
+    {
+        boost::system::error_code
+        onMessageUnknown (std::uint16_t)
+        {
+            return {};
+        }
+
+        boost::system::error_code
+        onMessageBegin (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const&,
+            std::size_t, std::size_t)
+        {
+            return {};
+        }
+
+        template <class T>
+        void
+        onMessage (std::shared_ptr <T> const&)
+        {
+        }
+
+        void
+        onMessageEnd (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const&)
+        {
+        }
+    };
+
+    struct Stats
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+        std::size_t heapAllocations = 0;
+        std::chrono::nanoseconds heap {0};
+        std::chrono::nanoseconds arena {0};
+        std::uint64_t arenaAllocations = 0;
+    };
+
+    // Heap allocations made parsing the fields of m without an arena:
+    // sub-messages, repeated field arrays and string storage
+    static
+    std::size_t
+    fieldAllocations (::google::protobuf::Message const& m)
+    {
+        using google::protobuf::FieldDescriptor;
+        auto const* r = m.GetReflection ();
+        std::vector<FieldDescriptor const*> fields;
+        r->ListFields (m, &fields);
+
+        auto string = [](std::string const& s)
+        {
+            // The string object, plus its buffer unless inline
+            return s.size () < sizeof (std::string) ? 1 : 2;
+        };
+
+        std::size_t n = 0;
+        for (auto f : fields)
+        {
+            if (f->is_repeated ())
+            {
+                ++n;
+                for (int i = 0; i < r->FieldSize (m, f); ++i)
+                {
+                    if (f->cpp_type () == FieldDescriptor::CPPTYPE_MESSAGE)
+                        n += 1 + fieldAllocations (
+                            r->GetRepeatedMessage (m, f, i));
+                    else if (f->cpp_type () == FieldDescriptor::CPPTYPE_STRING)
+                        n += string (r->GetRepeatedString (m, f, i));
+                }
+            }
+            else if (f->cpp_type () == FieldDescriptor::CPPTYPE_MESSAGE)
+            {
+                n += 1 + fieldAllocations (r->GetMessage (m, f));
+            }
+            else if (f->cpp_type () == FieldDescriptor::CPPTYPE_STRING)
+            {
+                n += string (r->GetString (m, f));
+            }
+        }
+        return n;
+    }
+
+    // Splits a captured stream into uncompressed messages
+    bool
+    readCorpus (std::string const& path,
+        std::vector<std::pair<std::string, std::vector<std::uint8_t>>>& corpus)
+    {
+        std::ifstream in (path, std::ios::binary);
+        if (! in)
+        {
+            log << "can't open " << path << std::endl;
+            return false;
+        }
+        std::vector<std::uint8_t> const data {
+            std::istreambuf_iterator<char> (in),
+            std::istreambuf_iterator<char> ()};
+
+        std::size_t pos = 0;
+        while (data.size () - pos >= Message::kHeaderBytes)
+        {
+            auto const b = boost::asio::buffer (
+                data.data () + pos, data.size () - pos);
+            auto const size = Message::kHeaderBytes + Message::size (b);
+            if (data.size () - pos < size)
+                break;
+            auto const type = Message::type (b);
+            std::vector<std::uint8_t> item (
+                data.begin () + pos, data.begin () + pos + size);
+            if (Message::compressed (b))
+            {
+                std::vector<std::uint8_t> payload;
+                if (! Message::decompress (item.data () + Message::kHeaderBytes,
+                        size - Message::kHeaderBytes, payload))
+                {
+                    log << "bad message at offset " << pos << std::endl;
+                    return false;
+                }
+                item.resize (Message::kHeaderBytes);
+                item[0] = static_cast<std::uint8_t> (payload.size () >> 24);
+                item[1] = static_cast<std::uint8_t> (payload.size () >> 16);
+                item[2] = static_cast<std::uint8_t> (payload.size () >> 8);
+                item[3] = static_cast<std::uint8_t> (payload.size ());
+                item.insert (item.end (), payload.begin (), payload.end ());
+            }
+            corpus.emplace_back (protocolMessageName (type), std::move (item));
+            pos += size;
+        }
+        return true;
+    }
+
+public:
+    void
+    run () override
+    {
+        using namespace std::chrono;
+
+        std::vector<std::pair<std::string, std::vector<std::uint8_t>>> corpus;
+        if (arg ().empty ())
+            corpus = makeCorpus ();
+        else if (! readCorpus (arg (), corpus))
+            return;
+
+        std::size_t const passes = arg ().empty () ? 20000 : 10;
+
+        // One empty message of each type, to allocate heap copies from
+        std::map<std::string, std::unique_ptr<::google::protobuf::Message>> types;
+        std::map<std::string, Stats> stats;
+        {
+            ProtocolMessageHandler h;
+            h.keep = true;
+            for (auto const& item : corpus)
+            {
+                h.kept.clear ();
+                invokeProtocolMessage (boost::asio::buffer (item.second), h);
+                if (h.kept.empty ())
+                    continue;
+                auto& s = stats[item.first];
+                ++s.count;
+                s.bytes += item.second.size ();
+                s.heapAllocations += 1 + fieldAllocations (*h.kept.front ());
+                if (! types.count (item.first))
+                    types[item.first].reset (h.kept.front ()->New ());
+            }
+        }
+
+        Handler h;
+        MessageArena arena;
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto const& item : corpus)
+            {
+                auto it = types.find (item.first);
+                if (it == types.end ())
+                    continue;
+                auto& s = stats[item.first];
+                auto const buffer = boost::asio::buffer (item.second);
+
+                // What every message cost before arenas
+                auto start = clock_type::now ();
+                {
+                    std::shared_ptr<::google::protobuf::Message> m (
+                        it->second->New ());
+                    ZeroCopyInputStream<
+                        boost::asio::const_buffers_1> stream (buffer);
+                    stream.Skip (Message::kHeaderBytes);
+                    m->ParseFromZeroCopyStream (&stream);
+                }
+                s.heap += clock_type::now () - start;
+
+                auto const before = MessageArena::allocations ();
+                start = clock_type::now ();
+                invokeProtocolMessage (buffer, h, arena);
+                s.arena += clock_type::now () - start;
+                s.arenaAllocations += MessageArena::allocations () - before;
+            }
+        }
+
+        log << std::fixed << corpus.size () << " messages, " << passes << " passes" <<
+            (CASINOCOIN_PROTOBUF_ARENA ? "" : " (no arena support)") <<
+            std::endl;
+        for (auto const& e : stats)
+        {
+            auto const& s = e.second;
+            auto const n = static_cast<double> (s.count * passes);
+            log << std::setw (12) << std::left << e.first << std::right <<
+                std::setw (7) << s.count << " msgs " <<
+                std::setw (7) << s.bytes / s.count << " bytes, heap " <<
+                std::setw (7) << static_cast<std::size_t> (
+                    s.heap.count () / n) << " ns ~" <<
+                std::setw (7) << std::setprecision (1) <<
+                    static_cast<double> (s.heapAllocations) / s.count <<
+                " allocs, arena " <<
+                std::setw (7) << static_cast<std::size_t> (
+                    s.arena.count () / n) << " ns " <<
+                std::setw (7) << std::setprecision (3) <<
+                    s.arenaAllocations / n <<
+                " allocs" << std::endl;
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ProtocolMessage,overlay,casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(ProtocolMessageBench,overlay,casinocoin);
+
+} // test
+} // casinocoin
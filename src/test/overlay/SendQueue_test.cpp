@@ -0,0 +1,236 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/make_SSLContext.h>
+#include <casinocoin/overlay/impl/SendQueue.h>
+#include <casinocoin/overlay/impl/Tuning.h>
+#include <casinocoin/beast/unit_test.h>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <chrono>
+#include <thread>
+
+namespace casinocoin {
+
+class SendQueue_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static
+    Message::pointer
+    makeMessage (std::size_t size, char fill)
+    {
+        protocol::TMTransaction tx;
+        tx.set_rawtransaction (std::string (size, fill));
+        tx.set_status (protocol::tsNEW);
+        return std::make_shared<Message> (tx, protocol::mtTRANSACTION);
+    }
+
+    struct Result
+    {
+        std::size_t writes = 0;
+        double seconds = 0;
+    };
+
+    // Writes the messages to the client end of a loopback SSL
+    // connection, the way PeerImp drains its send queue
+    static
+    Result
+    loopback (
+        beast::unit_test::suite& suite,
+        std::vector<Message::pointer> const& messages,
+        std::size_t maxMessages)
+    {
+        using namespace boost::asio;
+        using stream_type = ssl::stream<ip::tcp::socket&>;
+
+        std::string expected;
+        for (auto const& m : messages)
+            expected.append (m->getBuffer ().begin (), m->getBuffer ().end ());
+
+        io_service ios;
+        auto context = make_SSLContext ("");
+        ip::tcp::acceptor acceptor (ios, ip::tcp::endpoint (
+            ip::address::from_string ("127.0.0.1"), 0));
+        ip::tcp::socket server (ios);
+        ip::tcp::socket client (ios);
+
+        std::string received (expected.size (), '\0');
+        std::thread reader ([&]()
+        {
+            acceptor.accept (server);
+            stream_type stream (server, *context);
+            stream.handshake (stream_type::server);
+            read (stream, buffer (&received[0], received.size ()));
+        });
+
+        client.connect (acceptor.local_endpoint ());
+        stream_type stream (client, *context);
+        stream.handshake (stream_type::client);
+
+        Result result;
+        SendQueue queue (maxMessages, Tuning::sendBatchBytes);
+        auto const start = clock_type::now ();
+        for (auto const& m : messages)
+            queue.push (m);
+        while (! queue.empty ())
+        {
+            write (stream, queue.prepare (false));
+            queue.consume ();
+            ++result.writes;
+        }
+        reader.join ();
+        result.seconds = std::chrono::duration<double> (
+            clock_type::now () - start).count ();
+
+        suite.expect (received == expected, "Received the messages");
+        return result;
+    }
+
+private:
+    void
+    testBatch ()
+    {
+        testcase ("Batch");
+
+        std::vector<Message::pointer> messages;
+        for (int i = 0; i < 100; ++i)
+            messages.push_back (makeMessage (200, 'a' + i % 26));
+        auto const size = messages.front ()->getBuffer ().size ();
+
+        // Limited by the number of messages
+        {
+            SendQueue queue (64, 1024 * 1024);
+            for (auto const& m : messages)
+                queue.push (m);
+            auto buf = queue.prepare (false);
+            BEAST_EXPECT(boost::asio::buffer_size (buf) == 64 * size);
+            BEAST_EXPECT(queue.writing () == 64);
+            BEAST_EXPECT(queue.size () == 100);
+            BEAST_EXPECT(std::equal (messages[63]->getBuffer ().begin (),
+                messages[63]->getBuffer ().end (),
+                boost::asio::buffer_cast<std::uint8_t const*> (buf) +
+                    63 * size));
+            BEAST_EXPECT(queue.consume () == 64);
+            BEAST_EXPECT(queue.writing () == 0);
+            buf = queue.prepare (false);
+            BEAST_EXPECT(boost::asio::buffer_size (buf) == 36 * size);
+            BEAST_EXPECT(queue.consume () == 36);
+            BEAST_EXPECT(queue.empty ());
+        }
+
+        // Limited by the number of bytes
+        {
+            SendQueue queue (64, 10 * size + size / 2);
+            for (auto const& m : messages)
+                queue.push (m);
+            std::size_t writes = 0;
+            while (! queue.empty ())
+            {
+                auto const buf = queue.prepare (false);
+                BEAST_EXPECT(boost::asio::buffer_size (buf) == 10 * size);
+                BEAST_EXPECT(queue.consume () == 10);
+                ++writes;
+            }
+            BEAST_EXPECT(writes == 10);
+        }
+
+        // A large message is written from its own buffer
+        {
+            SendQueue queue (64, 4096);
+            auto const large = makeMessage (10000, 'x');
+            queue.push (large);
+            queue.push (messages[0]);
+            queue.push (messages[1]);
+            auto buf = queue.prepare (false);
+            BEAST_EXPECT(boost::asio::buffer_cast<std::uint8_t const*> (buf) ==
+                large->getBuffer ().data ());
+            BEAST_EXPECT(queue.consume () == 1);
+            buf = queue.prepare (false);
+            BEAST_EXPECT(boost::asio::buffer_size (buf) == 2 * size);
+            BEAST_EXPECT(queue.consume () == 2);
+        }
+    }
+
+    void
+    testLoopback ()
+    {
+        testcase ("Loopback");
+
+        std::vector<Message::pointer> messages;
+        for (int i = 0; i < 1000; ++i)
+            messages.push_back (makeMessage (100 + i % 7 * 50, 'a' + i % 26));
+        messages.insert (messages.begin () + 500, makeMessage (100000, 'z'));
+
+        auto const single = loopback (*this, messages, 1);
+        BEAST_EXPECT(single.writes == messages.size ());
+
+        auto const batched = loopback (
+            *this, messages, Tuning::sendBatchMessages);
+        BEAST_EXPECT(batched.writes < messages.size () / 10);
+    }
+
+public:
+    void
+    run () override
+    {
+        testBatch ();
+        testLoopback ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Compares writing a burst of small messages one per write to
+// writing them in batches over a loopback SSL connection
+class SendQueueBench_test : public beast::unit_test::suite
+{
+    void
+    bench (std::size_t maxMessages, std::size_t n)
+    {
+        std::vector<Message::pointer> messages;
+        for (std::size_t i = 0; i < n; ++i)
+            messages.push_back (SendQueue_test::makeMessage (
+                150 + i % 5 * 40, 'a' + i % 26));
+
+        auto const result = SendQueue_test::loopback (
+            *this, messages, maxMessages);
+        log << "max " << maxMessages << " messages per write: " <<
+            n << " messages, " << result.writes << " writes, " <<
+            static_cast<std::size_t> (n / result.seconds) <<
+            " messages/sec" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        bench (1, 200000);
+        bench (Tuning::sendBatchMessages, 200000);
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SendQueue,overlay,casinocoin);
+BEAST_DEFINE_TESTSUITE_MANUAL(SendQueueBench,overlay,casinocoin);
+
+} // casinocoin
@@ -0,0 +1,328 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/overlay/Squelch.h>
+#include <casinocoin/beast/clock/manual_clock.h>
+#include <casinocoin/beast/unit_test.h>
+#include <test/csf/BasicNetwork.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+
+namespace casinocoin {
+namespace test {
+
+class Squelch_test : public beast::unit_test::suite
+{
+    using clock_type = beast::manual_clock <std::chrono::steady_clock>;
+
+    //--------------------------------------------------------------------------
+
+    // A validator flooding messages over a csf network, squelching
+    // the peers which relay duplicates when enabled
+    struct Node
+    {
+        using Net = csf::BasicNetwork<Node*>;
+        using Slots = SquelchSlots<int, Node*, Net::clock_type>;
+
+        int const id;
+        Net& net;
+        bool const squelch;
+        Slots slots;
+        std::map<Node*, Squelched<int, Net::clock_type>> squelchedBy;
+        std::set<std::pair<int, int>> seen;
+        int seq = 0;
+
+        std::size_t received = 0;
+        std::size_t duplicates = 0;
+        std::size_t suppressed = 0;
+
+        Node (int id_, Net& net_, bool squelch_, Slots::Setup const& setup)
+            : id (id_)
+            , net (net_)
+            , squelch (squelch_)
+            , slots (setup, [this](int validator, Node* const& peer,
+                std::chrono::seconds duration)
+            {
+                net.send (this, peer, [this, peer, validator, duration]
+                {
+                    peer->squelchedBy[this].squelch (
+                        validator, duration, net.now ());
+                });
+            })
+        {
+        }
+
+        void
+        originate ()
+        {
+            seen.emplace (id, ++seq);
+            relay (id, seq, nullptr);
+        }
+
+        void
+        receive (Node* from, int validator, int s)
+        {
+            ++received;
+            if (squelch)
+                slots.update (validator, from, net.now ());
+            if (! seen.emplace (validator, s).second)
+            {
+                ++duplicates;
+                return;
+            }
+            relay (validator, s, from);
+        }
+
+        void
+        relay (int validator, int s, Node* from)
+        {
+            for (auto const& link : net.links (this))
+            {
+                auto const to = link.to;
+                if (to == from)
+                    continue;
+                if (squelchedBy[to].isSquelched (validator, net.now ()))
+                {
+                    ++suppressed;
+                    continue;
+                }
+                net.send (this, to, [this, to, validator, s]
+                {
+                    to->receive (this, validator, s);
+                });
+            }
+        }
+
+        // Originate a message every second until `end`
+        void
+        start (Net::time_point end)
+        {
+            using namespace std::chrono_literals;
+            net.timer (1s, [this, end]
+            {
+                if (net.now () >= end)
+                    return;
+                originate ();
+                slots.deleteIdle (net.now ());
+                start (end);
+            });
+        }
+    };
+
+    struct Totals
+    {
+        std::size_t received = 0;
+        std::size_t duplicates = 0;
+        std::size_t suppressed = 0;
+        std::size_t missing = 0;
+    };
+
+    // Floods messages from every node over a random mesh
+    Totals
+    simulate (int nodes, int links, std::chrono::seconds length,
+        bool squelch)
+    {
+        using namespace std::chrono_literals;
+
+        // Select sooner than the default, messages being far
+        // less frequent than proposals and validations
+        Node::Slots::Setup setup;
+        setup.messageThreshold = 5;
+
+        Node::Net net;
+        std::vector<std::unique_ptr<Node>> peers;
+        for (int i = 0; i < nodes; ++i)
+            peers.push_back (std::make_unique<Node> (
+                i, net, squelch, setup));
+
+        std::mt19937 gen (42);
+        std::uniform_int_distribution<int> peer (0, nodes - 1);
+        std::uniform_int_distribution<int> delay (20, 200);
+        for (int i = 0; i < nodes; ++i)
+        {
+            int connected = 0;
+            while (connected < links)
+            {
+                if (net.connect (peers[i].get (), peers[peer (gen)].get (),
+                        std::chrono::milliseconds (delay (gen))))
+                    ++connected;
+            }
+        }
+
+        auto const end = net.now () + length;
+        for (auto& p : peers)
+            p->start (end);
+        net.step ();
+
+        Totals totals;
+        for (auto const& p : peers)
+        {
+            totals.received += p->received;
+            totals.duplicates += p->duplicates;
+            totals.suppressed += p->suppressed;
+            for (auto const& q : peers)
+                totals.missing += q->seq - std::count_if (
+                    p->seen.begin (), p->seen.end (),
+                    [&](auto const& s) { return s.first == q->id; });
+        }
+        log << nodes << " nodes, " << (squelch ? "squelched" : "flooded") <<
+            ": " << totals.received << " received, " << totals.duplicates <<
+            " duplicates, " << totals.suppressed << " suppressed, " <<
+            totals.missing << " missing" << std::endl;
+        return totals;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    testSlots ()
+    {
+        testcase ("Slots");
+
+        using namespace std::chrono_literals;
+        using Slots = SquelchSlots<int, int, clock_type>;
+
+        clock_type clock;
+        std::map<int, std::chrono::seconds> squelches;
+        Slots::Setup setup;
+        setup.messageThreshold = 3;
+        setup.selectedPeers = 2;
+        Slots slots (setup, [&](int validator, int const& peer,
+            std::chrono::seconds duration)
+        {
+            BEAST_EXPECT(validator == 7);
+            squelches[peer] = duration;
+        });
+
+        auto send = [&](int peer, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                slots.update (7, peer, clock.now ());
+        };
+
+        auto expectSquelched = [&](std::size_t n)
+        {
+            auto const squelched = slots.squelched (7);
+            BEAST_EXPECT(squelched.size () == n);
+            for (auto const p : squelched)
+            {
+                BEAST_EXPECT(squelches[p] >= setup.minSquelch);
+                BEAST_EXPECT(squelches[p] <= setup.maxSquelch);
+            }
+        };
+
+        // Nobody is selected until enough peers reach the threshold
+        for (int peer = 0; peer < 5; ++peer)
+            send (peer, 2);
+        BEAST_EXPECT(slots.selected (7).empty ());
+        send (0, 1);
+        BEAST_EXPECT(slots.selected (7).empty ());
+        send (1, 1);
+        BEAST_EXPECT(slots.selected (7).size () == 2);
+        expectSquelched (3);
+        BEAST_EXPECT(squelches.size () == 3);
+
+        // Peers showing up later are squelched right away, and
+        // squelched peers which keep sending are ignored
+        send (5, 1);
+        expectSquelched (4);
+        for (auto const p : slots.squelched (7))
+            send (p, 5);
+        expectSquelched (4);
+        BEAST_EXPECT(squelches.size () == 4);
+
+        // Losing a selected peer releases the squelched ones
+        slots.deletePeer (slots.selected (7).front ());
+        BEAST_EXPECT(slots.selected (7).empty ());
+        BEAST_EXPECT(slots.squelched (7).empty ());
+        for (auto const& s : squelches)
+            BEAST_EXPECT(s.second == 0s);
+
+        // Select again, then let the selected peers go quiet
+        for (int peer = 1; peer < 6; ++peer)
+            send (peer, 3);
+        BEAST_EXPECT(slots.selected (7).size () == 2);
+        expectSquelched (3);
+        clock.advance (5s);
+        slots.deleteIdle (clock.now ());
+        BEAST_EXPECT(slots.selected (7).size () == 2);
+        clock.advance (5s);
+        slots.deleteIdle (clock.now ());
+        BEAST_EXPECT(slots.selected (7).empty ());
+        BEAST_EXPECT(slots.squelched (7).empty ());
+        BEAST_EXPECT(slots.size () == 1);
+        clock.advance (10s);
+        slots.deleteIdle (clock.now ());
+        BEAST_EXPECT(slots.size () == 0);
+    }
+
+    void
+    testSquelched ()
+    {
+        testcase ("Squelched");
+
+        using namespace std::chrono_literals;
+        clock_type clock;
+        Squelched<int, clock_type> squelched;
+        BEAST_EXPECT(! squelched.isSquelched (1, clock.now ()));
+        squelched.squelch (1, 10s, clock.now ());
+        squelched.squelch (2, 20s, clock.now ());
+        BEAST_EXPECT(squelched.isSquelched (1, clock.now ()));
+        clock.advance (10s);
+        BEAST_EXPECT(! squelched.isSquelched (1, clock.now ()));
+        BEAST_EXPECT(squelched.isSquelched (2, clock.now ()));
+        squelched.squelch (2, 0s, clock.now ());
+        BEAST_EXPECT(! squelched.isSquelched (2, clock.now ()));
+    }
+
+    void
+    testNetwork ()
+    {
+        testcase ("Network");
+
+        using namespace std::chrono_literals;
+        auto const flooded = simulate (50, 4, 40s, false);
+        auto const squelched = simulate (50, 4, 40s, true);
+
+        BEAST_EXPECT(flooded.missing == 0);
+        BEAST_EXPECT(squelched.missing == 0);
+        BEAST_EXPECT(flooded.suppressed == 0);
+        BEAST_EXPECT(squelched.suppressed > 0);
+        BEAST_EXPECT(squelched.received * 2 < flooded.received);
+        BEAST_EXPECT(squelched.duplicates * 2 < flooded.duplicates);
+    }
+
+public:
+    void
+    run () override
+    {
+        testSlots ();
+        testSquelched ();
+        testNetwork ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Squelch,overlay,casinocoin);
+
+} // test
+} // casinocoin
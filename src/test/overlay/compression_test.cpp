@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright 2014 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <BeastConfig.h>
+#include <casinocoin/overlay/Message.h>
+#include <casinocoin/overlay/impl/ProtocolMessage.h>
+#include <casinocoin/beast/unit_test.h>
+#include <boost/asio/buffer.hpp>
+#include <random>
+
+namespace casinocoin {
+
+class compression_test : public beast::unit_test::suite
+{
+    // Records what invokeProtocolMessage hands to a peer
+    struct Handler
+    {
+        std::shared_ptr <::google::protobuf::Message> message;
+        std::size_t size = 0;
+        std::size_t uncompressedSize = 0;
+
+        boost::system::error_code
+        onMessageUnknown (std::uint16_t)
+        {
+            return {};
+        }
+
+        boost::system::error_code
+        onMessageBegin (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const& m,
+            std::size_t size_, std::size_t uncompressedSize_)
+        {
+            message = m;
+            size = size_;
+            uncompressedSize = uncompressedSize_;
+            return {};
+        }
+
+        template <class T>
+        void
+        onMessage (std::shared_ptr <T> const&)
+        {
+        }
+
+        void
+        onMessageEnd (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const&)
+        {
+        }
+    };
+
+    static
+    protocol::TMLedgerData
+    makeLedgerData (bool random)
+    {
+        std::mt19937 gen;
+        protocol::TMLedgerData ld;
+        ld.set_ledgerhash (std::string (32, 'h'));
+        ld.set_ledgerseq (1000);
+        ld.set_type (protocol::liAS_NODE);
+        for (int i = 0; i < 200; ++i)
+        {
+            std::string id (33, static_cast<char> (i));
+            std::string data (120, 'x');
+            if (random)
+            {
+                for (auto& c : id)
+                    c = static_cast<char> (gen ());
+                for (auto& c : data)
+                    c = static_cast<char> (gen ());
+            }
+            else
+            {
+                data[i % data.size ()] = static_cast<char> (i);
+            }
+            auto node = ld.add_nodes ();
+            node->set_nodedata (data);
+            node->set_nodeid (id);
+        }
+        return ld;
+    }
+
+    void
+    testCompressed ()
+    {
+        testcase ("Compressed");
+
+        auto const ld = makeLedgerData (false);
+        Message const m (ld, protocol::mtLEDGER_DATA);
+        auto const& plain = m.getBuffer ();
+        auto const& packed = m.getBuffer (true);
+
+        BEAST_EXPECT(packed.size () < plain.size () / 4);
+        BEAST_EXPECT(! Message::compressed (boost::asio::buffer (plain)));
+        BEAST_EXPECT(Message::compressed (boost::asio::buffer (packed)));
+        BEAST_EXPECT(Message::size (boost::asio::buffer (packed)) +
+            Message::kHeaderBytes == packed.size ());
+        BEAST_EXPECT(Message::type (boost::asio::buffer (packed)) ==
+            protocol::mtLEDGER_DATA);
+
+        // Compressed once and shared
+        BEAST_EXPECT(&m.getBuffer (true) == &packed);
+
+        for (auto const buf : {&plain, &packed})
+        {
+            Handler h;
+            auto const result = invokeProtocolMessage (
+                boost::asio::buffer (*buf), h);
+            BEAST_EXPECT(! result.second);
+            BEAST_EXPECT(result.first == buf->size ());
+            BEAST_EXPECT(h.size == buf->size ());
+            BEAST_EXPECT(h.uncompressedSize == plain.size ());
+            if (BEAST_EXPECT(h.message))
+                BEAST_EXPECT(h.message->SerializeAsString () ==
+                    ld.SerializeAsString ());
+        }
+
+        // Incomplete messages are not consumed
+        {
+            Handler h;
+            auto const result = invokeProtocolMessage (
+                boost::asio::buffer (packed.data (), packed.size () - 1), h);
+            BEAST_EXPECT(! result.second);
+            BEAST_EXPECT(result.first == 0);
+        }
+    }
+
+    void
+    testUncompressed ()
+    {
+        testcase ("Uncompressed");
+
+        // Below the threshold
+        {
+            protocol::TMPing ping;
+            ping.set_type (protocol::TMPing::ptPING);
+            ping.set_seq (42);
+            Message const m (ping, protocol::mtPING);
+            BEAST_EXPECT(&m.getBuffer (true) == &m.getBuffer ());
+        }
+
+        // Not worth it
+        {
+            Message const m (makeLedgerData (true), protocol::mtLEDGER_DATA);
+            BEAST_EXPECT(&m.getBuffer (true) == &m.getBuffer ());
+        }
+    }
+
+    void
+    testMalformed ()
+    {
+        testcase ("Malformed");
+
+        Message const m (makeLedgerData (false), protocol::mtLEDGER_DATA);
+
+        auto check = [&](std::vector<std::uint8_t> const& buf)
+        {
+            Handler h;
+            auto const result = invokeProtocolMessage (
+                boost::asio::buffer (buf), h);
+            BEAST_EXPECT(result.second);
+            BEAST_EXPECT(! h.message);
+        };
+
+        // Claims more than the limit
+        auto buf = m.getBuffer (true);
+        buf[Message::kHeaderBytes] = 0xFF;
+        check (buf);
+
+        // Claims more than LZ4 could produce from it
+        buf = m.getBuffer (true);
+        buf[Message::kHeaderBytes + 1] = 0xFF;
+        check (buf);
+
+        // Claims more than it holds
+        buf = m.getBuffer (true);
+        buf[Message::kHeaderBytes + 2] ^= 0x10;
+        check (buf);
+
+        // Garbage payload
+        buf = m.getBuffer (true);
+        for (std::size_t i = Message::kHeaderBytes + 4; i < buf.size (); ++i)
+            buf[i] = static_cast<std::uint8_t> (i * 7);
+        check (buf);
+    }
+
+public:
+    void
+    run()
+    {
+        testCompressed ();
+        testUncompressed ();
+        testMalformed ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(compression,overlay,casinocoin);
+
+}
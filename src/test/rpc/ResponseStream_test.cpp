@@ -0,0 +1,266 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+    Copyright (c) 2019 CasinoCoin Foundation
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/JobQueue.h>
+#include <casinocoin/rpc/impl/ResponseStream.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace casinocoin {
+namespace test {
+
+class ResponseStream_test : public beast::unit_test::suite
+{
+    class gate
+    {
+    private:
+        std::condition_variable cv_;
+        std::mutex mutex_;
+        bool signaled_ = false;
+
+    public:
+        // Thread safe, blocks until signaled or period expires.
+        // Returns `true` if signaled.
+        template <class Rep, class Period>
+        bool
+        wait_for(std::chrono::duration<Rep, Period> const& rel_time)
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            auto b = cv_.wait_for(lk, rel_time, [=]{ return signaled_; });
+            signaled_ = false;
+            return b;
+        }
+
+        void
+        signal()
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            signaled_ = true;
+            cv_.notify_all();
+        }
+    };
+
+    static std::size_t const limit = 16 * 1024;
+    static std::size_t const pieces = 1000;
+
+    static
+    std::string
+    piece (std::size_t i)
+    {
+        return "{\"piece\":" + std::to_string (i) +
+            ",\"data\":\"" + std::string (i % 1000, 'a' + i % 26) + "\"}";
+    }
+
+    // Start a coroutine writing the pieces to a new stream
+    std::shared_ptr<RPC::ResponseStream>
+    produce (jtx::Env& env, bool chunked, gate& done)
+    {
+        using namespace std::chrono_literals;
+        gate started;
+        std::shared_ptr<RPC::ResponseStream> stream;
+        env.app().getJobQueue().postCoro(jtCLIENT, "ResponseStream-Test",
+            [&, chunked](auto const& c)
+            {
+                auto s = std::make_shared<RPC::ResponseStream> (
+                    c, limit, chunked);
+                if (chunked)
+                    s->setHeader ("header\r\n\r\n");
+                stream = s;
+                started.signal();
+                for (std::size_t i = 0; i < pieces; ++i)
+                    s->write (piece (i));
+                s->finish ();
+                done.signal();
+            });
+        BEAST_EXPECT(started.wait_for(5s));
+        return stream;
+    }
+
+    static
+    std::string
+    expected ()
+    {
+        std::string s;
+        for (std::size_t i = 0; i < pieces; ++i)
+            s += piece (i);
+        return s;
+    }
+
+    // Remove the chunked transfer encoding, returning false if malformed
+    static
+    bool
+    unchunk (std::string const& in, std::string& out)
+    {
+        std::size_t pos = 0;
+        for (;;)
+        {
+            auto const eol = in.find ("\r\n", pos);
+            if (eol == std::string::npos)
+                return false;
+            auto const n = std::stoul (in.substr (pos, eol - pos), nullptr, 16);
+            pos = eol + 2;
+            if (in.size () < pos + n + 2 || in.compare (pos + n, 2, "\r\n") != 0)
+                return false;
+            if (n == 0)
+                return pos + 2 == in.size ();
+            out.append (in, pos, n);
+            pos += n + 2;
+        }
+    }
+
+    void
+    testWriter ()
+    {
+        testcase ("Writer");
+
+        using namespace std::chrono_literals;
+        jtx::Env env (*this);
+        gate done;
+        auto stream = produce (env, true, done);
+        if (! BEAST_EXPECT(stream))
+            return;
+
+        std::string out;
+        {
+            gate resumed;
+            auto w = stream->makeWriter ();
+            for (;;)
+            {
+                // Pull the data the way an HTTP session does
+                if (! w->prepare (4096, [&]{ resumed.signal(); }))
+                {
+                    if (! BEAST_EXPECT(resumed.wait_for (5s)))
+                        break;
+                    continue;
+                }
+                std::size_t n = 0;
+                for (auto const& b : w->data ())
+                {
+                    out.append (boost::asio::buffer_cast<char const*>(b),
+                        boost::asio::buffer_size (b));
+                    n += boost::asio::buffer_size (b);
+                }
+                w->consume (n);
+                if (w->complete ())
+                    break;
+            }
+        }
+        BEAST_EXPECT(done.wait_for (5s));
+
+        std::string const header = "header\r\n\r\n";
+        BEAST_EXPECT(out.compare (0, header.size (), header) == 0);
+        std::string body;
+        BEAST_EXPECT(unchunk (out.substr (header.size ()), body));
+        BEAST_EXPECT(body == expected ());
+        BEAST_EXPECT(stream->size () == body.size ());
+        BEAST_EXPECT(! stream->cancelled ());
+
+        // The writer waited for the reader instead of buffering it all
+        BEAST_EXPECT(stream->peak () < 2 * limit + 2 * 1024 + header.size ());
+        BEAST_EXPECT(stream->peak () < body.size () / 4);
+    }
+
+    void
+    testWSMsg ()
+    {
+        testcase ("WSMsg");
+
+        using namespace std::chrono_literals;
+        jtx::Env env (*this);
+        gate done;
+        auto stream = produce (env, false, done);
+        if (! BEAST_EXPECT(stream))
+            return;
+
+        std::string out;
+        {
+            gate resumed;
+            auto m = stream->makeWSMsg ();
+            for (;;)
+            {
+                auto const result =
+                    m->prepare (4096, [&]{ resumed.signal(); });
+                if (boost::indeterminate (result.first))
+                {
+                    if (! BEAST_EXPECT(resumed.wait_for (5s)))
+                        break;
+                    continue;
+                }
+                for (auto const& b : result.second)
+                {
+                    BEAST_EXPECT(boost::asio::buffer_size (b) <= 4096);
+                    out.append (boost::asio::buffer_cast<char const*>(b),
+                        boost::asio::buffer_size (b));
+                }
+                if (result.first)
+                    break;
+            }
+        }
+        BEAST_EXPECT(done.wait_for (5s));
+        BEAST_EXPECT(out == expected ());
+        BEAST_EXPECT(stream->peak () < 2 * limit + 2 * 1024);
+    }
+
+    void
+    testCancel ()
+    {
+        testcase ("Cancel");
+
+        using namespace std::chrono_literals;
+        jtx::Env env (*this);
+        gate done;
+        auto stream = produce (env, true, done);
+        if (! BEAST_EXPECT(stream))
+            return;
+
+        {
+            // Take one buffer, then go away like a closed connection
+            gate resumed;
+            auto w = stream->makeWriter ();
+            while (! w->prepare (4096, [&]{ resumed.signal(); }))
+            {
+                if (! BEAST_EXPECT(resumed.wait_for (5s)))
+                    break;
+            }
+        }
+
+        // The writer is resumed and its output discarded
+        BEAST_EXPECT(done.wait_for (5s));
+        BEAST_EXPECT(stream->cancelled ());
+        BEAST_EXPECT(stream->size () < expected ().size ());
+    }
+
+public:
+    void
+    run () override
+    {
+        testWriter ();
+        testWSMsg ();
+        testCancel ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ResponseStream, rpc, casinocoin);
+
+} // test
+} // casinocoin
@@ -24,6 +24,10 @@
 #include <casinocoin/basics/StringUtilities.h>
 #include <casinocoin/beast/unit_test.h>
 #include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/beast/xor_shift_engine.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 
 namespace casinocoin {
 namespace tests {
@@ -118,8 +122,152 @@ public:
         return vuc;
     }
 
+    void testInnerNode ()
+    {
+        testcase ("sparse inner node");
+
+        auto leaf = [](int branch)
+        {
+            uint256 key;
+            key.begin()[0] = branch << 4;
+            return std::make_shared<SHAMapTreeNode> (
+                std::make_shared<SHAMapItem const> (key, IntToVUC (branch)),
+                SHAMapAbstractNode::tnACCOUNT_STATE, 1);
+        };
+
+        auto const nodes = SHAMapInnerNode::getCount ();
+        auto const bytes = SHAMapInnerNode::getBytes ();
+
+        auto node = std::make_shared<SHAMapInnerNode> (1);
+        BEAST_EXPECT(node->isEmpty ());
+        BEAST_EXPECT(SHAMapInnerNode::getCount () == nodes + 1);
+
+        // Branches are added out of order
+        std::vector<int> const branches {9, 2, 15, 0, 7};
+        for (auto b : branches)
+            node->setChild (b, leaf (b));
+        node->updateHashDeep ();
+        BEAST_EXPECT(node->getBranchCount () == static_cast<int> (branches.size ()));
+
+        for (int b = 0; b < 16; ++b)
+        {
+            auto const child = node->getChild (b);
+            if (std::find (branches.begin (), branches.end (), b) ==
+                branches.end ())
+            {
+                BEAST_EXPECT(node->isEmptyBranch (b));
+                BEAST_EXPECT(! child);
+                BEAST_EXPECT(node->getChildHash (b).isZero ());
+                continue;
+            }
+            BEAST_EXPECT(! node->isEmptyBranch (b));
+            BEAST_EXPECT(child && child->getNodeHash () == node->getChildHash (b));
+            BEAST_EXPECT(child && static_cast<SHAMapTreeNode*> (
+                child.get ())->peekItem ()->peekData ()[0] == b);
+        }
+
+        // The serialized forms read back into the same node
+        for (auto format : {snfPREFIX, snfWIRE})
+        {
+            Serializer s;
+            node->addRaw (s, format);
+            auto const copy = SHAMapAbstractNode::make (makeSlice (s.peekData ()),
+                0, format, SHAMapHash{}, false, beast::Journal{});
+            BEAST_EXPECT(copy && copy->getNodeHash () == node->getNodeHash ());
+        }
+
+        // Only the branches in use take memory
+        std::int64_t const limit = sizeof (SHAMapInnerNode) + 16 *
+            (sizeof (SHAMapHash) + sizeof (std::shared_ptr<SHAMapTreeNode>));
+        BEAST_EXPECT(SHAMapInnerNode::getBytes () - bytes < limit);
+
+        auto const clone = std::static_pointer_cast<SHAMapInnerNode> (
+            node->clone (2));
+        clone->setChild (2, nullptr);
+        clone->setChild (4, leaf (4));
+        clone->updateHashDeep ();
+        BEAST_EXPECT(clone->getBranchCount () == static_cast<int> (branches.size ()));
+        BEAST_EXPECT(clone->isEmptyBranch (2) && ! clone->isEmptyBranch (4));
+        BEAST_EXPECT(! node->isEmptyBranch (2) && node->isEmptyBranch (4));
+        BEAST_EXPECT(clone->getNodeHash () != node->getNodeHash ());
+
+        for (auto b : {0, 4, 7, 9, 15})
+            clone->setChild (b, nullptr);
+        BEAST_EXPECT(clone->isEmpty ());
+
+        node.reset ();
+        BEAST_EXPECT(SHAMapInnerNode::getCount () == nodes + 1);
+    }
+
+    void testParallelFlush (SHAMap::version v)
+    {
+        testcase ("parallel flush");
+
+        beast::xor_shift_engine g (19);
+        std::vector<uint256> keys (2000);
+        for (auto& key : keys)
+        {
+            for (auto& b : key)
+                b = static_cast<unsigned char> (g ());
+        }
+
+        tests::TestFamily serial{beast::Journal{}};
+        tests::TestFamily parallel{beast::Journal{}};
+        parallel.setFlushThreads (4);
+
+        SHAMap a (SHAMapType::STATE, serial, v);
+        SHAMap b (SHAMapType::STATE, parallel, v);
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            auto const data = IntToVUC (static_cast<int> (i));
+            BEAST_EXPECT(a.addItem (SHAMapItem{keys[i], data}, false, false));
+            BEAST_EXPECT(b.addItem (SHAMapItem{keys[i], data}, false, false));
+        }
+
+        auto const flushed = a.flushDirty (hotACCOUNT_NODE, 1);
+        BEAST_EXPECT(b.flushDirty (hotACCOUNT_NODE, 1) == flushed);
+        BEAST_EXPECT(a.getHash () == b.getHash ());
+        b.invariants ();
+
+        // Every node was written
+        auto stored = [](SHAMap const& map, tests::TestFamily& f)
+        {
+            bool ok = true;
+            map.visitNodes ([&](SHAMapAbstractNode& node)
+            {
+                ok = ok && f.db ().fetch (
+                    node.getNodeHash ().as_uint256 ()) != nullptr;
+                return !ok;
+            });
+            return ok;
+        };
+        BEAST_EXPECT(stored (b, parallel));
+
+        // Change a few subtrees of a snapshot and flush again
+        a.setImmutable ();
+        b.setImmutable ();
+        auto a2 = a.snapShot (true);
+        auto b2 = b.snapShot (true);
+        for (std::size_t i = 0; i < keys.size (); i += 97)
+        {
+            auto item = std::make_shared<SHAMapItem const> (keys[i],
+                IntToVUC (-static_cast<int> (i)));
+            BEAST_EXPECT(a2->updateGiveItem (item, false, false));
+            BEAST_EXPECT(b2->updateGiveItem (item, false, false));
+        }
+        BEAST_EXPECT(a2->flushDirty (hotACCOUNT_NODE, 2) ==
+            b2->flushDirty (hotACCOUNT_NODE, 2));
+        BEAST_EXPECT(a2->getHash () == b2->getHash ());
+        BEAST_EXPECT(a2->getHash () != a.getHash ());
+        BEAST_EXPECT(stored (*b2, parallel));
+    }
+
     void run ()
     {
+        testInnerNode ();
+        testParallelFlush (SHAMap::version{1});
+        testParallelFlush (SHAMap::version{2});
+
         run (true,  SHAMap::version{1});
         run (false, SHAMap::version{1});
         run (true,  SHAMap::version{2});
@@ -324,5 +472,107 @@ public:
 
 BEAST_DEFINE_TESTSUITE(SHAMap,casinocoin_app,casinocoin);
 
+//------------------------------------------------------------------------------
+
+// Measures read only traversal of a large state map
+class SHAMapTraversal_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class Walk>
+    void
+    measure (std::string const& what, std::size_t n, Walk&& walk)
+    {
+        using namespace std::chrono;
+        std::size_t visited = 0;
+        auto const start = clock_type::now ();
+        for (std::size_t i = 0; i < n; ++i)
+            visited += walk (i);
+        auto const elapsed = clock_type::now () - start;
+        log << std::setw (18) << what << " " <<
+            duration_cast<nanoseconds>(elapsed).count () /
+                std::max<std::size_t> (visited, 1) <<
+            " ns/node (" << visited << " nodes)" << std::endl;
+    }
+
+public:
+    void
+    run () override
+    {
+        std::size_t const items = 200000;
+        std::size_t const changed = 2000;
+
+        beast::xor_shift_engine g (11);
+        auto randomKey = [&g]()
+        {
+            uint256 key;
+            for (auto& b : key)
+                b = static_cast<unsigned char> (g ());
+            return key;
+        };
+
+        tests::TestFamily f{beast::Journal{}};
+        auto map = std::make_shared<SHAMap> (SHAMapType::STATE, f,
+            SHAMap::version{1});
+        std::vector<uint256> keys;
+        keys.reserve (items);
+        for (std::size_t i = 0; i < items; ++i)
+        {
+            keys.push_back (randomKey ());
+            map->addItem (SHAMapItem{keys.back (), SHAMap_test::IntToVUC (i)},
+                false, false);
+        }
+        map->flushDirty (hotACCOUNT_NODE, 1);
+        map->setImmutable ();
+
+        // The next ledger's state with a few thousand changed entries
+        auto next = map->snapShot (true);
+        for (std::size_t i = 0; i < changed; ++i)
+        {
+            next->updateGiveItem (std::make_shared<SHAMapItem const> (
+                keys[(i * 7919) % items], SHAMap_test::IntToVUC (-1)),
+                false, false);
+        }
+        next->flushDirty (hotACCOUNT_NODE, 2);
+        next->setImmutable ();
+
+        measure ("iterate", 5, [&](std::size_t)
+        {
+            std::size_t n = 0;
+            for (auto const& item : *map)
+                n += item.key ().isNonZero () ? 1 : 0;
+            return n;
+        });
+        measure ("visitNodes", 5, [&](std::size_t)
+        {
+            std::size_t n = 0;
+            map->visitNodes ([&n](SHAMapAbstractNode&)
+            {
+                ++n;
+                return false;
+            });
+            return n;
+        });
+        measure ("visitDifferences", 20, [&](std::size_t)
+        {
+            std::size_t n = 0;
+            next->getFetchPack (map.get (), true, 1 << 30,
+                [&n](SHAMapHash const&, Blob const&) { ++n; });
+            return n;
+        });
+        measure ("findKey", 1, [&](std::size_t)
+        {
+            std::size_t n = 0;
+            for (auto const& key : keys)
+                n += map->hasItem (key) ? 1 : 0;
+            return n;
+        });
+        BEAST_EXPECT(static_cast<std::size_t> (
+            std::distance (map->begin (), map->end ())) == items);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapTraversal,casinocoin_app,casinocoin);
+
 } // tests
 } // casinocoin
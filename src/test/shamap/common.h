@@ -38,6 +38,7 @@ private:
     FullBelowCache fullbelow_;
     RootStoppable parent_;
     std::unique_ptr<NodeStore::Database> db_;
+    std::unique_ptr<TaskPool> flushPool_;
     beast::Journal j_;
 
 public:
@@ -45,6 +46,7 @@ public:
         : treecache_ ("TreeNodeCache", 65536, 60, clock_, j)
         , fullbelow_ ("full_below", clock_)
         , parent_ ("TestRootStoppable")
+        , flushPool_ (std::make_unique<TaskPool> ("SHAMap flush", 1))
         , j_ (j)
     {
         Section testSection;
@@ -102,6 +104,18 @@ public:
         return *db_;
     }
 
+    TaskPool&
+    flushPool() override
+    {
+        return *flushPool_;
+    }
+
+    void
+    setFlushThreads (std::size_t threads)
+    {
+        flushPool_ = std::make_unique<TaskPool> ("SHAMap flush", threads);
+    }
+
     void
     missing_node (std::uint32_t refNum) override
     {
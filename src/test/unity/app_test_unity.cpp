@@ -19,20 +19,29 @@
 //==============================================================================
 
 #include <test/app/AccountTxPaging_test.cpp>
+#include <test/app/AccountTxStore_test.cpp>
 #include <test/app/AmendmentTable_test.cpp>
+#include <test/app/Blacklist_test.cpp>
+#include <test/app/CasinocoinLineIndex_test.cpp>
 #include <test/app/CrossingLimits_test.cpp>
 #include <test/app/DeliverMin_test.cpp>
 #include <test/app/Discrepancy_test.cpp>
+#include <test/app/FetchScheduler_test.cpp>
 #include <test/app/Flow_test.cpp>
 #include <test/app/Freeze_test.cpp>
 #include <test/app/HashRouter_test.cpp>
 #include <test/app/LedgerLoad_test.cpp>
+#include <test/app/LedgerReplay_test.cpp>
 #include <test/app/LoadFeeTrack_test.cpp>
 #include <test/app/Manifest_test.cpp>
 #include <test/app/MultiSign_test.cpp>
 #include <test/app/OfferStream_test.cpp>
 #include <test/app/Offer_test.cpp>
+#include <test/app/OrderBookDB_test.cpp>
+#include <test/app/OwnerDirIndex_test.cpp>
+#include <test/app/ParallelApply_test.cpp>
 #include <test/app/OversizeMeta_test.cpp>
+#include <test/app/PathCache_test.cpp>
 #include <test/app/Path_test.cpp>
 #include <test/app/PayChan_test.cpp>
 #include <test/app/PayStrand_test.cpp>
@@ -45,8 +54,10 @@
 #include <test/app/Transaction_ordering_test.cpp>
 #include <test/app/TrustAndBalance_test.cpp>
 #include <test/app/TxQ_test.cpp>
+#include <test/app/TxVerifier_test.cpp>
 #include <test/app/ValidatorList_test.cpp>
 #include <test/app/ValidatorSite_test.cpp>
 #include <test/app/SetTrust_test.cpp>
 #include <test/app/Ticket_test.cpp>
 #include <test/app/PseudoTx_test.cpp>
+#include <test/app/WLT_test.cpp>
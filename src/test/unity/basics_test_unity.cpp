@@ -25,6 +25,8 @@
 #include <test/basics/hardened_hash_test.cpp>
 #include <test/basics/KeyCache_test.cpp>
 #include <test/basics/mulDiv_test.cpp>
+#include <test/basics/PoolAllocator_test.cpp>
 #include <test/basics/Slice_test.cpp>
 #include <test/basics/StringUtilities_test.cpp>
+#include <test/basics/TaskPool_test.cpp>
 #include <test/basics/TaggedCache_test.cpp>
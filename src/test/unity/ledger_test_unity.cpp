@@ -18,7 +18,9 @@
 */
 //==============================================================================
 
+#include <test/ledger/AccountIndex_test.cpp>
 #include <test/ledger/BookDirs_test.cpp>
+#include <test/ledger/CachedSLEs_test.cpp>
 #include <test/ledger/CashDiff_test.cpp>
 #include <test/ledger/Directory_test.cpp>
 #include <test/ledger/Invariants_test.cpp>
@@ -26,4 +28,5 @@
 #include <test/ledger/PendingSaves_test.cpp>
 #include <test/ledger/SHAMapV2_test.cpp>
 #include <test/ledger/SkipList_test.cpp>
+#include <test/ledger/StateMap_test.cpp>
 #include <test/ledger/View_test.cpp>
@@ -19,5 +19,9 @@
 //==============================================================================
 
 #include <test/overlay/cluster_test.cpp>
+#include <test/overlay/compression_test.cpp>
+#include <test/overlay/ProtocolMessage_test.cpp>
+#include <test/overlay/SendQueue_test.cpp>
 #include <test/overlay/short_read_test.cpp>
+#include <test/overlay/Squelch_test.cpp>
 #include <test/overlay/TMHello_test.cpp>
\ No newline at end of file
@@ -37,6 +37,7 @@
 #include <test/rpc/NoCasinocoin_test.cpp>
 #include <test/rpc/NoCasinocoinCheck_test.cpp>
 #include <test/rpc/Peers_test.cpp>
+#include <test/rpc/ResponseStream_test.cpp>
 #include <test/rpc/RobustTransaction_test.cpp>
 #include <test/rpc/RPCOverload_test.cpp>
 #include <test/rpc/ServerInfo_test.cpp>